@@ -0,0 +1,469 @@
+/*
+* laser_scan_view.h
+* Structure of arrays laser scan storage and vectorized polar to cartesian projection
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/core/laser_point.h>
+#include <rpos/core/pose.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#   include <emmintrin.h>
+#   define RPOS_CORE_LASER_SCAN_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define RPOS_CORE_LASER_SCAN_NEON
+#endif
+
+namespace rpos {
+    namespace core {
+
+        /**
+        * Non-owning structure of arrays view of a laser scan
+        *
+        * Point i is valid when bit (i % 64) of validMask[i / 64] is set. The view never copies, it can
+        * wrap a LaserScanBuffer or arrays filled directly by a driver.
+        */
+        class LaserScanView {
+        public:
+            LaserScanView()
+                : size_(0)
+                , distances_(nullptr)
+                , angles_(nullptr)
+                , qualities_(nullptr)
+                , validMask_(nullptr)
+            {}
+
+            /**
+            * @param qualities May be nullptr when the lidar reports no quality
+            */
+            LaserScanView(size_t size, const float* distances, const float* angles, const std::uint8_t* qualities, const std::uint64_t* validMask)
+                : size_(size)
+                , distances_(distances)
+                , angles_(angles)
+                , qualities_(qualities)
+                , validMask_(validMask)
+            {}
+
+        public:
+            size_t size() const
+            {
+                return size_;
+            }
+
+            bool empty() const
+            {
+                return !size_;
+            }
+
+            const float* distances() const
+            {
+                return distances_;
+            }
+
+            const float* angles() const
+            {
+                return angles_;
+            }
+
+            const std::uint8_t* qualities() const
+            {
+                return qualities_;
+            }
+
+            const std::uint64_t* validMask() const
+            {
+                return validMask_;
+            }
+
+            bool valid(size_t i) const
+            {
+                return (validMask_[i >> 6] >> (i & 63)) & 1;
+            }
+
+            std::uint8_t quality(size_t i) const
+            {
+                return qualities_ ? qualities_[i] : 0;
+            }
+
+        private:
+            size_t size_;
+            const float* distances_;
+            const float* angles_;
+            const std::uint8_t* qualities_;
+            const std::uint64_t* validMask_;
+        };
+
+        /**
+        * Owning structure of arrays laser scan
+        */
+        class LaserScanBuffer {
+        public:
+            LaserScanBuffer()
+            {}
+
+            explicit LaserScanBuffer(const std::vector<LaserPoint>& points)
+            {
+                assign(points);
+            }
+
+        public:
+            /**
+            * Convert from the array of structures representation, one pass over the points
+            */
+            void assign(const std::vector<LaserPoint>& points)
+            {
+                resize(points.size());
+                for (size_t i = 0; i < points.size(); i++)
+                {
+                    const LaserPoint& point = points[i];
+                    distances_[i] = point.distance();
+                    angles_[i] = point.angle();
+                    qualities_[i] = point.quality();
+                    if (point.valid())
+                        validMask_[i >> 6] |= std::uint64_t(1) << (i & 63);
+                }
+            }
+
+            void toLaserPoints(std::vector<LaserPoint>& points) const
+            {
+                points.clear();
+                points.reserve(size());
+                for (size_t i = 0; i < size(); i++)
+                    points.push_back(LaserPoint(distances_[i], angles_[i], valid(i), qualities_[i]));
+            }
+
+            /**
+            * Resize to size points, all points are cleared to invalid
+            */
+            void resize(size_t size)
+            {
+                distances_.assign(size, 0.0f);
+                angles_.assign(size, 0.0f);
+                qualities_.assign(size, 0);
+                validMask_.assign((size + 63) / 64, 0);
+            }
+
+            void clear()
+            {
+                resize(0);
+            }
+
+            void push_back(float distance, float angle, bool valid, std::uint8_t quality = 0)
+            {
+                size_t i = size();
+                distances_.push_back(distance);
+                angles_.push_back(angle);
+                qualities_.push_back(quality);
+                if ((i & 63) == 0)
+                    validMask_.push_back(0);
+                setValid(i, valid);
+            }
+
+            size_t size() const
+            {
+                return distances_.size();
+            }
+
+            bool valid(size_t i) const
+            {
+                return (validMask_[i >> 6] >> (i & 63)) & 1;
+            }
+
+            void setValid(size_t i, bool valid)
+            {
+                std::uint64_t bit = std::uint64_t(1) << (i & 63);
+                if (valid)
+                    validMask_[i >> 6] |= bit;
+                else
+                    validMask_[i >> 6] &= ~bit;
+            }
+
+            std::vector<float>& distances() { return distances_; }
+            const std::vector<float>& distances() const { return distances_; }
+
+            std::vector<float>& angles() { return angles_; }
+            const std::vector<float>& angles() const { return angles_; }
+
+            std::vector<std::uint8_t>& qualities() { return qualities_; }
+            const std::vector<std::uint8_t>& qualities() const { return qualities_; }
+
+            const std::vector<std::uint64_t>& validMask() const { return validMask_; }
+
+            LaserScanView view() const
+            {
+                if (distances_.empty())
+                    return LaserScanView();
+                return LaserScanView(size(), &distances_[0], &angles_[0], &qualities_[0], &validMask_[0]);
+            }
+
+        private:
+            std::vector<float> distances_;
+            std::vector<float> angles_;
+            std::vector<std::uint8_t> qualities_;
+            std::vector<std::uint64_t> validMask_;
+        };
+
+        /**
+        * Cosine and sine of every beam angle of a lidar whose angles do not change between scans
+        */
+        class LaserAngleTable {
+        public:
+            LaserAngleTable()
+            {}
+
+            LaserAngleTable(const float* angles, size_t count)
+            {
+                assign(angles, count);
+            }
+
+            LaserAngleTable(float startAngle, float increment, size_t count)
+            {
+                angles_.resize(count);
+                for (size_t i = 0; i < count; i++)
+                    angles_[i] = static_cast<float>(startAngle + static_cast<double>(increment) * i);
+                build_();
+            }
+
+        public:
+            void assign(const float* angles, size_t count)
+            {
+                angles_.assign(angles, angles + count);
+                build_();
+            }
+
+            /**
+            * Whether the table was built for the angles of this scan
+            */
+            bool matches(const LaserScanView& scan, float tolerance = 1e-5f) const
+            {
+                if (scan.size() != angles_.size())
+                    return false;
+                for (size_t i = 0; i < angles_.size(); i++)
+                {
+                    if (std::fabs(scan.angles()[i] - angles_[i]) > tolerance)
+                        return false;
+                }
+                return true;
+            }
+
+            size_t size() const
+            {
+                return angles_.size();
+            }
+
+            const float* cosines() const
+            {
+                return cosines_.empty() ? nullptr : &cosines_[0];
+            }
+
+            const float* sines() const
+            {
+                return sines_.empty() ? nullptr : &sines_[0];
+            }
+
+        private:
+            void build_()
+            {
+                cosines_.resize(angles_.size());
+                sines_.resize(angles_.size());
+                for (size_t i = 0; i < angles_.size(); i++)
+                {
+                    cosines_[i] = static_cast<float>(std::cos(static_cast<double>(angles_[i])));
+                    sines_[i] = static_cast<float>(std::sin(static_cast<double>(angles_[i])));
+                }
+            }
+
+        private:
+            std::vector<float> angles_;
+            std::vector<float> cosines_;
+            std::vector<float> sines_;
+        };
+
+        namespace detail {
+
+            /**
+            * xs[i] = tx + d[i] * (c[i] * cy - s[i] * sy), ys[i] = ty + d[i] * (s[i] * cy + c[i] * sy)
+            */
+            inline void laserProjectKernel(const float* d, const float* c, const float* s, size_t count
+                , float tx, float ty, float cy, float sy, float* xs, float* ys)
+            {
+                size_t i = 0;
+#if defined(RPOS_CORE_LASER_SCAN_SSE2)
+                const __m128 vtx = _mm_set1_ps(tx);
+                const __m128 vty = _mm_set1_ps(ty);
+                const __m128 vcy = _mm_set1_ps(cy);
+                const __m128 vsy = _mm_set1_ps(sy);
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 vd = _mm_loadu_ps(d + i);
+                    __m128 vc = _mm_loadu_ps(c + i);
+                    __m128 vs = _mm_loadu_ps(s + i);
+                    __m128 rc = _mm_sub_ps(_mm_mul_ps(vc, vcy), _mm_mul_ps(vs, vsy));
+                    __m128 rs = _mm_add_ps(_mm_mul_ps(vs, vcy), _mm_mul_ps(vc, vsy));
+                    _mm_storeu_ps(xs + i, _mm_add_ps(vtx, _mm_mul_ps(vd, rc)));
+                    _mm_storeu_ps(ys + i, _mm_add_ps(vty, _mm_mul_ps(vd, rs)));
+                }
+#elif defined(RPOS_CORE_LASER_SCAN_NEON)
+                const float32x4_t vtx = vdupq_n_f32(tx);
+                const float32x4_t vty = vdupq_n_f32(ty);
+                for (; i + 4 <= count; i += 4)
+                {
+                    float32x4_t vd = vld1q_f32(d + i);
+                    float32x4_t vc = vld1q_f32(c + i);
+                    float32x4_t vs = vld1q_f32(s + i);
+                    float32x4_t rc = vmlsq_n_f32(vmulq_n_f32(vc, cy), vs, sy);
+                    float32x4_t rs = vmlaq_n_f32(vmulq_n_f32(vs, cy), vc, sy);
+                    vst1q_f32(xs + i, vmlaq_f32(vtx, vd, rc));
+                    vst1q_f32(ys + i, vmlaq_f32(vty, vd, rs));
+                }
+#endif
+                for (; i < count; i++)
+                {
+                    // c / s may alias xs / ys, read before writing
+                    float ci = c[i], si = s[i], di = d[i];
+                    xs[i] = tx + di * (ci * cy - si * sy);
+                    ys[i] = ty + di * (si * cy + ci * sy);
+                }
+            }
+
+            inline size_t laserLowestBit(std::uint64_t v)
+            {
+#if defined(__GNUC__)
+                return static_cast<size_t>(__builtin_ctzll(v));
+#else
+                size_t bit = 0;
+                while (!(v & 1))
+                {
+                    v >>= 1;
+                    bit++;
+                }
+                return bit;
+#endif
+            }
+
+            inline void laserMarkInvalid(const LaserScanView& scan, float* xs, float* ys)
+            {
+                const float nan = std::numeric_limits<float>::quiet_NaN();
+                size_t words = (scan.size() + 63) / 64;
+                for (size_t w = 0; w < words; w++)
+                {
+                    std::uint64_t invalid = ~scan.validMask()[w];
+                    if (w == words - 1 && (scan.size() & 63))
+                        invalid &= (std::uint64_t(1) << (scan.size() & 63)) - 1;
+                    while (invalid)
+                    {
+                        size_t i = w * 64 + laserLowestBit(invalid);
+                        xs[i] = nan;
+                        ys[i] = nan;
+                        invalid &= invalid - 1;
+                    }
+                }
+            }
+
+            inline size_t laserCompactValid(const LaserScanView& scan, float* xs, float* ys)
+            {
+                size_t out = 0;
+                size_t words = (scan.size() + 63) / 64;
+                for (size_t w = 0; w < words; w++)
+                {
+                    std::uint64_t valid = scan.validMask()[w];
+                    if (w == words - 1 && (scan.size() & 63))
+                        valid &= (std::uint64_t(1) << (scan.size() & 63)) - 1;
+                    while (valid)
+                    {
+                        size_t i = w * 64 + laserLowestBit(valid);
+                        xs[out] = xs[i];
+                        ys[out] = ys[i];
+                        out++;
+                        valid &= valid - 1;
+                    }
+                }
+                return out;
+            }
+
+            inline void laserProject(const LaserScanView& scan, const LaserAngleTable* table, const Pose& pose, float* xs, float* ys)
+            {
+                if (scan.empty())
+                    return;
+
+                const double yaw = pose.yaw();
+                const float tx = static_cast<float>(pose.x());
+                const float ty = static_cast<float>(pose.y());
+                const float cy = static_cast<float>(std::cos(yaw));
+                const float sy = static_cast<float>(std::sin(yaw));
+
+                if (table)
+                {
+                    if (table->size() != scan.size())
+                        throw std::runtime_error("laser angle table does not match the scan");
+                    laserProjectKernel(scan.distances(), table->cosines(), table->sines(), scan.size(), tx, ty, cy, sy, xs, ys);
+                    return;
+                }
+
+                // no table, stage cos / sin of the beam angles in the output arrays
+                for (size_t i = 0; i < scan.size(); i++)
+                {
+                    float angle = scan.angles()[i];
+                    xs[i] = std::cos(angle);
+                    ys[i] = std::sin(angle);
+                }
+                laserProjectKernel(scan.distances(), xs, ys, scan.size(), tx, ty, cy, sy, xs, ys);
+            }
+
+        }
+
+        /**
+        * Project every point of the scan to cartesian coordinates in the frame the pose is expressed in
+        *
+        * Pass the laser mounting pose to get robot frame points, or the laser pose in the map
+        * (robot pose composed with the mounting pose) to get world frame points. Invalid points are
+        * written as NaN. xs and ys must hold scan.size() floats.
+        *
+        * @param table Angle table of the lidar, must have been built for the angles of this scan
+        */
+        inline void projectLaserScan(const LaserScanView& scan, const LaserAngleTable& table, const Pose& pose, float* xs, float* ys)
+        {
+            detail::laserProject(scan, &table, pose, xs, ys);
+            if (!scan.empty())
+                detail::laserMarkInvalid(scan, xs, ys);
+        }
+
+        /**
+        * Same as above, evaluating the angles of this scan instead of a precomputed table
+        */
+        inline void projectLaserScan(const LaserScanView& scan, const Pose& pose, float* xs, float* ys)
+        {
+            detail::laserProject(scan, nullptr, pose, xs, ys);
+            if (!scan.empty())
+                detail::laserMarkInvalid(scan, xs, ys);
+        }
+
+        /**
+        * Project only the valid points, packed to the front of xs and ys
+        *
+        * @return Count of valid points written
+        */
+        inline size_t projectValidLaserPoints(const LaserScanView& scan, const LaserAngleTable& table, const Pose& pose, float* xs, float* ys)
+        {
+            detail::laserProject(scan, &table, pose, xs, ys);
+            return scan.empty() ? 0 : detail::laserCompactValid(scan, xs, ys);
+        }
+
+        inline size_t projectValidLaserPoints(const LaserScanView& scan, const Pose& pose, float* xs, float* ys)
+        {
+            detail::laserProject(scan, nullptr, pose, xs, ys);
+            return scan.empty() ? 0 : detail::laserCompactValid(scan, xs, ys);
+        }
+
+    }
+}
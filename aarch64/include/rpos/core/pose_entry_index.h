@@ -0,0 +1,557 @@
+/*
+* pose_entry_index.h
+* KD-tree over pose entries (POIs, home docks, landmarks) for nearest, k-nearest and radius queries
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/core/pose_entry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rpos { namespace core {
+
+    /**
+    * Result of a query, entry points into the index and stays valid until the next modification
+    */
+    struct PoseEntryNeighbor {
+        const std::string* key;
+        const PoseEntry* entry;
+        double distance;
+    };
+
+    /**
+    * 2D KD-tree over the locations of pose entries
+    *
+    * Inserts descend the existing tree and erases leave a tombstone, the tree is rebuilt balanced
+    * once half of its nodes are dead or it doubled since the last build, so updates are amortized
+    * O(log n). Like the standard containers it is not synchronized.
+    */
+    class PoseEntryIndex {
+    public:
+        PoseEntryIndex()
+            : root_(-1)
+            , alive_(0)
+            , builtSize_(0)
+        {}
+
+    public:
+        /**
+        * Replace the content, keyed by the map key
+        */
+        void assign(const PoseEntryMap& entries)
+        {
+            clear();
+            for (auto iter = entries.begin(); iter != entries.end(); ++iter)
+                addSlot_(iter->first, iter->second);
+            rebuild_();
+        }
+
+        /**
+        * Replace the content, keyed by the position in the vector ("0", "1", ...)
+        *
+        * Names of home docks and landmarks may be empty or repeated, so they can not be the key
+        */
+        void assign(const std::vector<PoseEntry>& entries)
+        {
+            clear();
+            for (size_t i = 0; i < entries.size(); i++)
+                addSlot_(std::to_string(i), entries[i]);
+            rebuild_();
+        }
+
+        /**
+        * Insert or replace the entry with this key
+        */
+        void insert(const std::string& key, const PoseEntry& entry)
+        {
+            erase(key);
+            int slot = addSlot_(key, entry);
+            insertNode_(slot);
+            maybeRebuild_();
+        }
+
+        void insert(const PoseEntry& entry)
+        {
+            insert(entry.name, entry);
+        }
+
+        bool erase(const std::string& key)
+        {
+            auto iter = keys_.find(key);
+            if (iter == keys_.end())
+                return false;
+            slots_[iter->second].alive = false;
+            keys_.erase(iter);
+            alive_--;
+            maybeRebuild_();
+            return true;
+        }
+
+        void clear()
+        {
+            slots_.clear();
+            nodes_.clear();
+            keys_.clear();
+            root_ = -1;
+            alive_ = 0;
+            builtSize_ = 0;
+        }
+
+        size_t size() const
+        {
+            return alive_;
+        }
+
+        bool empty() const
+        {
+            return !alive_;
+        }
+
+        const PoseEntry* find(const std::string& key) const
+        {
+            auto iter = keys_.find(key);
+            return iter == keys_.end() ? nullptr : &slots_[iter->second].entry;
+        }
+
+    public:
+        /**
+        * @return false if the index is empty
+        */
+        bool nearest(double x, double y, PoseEntryNeighbor& result) const
+        {
+            std::vector<PoseEntryNeighbor> neighbors = nearest(x, y, 1);
+            if (neighbors.empty())
+                return false;
+            result = neighbors[0];
+            return true;
+        }
+
+        bool nearest(const Pose& pose, PoseEntryNeighbor& result) const
+        {
+            return nearest(pose.x(), pose.y(), result);
+        }
+
+        /**
+        * Up to k entries, nearest first
+        */
+        std::vector<PoseEntryNeighbor> nearest(double x, double y, size_t k) const
+        {
+            return nearestIf(x, y, k, [](const PoseEntry&) { return true; });
+        }
+
+        /**
+        * Up to k entries accepted by the predicate (e.g. by tag), nearest first
+        */
+        template < class PredicateT >
+        std::vector<PoseEntryNeighbor> nearestIf(double x, double y, size_t k, PredicateT predicate) const
+        {
+            std::vector<std::pair<double, int> > heap;
+            if (k)
+                nearest_(root_, x, y, k, predicate, heap);
+            std::sort_heap(heap.begin(), heap.end());
+            return toNeighbors_(heap);
+        }
+
+        /**
+        * Entries within radius, nearest first
+        */
+        std::vector<PoseEntryNeighbor> withinRadius(double x, double y, double radius) const
+        {
+            std::vector<std::pair<double, int> > found;
+            if (radius >= 0)
+                radius_(root_, x, y, radius * radius, found);
+            std::sort(found.begin(), found.end());
+            return toNeighbors_(found);
+        }
+
+    private:
+        struct Slot_ {
+            std::string key;
+            PoseEntry entry;
+            double x, y;
+            bool alive;
+        };
+
+        struct Node_ {
+            int slot;
+            int left, right;
+            int axis;
+        };
+
+        int addSlot_(const std::string& key, const PoseEntry& entry)
+        {
+            Slot_ slot;
+            slot.key = key;
+            slot.entry = entry;
+            slot.x = entry.pose.x();
+            slot.y = entry.pose.y();
+            slot.alive = true;
+            slots_.push_back(slot);
+            int index = static_cast<int>(slots_.size() - 1);
+            keys_[key] = index;
+            alive_++;
+            return index;
+        }
+
+        double coordinate_(int slot, int axis) const
+        {
+            return axis ? slots_[slot].y : slots_[slot].x;
+        }
+
+        void insertNode_(int slot)
+        {
+            Node_ node = { slot, -1, -1, 0 };
+            int index = static_cast<int>(nodes_.size());
+            if (root_ < 0)
+            {
+                nodes_.push_back(node);
+                root_ = index;
+                return;
+            }
+
+            int current = root_;
+            for (;;)
+            {
+                Node_& parent = nodes_[current];
+                bool left = coordinate_(slot, parent.axis) < coordinate_(parent.slot, parent.axis);
+                int& child = left ? parent.left : parent.right;
+                if (child < 0)
+                {
+                    node.axis = 1 - parent.axis;
+                    child = index;
+                    nodes_.push_back(node);
+                    return;
+                }
+                current = child;
+            }
+        }
+
+        void maybeRebuild_()
+        {
+            if (nodes_.size() > 2 * alive_ + 16 || alive_ > 2 * builtSize_ + 16)
+                rebuild_();
+        }
+
+        /**
+        * Drop dead slots and build a balanced tree by median splits
+        */
+        void rebuild_()
+        {
+            std::vector<Slot_> slots;
+            slots.reserve(alive_);
+            keys_.clear();
+            for (auto iter = slots_.begin(); iter != slots_.end(); ++iter)
+            {
+                if (!iter->alive)
+                    continue;
+                keys_[iter->key] = static_cast<int>(slots.size());
+                slots.push_back(*iter);
+            }
+            slots_.swap(slots);
+
+            std::vector<int> order(slots_.size());
+            for (size_t i = 0; i < order.size(); i++)
+                order[i] = static_cast<int>(i);
+            nodes_.clear();
+            nodes_.reserve(order.size());
+            root_ = build_(order, 0, static_cast<int>(order.size()), 0);
+            builtSize_ = alive_;
+        }
+
+        int build_(std::vector<int>& order, int begin, int end, int axis)
+        {
+            if (begin >= end)
+                return -1;
+            int middle = begin + (end - begin) / 2;
+            std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [this, axis](int a, int b) {
+                return coordinate_(a, axis) < coordinate_(b, axis);
+            });
+
+            int index = static_cast<int>(nodes_.size());
+            Node_ node = { order[middle], -1, -1, axis };
+            nodes_.push_back(node);
+            int left = build_(order, begin, middle, 1 - axis);
+            int right = build_(order, middle + 1, end, 1 - axis);
+            nodes_[index].left = left;
+            nodes_[index].right = right;
+            return index;
+        }
+
+        template < class PredicateT >
+        void nearest_(int index, double x, double y, size_t k, PredicateT& predicate, std::vector<std::pair<double, int> >& heap) const
+        {
+            if (index < 0)
+                return;
+            const Node_& node = nodes_[index];
+            const Slot_& slot = slots_[node.slot];
+
+            if (slot.alive && predicate(slot.entry))
+            {
+                double dx = slot.x - x, dy = slot.y - y;
+                double d2 = dx * dx + dy * dy;
+                if (heap.size() < k)
+                {
+                    heap.push_back(std::make_pair(d2, node.slot));
+                    std::push_heap(heap.begin(), heap.end());
+                }
+                else if (d2 < heap.front().first)
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = std::make_pair(d2, node.slot);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+
+            double diff = (node.axis ? y : x) - (node.axis ? slot.y : slot.x);
+            int nearSide = diff < 0 ? node.left : node.right;
+            int farSide = diff < 0 ? node.right : node.left;
+            nearest_(nearSide, x, y, k, predicate, heap);
+            if (heap.size() < k || diff * diff < heap.front().first)
+                nearest_(farSide, x, y, k, predicate, heap);
+        }
+
+        void radius_(int index, double x, double y, double radius2, std::vector<std::pair<double, int> >& found) const
+        {
+            if (index < 0)
+                return;
+            const Node_& node = nodes_[index];
+            const Slot_& slot = slots_[node.slot];
+
+            double dx = slot.x - x, dy = slot.y - y;
+            double d2 = dx * dx + dy * dy;
+            if (slot.alive && d2 <= radius2)
+                found.push_back(std::make_pair(d2, node.slot));
+
+            double diff = (node.axis ? y : x) - (node.axis ? slot.y : slot.x);
+            if (diff < 0 || diff * diff <= radius2)
+                radius_(node.left, x, y, radius2, found);
+            if (diff >= 0 || diff * diff <= radius2)
+                radius_(node.right, x, y, radius2, found);
+        }
+
+        std::vector<PoseEntryNeighbor> toNeighbors_(const std::vector<std::pair<double, int> >& items) const
+        {
+            std::vector<PoseEntryNeighbor> result;
+            result.reserve(items.size());
+            for (auto iter = items.begin(); iter != items.end(); ++iter)
+            {
+                const Slot_& slot = slots_[iter->second];
+                PoseEntryNeighbor neighbor = { &slot.key, &slot.entry, std::sqrt(iter->first) };
+                result.push_back(neighbor);
+            }
+            return result;
+        }
+
+    private:
+        std::vector<Slot_> slots_;
+        std::vector<Node_> nodes_;
+        std::unordered_map<std::string, int> keys_;
+        int root_;
+        size_t alive_;
+        size_t builtSize_;
+    };
+
+    /**
+    * POI, home dock and landmark indices kept in sync with a platform
+    *
+    * PlatformT is robot_platforms::SlamwareCorePlatform (or anything with the same POI / home dock /
+    * laser landmark API). Mutations go through this object and update the index when the platform
+    * accepts them; reload() fetches everything again. POIs are keyed by PoseEntry::name, the key addPOI,
+    * editPOI and erasePOI use. Home docks and landmarks are plain vectors on the platform whose names
+    * may be empty or repeated, so they are keyed by their position in that vector.
+    */
+    template < class PlatformT >
+    class PoseEntryIndexCache {
+    public:
+        explicit PoseEntryIndexCache(PlatformT platform)
+            : platform_(platform)
+        {}
+
+    public:
+        void reload()
+        {
+            reloadPOIs();
+            reloadHomeDocks();
+            reloadLaserLandmarks();
+        }
+
+        void reloadPOIs()
+        {
+            assignByName_(platform_.getPOIs());
+        }
+
+        void reloadHomeDocks()
+        {
+            homeDocks_.assign(platform_.getHomeDocks());
+        }
+
+        void reloadLaserLandmarks()
+        {
+            landmarks_.assign(platform_.getLaserLandmarks());
+        }
+
+        const PoseEntryIndex& pois() const
+        {
+            return pois_;
+        }
+
+        const PoseEntryIndex& homeDocks() const
+        {
+            return homeDocks_;
+        }
+
+        const PoseEntryIndex& laserLandmarks() const
+        {
+            return landmarks_;
+        }
+
+    public:
+        bool setPOIs(const PoseEntryMap& pois)
+        {
+            if (!platform_.setPOIs(pois))
+                return false;
+            assignByName_(pois);
+            return true;
+        }
+
+        bool addPOI(const PoseEntry& poi)
+        {
+            if (!platform_.addPOI(poi))
+                return false;
+            pois_.insert(poi);
+            return true;
+        }
+
+        bool editPOI(const PoseEntry& poi)
+        {
+            if (!platform_.editPOI(poi))
+                return false;
+            pois_.insert(poi);
+            return true;
+        }
+
+        PoseEntry addPOIOnCurrentPose(const std::string& name, const Metadata& metadata)
+        {
+            PoseEntry added = platform_.addPOIOnCurrentPose(name, metadata);
+            pois_.insert(added);
+            return added;
+        }
+
+        bool erasePOI(const std::string& name)
+        {
+            if (!platform_.erasePOI(name))
+                return false;
+            pois_.erase(name);
+            return true;
+        }
+
+        bool clearPOIs()
+        {
+            if (!platform_.clearPOIs())
+                return false;
+            pois_.clear();
+            return true;
+        }
+
+        bool setHomeDocks(const std::vector<PoseEntry>& docks)
+        {
+            if (!platform_.setHomeDocks(docks))
+                return false;
+            homeDocks_.assign(docks);
+            return true;
+        }
+
+        /**
+        * Where the platform places or matches a dock is up to it, so the docks are fetched again
+        * after a single dock changed to keep the positions in step
+        */
+        PoseEntry registerHomeDock(const Metadata& metadata)
+        {
+            PoseEntry added = platform_.registerHomeDock(metadata);
+            reloadHomeDocks();
+            return added;
+        }
+
+        PoseEntry addHomeDock(const PoseEntry& dock)
+        {
+            PoseEntry added = platform_.addHomeDock(dock);
+            reloadHomeDocks();
+            return added;
+        }
+
+        bool editHomeDock(const PoseEntry& dock)
+        {
+            if (!platform_.editHomeDock(dock))
+                return false;
+            reloadHomeDocks();
+            return true;
+        }
+
+        bool eraseHomeDock(const std::string& id)
+        {
+            if (!platform_.eraseHomeDock(id))
+                return false;
+            reloadHomeDocks();
+            return true;
+        }
+
+        bool clearHomeDocks()
+        {
+            if (!platform_.clearHomeDocks())
+                return false;
+            homeDocks_.clear();
+            return true;
+        }
+
+        bool setLaserLandmarks(const std::vector<PoseEntry>& landmarks)
+        {
+            if (!platform_.setLaserLandmarks(landmarks))
+                return false;
+            landmarks_.assign(landmarks);
+            return true;
+        }
+
+        /**
+        * The ids are not part of the cached entries, so the landmarks are fetched again
+        */
+        bool removeLaserLandmarks(const std::vector<SegmentID>& ids)
+        {
+            if (!platform_.removeLaserLandmarks(ids))
+                return false;
+            reloadLaserLandmarks();
+            return true;
+        }
+
+        bool clearLaserLandmarks()
+        {
+            if (!platform_.clearLaserLandmarks())
+                return false;
+            landmarks_.clear();
+            return true;
+        }
+
+    private:
+        void assignByName_(const PoseEntryMap& entries)
+        {
+            // a later entry with the same name wins, as it would for addPOI
+            pois_.clear();
+            for (auto iter = entries.begin(); iter != entries.end(); ++iter)
+                pois_.insert(iter->second);
+        }
+
+    private:
+        PlatformT platform_;
+        PoseEntryIndex pois_;
+        PoseEntryIndex homeDocks_;
+        PoseEntryIndex landmarks_;
+    };
+
+} }
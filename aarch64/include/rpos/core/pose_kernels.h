@@ -0,0 +1,382 @@
+/*
+* pose_kernels.h
+* SE(2) / SE(3) compose, inverse and batch transform kernels over contiguous arrays
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/core/angle_math.h>
+#include <rpos/core/pose.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#   include <emmintrin.h>
+#   define RPOS_CORE_POSE_KERNELS_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define RPOS_CORE_POSE_KERNELS_NEON
+#endif
+
+namespace rpos {
+    namespace core {
+
+        /**
+        * Plain value types for bulk math, unlike Pose / Location they are trivially copyable and
+        * arrays of them are contiguous x, y(, z) so the kernels can load them directly
+        */
+        template < class T >
+        struct PointXY {
+            T x, y;
+        };
+
+        template < class T >
+        struct PointXYZ {
+            T x, y, z;
+        };
+
+        template < class T >
+        struct PoseSE2 {
+            T x, y, yaw;
+        };
+
+        /**
+        * Rotation (row major) and translation
+        */
+        template < class T >
+        struct TransformSE3 {
+            T r[9];
+            T t[3];
+        };
+
+        typedef PointXY<float> PointXYf;
+        typedef PointXY<double> PointXYd;
+        typedef PointXYZ<float> PointXYZf;
+        typedef PointXYZ<double> PointXYZd;
+        typedef PoseSE2<float> PoseSE2f;
+        typedef PoseSE2<double> PoseSE2d;
+        typedef TransformSE3<float> TransformSE3f;
+        typedef TransformSE3<double> TransformSE3d;
+
+        namespace detail {
+
+            // same [-pi, pi) range as constraitRadNegativePiToPi, the sum of two normalized yaws only
+            // needs one step so the fmod there is left for inputs further out
+            template < class T >
+            inline T normalizeYaw(T yaw)
+            {
+                const T pi = T(M_PI);
+                if (yaw >= pi)
+                    yaw -= 2 * pi;
+                else if (yaw < -pi)
+                    yaw += 2 * pi;
+                if (yaw >= pi || yaw < -pi)
+                    yaw = constraitRadNegativePiToPi(yaw);
+                return yaw;
+            }
+
+            template < class T >
+            inline void transformPointsSE2Scalar(T c, T s, T tx, T ty, const PointXY<T>* in, PointXY<T>* out, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; i++)
+                {
+                    T x = in[i].x, y = in[i].y;
+                    out[i].x = c * x - s * y + tx;
+                    out[i].y = s * x + c * y + ty;
+                }
+            }
+
+            template < class T >
+            inline void transformPointsSE2(T c, T s, T tx, T ty, const PointXY<T>* in, PointXY<T>* out, size_t count)
+            {
+                transformPointsSE2Scalar(c, s, tx, ty, in, out, 0, count);
+            }
+
+            // (x, y) -> (c x - s y + tx, s x + c y + ty) is v * c + swap(v) * (-s, s) + t, one point per
+            // register for double and two for float
+            inline void transformPointsSE2(double c, double s, double tx, double ty, const PointXY<double>* in, PointXY<double>* out, size_t count)
+            {
+                size_t i = 0;
+#if defined(RPOS_CORE_POSE_KERNELS_SSE2)
+                const __m128d vc = _mm_set1_pd(c);
+                const __m128d vs = _mm_set_pd(s, -s);
+                const __m128d vt = _mm_set_pd(ty, tx);
+                for (; i < count; i++)
+                {
+                    __m128d v = _mm_loadu_pd(&in[i].x);
+                    __m128d swapped = _mm_shuffle_pd(v, v, 1);
+                    _mm_storeu_pd(&out[i].x, _mm_add_pd(_mm_add_pd(_mm_mul_pd(v, vc), _mm_mul_pd(swapped, vs)), vt));
+                }
+#elif defined(RPOS_CORE_POSE_KERNELS_NEON)
+                const float64x2_t vs = { -s, s };
+                const float64x2_t vt = { tx, ty };
+                for (; i < count; i++)
+                {
+                    float64x2_t v = vld1q_f64(&in[i].x);
+                    float64x2_t swapped = vextq_f64(v, v, 1);
+                    vst1q_f64(&out[i].x, vfmaq_f64(vfmaq_n_f64(vt, v, c), swapped, vs));
+                }
+#endif
+                transformPointsSE2Scalar(c, s, tx, ty, in, out, i, count);
+            }
+
+            inline void transformPointsSE2(float c, float s, float tx, float ty, const PointXY<float>* in, PointXY<float>* out, size_t count)
+            {
+                size_t i = 0;
+#if defined(RPOS_CORE_POSE_KERNELS_SSE2)
+                const __m128 vc = _mm_set1_ps(c);
+                const __m128 vs = _mm_setr_ps(-s, s, -s, s);
+                const __m128 vt = _mm_setr_ps(tx, ty, tx, ty);
+                for (; i + 2 <= count; i += 2)
+                {
+                    __m128 v = _mm_loadu_ps(&in[i].x);
+                    __m128 swapped = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+                    _mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(v, vc), _mm_mul_ps(swapped, vs)), vt));
+                }
+#elif defined(RPOS_CORE_POSE_KERNELS_NEON)
+                const float32x4_t vs = { -s, s, -s, s };
+                const float32x4_t vt = { tx, ty, tx, ty };
+                for (; i + 2 <= count; i += 2)
+                {
+                    float32x4_t v = vld1q_f32(&in[i].x);
+                    float32x4_t swapped = vrev64q_f32(v);
+                    vst1q_f32(&out[i].x, vmlaq_f32(vmlaq_n_f32(vt, v, c), swapped, vs));
+                }
+#endif
+                transformPointsSE2Scalar(c, s, tx, ty, in, out, i, count);
+            }
+
+        }
+
+        // SE(2)
+
+        template < class T >
+        inline PoseSE2<T> compose(const PoseSE2<T>& a, const PoseSE2<T>& b)
+        {
+            T c = std::cos(a.yaw), s = std::sin(a.yaw);
+            PoseSE2<T> result = { a.x + c * b.x - s * b.y, a.y + s * b.x + c * b.y, detail::normalizeYaw(a.yaw + b.yaw) };
+            return result;
+        }
+
+        template < class T >
+        inline PoseSE2<T> inverse(const PoseSE2<T>& a)
+        {
+            T c = std::cos(a.yaw), s = std::sin(a.yaw);
+            PoseSE2<T> result = { -(c * a.x + s * a.y), s * a.x - c * a.y, detail::normalizeYaw(-a.yaw) };
+            return result;
+        }
+
+        template < class T >
+        inline PointXY<T> apply(const PoseSE2<T>& pose, const PointXY<T>& p)
+        {
+            T c = std::cos(pose.yaw), s = std::sin(pose.yaw);
+            PointXY<T> result = { c * p.x - s * p.y + pose.x, s * p.x + c * p.y + pose.y };
+            return result;
+        }
+
+        /**
+        * out[i] = a[i] * b[i], out may alias a or b
+        */
+        template < class T >
+        inline void composePoses(const PoseSE2<T>* a, const PoseSE2<T>* b, PoseSE2<T>* out, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = compose(a[i], b[i]);
+        }
+
+        /**
+        * out[i] = a * b[i], e.g. move poses from the robot frame to the map frame; out may alias b
+        */
+        template < class T >
+        inline void composePoses(const PoseSE2<T>& a, const PoseSE2<T>* b, PoseSE2<T>* out, size_t count)
+        {
+            const T c = std::cos(a.yaw), s = std::sin(a.yaw);
+            for (size_t i = 0; i < count; i++)
+            {
+                PoseSE2<T> v = b[i];
+                out[i].x = a.x + c * v.x - s * v.y;
+                out[i].y = a.y + s * v.x + c * v.y;
+                out[i].yaw = detail::normalizeYaw(a.yaw + v.yaw);
+            }
+        }
+
+        template < class T >
+        inline void inversePoses(const PoseSE2<T>* in, PoseSE2<T>* out, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = inverse(in[i]);
+        }
+
+        /**
+        * out[i] = pose * in[i], vectorized for float and double; out may alias in
+        */
+        template < class T >
+        inline void transformPoints(const PoseSE2<T>& pose, const PointXY<T>* in, PointXY<T>* out, size_t count)
+        {
+            detail::transformPointsSE2(T(std::cos(pose.yaw)), T(std::sin(pose.yaw)), pose.x, pose.y, in, out, count);
+        }
+
+        // SE(3)
+
+        template < class T >
+        inline TransformSE3<T> compose(const TransformSE3<T>& a, const TransformSE3<T>& b)
+        {
+            TransformSE3<T> result;
+            for (int row = 0; row < 3; row++)
+            {
+                const T* ar = a.r + row * 3;
+                for (int col = 0; col < 3; col++)
+                    result.r[row * 3 + col] = ar[0] * b.r[col] + ar[1] * b.r[3 + col] + ar[2] * b.r[6 + col];
+                result.t[row] = ar[0] * b.t[0] + ar[1] * b.t[1] + ar[2] * b.t[2] + a.t[row];
+            }
+            return result;
+        }
+
+        template < class T >
+        inline TransformSE3<T> inverse(const TransformSE3<T>& a)
+        {
+            TransformSE3<T> result;
+            for (int row = 0; row < 3; row++)
+            {
+                for (int col = 0; col < 3; col++)
+                    result.r[row * 3 + col] = a.r[col * 3 + row];
+            }
+            for (int row = 0; row < 3; row++)
+                result.t[row] = -(result.r[row * 3] * a.t[0] + result.r[row * 3 + 1] * a.t[1] + result.r[row * 3 + 2] * a.t[2]);
+            return result;
+        }
+
+        template < class T >
+        inline PointXYZ<T> apply(const TransformSE3<T>& transform, const PointXYZ<T>& p)
+        {
+            const T* r = transform.r;
+            PointXYZ<T> result = {
+                r[0] * p.x + r[1] * p.y + r[2] * p.z + transform.t[0],
+                r[3] * p.x + r[4] * p.y + r[5] * p.z + transform.t[1],
+                r[6] * p.x + r[7] * p.y + r[8] * p.z + transform.t[2]
+            };
+            return result;
+        }
+
+        template < class T >
+        inline void composePoses(const TransformSE3<T>* a, const TransformSE3<T>* b, TransformSE3<T>* out, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = compose(a[i], b[i]);
+        }
+
+        template < class T >
+        inline void composePoses(const TransformSE3<T>& a, const TransformSE3<T>* b, TransformSE3<T>* out, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = compose(a, b[i]);
+        }
+
+        template < class T >
+        inline void inversePoses(const TransformSE3<T>* in, TransformSE3<T>* out, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = inverse(in[i]);
+        }
+
+        /**
+        * out[i] = transform * in[i]; out may alias in
+        *
+        * The matrix lives in locals so the loop has no loads besides the points and compilers
+        * vectorize it for the target.
+        */
+        template < class T >
+        inline void transformPoints(const TransformSE3<T>& transform, const PointXYZ<T>* in, PointXYZ<T>* out, size_t count)
+        {
+            const T r0 = transform.r[0], r1 = transform.r[1], r2 = transform.r[2];
+            const T r3 = transform.r[3], r4 = transform.r[4], r5 = transform.r[5];
+            const T r6 = transform.r[6], r7 = transform.r[7], r8 = transform.r[8];
+            const T tx = transform.t[0], ty = transform.t[1], tz = transform.t[2];
+            for (size_t i = 0; i < count; i++)
+            {
+                T x = in[i].x, y = in[i].y, z = in[i].z;
+                out[i].x = r0 * x + r1 * y + r2 * z + tx;
+                out[i].y = r3 * x + r4 * y + r5 * z + ty;
+                out[i].z = r6 * x + r7 * y + r8 * z + tz;
+            }
+        }
+
+        // Conversion from and to Pose / Location, rotations are yaw (z), pitch (y), roll (x) applied in that order
+
+        template < class T >
+        inline PoseSE2<T> toPoseSE2(const Pose& pose)
+        {
+            PoseSE2<T> result = { T(pose.x()), T(pose.y()), T(pose.yaw()) };
+            return result;
+        }
+
+        template < class T >
+        inline TransformSE3<T> toTransformSE3(const Pose& pose)
+        {
+            const double cy = std::cos(pose.yaw()), sy = std::sin(pose.yaw());
+            const double cp = std::cos(pose.pitch()), sp = std::sin(pose.pitch());
+            const double cr = std::cos(pose.roll()), sr = std::sin(pose.roll());
+
+            TransformSE3<T> result = { {
+                T(cy * cp), T(cy * sp * sr - sy * cr), T(cy * sp * cr + sy * sr),
+                T(sy * cp), T(sy * sp * sr + cy * cr), T(sy * sp * cr - cy * sr),
+                T(-sp), T(cp * sr), T(cp * cr)
+            }, { T(pose.x()), T(pose.y()), T(pose.z()) } };
+            return result;
+        }
+
+        template < class T >
+        inline PointXYZ<T> toPointXYZ(const Location& location)
+        {
+            PointXYZ<T> result = { T(location.x()), T(location.y()), T(location.z()) };
+            return result;
+        }
+
+        template < class T >
+        inline Pose toPose(const PoseSE2<T>& pose)
+        {
+            return Pose(Location(pose.x, pose.y), Rotation(pose.yaw));
+        }
+
+        template < class T >
+        inline Pose toPose(const TransformSE3<T>& transform)
+        {
+            const T* r = transform.r;
+            double pitch = std::asin(std::max(-1.0, std::min(1.0, double(-r[6]))));
+            double yaw = std::atan2(double(r[3]), double(r[0]));
+            double roll = std::atan2(double(r[7]), double(r[8]));
+            return Pose(Location(transform.t[0], transform.t[1], transform.t[2]), Rotation(yaw, pitch, roll));
+        }
+
+        template < class T >
+        inline Location toLocation(const PointXYZ<T>& point)
+        {
+            return Location(point.x, point.y, point.z);
+        }
+
+        template < class T >
+        inline void toPoseSE2(const std::vector<Pose>& poses, std::vector<PoseSE2<T> >& out)
+        {
+            out.resize(poses.size());
+            for (size_t i = 0; i < poses.size(); i++)
+                out[i] = toPoseSE2<T>(poses[i]);
+        }
+
+        template < class T >
+        inline void toPointXY(const std::vector<Location>& locations, std::vector<PointXY<T> >& out)
+        {
+            out.resize(locations.size());
+            for (size_t i = 0; i < locations.size(); i++)
+            {
+                out[i].x = T(locations[i].x());
+                out[i].y = T(locations[i].y());
+            }
+        }
+
+    }
+}
@@ -0,0 +1,570 @@
+/*
+* path_geometry.h
+* Arc length tables, projection, resampling and curvature/speed profiles over paths
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/features/motion_planner/path.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace rpos { namespace features { namespace motion_planner {
+
+    /**
+    * Closest point on a path to a query point
+    */
+    struct PathProjection {
+        /**
+        * Index of the segment [segment, segment + 1] the point lies on
+        */
+        size_t segment;
+
+        /**
+        * Position along the segment, 0 at its first vertex and 1 at its second
+        */
+        float t;
+
+        /**
+        * Arc length from the beginning of the path
+        */
+        double s;
+
+        float x;
+        float y;
+        float distance;
+    };
+
+    /**
+    * Geometry of a polyline path with O(log n) lookups
+    *
+    * assign() copies the points and builds the cumulative arc length table and a bounding box tree
+    * over the segments in O(n). Buffers are kept between assignments, so a controller reassigning
+    * the remaining path every cycle does not allocate once the path stops growing. Queries are
+    * const and may run concurrently, assign() may not.
+    *
+    * Usage:
+    *   PathGeometry geometry;
+    *   ...
+    *   geometry.assign(action.getRemainingPath());
+    *   PathProjection p;
+    *   if (geometry.project(pose.x(), pose.y(), p))
+    *       remaining = geometry.length() - p.s;
+    *   size_t count = geometry.resample(0.05, xs, ys, capacity, p.s);
+    */
+    class PathGeometry {
+    public:
+        PathGeometry()
+        {}
+
+        explicit PathGeometry(const Path& path)
+        {
+            assign(path);
+        }
+
+    public:
+        void assign(const Path& path)
+        {
+            if (!path)
+            {
+                clear();
+                return;
+            }
+            assign(path.getPoints());
+        }
+
+        void assign(const std::vector<core::Location>& points)
+        {
+            xs_.resize(points.size());
+            ys_.resize(points.size());
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                xs_[i] = static_cast<float>(points[i].x());
+                ys_[i] = static_cast<float>(points[i].y());
+            }
+            rebuild_();
+        }
+
+        void assign(const float* xs, const float* ys, size_t count)
+        {
+            xs_.assign(xs, xs + count);
+            ys_.assign(ys, ys + count);
+            rebuild_();
+        }
+
+        void clear()
+        {
+            xs_.clear();
+            ys_.clear();
+            s_.clear();
+            boxes_.clear();
+        }
+
+    public:
+        size_t size() const
+        {
+            return xs_.size();
+        }
+
+        bool empty() const
+        {
+            return xs_.empty();
+        }
+
+        double length() const
+        {
+            return s_.empty() ? 0.0 : s_.back();
+        }
+
+        float x(size_t i) const
+        {
+            return xs_[i];
+        }
+
+        float y(size_t i) const
+        {
+            return ys_[i];
+        }
+
+        /**
+        * Arc length from the first point to point i
+        */
+        double arcLength(size_t i) const
+        {
+            return s_[i];
+        }
+
+        const std::vector<double>& arcLengths() const
+        {
+            return s_;
+        }
+
+        /**
+        * Segment containing arc length s, clamped to the path
+        */
+        size_t segmentAt(double s) const
+        {
+            if (xs_.size() < 2)
+                return 0;
+            size_t segment = static_cast<size_t>(std::upper_bound(s_.begin(), s_.end(), s) - s_.begin());
+            if (segment == 0)
+                return 0;
+            return std::min(segment - 1, xs_.size() - 2);
+        }
+
+        /**
+        * Point at arc length s (clamped), heading is the direction of the segment it lies on
+        */
+        bool pointAt(double s, float& x, float& y, float* heading = NULL) const
+        {
+            if (xs_.empty())
+                return false;
+            if (xs_.size() == 1)
+            {
+                x = xs_[0];
+                y = ys_[0];
+                if (heading)
+                    *heading = 0.0f;
+                return true;
+            }
+
+            size_t i = segmentAt(s);
+            double span = s_[i + 1] - s_[i];
+            float t = span > 0.0 ? static_cast<float>(std::min(std::max((s - s_[i]) / span, 0.0), 1.0)) : 0.0f;
+            float dx = xs_[i + 1] - xs_[i];
+            float dy = ys_[i + 1] - ys_[i];
+            x = xs_[i] + t * dx;
+            y = ys_[i] + t * dy;
+            if (heading)
+                *heading = std::atan2(dy, dx);
+            return true;
+        }
+
+        /**
+        * Closest point on the whole path
+        */
+        bool project(float x, float y, PathProjection& projection) const
+        {
+            return project(x, y, 0.0, std::numeric_limits<double>::infinity(), projection);
+        }
+
+        /**
+        * Closest point on the part of the path between arc lengths sMin and sMax
+        *
+        * Trackers pass a window around the previous projection so the robot does not snap to an
+        * earlier part of a path that crosses itself.
+        */
+        bool project(float x, float y, double sMin, double sMax, PathProjection& projection) const
+        {
+            if (xs_.empty() || sMin > sMax)
+                return false;
+
+            if (xs_.size() == 1)
+            {
+                projection.segment = 0;
+                projection.t = 0.0f;
+                projection.s = 0.0;
+                projection.x = xs_[0];
+                projection.y = ys_[0];
+                projection.distance = std::sqrt((x - xs_[0]) * (x - xs_[0]) + (y - ys_[0]) * (y - ys_[0]));
+                return true;
+            }
+
+            sMin = std::max(sMin, 0.0);
+            sMax = std::min(sMax, length());
+            Query query;
+            query.x = x;
+            query.y = y;
+            query.sMin = sMin;
+            query.sMax = sMax;
+            query.first = segmentAt(sMin);
+            query.last = segmentAt(sMax);
+            query.best = std::numeric_limits<float>::infinity();
+            query.segment = query.first;
+            query.t = 0.0f;
+            nearest_(1, 0, xs_.size() - 1, query);
+
+            size_t i = query.segment;
+            projection.segment = i;
+            projection.t = query.t;
+            projection.s = s_[i] + query.t * (s_[i + 1] - s_[i]);
+            projection.x = xs_[i] + query.t * (xs_[i + 1] - xs_[i]);
+            projection.y = ys_[i] + query.t * (ys_[i + 1] - ys_[i]);
+            projection.distance = std::sqrt(query.best);
+            return true;
+        }
+
+        /**
+        * Number of samples resample() writes for the same arguments
+        */
+        size_t sampleCount(double step, double sBegin = 0.0, double sEnd = std::numeric_limits<double>::infinity()) const
+        {
+            if (xs_.empty() || step <= 0.0)
+                return 0;
+            sBegin = std::min(std::max(sBegin, 0.0), length());
+            sEnd = std::min(std::max(sEnd, sBegin), length());
+            size_t steps = static_cast<size_t>(std::floor((sEnd - sBegin) / step));
+            bool tail = sBegin + steps * step < sEnd - step * 1e-3;
+            return steps + 1 + (tail ? 1 : 0);
+        }
+
+        /**
+        * Distance between the last two samples resample() writes for the same arguments, shorter
+        * than step when sEnd is not a whole number of steps from sBegin. 0 with less than 2 samples.
+        */
+        double lastStep(double step, double sBegin = 0.0, double sEnd = std::numeric_limits<double>::infinity()) const
+        {
+            const size_t total = sampleCount(step, sBegin, sEnd);
+            if (total < 2)
+                return 0.0;
+            sBegin = std::min(std::max(sBegin, 0.0), length());
+            sEnd = std::min(std::max(sEnd, sBegin), length());
+            return sEnd - std::min(sBegin + (total - 2) * step, sEnd);
+        }
+
+        /**
+        * Points every step meters from sBegin to sEnd into caller buffers, sEnd itself is always the
+        * last sample. Returns the number of samples written, never more than capacity.
+        */
+        size_t resample(double step, float* xs, float* ys, size_t capacity, double sBegin = 0.0, double sEnd = std::numeric_limits<double>::infinity()) const
+        {
+            const size_t total = sampleCount(step, sBegin, sEnd);
+            const size_t count = std::min(total, capacity);
+            if (count == 0)
+                return 0;
+
+            sBegin = std::min(std::max(sBegin, 0.0), length());
+            sEnd = std::min(std::max(sEnd, sBegin), length());
+
+            size_t segment = segmentAt(sBegin);
+            for (size_t k = 0; k < count; k++)
+            {
+                double s = (k + 1 == total) ? sEnd : std::min(sBegin + k * step, sEnd);
+
+                if (xs_.size() == 1)
+                {
+                    xs[k] = xs_[0];
+                    ys[k] = ys_[0];
+                    continue;
+                }
+
+                while (segment + 2 < xs_.size() && s_[segment + 1] < s)
+                    segment++;
+                double span = s_[segment + 1] - s_[segment];
+                float t = span > 0.0 ? static_cast<float>(std::min(std::max((s - s_[segment]) / span, 0.0), 1.0)) : 0.0f;
+                xs[k] = xs_[segment] + t * (xs_[segment + 1] - xs_[segment]);
+                ys[k] = ys_[segment] + t * (ys_[segment + 1] - ys_[segment]);
+            }
+            return count;
+        }
+
+        /**
+        * Same as above into vectors, which only reallocate when they have to grow
+        */
+        size_t resample(double step, std::vector<float>& xs, std::vector<float>& ys, double sBegin = 0.0, double sEnd = std::numeric_limits<double>::infinity()) const
+        {
+            size_t count = sampleCount(step, sBegin, sEnd);
+            xs.resize(count);
+            ys.resize(count);
+            return count ? resample(step, &xs[0], &ys[0], count, sBegin, sEnd) : 0;
+        }
+
+    private:
+        struct Box {
+            float minX, minY, maxX, maxY;
+        };
+
+        struct Query {
+            float x, y;
+            double sMin, sMax;
+            size_t first, last;
+            float best;
+            size_t segment;
+            float t;
+        };
+
+        void rebuild_()
+        {
+            const size_t n = xs_.size();
+            s_.resize(n);
+            if (n == 0)
+            {
+                boxes_.clear();
+                return;
+            }
+
+            s_[0] = 0.0;
+            for (size_t i = 1; i < n; i++)
+            {
+                double dx = xs_[i] - xs_[i - 1];
+                double dy = ys_[i] - ys_[i - 1];
+                s_[i] = s_[i - 1] + std::sqrt(dx * dx + dy * dy);
+            }
+
+            if (n < 2)
+            {
+                boxes_.clear();
+                return;
+            }
+            boxes_.resize(4 * (n - 1));
+            build_(1, 0, n - 1);
+        }
+
+        void build_(size_t node, size_t lo, size_t hi)
+        {
+            Box& box = boxes_[node];
+            if (hi - lo == 1)
+            {
+                box.minX = std::min(xs_[lo], xs_[hi]);
+                box.maxX = std::max(xs_[lo], xs_[hi]);
+                box.minY = std::min(ys_[lo], ys_[hi]);
+                box.maxY = std::max(ys_[lo], ys_[hi]);
+                return;
+            }
+
+            size_t mid = lo + (hi - lo) / 2;
+            build_(2 * node, lo, mid);
+            build_(2 * node + 1, mid, hi);
+            const Box& left = boxes_[2 * node];
+            const Box& right = boxes_[2 * node + 1];
+            box.minX = std::min(left.minX, right.minX);
+            box.maxX = std::max(left.maxX, right.maxX);
+            box.minY = std::min(left.minY, right.minY);
+            box.maxY = std::max(left.maxY, right.maxY);
+        }
+
+        static float boxDistance2_(const Box& box, float x, float y)
+        {
+            float dx = std::max(std::max(box.minX - x, x - box.maxX), 0.0f);
+            float dy = std::max(std::max(box.minY - y, y - box.maxY), 0.0f);
+            return dx * dx + dy * dy;
+        }
+
+        /**
+        * Branch and bound over the segment tree, node covers segments [lo, hi)
+        */
+        void nearest_(size_t node, size_t lo, size_t hi, Query& query) const
+        {
+            if (hi <= query.first || lo > query.last)
+                return;
+            if (boxDistance2_(boxes_[node], query.x, query.y) >= query.best)
+                return;
+
+            if (hi - lo == 1)
+            {
+                segment_(lo, query);
+                return;
+            }
+
+            size_t mid = lo + (hi - lo) / 2;
+            float left = boxDistance2_(boxes_[2 * node], query.x, query.y);
+            float right = boxDistance2_(boxes_[2 * node + 1], query.x, query.y);
+            if (left <= right)
+            {
+                nearest_(2 * node, lo, mid, query);
+                nearest_(2 * node + 1, mid, hi, query);
+            }
+            else
+            {
+                nearest_(2 * node + 1, mid, hi, query);
+                nearest_(2 * node, lo, mid, query);
+            }
+        }
+
+        void segment_(size_t i, Query& query) const
+        {
+            const float ax = xs_[i];
+            const float ay = ys_[i];
+            const float dx = xs_[i + 1] - ax;
+            const float dy = ys_[i + 1] - ay;
+            const double span = s_[i + 1] - s_[i];
+
+            float tMin = 0.0f;
+            float tMax = 1.0f;
+            if (span > 0.0)
+            {
+                tMin = static_cast<float>(std::max((query.sMin - s_[i]) / span, 0.0));
+                tMax = static_cast<float>(std::min((query.sMax - s_[i]) / span, 1.0));
+            }
+
+            float len2 = dx * dx + dy * dy;
+            float t = len2 > 0.0f ? ((query.x - ax) * dx + (query.y - ay) * dy) / len2 : 0.0f;
+            t = std::min(std::max(t, tMin), tMax);
+
+            float px = ax + t * dx - query.x;
+            float py = ay + t * dy - query.y;
+            float d2 = px * px + py * py;
+            if (d2 < query.best)
+            {
+                query.best = d2;
+                query.segment = i;
+                query.t = t;
+            }
+        }
+
+    private:
+        std::vector<float> xs_;
+        std::vector<float> ys_;
+        std::vector<double> s_;
+        std::vector<Box> boxes_;
+    };
+
+    /**
+    * Signed curvature at every sample from the circle through it and its neighbours, the first and
+    * last sample copy their neighbour
+    */
+    inline void curvatureProfile(const float* xs, const float* ys, size_t count, float* curvature)
+    {
+        if (count == 0)
+            return;
+        if (count < 3)
+        {
+            std::fill(curvature, curvature + count, 0.0f);
+            return;
+        }
+
+        for (size_t i = 1; i + 1 < count; i++)
+        {
+            float ax = xs[i] - xs[i - 1];
+            float ay = ys[i] - ys[i - 1];
+            float bx = xs[i + 1] - xs[i];
+            float by = ys[i + 1] - ys[i];
+            float cx = xs[i + 1] - xs[i - 1];
+            float cy = ys[i + 1] - ys[i - 1];
+
+            float cross = ax * by - ay * bx;
+            float denominator = std::sqrt((ax * ax + ay * ay) * (bx * bx + by * by) * (cx * cx + cy * cy));
+            curvature[i] = denominator > 0.0f ? 2.0f * cross / denominator : 0.0f;
+        }
+        curvature[0] = curvature[1];
+        curvature[count - 1] = curvature[count - 2];
+    }
+
+    struct SpeedProfileLimits {
+        SpeedProfileLimits()
+            : maxSpeed(0.7f)
+            , maxLateralAcceleration(0.5f)
+            , maxAcceleration(0.5f)
+            , maxDeceleration(0.5f)
+            , startSpeed(0.0f)
+            , endSpeed(0.0f)
+        {}
+
+        float maxSpeed;
+        float maxLateralAcceleration;
+        float maxAcceleration;
+        float maxDeceleration;
+        float startSpeed;
+        float endSpeed;
+    };
+
+    /**
+    * Speed at every sample of a path resampled every step meters
+    *
+    * Speed is capped by maxSpeed and by the lateral acceleration in curves, then a forward pass
+    * applies the acceleration limit from startSpeed and a backward pass the deceleration limit down
+    * to endSpeed. lastStep is the length of the final interval as given by PathGeometry::lastStep(),
+    * a negative value means it is a full step.
+    */
+    inline void speedProfile(const float* curvature, size_t count, float step, const SpeedProfileLimits& limits, float* speeds, float lastStep = -1.0f)
+    {
+        if (count == 0)
+            return;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float k = std::fabs(curvature[i]);
+            float v = limits.maxSpeed;
+            if (k > 1e-6f)
+                v = std::min(v, std::sqrt(limits.maxLateralAcceleration / k));
+            speeds[i] = v;
+        }
+
+        if (lastStep < 0.0f)
+            lastStep = step;
+
+        speeds[0] = std::min(speeds[0], limits.startSpeed);
+        for (size_t i = 1; i < count; i++)
+        {
+            float ds = (i + 1 == count) ? lastStep : step;
+            speeds[i] = std::min(speeds[i], std::sqrt(speeds[i - 1] * speeds[i - 1] + 2.0f * limits.maxAcceleration * ds));
+        }
+
+        speeds[count - 1] = std::min(speeds[count - 1], limits.endSpeed);
+        for (size_t i = count - 1; i > 0; i--)
+        {
+            float ds = (i + 1 == count) ? lastStep : step;
+            speeds[i - 1] = std::min(speeds[i - 1], std::sqrt(speeds[i] * speeds[i] + 2.0f * limits.maxDeceleration * ds));
+        }
+    }
+
+    /**
+    * Time to drive a speed profile, each step at the mean speed of its two samples. lastStep is the
+    * length of the final interval as in speedProfile().
+    */
+    inline double travelTime(const float* speeds, size_t count, float step, float lastStep = -1.0f)
+    {
+        if (lastStep < 0.0f)
+            lastStep = step;
+
+        double time = 0.0;
+        for (size_t i = 1; i < count; i++)
+        {
+            double ds = (i + 1 == count) ? lastStep : step;
+            if (ds <= 0.0)
+                continue;
+            double v = 0.5 * (speeds[i - 1] + speeds[i]);
+            if (v <= 0.0)
+                return std::numeric_limits<double>::infinity();
+            time += ds / v;
+        }
+        return time;
+    }
+
+} } }
@@ -0,0 +1,533 @@
+/*
+* route_optimizer.h
+* Local multi-goal route optimizer producing the same ordering as doMultTaskDispatch
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/core/pose.h>
+#include <rpos/system/parallel.h>
+
+#include <boost/chrono.hpp>
+#include <boost/function.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace rpos { namespace features { namespace motion_planner {
+
+    /**
+    * Symmetric distance matrix over the nodes of a route problem
+    *
+    * Node 0 is the start point, nodes 1..n are the pass points in caller order and node n + 1 is
+    * the end point. A missing start or end point is a node at distance 0 from everything, which
+    * turns the fixed-end problem into an open path.
+    */
+    class RouteDistanceMatrix {
+    public:
+        RouteDistanceMatrix()
+            : size_(0)
+        {}
+
+        explicit RouteDistanceMatrix(size_t passPoints)
+            : size_(passPoints + 2)
+            , values_(size_ * size_, 0.0f)
+        {}
+
+        /**
+        * Straight line distances, the fallback when no path lengths are known
+        */
+        static RouteDistanceMatrix euclidean(const boost::optional<core::Location>& startPoint, const std::vector<core::Location>& passPoints, const boost::optional<core::Location>& endPoint)
+        {
+            return build(startPoint, passPoints, endPoint, [](const core::Location& a, const core::Location& b) {
+                return static_cast<float>(a.distanceTo(b));
+            });
+        }
+
+        /**
+        * Fill every pair with a custom metric, e.g. cached path lengths
+        */
+        static RouteDistanceMatrix build(const boost::optional<core::Location>& startPoint, const std::vector<core::Location>& passPoints, const boost::optional<core::Location>& endPoint, const boost::function<float(const core::Location&, const core::Location&)>& distance)
+        {
+            RouteDistanceMatrix matrix(passPoints.size());
+            const size_t n = passPoints.size();
+            for (size_t i = 0; i < n; i++)
+            {
+                for (size_t j = i + 1; j < n; j++)
+                    matrix.set(i + 1, j + 1, distance(passPoints[i], passPoints[j]));
+                if (startPoint)
+                    matrix.set(0, i + 1, distance(*startPoint, passPoints[i]));
+                if (endPoint)
+                    matrix.set(i + 1, n + 1, distance(passPoints[i], *endPoint));
+            }
+            if (startPoint && endPoint)
+                matrix.set(0, n + 1, distance(*startPoint, *endPoint));
+            return matrix;
+        }
+
+    public:
+        size_t size() const
+        {
+            return size_;
+        }
+
+        size_t passPointCount() const
+        {
+            return size_ < 2 ? 0 : size_ - 2;
+        }
+
+        float operator()(size_t i, size_t j) const
+        {
+            return values_[i * size_ + j];
+        }
+
+        void set(size_t i, size_t j, float distance)
+        {
+            values_[i * size_ + j] = distance;
+            values_[j * size_ + i] = distance;
+        }
+
+        /**
+        * Overwrite the distances from one node to every pass point, e.g. the start node with the
+        * result of PathSearchCache::pathLengths()
+        */
+        void setRow(size_t i, const std::vector<float>& toPassPoints)
+        {
+            if (toPassPoints.size() != passPointCount())
+                throw std::runtime_error("Route distance row does not match the number of pass points");
+            for (size_t j = 0; j < toPassPoints.size(); j++)
+            {
+                if (j + 1 != i)
+                    set(i, j + 1, toPassPoints[j]);
+            }
+        }
+
+    private:
+        size_t size_;
+        std::vector<float> values_;
+    };
+
+    struct RouteOptimizerOptions {
+        RouteOptimizerOptions()
+            : timeBudgetMs(200)
+            , concurrency(0)
+            , seed(5489u)
+        {}
+
+        /**
+        * Wall time for the whole search, the nearest neighbour seed with one local search round is
+        * always finished even if it takes longer
+        */
+        int timeBudgetMs;
+
+        /**
+        * Number of independent searches, 0 means hardware concurrency
+        */
+        int concurrency;
+
+        unsigned int seed;
+    };
+
+    struct RouteSolution {
+        RouteSolution()
+            : cost(0.0)
+            , rounds(0)
+        {}
+
+        /**
+        * Indices into the pass points in visiting order, unreachable ones last
+        */
+        std::vector<size_t> order;
+
+        /**
+        * Pass points the start point has no finite distance to, directly or through other pass
+        * points, in caller order; they are also at the end of order
+        */
+        std::vector<size_t> unreachable;
+
+        /**
+        * Length of the route over the reachable pass points, infinite if even those can not be
+        * chained (e.g. the end point is unreachable)
+        */
+        double cost;
+        size_t rounds;
+    };
+
+    namespace detail {
+
+        /**
+        * Pass points (1..n) connected to the start node by finite distances, the route ends at the
+        * end node so it never leads on to other pass points
+        */
+        inline std::vector<bool> routeReachable(const RouteDistanceMatrix& matrix)
+        {
+            const size_t end = matrix.size() - 1;
+            std::vector<bool> reached(matrix.size(), false);
+            std::vector<size_t> pending(1, 0);
+            reached[0] = true;
+            while (!pending.empty())
+            {
+                size_t i = pending.back();
+                pending.pop_back();
+                for (size_t j = 1; j < end; j++)
+                {
+                    if (!reached[j] && !std::isinf(matrix(i, j)) && !std::isnan(matrix(i, j)))
+                    {
+                        reached[j] = true;
+                        pending.push_back(j);
+                    }
+                }
+            }
+            return reached;
+        }
+
+        class RouteSearch {
+        public:
+            typedef boost::chrono::steady_clock clock_t;
+
+            RouteSearch(const RouteDistanceMatrix& matrix, clock_t::time_point deadline)
+                : matrix_(matrix)
+                , deadline_(deadline)
+            {}
+
+            /**
+            * Nearest neighbour tour, with randomize set every step picks among the three nearest
+            */
+            std::vector<size_t> seed(std::mt19937& rng, bool randomize) const
+            {
+                const size_t n = matrix_.passPointCount();
+                std::vector<size_t> tour;
+                tour.reserve(n + 2);
+                tour.push_back(0);
+
+                std::vector<bool> visited(n + 2, false);
+                size_t current = 0;
+                for (size_t step = 0; step < n; step++)
+                {
+                    size_t best[3] = { 0, 0, 0 };
+                    float bestDistance[3] = { 0.0f, 0.0f, 0.0f };
+                    size_t found = 0;
+                    for (size_t j = 1; j <= n; j++)
+                    {
+                        if (visited[j])
+                            continue;
+
+                        const float d = matrix_(current, j);
+                        size_t k = found < 3 ? found++ : 3;
+                        for (; k > 0 && d < bestDistance[k - 1]; k--)
+                        {
+                            if (k < 3)
+                            {
+                                best[k] = best[k - 1];
+                                bestDistance[k] = bestDistance[k - 1];
+                            }
+                        }
+                        if (k < 3)
+                        {
+                            best[k] = j;
+                            bestDistance[k] = d;
+                        }
+                    }
+
+                    size_t candidates = randomize ? std::min<size_t>(found, 3) : 1;
+                    size_t next = best[candidates > 1 ? rng() % candidates : 0];
+                    visited[next] = true;
+                    tour.push_back(next);
+                    current = next;
+                }
+
+                tour.push_back(n + 1);
+                return tour;
+            }
+
+            double cost(const std::vector<size_t>& tour) const
+            {
+                double total = 0.0;
+                for (size_t i = 1; i < tour.size(); i++)
+                    total += matrix_(tour[i - 1], tour[i]);
+                return total;
+            }
+
+            /**
+            * 2-opt and Or-opt until neither improves or the deadline passes, at least one round is run
+            */
+            void improve(std::vector<size_t>& tour) const
+            {
+                bool improved = true;
+                bool first = true;
+                while (improved && (first || clock_t::now() < deadline_))
+                {
+                    first = false;
+                    improved = twoOpt_(tour);
+                    improved = orOpt_(tour) || improved;
+                }
+            }
+
+            /**
+            * Double bridge kick on the pass points, keeps both ends in place
+            */
+            void perturb(std::vector<size_t>& tour, std::mt19937& rng) const
+            {
+                const size_t n = tour.size() - 2;
+                if (n < 8)
+                {
+                    if (n < 2)
+                        return;
+                    size_t i = 1 + rng() % n;
+                    size_t j = 1 + rng() % n;
+                    std::swap(tour[i], tour[j]);
+                    return;
+                }
+
+                size_t cuts[3];
+                for (int k = 0; k < 3; k++)
+                    cuts[k] = 2 + rng() % (n - 1);
+                std::sort(cuts, cuts + 3);
+                if (cuts[0] == cuts[1] || cuts[1] == cuts[2])
+                    return;
+
+                std::vector<size_t> result;
+                result.reserve(tour.size());
+                result.insert(result.end(), tour.begin(), tour.begin() + cuts[0]);
+                result.insert(result.end(), tour.begin() + cuts[1], tour.begin() + cuts[2]);
+                result.insert(result.end(), tour.begin() + cuts[0], tour.begin() + cuts[1]);
+                result.insert(result.end(), tour.begin() + cuts[2], tour.end());
+                tour.swap(result);
+            }
+
+            bool expired() const
+            {
+                return clock_t::now() >= deadline_;
+            }
+
+        private:
+            bool twoOpt_(std::vector<size_t>& tour) const
+            {
+                bool improved = false;
+                const size_t m = tour.size();
+                for (size_t i = 0; i + 3 < m; i++)
+                {
+                    const size_t a = tour[i];
+                    const size_t b = tour[i + 1];
+                    const float ab = matrix_(a, b);
+                    for (size_t j = i + 2; j + 1 < m; j++)
+                    {
+                        const size_t c = tour[j];
+                        const size_t d = tour[j + 1];
+                        float delta = matrix_(a, c) + matrix_(b, d) - ab - matrix_(c, d);
+                        if (delta < -1e-6f)
+                        {
+                            std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                            improved = true;
+                            break;
+                        }
+                    }
+                }
+                return improved;
+            }
+
+            bool orOpt_(std::vector<size_t>& tour) const
+            {
+                bool improved = false;
+                for (size_t length = 1; length <= 3; length++)
+                {
+                    for (size_t i = 1; i + length < tour.size(); i++)
+                    {
+                        if (tryMoveSegment_(tour, i, length))
+                            improved = true;
+                    }
+                }
+                return improved;
+            }
+
+            /**
+            * Move tour[i, i + length) between two other neighbours, in either direction
+            */
+            bool tryMoveSegment_(std::vector<size_t>& tour, size_t i, size_t length) const
+            {
+                const size_t m = tour.size();
+                const size_t prev = tour[i - 1];
+                const size_t first = tour[i];
+                const size_t last = tour[i + length - 1];
+                const size_t next = tour[i + length];
+                const float removeGain = matrix_(prev, first) + matrix_(last, next) - matrix_(prev, next);
+
+                for (size_t p = 0; p + 1 < m; p++)
+                {
+                    if (p + 1 >= i && p < i + length)
+                        continue;
+
+                    const size_t a = tour[p];
+                    const size_t b = tour[p + 1];
+                    const float ab = matrix_(a, b);
+                    const float forward = matrix_(a, first) + matrix_(last, b) - ab;
+                    const float backward = matrix_(a, last) + matrix_(first, b) - ab;
+                    const bool reversed = backward < forward;
+                    if ((reversed ? backward : forward) - removeGain >= -1e-6f)
+                        continue;
+
+                    std::vector<size_t> segment(tour.begin() + i, tour.begin() + i + length);
+                    if (reversed)
+                        std::reverse(segment.begin(), segment.end());
+                    tour.erase(tour.begin() + i, tour.begin() + i + length);
+                    size_t at = p < i ? p + 1 : p + 1 - length;
+                    tour.insert(tour.begin() + at, segment.begin(), segment.end());
+                    return true;
+                }
+                return false;
+            }
+
+        private:
+            const RouteDistanceMatrix& matrix_;
+            clock_t::time_point deadline_;
+        };
+
+    }
+
+    /**
+    * Order the pass points to minimize the total distance from the start point through every pass
+    * point to the end point
+    *
+    * Every worker builds a nearest neighbour tour (the first one deterministic, the others
+    * randomized), improves it with 2-opt and Or-opt, then keeps kicking the best tour with a double
+    * bridge and improving again until the time budget is spent. The best tour of all workers wins.
+    *
+    * Infinite distances mark failed path searches. Pass points the start can not reach are left out
+    * of the search, listed in RouteSolution::unreachable and visited last in caller order.
+    */
+    inline RouteSolution solveRoute(const RouteDistanceMatrix& matrix, const RouteOptimizerOptions& options = RouteOptimizerOptions())
+    {
+        typedef detail::RouteSearch::clock_t clock_t;
+
+        RouteSolution solution;
+        if (matrix.passPointCount() == 0)
+            return solution;
+
+        std::vector<bool> reached = detail::routeReachable(matrix);
+        std::vector<size_t> reachable;
+        for (size_t j = 1; j <= matrix.passPointCount(); j++)
+        {
+            if (reached[j])
+                reachable.push_back(j - 1);
+            else
+                solution.unreachable.push_back(j - 1);
+        }
+        if (!solution.unreachable.empty())
+        {
+            const size_t m = reachable.size();
+            const size_t end = matrix.size() - 1;
+            RouteDistanceMatrix reduced(m);
+            for (size_t a = 0; a < m; a++)
+            {
+                for (size_t b = a + 1; b < m; b++)
+                    reduced.set(a + 1, b + 1, matrix(reachable[a] + 1, reachable[b] + 1));
+                reduced.set(0, a + 1, matrix(0, reachable[a] + 1));
+                reduced.set(a + 1, m + 1, matrix(reachable[a] + 1, end));
+            }
+            reduced.set(0, m + 1, matrix(0, end));
+
+            RouteSolution partial = solveRoute(reduced, options);
+            for (size_t i = 0; i < partial.order.size(); i++)
+                solution.order.push_back(reachable[partial.order[i]]);
+            solution.order.insert(solution.order.end(), solution.unreachable.begin(), solution.unreachable.end());
+            solution.cost = m ? partial.cost : matrix(0, end);
+            solution.rounds = partial.rounds;
+            return solution;
+        }
+
+        const size_t n = matrix.passPointCount();
+
+        const clock_t::time_point deadline = clock_t::now() + boost::chrono::milliseconds(options.timeBudgetMs);
+        int workers = options.concurrency > 0 ? options.concurrency : static_cast<int>(boost::thread::hardware_concurrency());
+        if (workers <= 0)
+            workers = 4;
+        if (n < 4)
+            workers = 1;
+
+        boost::mutex lock;
+        std::vector<size_t> bestTour;
+        double bestCost = std::numeric_limits<double>::infinity();
+        size_t rounds = 0;
+
+        rpos::system::parallel_for(workers, [&](int worker) {
+            detail::RouteSearch search(matrix, deadline);
+            std::mt19937 rng(options.seed + static_cast<unsigned int>(worker) * 7919u);
+
+            std::vector<size_t> best = search.seed(rng, worker != 0);
+            search.improve(best);
+            double cost = search.cost(best);
+            size_t localRounds = 1;
+
+            while (!search.expired())
+            {
+                std::vector<size_t> candidate = best;
+                search.perturb(candidate, rng);
+                search.improve(candidate);
+                double candidateCost = search.cost(candidate);
+                if (candidateCost < cost)
+                {
+                    best.swap(candidate);
+                    cost = candidateCost;
+                }
+                localRounds++;
+            }
+
+            boost::lock_guard<boost::mutex> guard(lock);
+            rounds += localRounds;
+            // an infinite cost (the end point can not be chained) still yields a tour
+            if (bestTour.empty() || cost < bestCost)
+            {
+                bestCost = cost;
+                bestTour.swap(best);
+            }
+        }, workers);
+
+        solution.order.reserve(n);
+        for (size_t i = 1; i + 1 < bestTour.size(); i++)
+            solution.order.push_back(bestTour[i] - 1);
+        solution.cost = bestCost;
+        solution.rounds = rounds;
+        return solution;
+    }
+
+    /**
+    * Drop-in local replacement for MotionPlanner::doMultTaskDispatch(), returns the pass points in
+    * visiting order using straight line distances
+    */
+    inline std::vector<core::Location> optimizeRoute(const boost::optional<core::Location>& startPoint, const std::vector<core::Location>& passPoints, const boost::optional<core::Location>& endPoint, const RouteOptimizerOptions& options = RouteOptimizerOptions())
+    {
+        RouteSolution solution = solveRoute(RouteDistanceMatrix::euclidean(startPoint, passPoints, endPoint), options);
+        std::vector<core::Location> route;
+        route.reserve(solution.order.size());
+        for (size_t i = 0; i < solution.order.size(); i++)
+            route.push_back(passPoints[solution.order[i]]);
+        return route;
+    }
+
+    /**
+    * Same as above over a caller supplied matrix, e.g. one filled from cached path lengths
+    */
+    inline std::vector<core::Location> optimizeRoute(const RouteDistanceMatrix& matrix, const std::vector<core::Location>& passPoints, const RouteOptimizerOptions& options = RouteOptimizerOptions())
+    {
+        if (matrix.passPointCount() != passPoints.size())
+            throw std::runtime_error("Route distance matrix does not match the number of pass points");
+
+        RouteSolution solution = solveRoute(matrix, options);
+        std::vector<core::Location> route;
+        route.reserve(solution.order.size());
+        for (size_t i = 0; i < solution.order.size(); i++)
+            route.push_back(passPoints[solution.order[i]]);
+        return route;
+    }
+
+} } }
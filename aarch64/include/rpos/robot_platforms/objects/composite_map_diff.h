@@ -0,0 +1,1368 @@
+/*
+* composite_map_diff.h
+* Diff and patch engine for composite maps
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/robot_platforms/objects/composite_map.h>
+#include <rpos/robot_platforms/objects/composite_map_defs.h>
+#include <rpos/robot_platforms/objects/grid_map_layer.h>
+#include <rpos/robot_platforms/objects/line_map_layer.h>
+#include <rpos/robot_platforms/objects/polygon_area_map_layer.h>
+#include <rpos/robot_platforms/objects/pose_map_layer.h>
+#include <rpos/robot_platforms/objects/rectangle_area_map_layer.h>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rpos { namespace robot_platforms { namespace objects {
+
+    struct CompositeMapDiffOptions {
+        CompositeMapDiffOptions()
+            : tileSize(64)
+        {}
+
+        /**
+        * Grid layers are compared and shipped in tiles of tileSize x tileSize cells
+        */
+        int tileSize;
+    };
+
+    namespace detail {
+
+        const uint8_t kMapPatchMagic[4] = { 'S', 'M', 'P', 'T' };
+        const uint8_t kMapPatchVersion = 1;
+
+        enum MapPatchLayerKind {
+            MapPatchLayerGrid = 1,
+            MapPatchLayerPose = 2,
+            MapPatchLayerLine = 3,
+            MapPatchLayerRectangleArea = 4,
+            MapPatchLayerPolygonArea = 5
+        };
+
+        enum MapPatchLayerOp {
+            MapPatchLayerAdd = 1,
+            MapPatchLayerRemove = 2,
+            MapPatchLayerModify = 3
+        };
+
+        enum MapPatchRunKind {
+            MapPatchRunSkip = 0,
+            MapPatchRunFill = 1,
+            MapPatchRunCopy = 2
+        };
+
+        class MapPatchWriter {
+        public:
+            explicit MapPatchWriter(std::vector<uint8_t>& out)
+                : out_(out)
+            {}
+
+            void u8(uint8_t v)
+            {
+                out_.push_back(v);
+            }
+
+            void varint(uint64_t v)
+            {
+                while (v >= 0x80)
+                {
+                    out_.push_back(static_cast<uint8_t>(v | 0x80));
+                    v >>= 7;
+                }
+                out_.push_back(static_cast<uint8_t>(v));
+            }
+
+            void svarint(int64_t v)
+            {
+                varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+            }
+
+            void f32(float v)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                for (int i = 0; i < 4; i++)
+                    out_.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+            }
+
+            void f64(double v)
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                for (int i = 0; i < 8; i++)
+                    out_.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+            }
+
+            void bytes(const uint8_t* data, size_t size)
+            {
+                out_.insert(out_.end(), data, data + size);
+            }
+
+            void blob(const std::vector<uint8_t>& data)
+            {
+                varint(data.size());
+                if (!data.empty())
+                    bytes(&data[0], data.size());
+            }
+
+            void str(const std::string& v)
+            {
+                varint(v.size());
+                out_.insert(out_.end(), v.begin(), v.end());
+            }
+
+            void metadata(const core::Metadata& v)
+            {
+                const std::map<std::string, std::string>& dict = v.dict();
+                varint(dict.size());
+                for (std::map<std::string, std::string>::const_iterator it = dict.begin(); it != dict.end(); ++it)
+                {
+                    str(it->first);
+                    str(it->second);
+                }
+            }
+
+            void location(const core::Location& v)
+            {
+                f64(v.x());
+                f64(v.y());
+                f64(v.z());
+            }
+
+        private:
+            std::vector<uint8_t>& out_;
+        };
+
+        class MapPatchReader {
+        public:
+            MapPatchReader(const uint8_t* data, size_t size)
+                : data_(data)
+                , size_(size)
+                , pos_(0)
+            {}
+
+            bool done() const
+            {
+                return pos_ == size_;
+            }
+
+            uint8_t u8()
+            {
+                need_(1);
+                return data_[pos_++];
+            }
+
+            uint64_t varint()
+            {
+                uint64_t v = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    uint8_t b = u8();
+                    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+                    if (!(b & 0x80))
+                        return v;
+                }
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: varint too long");
+            }
+
+            int64_t svarint()
+            {
+                uint64_t v = varint();
+                return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+            }
+
+            /**
+            * A count of items that each take at least one byte, checked against what is left
+            */
+            size_t count()
+            {
+                uint64_t v = varint();
+                if (v > size_ - pos_)
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: count exceeds patch size");
+                return static_cast<size_t>(v);
+            }
+
+            float f32()
+            {
+                need_(4);
+                uint32_t bits = 0;
+                for (int i = 0; i < 4; i++)
+                    bits |= static_cast<uint32_t>(data_[pos_++]) << (8 * i);
+                float v;
+                std::memcpy(&v, &bits, sizeof(v));
+                return v;
+            }
+
+            double f64()
+            {
+                need_(8);
+                uint64_t bits = 0;
+                for (int i = 0; i < 8; i++)
+                    bits |= static_cast<uint64_t>(data_[pos_++]) << (8 * i);
+                double v;
+                std::memcpy(&v, &bits, sizeof(v));
+                return v;
+            }
+
+            const uint8_t* bytes(size_t size)
+            {
+                need_(size);
+                const uint8_t* p = data_ + pos_;
+                pos_ += size;
+                return p;
+            }
+
+            std::vector<uint8_t> blob()
+            {
+                size_t size = count();
+                const uint8_t* p = bytes(size);
+                return std::vector<uint8_t>(p, p + size);
+            }
+
+            std::string str()
+            {
+                size_t size = count();
+                const uint8_t* p = bytes(size);
+                return std::string(reinterpret_cast<const char*>(p), size);
+            }
+
+            void metadata(core::Metadata& v)
+            {
+                v.clear();
+                size_t n = count();
+                for (size_t i = 0; i < n; i++)
+                {
+                    std::string key = str();
+                    v.set(key, str());
+                }
+            }
+
+            core::Location location()
+            {
+                double x = f64();
+                double y = f64();
+                double z = f64();
+                return core::Location(x, y, z);
+            }
+
+        private:
+            void need_(size_t n) const
+            {
+                if (n > size_ - pos_)
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: unexpected end of data");
+            }
+
+            const uint8_t* data_;
+            size_t size_;
+            size_t pos_;
+        };
+
+        inline uint32_t mapPatchHash(const std::vector<uint8_t>& data)
+        {
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < data.size(); i++)
+            {
+                h ^= data[i];
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        /**
+        * Canonical encoding of one record of a keyed layer, equal records encode to equal bytes
+        */
+        inline void encodeMapPatchRecord(MapPatchWriter& w, const core::PoseEntry& v)
+        {
+            w.str(v.name);
+            w.varint(v.tags.size());
+            for (size_t i = 0; i < v.tags.size(); i++)
+                w.str(v.tags[i]);
+            w.location(v.pose.location());
+            w.f64(v.pose.rotation().yaw());
+            w.f64(v.pose.rotation().pitch());
+            w.f64(v.pose.rotation().roll());
+            w.u8(v.flags);
+            w.metadata(v.metadata);
+        }
+
+        inline void decodeMapPatchRecord(MapPatchReader& r, core::PoseEntry& v)
+        {
+            v.name = r.str();
+            v.tags.resize(r.count());
+            for (size_t i = 0; i < v.tags.size(); i++)
+                v.tags[i] = r.str();
+            core::Location location = r.location();
+            double yaw = r.f64();
+            double pitch = r.f64();
+            double roll = r.f64();
+            v.pose = core::Pose(location, core::Rotation(yaw, pitch, roll));
+            v.flags = r.u8();
+            r.metadata(v.metadata);
+        }
+
+        inline void encodeMapPatchRecord(MapPatchWriter& w, const Line& v)
+        {
+            w.str(v.name);
+            w.location(v.start);
+            w.location(v.end);
+            w.metadata(v.metadata);
+        }
+
+        inline void decodeMapPatchRecord(MapPatchReader& r, Line& v)
+        {
+            v.name = r.str();
+            v.start = r.location();
+            v.end = r.location();
+            r.metadata(v.metadata);
+        }
+
+        inline void encodeMapPatchRecord(MapPatchWriter& w, const features::artifact_provider::RectangleArea& v)
+        {
+            w.varint(v.id);
+            w.svarint(static_cast<int64_t>(v.usage));
+            w.f32(v.area.start().x());
+            w.f32(v.area.start().y());
+            w.f32(v.area.end().x());
+            w.f32(v.area.end().y());
+            w.f32(v.area.halfWidth());
+            w.metadata(v.metadata);
+        }
+
+        inline void decodeMapPatchRecord(MapPatchReader& r, features::artifact_provider::RectangleArea& v)
+        {
+            v.id = static_cast<core::SegmentID>(r.varint());
+            v.usage = static_cast<features::artifact_provider::ArtifactUsage>(r.svarint());
+            float sx = r.f32();
+            float sy = r.f32();
+            float ex = r.f32();
+            float ey = r.f32();
+            float halfWidth = r.f32();
+            v.area = core::ORectangleF(core::Vector2f(sx, sy), core::Vector2f(ex, ey), halfWidth);
+            r.metadata(v.metadata);
+        }
+
+        inline void encodeMapPatchRecord(MapPatchWriter& w, const polygonArea& v)
+        {
+            w.varint(v.id);
+            w.u8(v.count);
+            w.varint(v.locations.size());
+            for (size_t i = 0; i < v.locations.size(); i++)
+                w.location(v.locations[i]);
+            w.metadata(v.metadata);
+        }
+
+        inline void decodeMapPatchRecord(MapPatchReader& r, polygonArea& v)
+        {
+            v.id = static_cast<core::SegmentID>(r.varint());
+            v.count = r.u8();
+            v.locations.resize(r.count());
+            for (size_t i = 0; i < v.locations.size(); i++)
+                v.locations[i] = r.location();
+            r.metadata(v.metadata);
+        }
+
+        /**
+        * Key and record accessors per keyed layer type, keys are the map keys for pose and line
+        * layers and the segment ids for area layers. apply() deletes and upserts records decoded
+        * beforehand, it only fails on allocation.
+        */
+        template <class LayerT>
+        struct MapPatchKeyedLayer;
+
+        template <>
+        struct MapPatchKeyedLayer<PoseMapLayer> {
+            typedef core::PoseEntry record_t;
+            static const MapPatchLayerKind kind = MapPatchLayerPose;
+
+            template <class F>
+            static void each(const PoseMapLayer& layer, F f)
+            {
+                for (PoseEntryMap::const_iterator it = layer.poses().begin(); it != layer.poses().end(); ++it)
+                    f(it->first, it->second);
+            }
+
+            static bool isKey(const std::string&)
+            {
+                return true;
+            }
+
+            static void apply(PoseMapLayer& layer, const std::vector<std::string>& deletes, const std::vector<std::string>& keys, const std::vector<record_t>& records)
+            {
+                for (size_t i = 0; i < deletes.size(); i++)
+                    layer.poses().erase(deletes[i]);
+                for (size_t i = 0; i < keys.size(); i++)
+                    layer.poses()[keys[i]] = records[i];
+            }
+        };
+
+        template <>
+        struct MapPatchKeyedLayer<LineMapLayer> {
+            typedef Line record_t;
+            static const MapPatchLayerKind kind = MapPatchLayerLine;
+
+            template <class F>
+            static void each(const LineMapLayer& layer, F f)
+            {
+                for (std::map<std::string, Line>::const_iterator it = layer.lines().begin(); it != layer.lines().end(); ++it)
+                    f(it->first, it->second);
+            }
+
+            static bool isKey(const std::string&)
+            {
+                return true;
+            }
+
+            static void apply(LineMapLayer& layer, const std::vector<std::string>& deletes, const std::vector<std::string>& keys, const std::vector<record_t>& records)
+            {
+                for (size_t i = 0; i < deletes.size(); i++)
+                    layer.lines().erase(deletes[i]);
+                for (size_t i = 0; i < keys.size(); i++)
+                    layer.lines()[keys[i]] = records[i];
+            }
+        };
+
+        /**
+        * Area layers may hold several areas with the same id, the n-th of them (counting from 0) is
+        * keyed "<id>#<n>", the first one just "<id>"
+        */
+        template <class LayerT, class RecordT>
+        struct MapPatchIdLayer {
+            typedef RecordT record_t;
+
+            static std::vector<std::string> keys(const LayerT& layer)
+            {
+                std::map<core::SegmentID, size_t> seen;
+                std::vector<std::string> result(layer.areas().size());
+                for (size_t i = 0; i < result.size(); i++)
+                {
+                    core::SegmentID id = layer.areas()[i].id;
+                    size_t n = seen[id]++;
+                    result[i] = boost::lexical_cast<std::string>(id);
+                    if (n)
+                        result[i] += "#" + boost::lexical_cast<std::string>(n);
+                }
+                return result;
+            }
+
+            template <class F>
+            static void each(const LayerT& layer, F f)
+            {
+                std::vector<std::string> k = keys(layer);
+                for (size_t i = 0; i < k.size(); i++)
+                    f(k[i], layer.areas()[i]);
+            }
+
+            static bool isKey(const std::string& key)
+            {
+                size_t hash = key.find('#');
+                return isNumber_(key.substr(0, hash)) && (hash == std::string::npos || isNumber_(key.substr(hash + 1)));
+            }
+
+            /**
+            * Existing areas are replaced in place, deleted ones removed and new ones appended in the
+            * order of their n so the keys stay the same
+            */
+            static void apply(LayerT& layer, const std::vector<std::string>& deletes, const std::vector<std::string>& keys, const std::vector<record_t>& records)
+            {
+                std::vector<RecordT>& areas = layer.areas();
+                std::map<std::string, size_t> index;
+                std::vector<std::string> existing = MapPatchIdLayer::keys(layer);
+                for (size_t i = 0; i < existing.size(); i++)
+                    index[existing[i]] = i;
+
+                std::vector<bool> erased(areas.size(), false);
+                for (size_t i = 0; i < deletes.size(); i++)
+                {
+                    std::map<std::string, size_t>::const_iterator it = index.find(deletes[i]);
+                    if (it != index.end())
+                        erased[it->second] = true;
+                }
+
+                std::vector< std::pair<size_t, size_t> > appended;
+                for (size_t i = 0; i < keys.size(); i++)
+                {
+                    std::map<std::string, size_t>::const_iterator it = index.find(keys[i]);
+                    if (it != index.end())
+                    {
+                        areas[it->second] = records[i];
+                        erased[it->second] = false;
+                    }
+                    else
+                    {
+                        appended.push_back(std::make_pair(ordinal_(keys[i]), i));
+                    }
+                }
+
+                size_t kept = 0;
+                for (size_t i = 0; i < areas.size(); i++)
+                {
+                    if (erased[i])
+                        continue;
+                    if (kept != i)
+                        areas[kept] = areas[i];
+                    kept++;
+                }
+                areas.resize(kept);
+
+                std::stable_sort(appended.begin(), appended.end());
+                for (size_t i = 0; i < appended.size(); i++)
+                    areas.push_back(records[appended[i].second]);
+            }
+
+        private:
+            static bool isNumber_(const std::string& v)
+            {
+                return !v.empty() && v.size() <= 19 && v.find_first_not_of("0123456789") == std::string::npos;
+            }
+
+            static size_t ordinal_(const std::string& key)
+            {
+                size_t hash = key.find('#');
+                return hash == std::string::npos ? 0 : static_cast<size_t>(std::strtoull(key.c_str() + hash + 1, NULL, 10));
+            }
+        };
+
+        template <>
+        struct MapPatchKeyedLayer<RectangleAreaMapLayer> : MapPatchIdLayer<RectangleAreaMapLayer, features::artifact_provider::RectangleArea> {
+            static const MapPatchLayerKind kind = MapPatchLayerRectangleArea;
+        };
+
+        template <>
+        struct MapPatchKeyedLayer<PolygonAreaMapLayer> : MapPatchIdLayer<PolygonAreaMapLayer, polygonArea> {
+            static const MapPatchLayerKind kind = MapPatchLayerPolygonArea;
+        };
+
+        /**
+        * Delta of one grid tile as runs: skip n unchanged cells, fill n cells with a value, or copy
+        * n literal cells. Runs of at least 4 equal new cells become fills, new layers are encoded
+        * against an all-unknown (zero) tile.
+        */
+        inline void encodeGridTileDelta(const uint8_t* from, const uint8_t* to, size_t count, MapPatchWriter& w)
+        {
+            size_t i = 0;
+            size_t literal = 0;
+            size_t literalStart = 0;
+
+            while (i < count)
+            {
+                size_t skip = 0;
+                while (i + skip < count && from[i + skip] == to[i + skip])
+                    skip++;
+
+                size_t fill = 1;
+                if (skip == 0)
+                {
+                    while (i + fill < count && to[i + fill] == to[i] && from[i + fill] != to[i + fill])
+                        fill++;
+                }
+
+                if (skip >= 2 || fill >= 4 || (skip > 0 && i + skip == count))
+                {
+                    if (literal)
+                    {
+                        w.varint((literal << 2) | MapPatchRunCopy);
+                        w.bytes(to + literalStart, literal);
+                        literal = 0;
+                    }
+                    if (skip)
+                    {
+                        w.varint((skip << 2) | MapPatchRunSkip);
+                        i += skip;
+                    }
+                    else
+                    {
+                        w.varint((fill << 2) | MapPatchRunFill);
+                        w.u8(to[i]);
+                        i += fill;
+                    }
+                    continue;
+                }
+
+                if (!literal)
+                    literalStart = i;
+                size_t n = skip ? skip : 1;
+                literal += n;
+                i += n;
+            }
+
+            if (literal)
+            {
+                w.varint((literal << 2) | MapPatchRunCopy);
+                w.bytes(to + literalStart, literal);
+            }
+        }
+
+        inline void decodeGridTileDelta(MapPatchReader& r, uint8_t* cells, size_t count)
+        {
+            size_t i = 0;
+            while (i < count)
+            {
+                uint64_t run = r.varint();
+                size_t n = static_cast<size_t>(run >> 2);
+                if (n == 0 || n > count - i)
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: tile run out of range");
+                switch (run & 3)
+                {
+                case MapPatchRunSkip:
+                    break;
+                case MapPatchRunFill:
+                    std::fill(cells + i, cells + i + n, r.u8());
+                    break;
+                case MapPatchRunCopy:
+                    std::memcpy(cells + i, r.bytes(n), n);
+                    break;
+                default:
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: unknown tile run");
+                }
+                i += n;
+            }
+        }
+
+    }
+
+    /**
+    * Difference between two composite maps, with a compact binary form to ship it
+    *
+    * Layers are matched by name and usage. Grid layers of the same geometry are compared tile by
+    * tile and each changed tile is stored as skip/fill/copy runs; pose, line, rectangle area and
+    * polygon area layers are compared record by record and stored as keyed deletes and upserts.
+    * Added layers carry their full content, layer metadata is replaced when it changed. Layer
+    * types the engine does not know (points maps, image features, ...) are not compared and are
+    * listed in skippedLayers(), ship the full map if those matter.
+    *
+    * apply() checks the whole patch against the target first (grid layers carry a hash of the data
+    * they were diffed against) and decodes every layer body into staging before changing the map,
+    * a patch that does not match or does not decode throws CompositeMapException and leaves the map
+    * as it was.
+    *
+    * Usage:
+    *   CompositeMapPatch patch = CompositeMapPatch::diff(*deployed, *edited);
+    *   std::vector<uint8_t> bytes = patch.serialize();
+    *   ...
+    *   CompositeMapPatch::deserialize(bytes).apply(*robotMap);
+    */
+    class CompositeMapPatch {
+    public:
+        CompositeMapPatch()
+        {}
+
+    public:
+        static CompositeMapPatch diff(const CompositeMap& from, const CompositeMap& to, const CompositeMapDiffOptions& options = CompositeMapDiffOptions())
+        {
+            CompositeMapPatch patch;
+            const int tileSize = std::max(1, options.tileSize);
+
+            std::map<LayerKey, boost::shared_ptr<MapLayer> > fromLayers;
+            for (size_t i = 0; i < from.maps().size(); i++)
+            {
+                const boost::shared_ptr<MapLayer>& layer = from.maps()[i];
+                if (layer)
+                    fromLayers[keyOf_(*layer)] = layer;
+            }
+
+            std::map<LayerKey, bool> seen;
+            for (size_t i = 0; i < to.maps().size(); i++)
+            {
+                const boost::shared_ptr<MapLayer>& layer = to.maps()[i];
+                if (!layer)
+                    continue;
+                LayerKey key = keyOf_(*layer);
+                seen[key] = true;
+
+                int kind = kindOf_(*layer);
+                if (!kind)
+                {
+                    patch.skipped_.push_back(layer->getName());
+                    continue;
+                }
+
+                std::map<LayerKey, boost::shared_ptr<MapLayer> >::const_iterator old = fromLayers.find(key);
+                if (old == fromLayers.end() || kindOf_(*old->second) != kind || !sameGeometry_(*old->second, *layer))
+                {
+                    if (old != fromLayers.end())
+                        patch.addRemove_(*old->second);
+                    patch.addLayer_(NULL, *layer, kind, tileSize);
+                }
+                else
+                {
+                    patch.addLayer_(old->second.get(), *layer, kind, tileSize);
+                }
+            }
+
+            for (std::map<LayerKey, boost::shared_ptr<MapLayer> >::const_iterator it = fromLayers.begin(); it != fromLayers.end(); ++it)
+            {
+                if (seen.count(it->first))
+                    continue;
+                if (!kindOf_(*it->second))
+                    patch.skipped_.push_back(it->second->getName());
+                else
+                    patch.addRemove_(*it->second);
+            }
+            return patch;
+        }
+
+        /**
+        * Apply to a map equal to the diff source, the map equals the diff target afterwards
+        */
+        void apply(CompositeMap& map) const
+        {
+            std::vector< boost::shared_ptr<MapLayer> >& layers = map.maps();
+
+            std::vector<int> targets(deltas_.size(), -1);
+            for (size_t i = 0; i < deltas_.size(); i++)
+            {
+                const LayerDelta& delta = deltas_[i];
+                targets[i] = findLayer_(layers, delta);
+                if (delta.op == detail::MapPatchLayerAdd)
+                {
+                    if (targets[i] >= 0 && !removes_(delta))
+                        RPOS_COMPOSITEMAP_THROW_EXCEPTION("map patch does not match: layer " + delta.name + " already exists");
+                    continue;
+                }
+                if (targets[i] < 0)
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("map patch does not match: missing layer " + delta.name);
+                if (delta.op == detail::MapPatchLayerModify && delta.kind == detail::MapPatchLayerGrid)
+                {
+                    const GridMapLayer* grid = dynamic_cast<const GridMapLayer*>(layers[targets[i]].get());
+                    if (!grid || grid->getDimension().x() != delta.width || grid->getDimension().y() != delta.height
+                        || grid->mapData().size() != static_cast<size_t>(delta.width) * delta.height
+                        || detail::mapPatchHash(grid->mapData()) != delta.baseHash)
+                        RPOS_COMPOSITEMAP_THROW_EXCEPTION("map patch does not match: grid layer " + delta.name + " differs from the diff source");
+                }
+                else if (kindOf_(*layers[targets[i]]) != delta.kind)
+                {
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("map patch does not match: layer " + delta.name + " has a different type");
+                }
+            }
+
+            std::vector<LayerStage> stages(deltas_.size());
+            std::vector< boost::shared_ptr<MapLayer> > removed;
+            size_t added = 0;
+            for (size_t i = 0; i < deltas_.size(); i++)
+            {
+                const LayerDelta& delta = deltas_[i];
+                if (delta.op == detail::MapPatchLayerRemove)
+                {
+                    removed.push_back(layers[targets[i]]);
+                    continue;
+                }
+
+                LayerStage& stage = stages[i];
+                if (delta.op == detail::MapPatchLayerAdd)
+                {
+                    stage.layer = makeLayer_(delta);
+                    added++;
+                }
+                else
+                {
+                    stage.layer = layers[targets[i]];
+                }
+
+                if (delta.hasMetadata)
+                {
+                    detail::MapPatchReader reader(delta.metadata.empty() ? NULL : &delta.metadata[0], delta.metadata.size());
+                    reader.metadata(stage.metadata);
+                    if (!reader.done())
+                        RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: trailing layer metadata");
+                }
+                stageBody_(delta, *stage.layer, stage);
+            }
+
+            // nothing below fails but allocation
+            layers.reserve(layers.size() + added);
+            for (size_t i = 0; i < deltas_.size(); i++)
+            {
+                const LayerDelta& delta = deltas_[i];
+                if (delta.op == detail::MapPatchLayerRemove)
+                    continue;
+                commitStage_(delta, stages[i]);
+                if (delta.op == detail::MapPatchLayerAdd)
+                    layers.push_back(stages[i].layer);
+            }
+
+            for (size_t i = 0; i < removed.size(); i++)
+                layers.erase(std::remove(layers.begin(), layers.end(), removed[i]), layers.end());
+        }
+
+        bool empty() const
+        {
+            return deltas_.empty();
+        }
+
+        /**
+        * Names of layers that were not compared because their type is not supported
+        */
+        const std::vector<std::string>& skippedLayers() const
+        {
+            return skipped_;
+        }
+
+    public:
+        std::vector<uint8_t> serialize() const
+        {
+            std::vector<uint8_t> out;
+            detail::MapPatchWriter w(out);
+            w.bytes(detail::kMapPatchMagic, sizeof(detail::kMapPatchMagic));
+            w.u8(detail::kMapPatchVersion);
+            w.varint(deltas_.size());
+            for (size_t i = 0; i < deltas_.size(); i++)
+            {
+                const LayerDelta& delta = deltas_[i];
+                w.u8(static_cast<uint8_t>(delta.op));
+                w.u8(static_cast<uint8_t>(delta.kind));
+                w.str(delta.name);
+                w.str(delta.usage);
+                w.str(delta.type);
+                if (delta.op == detail::MapPatchLayerRemove)
+                    continue;
+
+                w.u8(delta.hasMetadata ? 1 : 0);
+                if (delta.hasMetadata)
+                    w.blob(delta.metadata);
+
+                if (delta.kind == detail::MapPatchLayerGrid)
+                {
+                    if (delta.op == detail::MapPatchLayerAdd)
+                    {
+                        w.location(delta.origin);
+                        w.f32(delta.resolutionX);
+                        w.f32(delta.resolutionY);
+                    }
+                    w.varint(static_cast<uint64_t>(delta.width));
+                    w.varint(static_cast<uint64_t>(delta.height));
+                    w.varint(static_cast<uint64_t>(delta.tileSize));
+                    if (delta.op == detail::MapPatchLayerModify)
+                        w.varint(delta.baseHash);
+                }
+                else if (delta.kind == detail::MapPatchLayerRectangleArea)
+                {
+                    w.str(delta.layerId);
+                }
+
+                w.blob(delta.body);
+            }
+            return out;
+        }
+
+        static CompositeMapPatch deserialize(const std::vector<uint8_t>& bytes)
+        {
+            return deserialize(bytes.empty() ? NULL : &bytes[0], bytes.size());
+        }
+
+        static CompositeMapPatch deserialize(const uint8_t* data, size_t size)
+        {
+            detail::MapPatchReader r(data, size);
+            if (size < sizeof(detail::kMapPatchMagic) || std::memcmp(r.bytes(sizeof(detail::kMapPatchMagic)), detail::kMapPatchMagic, sizeof(detail::kMapPatchMagic)) != 0)
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("not a map patch");
+            if (r.u8() != detail::kMapPatchVersion)
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("unsupported map patch version");
+
+            CompositeMapPatch patch;
+            size_t count = r.count();
+            patch.deltas_.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                LayerDelta& delta = patch.deltas_[i];
+                delta.op = r.u8();
+                delta.kind = r.u8();
+                if (delta.op < detail::MapPatchLayerAdd || delta.op > detail::MapPatchLayerModify
+                    || delta.kind < detail::MapPatchLayerGrid || delta.kind > detail::MapPatchLayerPolygonArea)
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: unknown layer operation");
+                delta.name = r.str();
+                delta.usage = r.str();
+                delta.type = r.str();
+                if (delta.op == detail::MapPatchLayerRemove)
+                    continue;
+
+                delta.hasMetadata = r.u8() != 0;
+                if (delta.hasMetadata)
+                    delta.metadata = r.blob();
+
+                if (delta.kind == detail::MapPatchLayerGrid)
+                {
+                    if (delta.op == detail::MapPatchLayerAdd)
+                    {
+                        delta.origin = r.location();
+                        delta.resolutionX = r.f32();
+                        delta.resolutionY = r.f32();
+                    }
+                    delta.width = static_cast<int>(r.varint());
+                    delta.height = static_cast<int>(r.varint());
+                    delta.tileSize = static_cast<int>(r.varint());
+                    if (delta.width < 0 || delta.height < 0 || delta.tileSize <= 0)
+                        RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: bad grid geometry");
+                    if (delta.op == detail::MapPatchLayerModify)
+                        delta.baseHash = static_cast<uint32_t>(r.varint());
+                }
+                else if (delta.kind == detail::MapPatchLayerRectangleArea)
+                {
+                    delta.layerId = r.str();
+                }
+
+                delta.body = r.blob();
+            }
+            if (!r.done())
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: trailing data");
+            return patch;
+        }
+
+    private:
+        typedef std::pair<std::string, std::string> LayerKey;
+
+        struct LayerDelta {
+            LayerDelta()
+                : op(0)
+                , kind(0)
+                , hasMetadata(false)
+                , resolutionX(0.0f)
+                , resolutionY(0.0f)
+                , width(0)
+                , height(0)
+                , tileSize(0)
+                , baseHash(0)
+            {}
+
+            int op;
+            int kind;
+            std::string name;
+            std::string usage;
+            std::string type;
+
+            bool hasMetadata;
+            std::vector<uint8_t> metadata;
+
+            core::Location origin;
+            float resolutionX;
+            float resolutionY;
+            int width;
+            int height;
+            int tileSize;
+            uint32_t baseHash;
+
+            std::string layerId;
+
+            /**
+            * Grid layers: varint tile count, then per tile varint column, varint row and its runs.
+            * Keyed layers: varint delete count and keys, varint upsert count and key/record pairs.
+            */
+            std::vector<uint8_t> body;
+        };
+
+        struct StagedTile {
+            int x0;
+            int y0;
+            int width;
+            int height;
+            std::vector<uint8_t> cells;
+        };
+
+        /**
+        * One layer delta decoded against its target, committing it to the layer only copies
+        */
+        struct LayerStage {
+            boost::shared_ptr<MapLayer> layer;
+            core::Metadata metadata;
+
+            std::vector<StagedTile> tiles;
+
+            std::vector<std::string> deletes;
+            std::vector<std::string> keys;
+            std::vector<core::PoseEntry> poses;
+            std::vector<Line> lines;
+            std::vector<features::artifact_provider::RectangleArea> rectangles;
+            std::vector<polygonArea> polygons;
+        };
+
+        bool removes_(const LayerDelta& added) const
+        {
+            for (size_t i = 0; i < deltas_.size(); i++)
+            {
+                if (deltas_[i].op == detail::MapPatchLayerRemove && deltas_[i].name == added.name && deltas_[i].usage == added.usage)
+                    return true;
+            }
+            return false;
+        }
+
+        static LayerKey keyOf_(const MapLayer& layer)
+        {
+            return LayerKey(layer.getName(), layer.getUsage());
+        }
+
+        static int kindOf_(const MapLayer& layer)
+        {
+            if (dynamic_cast<const GridMapLayer*>(&layer))
+                return detail::MapPatchLayerGrid;
+            if (dynamic_cast<const PoseMapLayer*>(&layer))
+                return detail::MapPatchLayerPose;
+            if (dynamic_cast<const LineMapLayer*>(&layer))
+                return detail::MapPatchLayerLine;
+            if (dynamic_cast<const RectangleAreaMapLayer*>(&layer))
+                return detail::MapPatchLayerRectangleArea;
+            if (dynamic_cast<const PolygonAreaMapLayer*>(&layer))
+                return detail::MapPatchLayerPolygonArea;
+            return 0;
+        }
+
+        static bool sameGeometry_(const MapLayer& a, const MapLayer& b)
+        {
+            const GridMapLayer* ga = dynamic_cast<const GridMapLayer*>(&a);
+            const GridMapLayer* gb = dynamic_cast<const GridMapLayer*>(&b);
+            if (!ga || !gb)
+                return true;
+            return ga->getDimension() == gb->getDimension()
+                && ga->getResolution() == gb->getResolution()
+                && ga->getOrigin().x() == gb->getOrigin().x()
+                && ga->getOrigin().y() == gb->getOrigin().y()
+                && ga->getOrigin().z() == gb->getOrigin().z()
+                && ga->mapData().size() == gb->mapData().size();
+        }
+
+        static std::vector<uint8_t> encodeMetadata_(const core::Metadata& metadata)
+        {
+            std::vector<uint8_t> out;
+            detail::MapPatchWriter w(out);
+            w.metadata(metadata);
+            return out;
+        }
+
+        void addRemove_(const MapLayer& layer)
+        {
+            LayerDelta delta;
+            delta.op = detail::MapPatchLayerRemove;
+            delta.kind = kindOf_(layer);
+            delta.name = layer.getName();
+            delta.usage = layer.getUsage();
+            delta.type = layer.getType();
+            deltas_.push_back(delta);
+        }
+
+        /**
+        * Record layer `to` against `from`, or as a new layer when from is NULL, nothing is recorded
+        * for an unchanged layer
+        */
+        void addLayer_(const MapLayer* from, const MapLayer& to, int kind, int tileSize)
+        {
+            LayerDelta delta;
+            delta.op = from ? detail::MapPatchLayerModify : detail::MapPatchLayerAdd;
+            delta.kind = kind;
+            delta.name = to.getName();
+            delta.usage = to.getUsage();
+            delta.type = to.getType();
+            delta.hasMetadata = !from || !(from->metadata() == to.metadata());
+            if (delta.hasMetadata)
+                delta.metadata = encodeMetadata_(to.metadata());
+
+            bool changed;
+            switch (kind)
+            {
+            case detail::MapPatchLayerGrid:
+                changed = diffGrid_(static_cast<const GridMapLayer*>(from), static_cast<const GridMapLayer&>(to), tileSize, delta);
+                break;
+            case detail::MapPatchLayerPose:
+                changed = diffKeyed_(static_cast<const PoseMapLayer*>(from), static_cast<const PoseMapLayer&>(to), delta);
+                break;
+            case detail::MapPatchLayerLine:
+                changed = diffKeyed_(static_cast<const LineMapLayer*>(from), static_cast<const LineMapLayer&>(to), delta);
+                break;
+            case detail::MapPatchLayerRectangleArea:
+                delta.layerId = static_cast<const RectangleAreaMapLayer&>(to).getId();
+                changed = diffKeyed_(static_cast<const RectangleAreaMapLayer*>(from), static_cast<const RectangleAreaMapLayer&>(to), delta);
+                changed = changed || (from && static_cast<const RectangleAreaMapLayer*>(from)->getId() != delta.layerId);
+                break;
+            default:
+                changed = diffKeyed_(static_cast<const PolygonAreaMapLayer*>(from), static_cast<const PolygonAreaMapLayer&>(to), delta);
+                break;
+            }
+
+            if (!from || changed || delta.hasMetadata)
+                deltas_.push_back(delta);
+        }
+
+        static bool diffGrid_(const GridMapLayer* from, const GridMapLayer& to, int tileSize, LayerDelta& delta)
+        {
+            const int width = to.getDimension().x();
+            const int height = to.getDimension().y();
+            if (width < 0 || height < 0 || to.mapData().size() != static_cast<size_t>(width) * height)
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("grid map layer data does not match its dimension");
+
+            delta.origin = to.getOrigin();
+            delta.resolutionX = to.getResolution().x();
+            delta.resolutionY = to.getResolution().y();
+            delta.width = width;
+            delta.height = height;
+            delta.tileSize = tileSize;
+            if (from)
+                delta.baseHash = detail::mapPatchHash(from->mapData());
+
+            std::vector<uint8_t> tiles;
+            detail::MapPatchWriter tileWriter(tiles);
+            std::vector<uint8_t> a;
+            std::vector<uint8_t> b;
+            size_t changed = 0;
+
+            for (int ty = 0; ty * tileSize < height; ty++)
+            {
+                for (int tx = 0; tx * tileSize < width; tx++)
+                {
+                    const int x0 = tx * tileSize;
+                    const int y0 = ty * tileSize;
+                    const int w = std::min(tileSize, width - x0);
+                    const int h = std::min(tileSize, height - y0);
+
+                    b.resize(static_cast<size_t>(w) * h);
+                    gatherTile_(to.mapData(), width, x0, y0, w, h, &b[0]);
+                    if (from)
+                    {
+                        a.resize(b.size());
+                        gatherTile_(from->mapData(), width, x0, y0, w, h, &a[0]);
+                    }
+                    else
+                    {
+                        a.assign(b.size(), 0);
+                    }
+                    if (a == b)
+                        continue;
+
+                    tileWriter.varint(static_cast<uint64_t>(tx));
+                    tileWriter.varint(static_cast<uint64_t>(ty));
+                    detail::encodeGridTileDelta(&a[0], &b[0], b.size(), tileWriter);
+                    changed++;
+                }
+            }
+
+            detail::MapPatchWriter w(delta.body);
+            w.varint(changed);
+            w.bytes(tiles.empty() ? NULL : &tiles[0], tiles.size());
+            return changed > 0;
+        }
+
+        template <class LayerT>
+        static bool diffKeyed_(const LayerT* from, const LayerT& to, LayerDelta& delta)
+        {
+            typedef detail::MapPatchKeyedLayer<LayerT> traits_t;
+            typedef std::map<std::string, std::vector<uint8_t> > encoded_t;
+
+            encoded_t before;
+            encoded_t after;
+            if (from)
+                traits_t::each(*from, [&before](const std::string& key, const typename traits_t::record_t& record) {
+                    detail::MapPatchWriter w(before[key]);
+                    detail::encodeMapPatchRecord(w, record);
+                });
+            traits_t::each(to, [&after](const std::string& key, const typename traits_t::record_t& record) {
+                detail::MapPatchWriter w(after[key]);
+                detail::encodeMapPatchRecord(w, record);
+            });
+
+            std::vector<const std::string*> deletes;
+            for (typename encoded_t::const_iterator it = before.begin(); it != before.end(); ++it)
+            {
+                if (!after.count(it->first))
+                    deletes.push_back(&it->first);
+            }
+
+            std::vector<typename encoded_t::const_iterator> upserts;
+            for (typename encoded_t::const_iterator it = after.begin(); it != after.end(); ++it)
+            {
+                typename encoded_t::const_iterator old = before.find(it->first);
+                if (old == before.end() || old->second != it->second)
+                    upserts.push_back(it);
+            }
+
+            detail::MapPatchWriter w(delta.body);
+            w.varint(deletes.size());
+            for (size_t i = 0; i < deletes.size(); i++)
+                w.str(*deletes[i]);
+            w.varint(upserts.size());
+            for (size_t i = 0; i < upserts.size(); i++)
+            {
+                w.str(upserts[i]->first);
+                w.bytes(&upserts[i]->second[0], upserts[i]->second.size());
+            }
+            return !deletes.empty() || !upserts.empty();
+        }
+
+        static void gatherTile_(const std::vector<uint8_t>& data, int width, int x0, int y0, int w, int h, uint8_t* out)
+        {
+            for (int y = 0; y < h; y++)
+                std::memcpy(out + static_cast<size_t>(y) * w, &data[static_cast<size_t>(y0 + y) * width + x0], w);
+        }
+
+        static int findLayer_(const std::vector< boost::shared_ptr<MapLayer> >& layers, const LayerDelta& delta)
+        {
+            for (size_t i = 0; i < layers.size(); i++)
+            {
+                if (layers[i] && layers[i]->getName() == delta.name && layers[i]->getUsage() == delta.usage)
+                    return static_cast<int>(i);
+            }
+            return -1;
+        }
+
+        static boost::shared_ptr<MapLayer> makeLayer_(const LayerDelta& delta)
+        {
+            boost::shared_ptr<MapLayer> layer;
+            switch (delta.kind)
+            {
+            case detail::MapPatchLayerGrid:
+            {
+                boost::shared_ptr<GridMapLayer> grid = boost::make_shared<GridMapLayer>();
+                grid->setOrigin(delta.origin);
+                grid->setDimension(core::Vector2i(delta.width, delta.height));
+                grid->setResolution(core::Vector2f(delta.resolutionX, delta.resolutionY));
+                grid->mapData().assign(static_cast<size_t>(delta.width) * delta.height, 0);
+                layer = grid;
+                break;
+            }
+            case detail::MapPatchLayerPose:
+                layer = boost::make_shared<PoseMapLayer>();
+                break;
+            case detail::MapPatchLayerLine:
+                layer = boost::make_shared<LineMapLayer>();
+                break;
+            case detail::MapPatchLayerRectangleArea:
+                layer = boost::make_shared<RectangleAreaMapLayer>();
+                break;
+            default:
+                layer = boost::make_shared<PolygonAreaMapLayer>();
+                break;
+            }
+            layer->setName(delta.name);
+            layer->setUsage(delta.usage);
+            layer->setType(delta.type);
+            return layer;
+        }
+
+        static void stageBody_(const LayerDelta& delta, const MapLayer& layer, LayerStage& stage)
+        {
+            detail::MapPatchReader r(delta.body.empty() ? NULL : &delta.body[0], delta.body.size());
+            switch (delta.kind)
+            {
+            case detail::MapPatchLayerGrid:
+                stageGrid_(delta, static_cast<const GridMapLayer&>(layer), r, stage);
+                break;
+            case detail::MapPatchLayerPose:
+                stageKeyed_<PoseMapLayer>(r, stage, stage.poses);
+                break;
+            case detail::MapPatchLayerLine:
+                stageKeyed_<LineMapLayer>(r, stage, stage.lines);
+                break;
+            case detail::MapPatchLayerRectangleArea:
+                stageKeyed_<RectangleAreaMapLayer>(r, stage, stage.rectangles);
+                break;
+            default:
+                stageKeyed_<PolygonAreaMapLayer>(r, stage, stage.polygons);
+                break;
+            }
+            if (!r.done())
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: trailing layer data");
+        }
+
+        static void stageGrid_(const LayerDelta& delta, const GridMapLayer& layer, detail::MapPatchReader& r, LayerStage& stage)
+        {
+            const std::vector<uint8_t>& data = layer.mapData();
+            const int width = delta.width;
+            const int height = delta.height;
+            const int tileSize = delta.tileSize;
+
+            size_t count = r.count();
+            stage.tiles.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                uint64_t tx = r.varint();
+                uint64_t ty = r.varint();
+                if (tx * tileSize >= static_cast<uint64_t>(width) || ty * tileSize >= static_cast<uint64_t>(height))
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: tile out of range");
+
+                StagedTile& tile = stage.tiles[i];
+                tile.x0 = static_cast<int>(tx) * tileSize;
+                tile.y0 = static_cast<int>(ty) * tileSize;
+                tile.width = std::min(tileSize, width - tile.x0);
+                tile.height = std::min(tileSize, height - tile.y0);
+
+                tile.cells.resize(static_cast<size_t>(tile.width) * tile.height);
+                gatherTile_(data, width, tile.x0, tile.y0, tile.width, tile.height, &tile.cells[0]);
+                detail::decodeGridTileDelta(r, &tile.cells[0], tile.cells.size());
+            }
+        }
+
+        template <class LayerT>
+        static void stageKeyed_(detail::MapPatchReader& r, LayerStage& stage, std::vector<typename detail::MapPatchKeyedLayer<LayerT>::record_t>& records)
+        {
+            typedef detail::MapPatchKeyedLayer<LayerT> traits_t;
+
+            stage.deletes.resize(r.count());
+            for (size_t i = 0; i < stage.deletes.size(); i++)
+            {
+                stage.deletes[i] = r.str();
+                if (!traits_t::isKey(stage.deletes[i]))
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: bad record key");
+            }
+
+            stage.keys.resize(r.count());
+            records.resize(stage.keys.size());
+            for (size_t i = 0; i < stage.keys.size(); i++)
+            {
+                stage.keys[i] = r.str();
+                if (!traits_t::isKey(stage.keys[i]))
+                    RPOS_COMPOSITEMAP_THROW_EXCEPTION("malformed map patch: bad record key");
+                detail::decodeMapPatchRecord(r, records[i]);
+            }
+        }
+
+        static void commitStage_(const LayerDelta& delta, LayerStage& stage)
+        {
+            MapLayer& layer = *stage.layer;
+            if (delta.hasMetadata)
+                layer.metadata().swap(stage.metadata);
+
+            switch (delta.kind)
+            {
+            case detail::MapPatchLayerGrid:
+            {
+                std::vector<uint8_t>& data = static_cast<GridMapLayer&>(layer).mapData();
+                for (size_t i = 0; i < stage.tiles.size(); i++)
+                {
+                    const StagedTile& tile = stage.tiles[i];
+                    for (int y = 0; y < tile.height; y++)
+                        std::memcpy(&data[static_cast<size_t>(tile.y0 + y) * delta.width + tile.x0], &tile.cells[static_cast<size_t>(y) * tile.width], tile.width);
+                }
+                break;
+            }
+            case detail::MapPatchLayerPose:
+                detail::MapPatchKeyedLayer<PoseMapLayer>::apply(static_cast<PoseMapLayer&>(layer), stage.deletes, stage.keys, stage.poses);
+                break;
+            case detail::MapPatchLayerLine:
+                detail::MapPatchKeyedLayer<LineMapLayer>::apply(static_cast<LineMapLayer&>(layer), stage.deletes, stage.keys, stage.lines);
+                break;
+            case detail::MapPatchLayerRectangleArea:
+                static_cast<RectangleAreaMapLayer&>(layer).setId(delta.layerId);
+                detail::MapPatchKeyedLayer<RectangleAreaMapLayer>::apply(static_cast<RectangleAreaMapLayer&>(layer), stage.deletes, stage.keys, stage.rectangles);
+                break;
+            default:
+                detail::MapPatchKeyedLayer<PolygonAreaMapLayer>::apply(static_cast<PolygonAreaMapLayer&>(layer), stage.deletes, stage.keys, stage.polygons);
+                break;
+            }
+        }
+
+    private:
+        std::vector<LayerDelta> deltas_;
+        std::vector<std::string> skipped_;
+    };
+
+} } }
@@ -0,0 +1,131 @@
+/*
+* batch_digest.h
+* Hash many independent buffers concurrently
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "digest.h"
+#include "fast_digest.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace rpos { namespace system { namespace crypto {
+
+    // below this many bytes in total, a batch is hashed on the calling thread
+    static const size_t kBatchDigestParallelThreshold = 256 * 1024;
+
+    struct DigestInput {
+        const void* buffer;
+        size_t size;
+    };
+
+    typedef boost::function<boost::shared_ptr<IDigest>()> digest_factory_t;
+
+    namespace detail {
+
+        inline void digestBatchWorker(const digest_factory_t& factory, const std::vector<DigestInput>& inputs, const std::vector<size_t>& order
+            , boost::atomic<size_t>& next, std::vector<std::vector<std::uint8_t>>& results, std::vector<std::string>& errors)
+        {
+            boost::shared_ptr<IDigest> digest;
+            for (;;)
+            {
+                size_t slot = next.fetch_add(1, boost::memory_order_relaxed);
+                if (slot >= order.size())
+                    return;
+
+                size_t index = order[slot];
+                try
+                {
+                    if (!digest)
+                        digest = factory();
+                    digest->reset();
+                    digest->update(inputs[index].buffer, inputs[index].size);
+                    results[index].resize(digest->digestSize());
+                    digest->getDigest(results[index].data());
+                }
+                catch (const std::exception& e)
+                {
+                    errors[index] = e.what();
+                }
+            }
+        }
+
+    }
+
+    /**
+    * Compute the digest of every input independently
+    *
+    * Inputs are scheduled largest first on up to `concurrency` threads (0 for hardware concurrency),
+    * so a few large firmware blobs and thousands of small map tiles balance well.
+    * Each worker creates one digest with `factory` and reuses it across inputs
+    *
+    * @return digests in the same order as inputs
+    * @throw std::runtime_error if any digest fails
+    */
+    inline std::vector<std::vector<std::uint8_t>> digestBatch(const digest_factory_t& factory, const std::vector<DigestInput>& inputs, int concurrency = 0)
+    {
+        std::vector<std::vector<std::uint8_t>> results(inputs.size());
+        std::vector<std::string> errors(inputs.size());
+
+        size_t totalSize = 0;
+        for (auto iter = inputs.begin(); iter != inputs.end(); ++iter)
+            totalSize += iter->size;
+
+        std::vector<size_t> order(inputs.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+
+        int threads = (concurrency > 0) ? concurrency : static_cast<int>(boost::thread::hardware_concurrency());
+        if (threads <= 0)
+            threads = 4;
+        if (static_cast<size_t>(threads) > inputs.size())
+            threads = static_cast<int>(inputs.size());
+        if (totalSize < kBatchDigestParallelThreshold)
+            threads = 1;
+
+        boost::atomic<size_t> next(0);
+        if (threads <= 1)
+        {
+            detail::digestBatchWorker(factory, inputs, order, next, results, errors);
+        }
+        else
+        {
+            std::stable_sort(order.begin(), order.end(), [&inputs](size_t a, size_t b) {
+                return inputs[a].size > inputs[b].size;
+            });
+
+            boost::thread_group group;
+            for (int i = 1; i < threads; i++)
+                group.create_thread(boost::bind(&detail::digestBatchWorker, boost::cref(factory), boost::cref(inputs), boost::cref(order), boost::ref(next), boost::ref(results), boost::ref(errors)));
+            detail::digestBatchWorker(factory, inputs, order, next, results, errors);
+            group.join_all();
+        }
+
+        for (size_t i = 0; i < errors.size(); i++)
+        {
+            if (!errors[i].empty())
+                throw std::runtime_error("Failed to digest batch input: " + errors[i]);
+        }
+        return results;
+    }
+
+    inline std::vector<std::vector<std::uint8_t>> digestBatch(DigestAlgorithm algorithm, const std::vector<DigestInput>& inputs, int concurrency = 0)
+    {
+        return digestBatch(boost::bind(&createDigest, algorithm), inputs, concurrency);
+    }
+
+    inline std::vector<std::vector<std::uint8_t>> digestBatch(FastDigestAlgorithm algorithm, const std::vector<DigestInput>& inputs, int concurrency = 0)
+    {
+        return digestBatch(boost::bind(&createFastDigest, algorithm), inputs, concurrency);
+    }
+
+} } }
@@ -0,0 +1,395 @@
+/*
+* fast_digest.h
+* Fast non-cryptographic digests (CRC32C, xxHash64) for deduplication and change detection
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "digest.h"
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#   include <nmmintrin.h>
+#   define RPOS_CRYPTO_CRC32C_X86
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#   include <arm_acle.h>
+#   define RPOS_CRYPTO_CRC32C_ARM
+#endif
+
+namespace rpos { namespace system { namespace crypto {
+
+    /**
+    * Non-cryptographic digests, never use them to verify untrusted data
+    */
+    enum FastDigestAlgorithm {
+        FastDigestAlgorithmCRC32C,
+        FastDigestAlgorithmXXHash64
+    };
+
+    namespace detail {
+
+        inline std::uint32_t readLE32(const std::uint8_t* p)
+        {
+            return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+        }
+
+        inline std::uint64_t readLE64(const std::uint8_t* p)
+        {
+            return std::uint64_t(readLE32(p)) | (std::uint64_t(readLE32(p + 4)) << 32);
+        }
+
+        inline void writeBE(std::uint8_t* buffer, std::uint64_t v, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; i++)
+                buffer[i] = static_cast<std::uint8_t>(v >> (8 * (bytes - 1 - i)));
+        }
+
+        // CRC32C (Castagnoli), reflected polynomial
+        static const std::uint32_t kCrc32cPolynomial = 0x82F63B78u;
+
+        struct Crc32cTables {
+            std::uint32_t table[8][256];
+
+            Crc32cTables()
+            {
+                for (std::uint32_t i = 0; i < 256; i++)
+                {
+                    std::uint32_t crc = i;
+                    for (int j = 0; j < 8; j++)
+                        crc = (crc & 1) ? (crc >> 1) ^ kCrc32cPolynomial : (crc >> 1);
+                    table[0][i] = crc;
+                }
+                for (std::uint32_t i = 0; i < 256; i++)
+                {
+                    for (int k = 1; k < 8; k++)
+                        table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+                }
+            }
+        };
+
+        inline const Crc32cTables& crc32cTables()
+        {
+            static const Crc32cTables tables;
+            return tables;
+        }
+
+        /**
+        * Slicing-by-8 software implementation, works on every CPU
+        */
+        inline std::uint32_t crc32cSoftware(std::uint32_t crc, const std::uint8_t* p, size_t size)
+        {
+            const Crc32cTables& t = crc32cTables();
+            while (size >= 8)
+            {
+                std::uint32_t lo = readLE32(p) ^ crc;
+                std::uint32_t hi = readLE32(p + 4);
+                crc = t.table[7][lo & 0xff] ^ t.table[6][(lo >> 8) & 0xff] ^ t.table[5][(lo >> 16) & 0xff] ^ t.table[4][lo >> 24]
+                    ^ t.table[3][hi & 0xff] ^ t.table[2][(hi >> 8) & 0xff] ^ t.table[1][(hi >> 16) & 0xff] ^ t.table[0][hi >> 24];
+                p += 8;
+                size -= 8;
+            }
+            while (size--)
+                crc = (crc >> 8) ^ t.table[0][(crc ^ *p++) & 0xff];
+            return crc;
+        }
+
+#if defined(RPOS_CRYPTO_CRC32C_X86)
+        __attribute__((target("sse4.2")))
+        inline std::uint32_t crc32cHardware(std::uint32_t crc, const std::uint8_t* p, size_t size)
+        {
+#   if defined(__x86_64__)
+            std::uint64_t crc64 = crc;
+            while (size >= 8)
+            {
+                std::uint64_t v;
+                memcpy(&v, p, 8);
+                crc64 = _mm_crc32_u64(crc64, v);
+                p += 8;
+                size -= 8;
+            }
+            crc = static_cast<std::uint32_t>(crc64);
+#   endif
+            while (size--)
+                crc = _mm_crc32_u8(crc, *p++);
+            return crc;
+        }
+
+        inline bool crc32cHardwareSupported()
+        {
+            static const bool supported = (__builtin_cpu_supports("sse4.2") != 0);
+            return supported;
+        }
+#elif defined(RPOS_CRYPTO_CRC32C_ARM)
+        inline std::uint32_t crc32cHardware(std::uint32_t crc, const std::uint8_t* p, size_t size)
+        {
+            while (size >= 8)
+            {
+                std::uint64_t v;
+                memcpy(&v, p, 8);
+                crc = __crc32cd(crc, v);
+                p += 8;
+                size -= 8;
+            }
+            while (size--)
+                crc = __crc32cb(crc, *p++);
+            return crc;
+        }
+
+        inline bool crc32cHardwareSupported()
+        {
+            return true;
+        }
+#endif
+
+        /**
+        * Update a raw (non-inverted) CRC32C state, using SSE4.2 / ARMv8 CRC instructions when available
+        */
+        inline std::uint32_t crc32cUpdate(std::uint32_t crc, const void* buffer, size_t size)
+        {
+            const std::uint8_t* p = static_cast<const std::uint8_t*>(buffer);
+#if defined(RPOS_CRYPTO_CRC32C_X86) || defined(RPOS_CRYPTO_CRC32C_ARM)
+            if (crc32cHardwareSupported())
+                return crc32cHardware(crc, p, size);
+#endif
+            return crc32cSoftware(crc, p, size);
+        }
+
+        // xxHash64 primes
+        static const std::uint64_t kXXHashPrime1 = 11400714785074694791ULL;
+        static const std::uint64_t kXXHashPrime2 = 14029467366897019727ULL;
+        static const std::uint64_t kXXHashPrime3 = 1609587929392839161ULL;
+        static const std::uint64_t kXXHashPrime4 = 9650029242287828579ULL;
+        static const std::uint64_t kXXHashPrime5 = 2870177450012600261ULL;
+
+        inline std::uint64_t rotl64(std::uint64_t v, int r)
+        {
+            return (v << r) | (v >> (64 - r));
+        }
+
+        inline std::uint64_t xxhash64Round(std::uint64_t acc, std::uint64_t input)
+        {
+            acc += input * kXXHashPrime2;
+            acc = rotl64(acc, 31);
+            return acc * kXXHashPrime1;
+        }
+
+        inline std::uint64_t xxhash64MergeRound(std::uint64_t acc, std::uint64_t v)
+        {
+            acc ^= xxhash64Round(0, v);
+            return acc * kXXHashPrime1 + kXXHashPrime4;
+        }
+
+    }
+
+    /**
+    * CRC32C digest, 4 bytes big endian
+    */
+    class Crc32cDigest : public IDigest {
+    public:
+        Crc32cDigest()
+        {
+            reset();
+        }
+
+        virtual ~Crc32cDigest() {}
+
+    public:
+        virtual size_t digestSize() const
+        {
+            return 4;
+        }
+
+        virtual void reset()
+        {
+            crc_ = 0xFFFFFFFFu;
+        }
+
+        virtual void update(const void* buffer, size_t size)
+        {
+            crc_ = detail::crc32cUpdate(crc_, buffer, size);
+        }
+
+        virtual void getDigest(std::uint8_t* buffer)
+        {
+            detail::writeBE(buffer, value(), 4);
+        }
+
+        std::uint32_t value() const
+        {
+            return crc_ ^ 0xFFFFFFFFu;
+        }
+
+    private:
+        std::uint32_t crc_;
+    };
+
+    /**
+    * xxHash64 digest (XXH64 with seed), 8 bytes big endian (the xxHash canonical form)
+    */
+    class XXHash64Digest : public IDigest {
+    public:
+        explicit XXHash64Digest(std::uint64_t seed = 0)
+            : seed_(seed)
+        {
+            reset();
+        }
+
+        virtual ~XXHash64Digest() {}
+
+    public:
+        virtual size_t digestSize() const
+        {
+            return 8;
+        }
+
+        virtual void reset()
+        {
+            v_[0] = seed_ + detail::kXXHashPrime1 + detail::kXXHashPrime2;
+            v_[1] = seed_ + detail::kXXHashPrime2;
+            v_[2] = seed_;
+            v_[3] = seed_ - detail::kXXHashPrime1;
+            totalSize_ = 0;
+            pendingSize_ = 0;
+        }
+
+        virtual void update(const void* buffer, size_t size)
+        {
+            const std::uint8_t* p = static_cast<const std::uint8_t*>(buffer);
+            totalSize_ += size;
+
+            if (pendingSize_ + size < 32)
+            {
+                memcpy(pending_ + pendingSize_, p, size);
+                pendingSize_ += size;
+                return;
+            }
+
+            if (pendingSize_)
+            {
+                size_t fill = 32 - pendingSize_;
+                memcpy(pending_ + pendingSize_, p, fill);
+                consumeStripe_(pending_);
+                p += fill;
+                size -= fill;
+                pendingSize_ = 0;
+            }
+
+            while (size >= 32)
+            {
+                consumeStripe_(p);
+                p += 32;
+                size -= 32;
+            }
+
+            memcpy(pending_, p, size);
+            pendingSize_ = size;
+        }
+
+        virtual void getDigest(std::uint8_t* buffer)
+        {
+            detail::writeBE(buffer, value(), 8);
+        }
+
+        std::uint64_t value() const
+        {
+            using namespace detail;
+
+            std::uint64_t h;
+            if (totalSize_ >= 32)
+            {
+                h = rotl64(v_[0], 1) + rotl64(v_[1], 7) + rotl64(v_[2], 12) + rotl64(v_[3], 18);
+                for (int i = 0; i < 4; i++)
+                    h = xxhash64MergeRound(h, v_[i]);
+            }
+            else
+            {
+                h = seed_ + kXXHashPrime5;
+            }
+            h += totalSize_;
+
+            const std::uint8_t* p = pending_;
+            size_t size = pendingSize_;
+            while (size >= 8)
+            {
+                h ^= xxhash64Round(0, readLE64(p));
+                h = rotl64(h, 27) * kXXHashPrime1 + kXXHashPrime4;
+                p += 8;
+                size -= 8;
+            }
+            if (size >= 4)
+            {
+                h ^= std::uint64_t(readLE32(p)) * kXXHashPrime1;
+                h = rotl64(h, 23) * kXXHashPrime2 + kXXHashPrime3;
+                p += 4;
+                size -= 4;
+            }
+            while (size--)
+            {
+                h ^= (*p++) * kXXHashPrime5;
+                h = rotl64(h, 11) * kXXHashPrime1;
+            }
+
+            h ^= h >> 33;
+            h *= kXXHashPrime2;
+            h ^= h >> 29;
+            h *= kXXHashPrime3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        void consumeStripe_(const std::uint8_t* p)
+        {
+            v_[0] = detail::xxhash64Round(v_[0], detail::readLE64(p));
+            v_[1] = detail::xxhash64Round(v_[1], detail::readLE64(p + 8));
+            v_[2] = detail::xxhash64Round(v_[2], detail::readLE64(p + 16));
+            v_[3] = detail::xxhash64Round(v_[3], detail::readLE64(p + 24));
+        }
+
+    private:
+        std::uint64_t seed_;
+        std::uint64_t v_[4];
+        std::uint64_t totalSize_;
+        std::uint8_t pending_[32];
+        size_t pendingSize_;
+    };
+
+    inline boost::shared_ptr<IDigest> createFastDigest(FastDigestAlgorithm algorithm)
+    {
+        switch (algorithm)
+        {
+        case FastDigestAlgorithmCRC32C:
+            return boost::shared_ptr<IDigest>(new Crc32cDigest());
+        case FastDigestAlgorithmXXHash64:
+            return boost::shared_ptr<IDigest>(new XXHash64Digest());
+        default:
+            throw std::invalid_argument("Unknown fast digest algorithm");
+        }
+    }
+
+    inline std::uint32_t crc32c(const void* buffer, size_t size)
+    {
+        return detail::crc32cUpdate(0xFFFFFFFFu, buffer, size) ^ 0xFFFFFFFFu;
+    }
+
+    inline std::uint64_t xxhash64(const void* buffer, size_t size, std::uint64_t seed = 0)
+    {
+        XXHash64Digest digest(seed);
+        digest.update(buffer, size);
+        return digest.value();
+    }
+
+    inline std::vector<std::uint8_t> fastDigest(FastDigestAlgorithm algorithm, const void* buffer, size_t size)
+    {
+        boost::shared_ptr<IDigest> d = createFastDigest(algorithm);
+        d->update(buffer, size);
+        std::vector<std::uint8_t> result(d->digestSize());
+        d->getDigest(&result[0]);
+        return result;
+    }
+
+} } }
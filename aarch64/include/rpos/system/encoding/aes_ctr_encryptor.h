@@ -0,0 +1,278 @@
+/*
+* aes_ctr_encryptor.h
+* AES-CTR stream encryptor based on OpenSSL EVP (AES-NI / ARMv8 crypto extension when available)
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "i_encoder.h"
+#include "../parallel.h"
+#include <openssl/evp.h>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rpos { namespace system { namespace encoding {
+
+    /**
+    * AES block size and the size of the CTR initial counter block
+    */
+    static const size_t kAesCtrIvSize = 16u;
+
+    /**
+    * Inputs smaller than this are encrypted on the calling thread
+    */
+    static const size_t kAesCtrDefaultParallelThreshold = 1024 * 1024;
+
+    namespace detail {
+
+        inline const EVP_CIPHER* aesCtrCipher(size_t keyBytes)
+        {
+            switch (keyBytes)
+            {
+            case 16:
+                return EVP_aes_128_ctr();
+            case 24:
+                return EVP_aes_192_ctr();
+            case 32:
+                return EVP_aes_256_ctr();
+            default:
+                throw std::invalid_argument("AES key must be 16, 24 or 32 bytes");
+            }
+        }
+
+        /**
+        * Counter block for the given block index: iv + blockIndex as a 128bit big endian integer
+        */
+        inline void aesCtrCounterAt(const std::uint8_t* iv, std::uint64_t blockIndex, std::uint8_t* counter)
+        {
+            memcpy(counter, iv, kAesCtrIvSize);
+            std::uint64_t carry = blockIndex;
+            for (int i = static_cast<int>(kAesCtrIvSize) - 1; i >= 0 && carry; i--)
+            {
+                std::uint64_t sum = counter[i] + (carry & 0xff);
+                counter[i] = static_cast<std::uint8_t>(sum);
+                carry = (carry >> 8) + (sum >> 8);
+            }
+        }
+
+        /**
+        * Encrypt (or decrypt, it is the same operation) size bytes located at stream offset `offset`
+        */
+        inline void aesCtrCryptSegment(const EVP_CIPHER* cipher, const std::uint8_t* key, const std::uint8_t* iv, std::uint64_t offset
+            , const std::uint8_t* src, std::uint8_t* dest, size_t size)
+        {
+            std::uint8_t counter[kAesCtrIvSize];
+            aesCtrCounterAt(iv, offset / kAesCtrIvSize, counter);
+
+            EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+            if (!ctx)
+                throw std::runtime_error("Failed to create cipher context");
+
+            bool ok = (EVP_EncryptInit_ex(ctx, cipher, nullptr, key, counter) == 1);
+
+            // discard the key stream before offset inside the first block
+            size_t skip = static_cast<size_t>(offset % kAesCtrIvSize);
+            int outLen = 0;
+            if (ok && skip)
+            {
+                std::uint8_t zeros[kAesCtrIvSize] = { 0 };
+                std::uint8_t discard[kAesCtrIvSize * 2];
+                ok = (EVP_EncryptUpdate(ctx, discard, &outLen, zeros, static_cast<int>(skip)) == 1);
+            }
+
+            const size_t kMaxUpdate = 1u << 30;
+            while (ok && size)
+            {
+                size_t n = size < kMaxUpdate ? size : kMaxUpdate;
+                ok = (EVP_EncryptUpdate(ctx, dest, &outLen, src, static_cast<int>(n)) == 1);
+                src += n;
+                dest += n;
+                size -= n;
+            }
+
+            EVP_CIPHER_CTX_free(ctx);
+            if (!ok)
+                throw std::runtime_error("AES-CTR encryption failed");
+        }
+
+    }
+
+    /**
+    * AES-CTR encryptor
+    *
+    * CTR mode turns AES into a stream cipher: encryption and decryption are the same operation, there is no
+    * padding, and any block can be computed independently. So encode() always consumes the whole input,
+    * large inputs are split across cores, and the output is identical regardless of how the input is chunked.
+    *
+    * Never reuse the same key and IV pair for two different streams.
+    * AesEncryptor keeps providing the ECB and CBC modes for existing data.
+    */
+    class AesCtrEncryptor : public IEncoder, private boost::noncopyable {
+    public:
+        typedef std::uint8_t byte_t;
+
+    public:
+        /**
+        * Constructor
+        *
+        * @param key               The AES key (16, 24 or 32 bytes)
+        * @param nbytes            The size of the key (in bytes)
+        * @param iv                The initial counter block (16 bytes)
+        * @param concurrency       Threads used for large inputs, 0 for hardware concurrency, 1 to disable
+        * @param parallelThreshold Inputs smaller than this are encrypted on the calling thread
+        */
+        AesCtrEncryptor(const byte_t* key, size_t nbytes, const byte_t* iv, int concurrency = 0, size_t parallelThreshold = kAesCtrDefaultParallelThreshold)
+            : cipher_(detail::aesCtrCipher(nbytes))
+            , key_(key, key + nbytes)
+            , iv_(iv, iv + kAesCtrIvSize)
+            , concurrency_(concurrency)
+            , parallelThreshold_(parallelThreshold)
+            , offset_(0)
+        {}
+
+        /**
+        * Constructor
+        *
+        * @param key               The AES key (16, 24 or 32 bytes)
+        * @param iv                The initial counter block (16 bytes)
+        * @param concurrency       Threads used for large inputs, 0 for hardware concurrency, 1 to disable
+        * @param parallelThreshold Inputs smaller than this are encrypted on the calling thread
+        */
+        AesCtrEncryptor(const std::vector<byte_t>& key, const std::vector<byte_t>& iv, int concurrency = 0, size_t parallelThreshold = kAesCtrDefaultParallelThreshold)
+            : cipher_(detail::aesCtrCipher(key.size()))
+            , key_(key)
+            , iv_(iv)
+            , concurrency_(concurrency)
+            , parallelThreshold_(parallelThreshold)
+            , offset_(0)
+        {
+            if (iv_.size() != kAesCtrIvSize)
+                throw std::invalid_argument("AES-CTR IV must be 16 bytes");
+        }
+
+        virtual ~AesCtrEncryptor()
+        {}
+
+    public:
+        /**
+        * Encrypt (or decrypt) data from source buffer to dest buffer, as much as fits in dest
+        *
+        * @param srcBuffer        The source buffer
+        * @param srcSize          The size of source buffer
+        * @param destBuffer       The buffer to store encoded data
+        * @param destSize         The size of dest buffer
+        * @param dataPosition     Not used, CTR mode needs no padding
+        * @param consumedSrcSize  Bytes encoded in the source stream
+        * @param consumedDestSize Bytes written to the dest stream
+        * @return The encoding is successful or not
+        */
+        virtual bool encode(
+            const void* srcBuffer, size_t srcSize,
+            void* destBuffer, size_t destSize,
+            StreamPosition dataPosition,
+            size_t& consumedSrcSize, size_t& consumedDestSize
+        )
+        {
+            (void)dataPosition;
+            size_t size = srcSize < destSize ? srcSize : destSize;
+            consumedSrcSize = consumedDestSize = 0;
+            try
+            {
+                crypt(offset_, srcBuffer, destBuffer, size);
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+            offset_ += size;
+            consumedSrcSize = consumedDestSize = size;
+            return true;
+        }
+
+        virtual size_t estimateEncodedSize(const void* srcBuffer, size_t srcSize)
+        {
+            (void)srcBuffer;
+            return srcSize;
+        }
+
+        virtual size_t estimateEncodedSize(size_t srcSize)
+        {
+            return srcSize;
+        }
+
+        /**
+        * Restart the key stream from the initial counter
+        */
+        virtual void reset()
+        {
+            offset_ = 0;
+        }
+
+    public:
+        /**
+        * Encrypt (or decrypt) size bytes located at an arbitrary offset of the stream, without touching the
+        * encoder position. src and dest may be the same buffer
+        *
+        * @throw std::runtime_error if OpenSSL fails
+        */
+        void crypt(std::uint64_t offset, const void* src, void* dest, size_t size) const
+        {
+            const std::uint8_t* in = static_cast<const std::uint8_t*>(src);
+            std::uint8_t* out = static_cast<std::uint8_t*>(dest);
+
+            int threads = concurrency_ > 0 ? concurrency_ : static_cast<int>(boost::thread::hardware_concurrency());
+            if (threads <= 1 || size < parallelThreshold_)
+            {
+                detail::aesCtrCryptSegment(cipher_, key_.data(), iv_.data(), offset, in, out, size);
+                return;
+            }
+
+            // segments are aligned to AES blocks so every thread starts on a fresh counter
+            size_t segment = (size + threads - 1) / threads;
+            segment = (segment + kAesCtrIvSize - 1) / kAesCtrIvSize * kAesCtrIvSize;
+            int segments = static_cast<int>((size + segment - 1) / segment);
+
+            std::vector<std::string> errors(segments);
+            rpos::system::parallel_for(segments, [&](int i) {
+                size_t begin = static_cast<size_t>(i) * segment;
+                size_t n = std::min(segment, size - begin);
+                try
+                {
+                    detail::aesCtrCryptSegment(cipher_, key_.data(), iv_.data(), offset + begin, in + begin, out + begin, n);
+                }
+                catch (const std::exception& e)
+                {
+                    errors[i] = e.what();
+                }
+            }, threads);
+
+            for (auto iter = errors.begin(); iter != errors.end(); ++iter)
+            {
+                if (!iter->empty())
+                    throw std::runtime_error(*iter);
+            }
+        }
+
+        std::uint64_t position() const
+        {
+            return offset_;
+        }
+
+    private:
+        const EVP_CIPHER* cipher_;
+        std::vector<byte_t> key_;
+        std::vector<byte_t> iv_;
+        int concurrency_;
+        size_t parallelThreshold_;
+        std::uint64_t offset_;
+    };
+
+} } }
@@ -0,0 +1,623 @@
+/*
+* fast_base64.h
+* Vectorized base64 encoder and decoder (AVX2 / SSSE3 with runtime dispatch, NEON on aarch64)
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "i_encoder.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#   include <immintrin.h>
+#   define RPOS_ENCODING_BASE64_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#   include <arm_neon.h>
+#   define RPOS_ENCODING_BASE64_NEON
+#endif
+
+namespace rpos { namespace system { namespace encoding {
+
+    namespace detail {
+
+        static const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        static const std::uint8_t kBase64Invalid = 0xff;
+
+        struct Base64DecodeTable {
+            std::uint8_t values[256];
+
+            Base64DecodeTable()
+            {
+                memset(values, kBase64Invalid, sizeof(values));
+                for (std::uint8_t i = 0; i < 64; i++)
+                    values[static_cast<std::uint8_t>(kBase64Alphabet[i])] = i;
+            }
+        };
+
+        inline const Base64DecodeTable& base64DecodeTable()
+        {
+            static const Base64DecodeTable table;
+            return table;
+        }
+
+        inline size_t base64EncodeScalar(const std::uint8_t* src, size_t blocks, char* dest)
+        {
+            for (size_t i = 0; i < blocks; i++, src += 3, dest += 4)
+            {
+                std::uint32_t v = (std::uint32_t(src[0]) << 16) | (std::uint32_t(src[1]) << 8) | src[2];
+                dest[0] = kBase64Alphabet[(v >> 18) & 0x3f];
+                dest[1] = kBase64Alphabet[(v >> 12) & 0x3f];
+                dest[2] = kBase64Alphabet[(v >> 6) & 0x3f];
+                dest[3] = kBase64Alphabet[v & 0x3f];
+            }
+            return blocks;
+        }
+
+        /**
+        * Decode complete quads without padding, stops at the first quad containing an invalid character or '='
+        *
+        * @return quads decoded
+        */
+        inline size_t base64DecodeScalar(const char* src, size_t quads, std::uint8_t* dest)
+        {
+            const std::uint8_t* table = base64DecodeTable().values;
+            for (size_t i = 0; i < quads; i++, src += 4, dest += 3)
+            {
+                std::uint8_t a = table[static_cast<std::uint8_t>(src[0])];
+                std::uint8_t b = table[static_cast<std::uint8_t>(src[1])];
+                std::uint8_t c = table[static_cast<std::uint8_t>(src[2])];
+                std::uint8_t d = table[static_cast<std::uint8_t>(src[3])];
+                if ((a | b | c | d) & 0x80)
+                    return i;
+
+                std::uint32_t v = (std::uint32_t(a) << 18) | (std::uint32_t(b) << 12) | (std::uint32_t(c) << 6) | d;
+                dest[0] = static_cast<std::uint8_t>(v >> 16);
+                dest[1] = static_cast<std::uint8_t>(v >> 8);
+                dest[2] = static_cast<std::uint8_t>(v);
+            }
+            return quads;
+        }
+
+#if defined(RPOS_ENCODING_BASE64_X86)
+        // Wojciech Mula's pshufb based base64 algorithms, each 128bit lane converts 12 bytes <=> 16 chars
+
+        __attribute__((target("ssse3")))
+        inline __m128i base64EncodeLaneSsse3(__m128i in)
+        {
+            in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+            __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            __m128i indices = _mm_or_si128(t1, t3);
+
+            __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            reduced = _mm_or_si128(reduced, _mm_and_si128(less, _mm_set1_epi8(13)));
+            const __m128i shiftLut = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0);
+            return _mm_add_epi8(_mm_shuffle_epi8(shiftLut, reduced), indices);
+        }
+
+        __attribute__((target("ssse3")))
+        inline size_t base64EncodeSsse3(const std::uint8_t* src, size_t blocks, char* dest)
+        {
+            // every iteration loads 16 bytes but consumes 12 (4 blocks)
+            size_t done = 0;
+            while (blocks - done >= 6)
+            {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + done * 4), base64EncodeLaneSsse3(in));
+                done += 4;
+            }
+            return done + base64EncodeScalar(src + done * 3, blocks - done, dest + done * 4);
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t base64EncodeAvx2(const std::uint8_t* src, size_t blocks, char* dest)
+        {
+            const __m256i shuffle = _mm256_set_epi8(
+                10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+            const __m256i shiftLut = _mm256_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0,
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0);
+
+            // every iteration loads 12 + 16 bytes but consumes 24 (8 blocks)
+            size_t done = 0;
+            while (blocks - done >= 10)
+            {
+                const std::uint8_t* p = src + done * 3;
+                __m256i in = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)), 1);
+
+                in = _mm256_shuffle_epi8(in, shuffle);
+                __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+                __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+                __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                __m256i indices = _mm256_or_si256(t1, t3);
+
+                __m256i reduced = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+                __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+                reduced = _mm256_or_si256(reduced, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+                __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLut, reduced), indices);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + done * 4), out);
+                done += 8;
+            }
+            return done + base64EncodeSsse3(src + done * 3, blocks - done, dest + done * 4);
+        }
+
+        __attribute__((target("ssse3")))
+        inline bool base64TestzSsse3(__m128i a, __m128i b)
+        {
+            // _mm_testz_si128 needs SSE4.1
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, b), _mm_setzero_si128())) == 0xffff;
+        }
+
+        /**
+        * @return true if all 16 chars are valid, out receives the 12 decoded bytes
+        */
+        __attribute__((target("ssse3")))
+        inline bool base64DecodeLaneSsse3(__m128i in, __m128i& out)
+        {
+            const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i mask2F = _mm_set1_epi8(0x2f);
+
+            __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+            __m128i loNibbles = _mm_and_si128(in, mask2F);
+            __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+            __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+            if (!base64TestzSsse3(lo, hi))
+                return false;
+
+            __m128i eq2F = _mm_cmpeq_epi8(in, mask2F);
+            __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+            __m128i values = _mm_add_epi8(in, roll);
+
+            __m128i mergeAbBc = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            __m128i packed = _mm_madd_epi16(mergeAbBc, _mm_set1_epi32(0x00011000));
+            out = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+            return true;
+        }
+
+        __attribute__((target("ssse3")))
+        inline size_t base64DecodeSsse3(const char* src, size_t quads, std::uint8_t* dest)
+        {
+            // every iteration stores 16 bytes but produces 12 (4 quads)
+            size_t done = 0;
+            while (quads - done >= 6)
+            {
+                __m128i out;
+                if (!base64DecodeLaneSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done * 4)), out))
+                    break;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + done * 3), out);
+                done += 4;
+            }
+            return done + base64DecodeScalar(src + done * 4, quads - done, dest + done * 3);
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t base64DecodeAvx2(const char* src, size_t quads, std::uint8_t* dest)
+        {
+            const __m256i lutLo = _mm256_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m256i lutHi = _mm256_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i lutRoll = _mm256_setr_epi8(
+                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i mask2F = _mm256_set1_epi8(0x2f);
+            const __m256i pack = _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+            // every iteration stores 32 bytes but produces 24 (8 quads)
+            size_t done = 0;
+            while (quads - done >= 11)
+            {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + done * 4));
+                __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+                __m256i loNibbles = _mm256_and_si256(in, mask2F);
+                __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+                __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+                if (!_mm256_testz_si256(lo, hi))
+                    break;
+
+                __m256i eq2F = _mm256_cmpeq_epi8(in, mask2F);
+                __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+                __m256i values = _mm256_add_epi8(in, roll);
+
+                __m256i mergeAbBc = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+                __m256i packed = _mm256_madd_epi16(mergeAbBc, _mm256_set1_epi32(0x00011000));
+                packed = _mm256_shuffle_epi8(packed, pack);
+                packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + done * 3), packed);
+                done += 8;
+            }
+            return done + base64DecodeSsse3(src + done * 4, quads - done, dest + done * 3);
+        }
+
+        enum Base64Isa {
+            Base64IsaScalar,
+            Base64IsaSsse3,
+            Base64IsaAvx2
+        };
+
+        inline Base64Isa base64Isa()
+        {
+            static const Base64Isa isa = __builtin_cpu_supports("avx2") ? Base64IsaAvx2
+                : (__builtin_cpu_supports("ssse3") ? Base64IsaSsse3 : Base64IsaScalar);
+            return isa;
+        }
+#elif defined(RPOS_ENCODING_BASE64_NEON)
+        inline uint8x16x4_t base64LoadTable(const std::uint8_t* table)
+        {
+            uint8x16x4_t t;
+            t.val[0] = vld1q_u8(table);
+            t.val[1] = vld1q_u8(table + 16);
+            t.val[2] = vld1q_u8(table + 32);
+            t.val[3] = vld1q_u8(table + 48);
+            return t;
+        }
+
+        // 48 bytes => 64 chars per iteration
+        inline size_t base64EncodeNeon(const std::uint8_t* src, size_t blocks, char* dest)
+        {
+            const uint8x16x4_t alphabet = base64LoadTable(reinterpret_cast<const std::uint8_t*>(kBase64Alphabet));
+            const uint8x16_t mask = vdupq_n_u8(0x3f);
+
+            size_t done = 0;
+            while (blocks - done >= 16)
+            {
+                uint8x16x3_t in = vld3q_u8(src + done * 3);
+                uint8x16x4_t indices;
+                indices.val[0] = vshrq_n_u8(in.val[0], 2);
+                indices.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+                indices.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+                indices.val[3] = vandq_u8(in.val[2], mask);
+
+                uint8x16x4_t out;
+                for (int i = 0; i < 4; i++)
+                    out.val[i] = vqtbl4q_u8(alphabet, indices.val[i]);
+                vst4q_u8(reinterpret_cast<std::uint8_t*>(dest + done * 4), out);
+                done += 16;
+            }
+            return done + base64EncodeScalar(src + done * 3, blocks - done, dest + done * 4);
+        }
+
+        // 64 chars => 48 bytes per iteration
+        inline size_t base64DecodeNeon(const char* src, size_t quads, std::uint8_t* dest)
+        {
+            const std::uint8_t* table = base64DecodeTable().values;
+            const uint8x16x4_t tableLo = base64LoadTable(table);
+            const uint8x16x4_t tableHi = base64LoadTable(table + 64);
+            const uint8x16_t offset = vdupq_n_u8(64);
+
+            size_t done = 0;
+            while (quads - done >= 16)
+            {
+                uint8x16x4_t in = vld4q_u8(reinterpret_cast<const std::uint8_t*>(src + done * 4));
+                uint8x16x4_t values;
+                uint8x16_t invalid = vdupq_n_u8(0);
+                for (int i = 0; i < 4; i++)
+                {
+                    // chars 0..63 from the low table, 64..127 from the high table, >= 128 are invalid
+                    uint8x16_t v = vqtbl4q_u8(tableLo, in.val[i]);
+                    v = vqtbx4q_u8(v, tableHi, vsubq_u8(in.val[i], offset));
+                    invalid = vorrq_u8(invalid, vorrq_u8(v, vcgeq_u8(in.val[i], vdupq_n_u8(128))));
+                    values.val[i] = v;
+                }
+                if (vmaxvq_u8(invalid) & 0x80)
+                    break;
+
+                uint8x16x3_t out;
+                out.val[0] = vorrq_u8(vshlq_n_u8(values.val[0], 2), vshrq_n_u8(values.val[1], 4));
+                out.val[1] = vorrq_u8(vshlq_n_u8(values.val[1], 4), vshrq_n_u8(values.val[2], 2));
+                out.val[2] = vorrq_u8(vshlq_n_u8(values.val[2], 6), values.val[3]);
+                vst3q_u8(dest + done * 3, out);
+                done += 16;
+            }
+            return done + base64DecodeScalar(src + done * 4, quads - done, dest + done * 3);
+        }
+#endif
+
+        /**
+        * Encode `blocks` complete 3 byte blocks into 4 * blocks chars
+        */
+        inline void base64EncodeBlocks(const std::uint8_t* src, size_t blocks, char* dest)
+        {
+#if defined(RPOS_ENCODING_BASE64_X86)
+            switch (base64Isa())
+            {
+            case Base64IsaAvx2:
+                base64EncodeAvx2(src, blocks, dest);
+                return;
+            case Base64IsaSsse3:
+                base64EncodeSsse3(src, blocks, dest);
+                return;
+            default:
+                break;
+            }
+#elif defined(RPOS_ENCODING_BASE64_NEON)
+            base64EncodeNeon(src, blocks, dest);
+            return;
+#endif
+            base64EncodeScalar(src, blocks, dest);
+        }
+
+        /**
+        * Decode up to `quads` complete quads into 3 * quads bytes, stops at the first quad with an invalid char or '='
+        *
+        * @return quads decoded
+        */
+        inline size_t base64DecodeQuads(const char* src, size_t quads, std::uint8_t* dest)
+        {
+#if defined(RPOS_ENCODING_BASE64_X86)
+            switch (base64Isa())
+            {
+            case Base64IsaAvx2:
+                return base64DecodeAvx2(src, quads, dest);
+            case Base64IsaSsse3:
+                return base64DecodeSsse3(src, quads, dest);
+            default:
+                break;
+            }
+#elif defined(RPOS_ENCODING_BASE64_NEON)
+            return base64DecodeNeon(src, quads, dest);
+#endif
+            return base64DecodeScalar(src, quads, dest);
+        }
+
+        /**
+        * Encode the last 1 or 2 bytes with padding
+        */
+        inline void base64EncodeTail(const std::uint8_t* src, size_t size, char* dest)
+        {
+            std::uint32_t v = std::uint32_t(src[0]) << 16;
+            if (size > 1)
+                v |= std::uint32_t(src[1]) << 8;
+            dest[0] = kBase64Alphabet[(v >> 18) & 0x3f];
+            dest[1] = kBase64Alphabet[(v >> 12) & 0x3f];
+            dest[2] = size > 1 ? kBase64Alphabet[(v >> 6) & 0x3f] : '=';
+            dest[3] = '=';
+        }
+
+        /**
+        * Decode the final group of 2 to 4 chars. Only a complete quad may be padded, with one or two trailing '='
+        *
+        * @return bytes written (0 to 3), or -1 if the group is malformed
+        */
+        inline int base64DecodeTail(const char* src, size_t size, std::uint8_t* dest)
+        {
+            if (size == 4)
+            {
+                if (src[3] == '=')
+                    size = (src[2] == '=') ? 2 : 3;
+            }
+            else if (size != 2 && size != 3)
+            {
+                return size == 0 ? 0 : -1;
+            }
+
+            const std::uint8_t* table = base64DecodeTable().values;
+            std::uint32_t v = 0;
+            for (size_t i = 0; i < size; i++)
+            {
+                std::uint8_t c = table[static_cast<std::uint8_t>(src[i])];
+                if (c == kBase64Invalid)
+                    return -1;
+                v |= std::uint32_t(c) << (18 - 6 * i);
+            }
+
+            int bytes = static_cast<int>(size) - 1;
+            for (int i = 0; i < bytes; i++)
+                dest[i] = static_cast<std::uint8_t>(v >> (16 - 8 * i));
+            return bytes;
+        }
+
+    }
+
+    inline size_t base64EncodedSize(size_t size)
+    {
+        return (size + 2) / 3 * 4;
+    }
+
+    inline size_t base64MaxDecodedSize(size_t size)
+    {
+        return (size + 3) / 4 * 3;
+    }
+
+    /**
+    * Encode size bytes into dest, which must hold base64EncodedSize(size) chars (no terminating zero is written)
+    *
+    * @return chars written
+    */
+    inline size_t base64Encode(const void* src, size_t size, char* dest)
+    {
+        const std::uint8_t* p = static_cast<const std::uint8_t*>(src);
+        size_t blocks = size / 3;
+        detail::base64EncodeBlocks(p, blocks, dest);
+        if (size % 3)
+            detail::base64EncodeTail(p + blocks * 3, size % 3, dest + blocks * 4);
+        return base64EncodedSize(size);
+    }
+
+    inline std::string base64Encode(const void* src, size_t size)
+    {
+        std::string result(base64EncodedSize(size), '\0');
+        if (size)
+            base64Encode(src, size, &result[0]);
+        return result;
+    }
+
+    inline std::string base64Encode(const std::vector<std::uint8_t>& src)
+    {
+        return base64Encode(src.data(), src.size());
+    }
+
+    /**
+    * Decode base64 text (padded or not) into dest, which must hold base64MaxDecodedSize(size) bytes
+    *
+    * @param decodedSize Bytes written
+    * @return false if the text is not valid base64
+    */
+    inline bool base64Decode(const char* src, size_t size, void* dest, size_t& decodedSize)
+    {
+        std::uint8_t* out = static_cast<std::uint8_t*>(dest);
+        decodedSize = 0;
+        if (!size)
+            return true;
+
+        // the last group (which may be padded) is always decoded by the tail routine
+        size_t quads = (size - 1) / 4;
+        if (detail::base64DecodeQuads(src, quads, out) != quads)
+            return false;
+
+        int tail = detail::base64DecodeTail(src + quads * 4, size - quads * 4, out + quads * 3);
+        if (tail < 0)
+            return false;
+        decodedSize = quads * 3 + static_cast<size_t>(tail);
+        return true;
+    }
+
+    inline bool base64Decode(const std::string& src, std::vector<std::uint8_t>& dest)
+    {
+        dest.resize(base64MaxDecodedSize(src.size()));
+        size_t decodedSize = 0;
+        bool ok = base64Decode(src.data(), src.size(), dest.data(), decodedSize);
+        dest.resize(ok ? decodedSize : 0);
+        return ok;
+    }
+
+    /**
+    * Vectorized base64 encoder, output is identical to Base64Encoder
+    */
+    class FastBase64Encoder : public IEncoder {
+    public:
+        FastBase64Encoder() {}
+        virtual ~FastBase64Encoder() {}
+
+    public:
+        virtual bool encode(
+            const void* srcBuffer, size_t srcSize,
+            void* destBuffer, size_t destSize,
+            StreamPosition dataPosition,
+            size_t& consumedSrcSize, size_t& consumedDestSize
+        )
+        {
+            const std::uint8_t* src = static_cast<const std::uint8_t*>(srcBuffer);
+            char* dest = static_cast<char*>(destBuffer);
+
+            size_t blocks = srcSize / 3;
+            if (blocks > destSize / 4)
+                blocks = destSize / 4;
+            detail::base64EncodeBlocks(src, blocks, dest);
+            consumedSrcSize = blocks * 3;
+            consumedDestSize = blocks * 4;
+
+            size_t rest = srcSize - consumedSrcSize;
+            if (dataPosition == StreamPositionEnd && rest && rest < 3 && destSize - consumedDestSize >= 4)
+            {
+                detail::base64EncodeTail(src + consumedSrcSize, rest, dest + consumedDestSize);
+                consumedSrcSize += rest;
+                consumedDestSize += 4;
+            }
+            return true;
+        }
+
+        virtual size_t estimateEncodedSize(const void* srcBuffer, size_t srcSize)
+        {
+            (void)srcBuffer;
+            return base64EncodedSize(srcSize);
+        }
+
+        virtual size_t estimateEncodedSize(size_t srcSize)
+        {
+            return base64EncodedSize(srcSize);
+        }
+
+        virtual void reset()
+        {}
+    };
+
+    /**
+    * Vectorized base64 decoder, fails on any character outside the base64 alphabet
+    */
+    class FastBase64Decoder : public IEncoder {
+    public:
+        FastBase64Decoder() {}
+        virtual ~FastBase64Decoder() {}
+
+    public:
+        virtual bool encode(
+            const void* srcBuffer, size_t srcSize,
+            void* destBuffer, size_t destSize,
+            StreamPosition dataPosition,
+            size_t& consumedSrcSize, size_t& consumedDestSize
+        )
+        {
+            const char* src = static_cast<const char*>(srcBuffer);
+            std::uint8_t* dest = static_cast<std::uint8_t*>(destBuffer);
+            bool end = (dataPosition == StreamPositionEnd);
+            consumedSrcSize = consumedDestSize = 0;
+
+            // keep the last group for the tail routine at the end of stream, it may contain padding
+            size_t quads = end ? (srcSize ? (srcSize - 1) / 4 : 0) : srcSize / 4;
+            if (quads > destSize / 3)
+                quads = destSize / 3;
+
+            size_t decoded = detail::base64DecodeQuads(src, quads, dest);
+            consumedSrcSize = decoded * 4;
+            consumedDestSize = decoded * 3;
+            if (decoded != quads)
+            {
+                // a padded quad may arrive before the end of stream is signalled, leave it for the final call
+                return !end && src[decoded * 4 + 3] == '=' && decoded + 1 == srcSize / 4 && srcSize % 4 == 0;
+            }
+
+            size_t rest = srcSize - consumedSrcSize;
+            if (end && rest && rest <= 4 && destSize - consumedDestSize >= 3)
+            {
+                int tail = detail::base64DecodeTail(src + consumedSrcSize, rest, dest + consumedDestSize);
+                if (tail < 0)
+                    return false;
+                consumedSrcSize += rest;
+                consumedDestSize += static_cast<size_t>(tail);
+            }
+            return true;
+        }
+
+        virtual size_t estimateEncodedSize(const void* srcBuffer, size_t srcSize)
+        {
+            (void)srcBuffer;
+            return base64MaxDecodedSize(srcSize);
+        }
+
+        virtual size_t estimateEncodedSize(size_t srcSize)
+        {
+            return base64MaxDecodedSize(srcSize);
+        }
+
+        virtual void reset()
+        {}
+    };
+
+} } }
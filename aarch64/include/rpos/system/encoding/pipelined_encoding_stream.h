@@ -0,0 +1,725 @@
+/*
+* pipelined_encoding_stream.h
+* Encoding stream which chains several encoders, each stage running on its own worker thread
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "../io/i_stream.h"
+#include "i_encoder.h"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <deque>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace rpos { namespace system { namespace encoding {
+
+    static const size_t kPipelinedEncodingStreamDefaultChunkSize = 64 * 1024;
+    static const size_t kPipelinedEncodingStreamDefaultQueueDepth = 2;
+    static const size_t kEncodingStageDefaultBlockSize = 256 * 1024;
+
+    typedef boost::function<boost::shared_ptr<IEncoder>()> encoder_factory_t;
+
+    /**
+    * One stage of PipelinedEncodingStream
+    */
+    class EncodingStage {
+    public:
+        /**
+        * A stage driving one encoder sequentially, works with every encoder
+        */
+        static EncodingStage serial(IEncoder& encoder)
+        {
+            EncodingStage stage;
+            stage.encoder_ = &encoder;
+            return stage;
+        }
+
+        /**
+        * A stage splitting its input into independent blocks encoded concurrently
+        *
+        * Only use it with encoders whose output for concatenated input equals the concatenation of
+        * the outputs of each block (e.g. AES-ECB or base64 with blockSize multiple of 3).
+        * AesCtrEncryptor parallelizes internally, use it in a serial stage.
+        * Every block is encoded by a freshly reset encoder created by factory
+        *
+        * @param factory     Creates encoders, one per worker
+        * @param blockSize   Size of each independent block, must be aligned to the encoder's unit
+        * @param concurrency Number of workers, 0 for hardware concurrency
+        */
+        static EncodingStage parallel(const encoder_factory_t& factory, size_t blockSize = kEncodingStageDefaultBlockSize, int concurrency = 0)
+        {
+            EncodingStage stage;
+            stage.factory_ = factory;
+            stage.blockSize_ = blockSize ? blockSize : kEncodingStageDefaultBlockSize;
+            stage.concurrency_ = concurrency;
+            return stage;
+        }
+
+    public:
+        bool isParallel() const { return encoder_ == nullptr; }
+        IEncoder* encoder() const { return encoder_; }
+        const encoder_factory_t& factory() const { return factory_; }
+        size_t blockSize() const { return blockSize_; }
+        int concurrency() const { return concurrency_; }
+
+    private:
+        EncodingStage()
+            : encoder_(nullptr)
+            , blockSize_(0)
+            , concurrency_(0)
+        {}
+
+    private:
+        IEncoder* encoder_;
+        encoder_factory_t factory_;
+        size_t blockSize_;
+        int concurrency_;
+    };
+
+    namespace detail {
+
+        typedef std::vector<std::uint8_t> encoding_chunk_t;
+
+        /**
+        * Bounded blocking queue of chunks between two pipeline stages
+        */
+        class EncodingChunkQueue : private boost::noncopyable {
+        public:
+            // capacity 0 means unbounded
+            explicit EncodingChunkQueue(size_t capacity)
+                : capacity_(capacity)
+                , finished_(false)
+                , aborted_(false)
+            {}
+
+        public:
+            bool push(encoding_chunk_t&& chunk)
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                while (capacity_ && chunks_.size() >= capacity_ && !aborted_)
+                    notFull_.wait(guard);
+                if (aborted_)
+                    return false;
+                chunks_.push_back(std::move(chunk));
+                notEmpty_.notify_one();
+                return true;
+            }
+
+            /**
+            * @return false if the queue is finished and drained, or aborted
+            */
+            bool pop(encoding_chunk_t& chunk)
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                while (chunks_.empty() && !finished_ && !aborted_)
+                    notEmpty_.wait(guard);
+                return popWithLock_(chunk);
+            }
+
+            bool tryPop(encoding_chunk_t& chunk)
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                return popWithLock_(chunk);
+            }
+
+            void finish()
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                finished_ = true;
+                notEmpty_.notify_all();
+            }
+
+            void abort()
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                aborted_ = true;
+                notEmpty_.notify_all();
+                notFull_.notify_all();
+            }
+
+            bool drained() const
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                return finished_ && chunks_.empty();
+            }
+
+        private:
+            bool popWithLock_(encoding_chunk_t& chunk)
+            {
+                if (aborted_ || chunks_.empty())
+                    return false;
+                chunk = std::move(chunks_.front());
+                chunks_.pop_front();
+                notFull_.notify_one();
+                return true;
+            }
+
+        private:
+            const size_t capacity_;
+            mutable boost::mutex lock_;
+            boost::condition_variable notEmpty_;
+            boost::condition_variable notFull_;
+            std::deque<encoding_chunk_t> chunks_;
+            bool finished_;
+            bool aborted_;
+        };
+
+        /**
+        * Fixed set of worker threads for a parallel stage, started once and reused for every batch
+        *
+        * run() hands out items from a shared counter to the workers and the calling thread, and
+        * returns when all items are done. Every batch has its own counters, so a worker waking up late
+        * for a finished batch finds nothing left to do.
+        */
+        class EncodingWorkerPool : private boost::noncopyable {
+        public:
+            typedef boost::function<void(size_t item, size_t worker)> job_t;
+
+            /**
+            * @param concurrency Total workers including the thread calling run()
+            */
+            explicit EncodingWorkerPool(size_t concurrency)
+                : concurrency_(concurrency ? concurrency : 1)
+                , stopping_(false)
+            {
+                for (size_t i = 1; i < concurrency_; i++)
+                    threads_.create_thread(boost::bind(&EncodingWorkerPool::workerProc_, this, i));
+            }
+
+            ~EncodingWorkerPool()
+            {
+                {
+                    boost::lock_guard<boost::mutex> guard(lock_);
+                    stopping_ = true;
+                }
+                wakeUp_.notify_all();
+                threads_.join_all();
+            }
+
+        public:
+            size_t concurrency() const
+            {
+                return concurrency_;
+            }
+
+            /**
+            * Call job(item, worker) for every item in [0, count), job must not throw
+            */
+            void run(size_t count, const job_t& job)
+            {
+                if (!count)
+                    return;
+
+                boost::shared_ptr<Batch_> batch(new Batch_(job, count));
+                if (concurrency_ > 1 && count > 1)
+                {
+                    {
+                        boost::lock_guard<boost::mutex> guard(lock_);
+                        batch_ = batch;
+                    }
+                    wakeUp_.notify_all();
+                }
+
+                work_(*batch, 0);
+
+                boost::unique_lock<boost::mutex> guard(lock_);
+                while (batch->pending.load(boost::memory_order_acquire))
+                    done_.wait(guard);
+                if (batch_ == batch)
+                    batch_.reset();
+            }
+
+        private:
+            struct Batch_ {
+                Batch_(const job_t& job, size_t count)
+                    : job(job)
+                    , count(count)
+                    , next(0)
+                    , pending(count)
+                {}
+
+                const job_t& job;
+                const size_t count;
+                boost::atomic<size_t> next;
+                boost::atomic<size_t> pending;
+            };
+
+            void work_(Batch_& batch, size_t worker)
+            {
+                for (;;)
+                {
+                    size_t item = batch.next.fetch_add(1, boost::memory_order_relaxed);
+                    if (item >= batch.count)
+                        return;
+
+                    batch.job(item, worker);
+                    if (batch.pending.fetch_sub(1, boost::memory_order_acq_rel) == 1)
+                    {
+                        boost::lock_guard<boost::mutex> guard(lock_);
+                        done_.notify_all();
+                    }
+                }
+            }
+
+            void workerProc_(size_t worker)
+            {
+                boost::shared_ptr<Batch_> last;
+                for (;;)
+                {
+                    boost::shared_ptr<Batch_> batch;
+                    {
+                        boost::unique_lock<boost::mutex> guard(lock_);
+                        while (!stopping_ && (!batch_ || batch_ == last))
+                            wakeUp_.wait(guard);
+                        if (stopping_)
+                            return;
+                        batch = batch_;
+                    }
+                    work_(*batch, worker);
+                    last = batch;
+                }
+            }
+
+        private:
+            const size_t concurrency_;
+            boost::thread_group threads_;
+            boost::mutex lock_;
+            boost::condition_variable wakeUp_;
+            boost::condition_variable done_;
+            boost::shared_ptr<Batch_> batch_;
+            bool stopping_;
+        };
+
+        /**
+        * Feed src to the encoder until it stops making progress, appending encoded data to output
+        * With StreamPositionEnd the encoder is called until it has flushed everything
+        *
+        * @return bytes of src consumed
+        */
+        inline size_t runEncoder(IEncoder& encoder, const std::uint8_t* src, size_t size, StreamPosition& position, encoding_chunk_t& output)
+        {
+            size_t consumed = 0;
+            for (;;)
+            {
+                size_t destSize = encoder.estimateEncodedSize(size - consumed) + 64;
+                size_t offset = output.size();
+                output.resize(offset + destSize);
+
+                size_t consumedSrc = 0, consumedDest = 0;
+                if (!encoder.encode(src + consumed, size - consumed, &output[offset], destSize, position, consumedSrc, consumedDest))
+                    throw std::runtime_error("Encoder failed");
+
+                output.resize(offset + consumedDest);
+                consumed += consumedSrc;
+                if (!consumedSrc && !consumedDest)
+                    break;
+                if (position == StreamPositionBegin)
+                    position = StreamPositionBody;
+                if (consumed == size && position != StreamPositionEnd)
+                    break;
+            }
+            return consumed;
+        }
+
+        class EncodingStageRunner : private boost::noncopyable {
+        public:
+            /**
+            * @param pool Workers of a parallel stage, owned by the stream and reused across batches
+            */
+            EncodingStageRunner(const EncodingStage& stage, EncodingWorkerPool* pool)
+                : stage_(stage)
+                , pool_(pool)
+                , position_(StreamPositionBegin)
+            {
+                if (stage_.isParallel())
+                {
+                    encoders_.resize(pool_->concurrency());
+                    for (size_t i = 0; i < encoders_.size(); i++)
+                        encoders_[i] = stage_.factory()();
+                }
+            }
+
+        public:
+            void feed(encoding_chunk_t& chunk, EncodingChunkQueue& out)
+            {
+                pending_.insert(pending_.end(), chunk.begin(), chunk.end());
+                if (stage_.isParallel())
+                {
+                    size_t batchSize = stage_.blockSize() * encoders_.size();
+                    if (pending_.size() >= batchSize + 1)
+                        encodeBlocks_(batchSize, false, out);
+                }
+                else
+                {
+                    encodeSerial_(false, out);
+                }
+            }
+
+            void finish(EncodingChunkQueue& out)
+            {
+                if (stage_.isParallel())
+                {
+                    while (pending_.size() > stage_.blockSize() * encoders_.size())
+                        encodeBlocks_(stage_.blockSize() * encoders_.size(), false, out);
+                    encodeBlocks_(pending_.size(), true, out);
+                }
+                else
+                {
+                    encodeSerial_(true, out);
+                }
+            }
+
+        private:
+            void encodeSerial_(bool end, EncodingChunkQueue& out)
+            {
+                if (end)
+                    position_ = StreamPositionEnd;
+
+                encoding_chunk_t output;
+                size_t consumed = runEncoder(*stage_.encoder(), pending_.data(), pending_.size(), position_, output);
+                pending_.erase(pending_.begin(), pending_.begin() + consumed);
+                if (!output.empty())
+                    out.push(std::move(output));
+            }
+
+            void encodeBlocks_(size_t bytes, bool containsLast, EncodingChunkQueue& out)
+            {
+                size_t blockSize = stage_.blockSize();
+                size_t blocks = (bytes + blockSize - 1) / blockSize;
+                if (!blocks && containsLast)
+                    blocks = 1;
+
+                std::vector<encoding_chunk_t> outputs(blocks);
+                std::vector<std::string> errors(blocks);
+                bool first = (position_ == StreamPositionBegin);
+
+                pool_->run(blocks, [&](size_t block, size_t worker) {
+                    size_t offset = block * blockSize;
+                    size_t size = std::min(blockSize, bytes - offset);
+                    bool last = containsLast && block + 1 == blocks;
+                    StreamPosition position = last ? StreamPositionEnd : ((first && block == 0) ? StreamPositionBegin : StreamPositionBody);
+
+                    try
+                    {
+                        IEncoder& encoder = *encoders_[worker];
+                        encoder.reset();
+                        if (runEncoder(encoder, pending_.data() + offset, size, position, outputs[block]) != size)
+                            throw std::runtime_error("Block size is not aligned to the encoder unit");
+                    }
+                    catch (const std::exception& e)
+                    {
+                        errors[block] = e.what();
+                    }
+                });
+
+                for (size_t i = 0; i < blocks; i++)
+                {
+                    if (!errors[i].empty())
+                        throw std::runtime_error(errors[i]);
+                    if (!outputs[i].empty())
+                        out.push(std::move(outputs[i]));
+                }
+
+                position_ = StreamPositionBody;
+                pending_.erase(pending_.begin(), pending_.begin() + bytes);
+            }
+
+        private:
+            EncodingStage stage_;
+            EncodingWorkerPool* pool_;
+            StreamPosition position_;
+            encoding_chunk_t pending_;
+            std::vector<boost::shared_ptr<IEncoder>> encoders_;
+        };
+
+    }
+
+    /**
+    * Pipelined encoding stream
+    *
+    * Chains encoders, e.g. RLE -> AES -> base64, each stage on its own worker thread. Stages are
+    * connected by bounded queues (queueDepth chunks, 2 means double buffering), so a slow stage
+    * throttles the writer instead of buffering unboundedly.
+    *
+    * Write raw data via write(), call endWrite() when done, and read encoded data via read().
+    * Before endWrite(), read() returns whatever is available without blocking; after endWrite(),
+    * read() blocks until data is available and returns 0 only at the end of the encoded stream.
+    * Encoded output is buffered without limit, so writers need not interleave reads.
+    *
+    * Serial stages call their encoder exclusively from the stage worker, the encoders must outlive the stream.
+    * Parallel stages run on worker threads started with the stream and reused for every batch
+    */
+    class PipelinedEncodingStream
+        : public io::IStream
+        , private boost::noncopyable
+    {
+    public:
+        /**
+        * Constructor
+        *
+        * @param stages     Encoding stages in order, at least one
+        * @param chunkSize  Size of chunks the written data is split into
+        * @param queueDepth Chunks buffered between two adjacent stages
+        */
+        explicit PipelinedEncodingStream(
+            const std::vector<EncodingStage>& stages,
+            size_t chunkSize = kPipelinedEncodingStreamDefaultChunkSize,
+            size_t queueDepth = kPipelinedEncodingStreamDefaultQueueDepth
+        )
+            : stages_(stages)
+            , chunkSize_(chunkSize ? chunkSize : kPipelinedEncodingStreamDefaultChunkSize)
+            , queueDepth_(queueDepth ? queueDepth : kPipelinedEncodingStreamDefaultQueueDepth)
+            , failed_(false)
+        {
+            if (stages_.empty())
+                throw std::invalid_argument("PipelinedEncodingStream requires at least one stage");
+
+            pools_.resize(stages_.size());
+            for (size_t i = 0; i < stages_.size(); i++)
+            {
+                if (!stages_[i].isParallel())
+                    continue;
+                int n = stages_[i].concurrency() > 0 ? stages_[i].concurrency() : static_cast<int>(boost::thread::hardware_concurrency());
+                pools_[i].reset(new detail::EncodingWorkerPool(n > 0 ? n : 4));
+            }
+            start_();
+        }
+
+        virtual ~PipelinedEncodingStream()
+        {
+            close();
+        }
+
+        // IStream APIs
+    public:
+        virtual bool isOpen()
+        {
+            return !workers_.empty();
+        }
+
+        virtual bool canRead()
+        {
+            return isOpen();
+        }
+
+        virtual bool canWrite()
+        {
+            return isOpen() && isWritable_;
+        }
+
+        virtual bool canSeek()
+        {
+            return false;
+        }
+
+    public:
+        /**
+        * Abort all stages and release the workers, pending data is dropped
+        */
+        virtual void close()
+        {
+            abort_();
+            for (auto iter = workers_.begin(); iter != workers_.end(); ++iter)
+                (*iter)->join();
+            workers_.clear();
+            isWritable_ = false;
+        }
+
+    public:
+        virtual bool endOfStream()
+        {
+            return outputOffset_ >= output_.size() && queues_.back()->drained();
+        }
+
+    public:
+        virtual int read(void* buffer, size_t size)
+        {
+            if (failed_.load())
+                return -1;
+
+            std::uint8_t* dest = static_cast<std::uint8_t*>(buffer);
+            size_t done = 0;
+            while (done < size)
+            {
+                if (outputOffset_ >= output_.size())
+                {
+                    output_.clear();
+                    outputOffset_ = 0;
+
+                    bool got = (isWritable_ || done) ? queues_.back()->tryPop(output_) : queues_.back()->pop(output_);
+                    if (!got)
+                        break;
+                    continue;
+                }
+
+                size_t n = std::min(size - done, output_.size() - outputOffset_);
+                memcpy(dest + done, &output_[outputOffset_], n);
+                outputOffset_ += n;
+                done += n;
+            }
+
+            if (!done && failed_.load())
+                return -1;
+            readBytes_ += done;
+            return static_cast<int>(done);
+        }
+
+        virtual int write(const void* buffer, size_t size)
+        {
+            if (!canWrite() || failed_.load())
+                return -1;
+
+            const std::uint8_t* src = static_cast<const std::uint8_t*>(buffer);
+            size_t done = 0;
+            while (done < size)
+            {
+                size_t n = std::min(size - done, chunkSize_ - inputChunk_.size());
+                inputChunk_.insert(inputChunk_.end(), src + done, src + done + n);
+                done += n;
+
+                if (inputChunk_.size() >= chunkSize_ && !flushInputChunk_())
+                    return -1;
+            }
+            return static_cast<int>(done);
+        }
+
+        virtual size_t tell()
+        {
+            return readBytes_;
+        }
+
+        virtual void seek(io::SeekType type, int offset)
+        {
+            (void)type;
+            (void)offset;
+        }
+
+        // Specific APIs
+    public:
+        /**
+        * Finish the write, the last stage will be called with StreamPositionEnd
+        */
+        virtual void endWrite()
+        {
+            if (!isWritable_)
+                return;
+
+            flushInputChunk_();
+            isWritable_ = false;
+            queues_.front()->finish();
+        }
+
+        /**
+        * Abort current work and restart the pipeline with empty buffers
+        * Serial stage encoders are reset as well
+        */
+        virtual void reset()
+        {
+            close();
+            for (auto iter = stages_.begin(); iter != stages_.end(); ++iter)
+            {
+                if (!iter->isParallel())
+                    iter->encoder()->reset();
+            }
+            start_();
+        }
+
+        bool failed() const
+        {
+            return failed_.load();
+        }
+
+    private:
+        void start_()
+        {
+            queues_.clear();
+            for (size_t i = 0; i < stages_.size(); i++)
+                queues_.push_back(boost::shared_ptr<detail::EncodingChunkQueue>(new detail::EncodingChunkQueue(queueDepth_)));
+            // the output of the last stage is drained by read(), never block the pipeline on it
+            queues_.push_back(boost::shared_ptr<detail::EncodingChunkQueue>(new detail::EncodingChunkQueue(0)));
+
+            failed_.store(false);
+            isWritable_ = true;
+            inputChunk_.clear();
+            inputChunk_.reserve(chunkSize_);
+            output_.clear();
+            outputOffset_ = 0;
+            readBytes_ = 0;
+
+            for (size_t i = 0; i < stages_.size(); i++)
+                workers_.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&PipelinedEncodingStream::stageProc_, this, i))));
+        }
+
+        void abort_()
+        {
+            for (auto iter = queues_.begin(); iter != queues_.end(); ++iter)
+                (*iter)->abort();
+        }
+
+        bool flushInputChunk_()
+        {
+            if (inputChunk_.empty())
+                return true;
+
+            detail::encoding_chunk_t chunk;
+            chunk.reserve(chunkSize_);
+            chunk.swap(inputChunk_);
+            return queues_.front()->push(std::move(chunk));
+        }
+
+        void stageProc_(size_t index)
+        {
+            detail::EncodingChunkQueue& in = *queues_[index];
+            detail::EncodingChunkQueue& out = *queues_[index + 1];
+
+            try
+            {
+                detail::EncodingStageRunner runner(stages_[index], pools_[index].get());
+                detail::encoding_chunk_t chunk;
+                while (in.pop(chunk))
+                    runner.feed(chunk, out);
+
+                if (in.drained())
+                {
+                    runner.finish(out);
+                    out.finish();
+                }
+            }
+            catch (const std::exception&)
+            {
+                failed_.store(true);
+                abort_();
+            }
+        }
+
+    private:
+        std::vector<EncodingStage> stages_;
+        const size_t chunkSize_;
+        const size_t queueDepth_;
+
+        std::vector<boost::shared_ptr<detail::EncodingChunkQueue>> queues_;
+        std::vector<boost::shared_ptr<boost::thread>> workers_;
+        // worker threads of parallel stages (null for serial stages), kept across reset()
+        std::vector<boost::shared_ptr<detail::EncodingWorkerPool>> pools_;
+        boost::atomic<bool> failed_;
+
+        bool isWritable_;
+        detail::encoding_chunk_t inputChunk_;
+        detail::encoding_chunk_t output_;
+        size_t outputOffset_;
+        size_t readBytes_;
+    };
+
+} } }
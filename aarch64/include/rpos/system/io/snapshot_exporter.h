@@ -0,0 +1,494 @@
+/*
+* snapshot_exporter.h
+* Export SnapshotLoopBufferMemoryWriteStream snapshots to files and sockets with gather writes,
+* optionally gzip compressed in parallel and on a background thread
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "snapshot_loop_buffer_memory_write_stream.h"
+#include <rpos/system/parallel.h>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#   include <stdio.h>
+#else
+#   include <fcntl.h>
+#   include <limits.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+namespace rpos { namespace system { namespace io {
+
+    struct SnapshotExportOptions {
+        SnapshotExportOptions()
+            : compress(false)
+            , compressionLevel(6)
+            , compressionConcurrency(0)
+        {}
+
+        // gzip every chunk as an independent gzip member, the concatenation is a valid gzip stream
+        bool compress;
+        // zlib compression level, 1 (fastest) to 9 (smallest)
+        int compressionLevel;
+        // threads used to compress chunks, 0 for hardware concurrency
+        int compressionConcurrency;
+    };
+
+    namespace detail {
+
+        struct SnapshotSegment {
+            const void* data;
+            size_t size;
+        };
+
+        inline std::vector<SnapshotSegment> collectSnapshotSegments(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot)
+        {
+            std::vector<SnapshotSegment> segments;
+            size_t remaining = snapshot.size();
+            const auto& buffers = snapshot.buffers();
+            segments.reserve(buffers.size());
+
+            for (auto iter = buffers.begin(); iter != buffers.end() && remaining; ++iter)
+            {
+                size_t size = (*iter)->size();
+                if (size > remaining)
+                    size = remaining;
+                if (!size)
+                    continue;
+
+                SnapshotSegment segment = { (*iter)->buffer(), size };
+                segments.push_back(segment);
+                remaining -= size;
+            }
+            return segments;
+        }
+
+        inline void gzipSegment(const SnapshotSegment& segment, int level, std::vector<char>& output)
+        {
+            output.clear();
+            output.reserve(segment.size / 2 + 64);
+
+            boost::iostreams::filtering_ostream out;
+            out.push(boost::iostreams::gzip_compressor(boost::iostreams::gzip_params(level)));
+            out.push(boost::iostreams::back_inserter(output));
+            out.write(static_cast<const char*>(segment.data), segment.size);
+            boost::iostreams::close(out);
+        }
+
+#ifdef _WIN32
+        inline void gatherWriteAll(FILE* file, const std::vector<SnapshotSegment>& segments)
+        {
+            for (auto iter = segments.begin(); iter != segments.end(); ++iter)
+            {
+                if (fwrite(iter->data, 1, iter->size, file) != iter->size)
+                    throw std::runtime_error("Failed to write snapshot");
+            }
+        }
+#else
+        /**
+        * Write all segments to fd with writev, batched by IOV_MAX and resumed on partial writes
+        */
+        inline void gatherWriteAll(int fd, const std::vector<SnapshotSegment>& segments)
+        {
+            std::vector<struct iovec> iovs(segments.size());
+            for (size_t i = 0; i < segments.size(); i++)
+            {
+                iovs[i].iov_base = const_cast<void*>(segments[i].data);
+                iovs[i].iov_len = segments[i].size;
+            }
+
+            size_t current = 0;
+            while (current < iovs.size())
+            {
+                size_t count = iovs.size() - current;
+                if (count > IOV_MAX)
+                    count = IOV_MAX;
+
+                ssize_t written = ::writev(fd, &iovs[current], static_cast<int>(count));
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::runtime_error(std::string("Failed to write snapshot: ") + strerror(errno));
+                }
+
+                size_t left = static_cast<size_t>(written);
+                while (current < iovs.size() && left >= iovs[current].iov_len)
+                {
+                    left -= iovs[current].iov_len;
+                    current++;
+                }
+                if (left)
+                {
+                    iovs[current].iov_base = static_cast<std::uint8_t*>(iovs[current].iov_base) + left;
+                    iovs[current].iov_len -= left;
+                }
+            }
+        }
+#endif
+
+        template < class TargetT >
+        inline void exportSegments(std::vector<SnapshotSegment> segments, TargetT target, const SnapshotExportOptions& options)
+        {
+            if (!options.compress)
+            {
+                gatherWriteAll(target, segments);
+                return;
+            }
+
+            std::vector<std::vector<char>> compressed(segments.size());
+            std::vector<std::string> errors(segments.size());
+            rpos::system::parallel_for(static_cast<int>(segments.size()), [&](int i) {
+                try
+                {
+                    gzipSegment(segments[i], options.compressionLevel, compressed[i]);
+                }
+                catch (const std::exception& e)
+                {
+                    errors[i] = e.what();
+                }
+            }, options.compressionConcurrency);
+
+            for (size_t i = 0; i < segments.size(); i++)
+            {
+                if (!errors[i].empty())
+                    throw std::runtime_error("Failed to compress snapshot: " + errors[i]);
+
+                segments[i].data = compressed[i].data();
+                segments[i].size = compressed[i].size();
+            }
+            gatherWriteAll(target, segments);
+        }
+
+    }
+
+    /**
+    * The snapshot contents, safe to export on another thread while the stream is being written
+    *
+    * Snapshot only holds references to the chunks of the live stream. The stream only ever appends to (and
+    * may reallocate) its last chunk, the earlier ones are immutable once it moved on. So an image shares the
+    * full chunks by reference count and copies only the last one.
+    */
+    class SnapshotImage {
+    public:
+        SnapshotImage()
+            : size_(0)
+        {}
+
+        /**
+        * Capture the snapshot contents, must not run concurrently with writes to the stream
+        */
+        explicit SnapshotImage(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot)
+            : size_(0)
+        {
+            size_t remaining = snapshot.size();
+            const SnapshotLoopBufferMemoryWriteStream::Snapshot::buffer_list_t& buffers = snapshot.buffers();
+            for (auto iter = buffers.begin(); iter != buffers.end() && remaining; ++iter)
+            {
+                size_t size = std::min((*iter)->size(), remaining);
+                if (!size)
+                    continue;
+
+                if (std::next(iter) == buffers.end())
+                {
+                    tail_.assign((*iter)->buffer(), (*iter)->buffer() + size);
+                }
+                else
+                {
+                    SharedChunk chunk = { *iter, size };
+                    chunks_.push_back(chunk);
+                }
+                remaining -= size;
+                size_ += size;
+            }
+        }
+
+    public:
+        size_t size() const
+        {
+            return size_;
+        }
+
+        std::vector<detail::SnapshotSegment> segments() const
+        {
+            std::vector<detail::SnapshotSegment> segments;
+            segments.reserve(chunks_.size() + 1);
+            for (size_t i = 0; i < chunks_.size(); i++)
+            {
+                detail::SnapshotSegment segment = { chunks_[i].stream->buffer(), chunks_[i].size };
+                segments.push_back(segment);
+            }
+            if (!tail_.empty())
+            {
+                detail::SnapshotSegment segment = { tail_.data(), tail_.size() };
+                segments.push_back(segment);
+            }
+            return segments;
+        }
+
+    private:
+        struct SharedChunk {
+            boost::shared_ptr<MemoryWriteStream> stream;
+            size_t size;
+        };
+
+        std::vector<SharedChunk> chunks_;
+        std::vector<std::uint8_t> tail_;
+        size_t size_;
+    };
+
+#ifndef _WIN32
+    /**
+    * Write the snapshot to an opened file descriptor (regular file, pipe or socket) with gather writes
+    * Chunks are written straight from the snapshot memory, nothing is copied unless compression is enabled.
+    * The chunks are shared with the stream, so call this on the writer thread or while writes are paused
+    *
+    * @throw std::runtime_error on write or compression failure
+    */
+    inline void exportSnapshot(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot, int fd, const SnapshotExportOptions& options = SnapshotExportOptions())
+    {
+        detail::exportSegments(detail::collectSnapshotSegments(snapshot), fd, options);
+    }
+
+    inline void exportSnapshot(const SnapshotImage& image, int fd, const SnapshotExportOptions& options = SnapshotExportOptions())
+    {
+        detail::exportSegments(image.segments(), fd, options);
+    }
+#endif
+
+    namespace detail {
+
+        inline void exportSegmentsToFile(const std::vector<SnapshotSegment>& segments, const std::string& filename, const SnapshotExportOptions& options)
+        {
+#ifdef _WIN32
+            FILE* file = fopen(filename.c_str(), "wb");
+            if (!file)
+                throw std::runtime_error("Failed to open " + filename);
+
+            try
+            {
+                exportSegments(segments, file, options);
+            }
+            catch (...)
+            {
+                fclose(file);
+                throw;
+            }
+            fclose(file);
+#else
+            int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0)
+                throw std::runtime_error("Failed to open " + filename + ": " + strerror(errno));
+
+            try
+            {
+                exportSegments(segments, fd, options);
+            }
+            catch (...)
+            {
+                ::close(fd);
+                throw;
+            }
+            if (::close(fd) != 0)
+                throw std::runtime_error("Failed to close " + filename + ": " + strerror(errno));
+#endif
+        }
+
+    }
+
+    /**
+    * Write the snapshot to a file, the file is truncated if it exists.
+    * The chunks are shared with the stream, so call this on the writer thread or while writes are paused
+    *
+    * @throw std::runtime_error on open, write or compression failure
+    */
+    inline void exportSnapshotToFile(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot, const std::string& filename, const SnapshotExportOptions& options = SnapshotExportOptions())
+    {
+        detail::exportSegmentsToFile(detail::collectSnapshotSegments(snapshot), filename, options);
+    }
+
+    inline void exportSnapshotToFile(const SnapshotImage& image, const std::string& filename, const SnapshotExportOptions& options = SnapshotExportOptions())
+    {
+        detail::exportSegmentsToFile(image.segments(), filename, options);
+    }
+
+    /**
+    * SnapshotExporter exports snapshots on a background thread, so the caller (usually an incident handler)
+    * never blocks on disk or network. Jobs are executed in submission order.
+    * Submitting a snapshot captures a SnapshotImage on the calling thread (only the last chunk is copied), so
+    * the stream can keep being written while the export runs; submit right after taking the snapshot
+    */
+    class SnapshotExporter : private boost::noncopyable {
+    public:
+        typedef boost::function<void(bool succeed, const std::string& error)> callback_t;
+
+        SnapshotExporter()
+            : stopping_(false)
+            , busy_(false)
+        {
+            worker_ = boost::thread(&SnapshotExporter::workerProc_, this);
+        }
+
+        /**
+        * Finish all pending jobs then stop the background thread
+        */
+        ~SnapshotExporter()
+        {
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                stopping_ = true;
+            }
+            cond_.notify_all();
+            worker_.join();
+        }
+
+    public:
+        void exportToFileAsync(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot, const std::string& filename, const SnapshotExportOptions& options = SnapshotExportOptions(), callback_t callback = callback_t())
+        {
+            exportToFileAsync(boost::make_shared<SnapshotImage>(snapshot), filename, options, callback);
+        }
+
+        void exportToFileAsync(const boost::shared_ptr<const SnapshotImage>& image, const std::string& filename, const SnapshotExportOptions& options = SnapshotExportOptions(), callback_t callback = callback_t())
+        {
+            typedef void (*export_file_t)(const SnapshotImage&, const std::string&, const SnapshotExportOptions&);
+            push_(boost::bind(static_cast<export_file_t>(&exportSnapshotToFile), boost::cref(*image), filename, options), image, callback);
+        }
+
+#ifndef _WIN32
+        /**
+        * The fd is owned by the caller and must stay open until the callback is invoked
+        */
+        void exportAsync(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot, int fd, const SnapshotExportOptions& options = SnapshotExportOptions(), callback_t callback = callback_t())
+        {
+            exportAsync(boost::make_shared<SnapshotImage>(snapshot), fd, options, callback);
+        }
+
+        void exportAsync(const boost::shared_ptr<const SnapshotImage>& image, int fd, const SnapshotExportOptions& options = SnapshotExportOptions(), callback_t callback = callback_t())
+        {
+            typedef void (*export_fd_t)(const SnapshotImage&, int, const SnapshotExportOptions&);
+            push_(boost::bind(static_cast<export_fd_t>(&exportSnapshot), boost::cref(*image), fd, options), image, callback);
+        }
+#endif
+
+        size_t pendingJobs() const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            return jobs_.size() + (busy_ ? 1 : 0);
+        }
+
+        /**
+        * Block until every submitted job has finished
+        */
+        void waitForIdle()
+        {
+            boost::unique_lock<boost::mutex> guard(lock_);
+            while (!jobs_.empty() || busy_)
+                idleCond_.wait(guard);
+        }
+
+    private:
+        struct Job {
+            boost::function<void()> run;
+            boost::shared_ptr<const SnapshotImage> image;
+            callback_t callback;
+        };
+
+        void push_(const boost::function<void()>& run, const boost::shared_ptr<const SnapshotImage>& image, const callback_t& callback)
+        {
+            Job job;
+            job.run = run;
+            job.image = image;
+            job.callback = callback;
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                jobs_.push_back(job);
+            }
+            cond_.notify_one();
+        }
+
+        void workerProc_()
+        {
+            for (;;)
+            {
+                Job job;
+                {
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    while (jobs_.empty() && !stopping_)
+                        cond_.wait(guard);
+                    if (jobs_.empty())
+                        return;
+
+                    job = jobs_.front();
+                    jobs_.pop_front();
+                    busy_ = true;
+                }
+
+                bool succeed = true;
+                std::string error;
+                try
+                {
+                    job.run();
+                }
+                catch (const std::exception& e)
+                {
+                    succeed = false;
+                    error = e.what();
+                }
+                catch (...)
+                {
+                    succeed = false;
+                    error = "Unknown error while exporting snapshot";
+                }
+
+                // a throwing callback must not take the worker down or leave waiters blocked
+                if (job.callback)
+                {
+                    try
+                    {
+                        job.callback(succeed, error);
+                    }
+                    catch (...)
+                    {
+                    }
+                }
+
+                {
+                    boost::lock_guard<boost::mutex> guard(lock_);
+                    busy_ = false;
+                }
+                idleCond_.notify_all();
+            }
+        }
+
+    private:
+        mutable boost::mutex lock_;
+        boost::condition_variable cond_;
+        boost::condition_variable idleCond_;
+        std::deque<Job> jobs_;
+        bool stopping_;
+        bool busy_;
+        boost::thread worker_;
+    };
+
+} } }
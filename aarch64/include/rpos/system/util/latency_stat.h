@@ -0,0 +1,448 @@
+/*
+* latency_stat.h
+* HDR histogram style latency statistics with lock-free recording and windowed percentiles
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "debug_server.h"
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace rpos { namespace system { namespace util {
+
+    namespace detail {
+
+        /**
+        * Log-linear bucket layout shared by every LatencyStat, so snapshots can always be merged
+        *
+        * Values below 2 * kLatencySubBuckets are exact, above that every power of two is split into
+        * kLatencySubBuckets buckets, i.e. the relative error is below 1 / kLatencySubBuckets (~3%).
+        */
+        static const int kLatencySubBucketBits = 5;
+        static const std::uint64_t kLatencySubBuckets = 1u << kLatencySubBucketBits;
+        // values are in nanoseconds, 2^44 ns is about 4.9 hours, larger values are clamped
+        static const int kLatencyMaxBits = 44;
+        static const size_t kLatencyBucketCount = static_cast<size_t>(2 * kLatencySubBuckets + (kLatencyMaxBits - 1 - kLatencySubBucketBits) * kLatencySubBuckets);
+
+        inline int latencyMostSignificantBit(std::uint64_t v)
+        {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(v);
+#else
+            int msb = 0;
+            while (v >>= 1)
+                msb++;
+            return msb;
+#endif
+        }
+
+        inline size_t latencyBucketOf(std::uint64_t value)
+        {
+            const std::uint64_t maxValue = (std::uint64_t(1) << kLatencyMaxBits) - 1;
+            if (value > maxValue)
+                value = maxValue;
+            if (value < 2 * kLatencySubBuckets)
+                return static_cast<size_t>(value);
+
+            int shift = latencyMostSignificantBit(value) - kLatencySubBucketBits;
+            std::uint64_t mantissa = value >> shift;
+            return static_cast<size_t>(2 * kLatencySubBuckets + (shift - 1) * kLatencySubBuckets + (mantissa - kLatencySubBuckets));
+        }
+
+        inline std::uint64_t latencyBucketLowerBound(size_t bucket)
+        {
+            if (bucket < 2 * kLatencySubBuckets)
+                return bucket;
+            size_t k = bucket - 2 * kLatencySubBuckets;
+            int shift = static_cast<int>(k / kLatencySubBuckets) + 1;
+            return (kLatencySubBuckets + k % kLatencySubBuckets) << shift;
+        }
+
+        inline std::uint64_t latencyBucketUpperBound(size_t bucket)
+        {
+            if (bucket < 2 * kLatencySubBuckets)
+                return bucket;
+            int shift = static_cast<int>((bucket - 2 * kLatencySubBuckets) / kLatencySubBuckets) + 1;
+            return latencyBucketLowerBound(bucket) + (std::uint64_t(1) << shift) - 1;
+        }
+
+    }
+
+    /**
+    * A consistent copy of a LatencyStat histogram, values in nanoseconds
+    */
+    class LatencyStatSnapshot {
+    public:
+        LatencyStatSnapshot()
+            : counts_(detail::kLatencyBucketCount, 0)
+            , count_(0)
+            , sum_(0)
+            , min_(std::numeric_limits<std::uint64_t>::max())
+            , max_(0)
+        {}
+
+    public:
+        void add(std::uint64_t value, std::uint64_t times = 1)
+        {
+            if (!times)
+                return;
+            counts_[detail::latencyBucketOf(value)] += times;
+            count_ += times;
+            sum_ += value * times;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        /**
+        * Add the samples of another snapshot, e.g. the same operation measured on another robot
+        */
+        void merge(const LatencyStatSnapshot& other)
+        {
+            for (size_t i = 0; i < counts_.size(); i++)
+                counts_[i] += other.counts_[i];
+            count_ += other.count_;
+            sum_ += other.sum_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+
+        /**
+        * Value at quantile q (0..1), within the ~3% bucket resolution, 0 if empty
+        */
+        std::uint64_t percentile(double q) const
+        {
+            if (!count_)
+                return 0;
+            q = std::min(std::max(q, 0.0), 1.0);
+            std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count_)));
+            if (rank == 0)
+                rank = 1;
+
+            std::uint64_t seen = 0;
+            for (size_t i = 0; i < counts_.size(); i++)
+            {
+                seen += counts_[i];
+                if (seen >= rank)
+                    return std::min(std::max(detail::latencyBucketUpperBound(i), min_), max_);
+            }
+            return max_;
+        }
+
+        std::uint64_t count() const
+        {
+            return count_;
+        }
+
+        std::uint64_t sum() const
+        {
+            return sum_;
+        }
+
+        std::uint64_t min() const
+        {
+            return count_ ? min_ : 0;
+        }
+
+        std::uint64_t max() const
+        {
+            return max_;
+        }
+
+        double mean() const
+        {
+            return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+        }
+
+        const std::vector<std::uint64_t>& counts() const
+        {
+            return counts_;
+        }
+
+    private:
+        friend class LatencyStat;
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t count_;
+        std::uint64_t sum_;
+        std::uint64_t min_;
+        std::uint64_t max_;
+    };
+
+    /**
+    * Latency histogram for percentile reporting (p50 / p90 / p99 / p999)
+    *
+    * Complements EventStat, which only keeps count / sum / last. Memory is fixed at construction:
+    * windowCount rotating windows of detail::kLatencyBucketCount counters. Recording is a couple of
+    * relaxed atomic increments and never blocks, so any number of threads may record concurrently.
+    *
+    * Windows are recycled by the first sample of the window before them, one slot always holds the
+    * upcoming window, so a reader sees the last (windowCount - 2) complete windows plus the current
+    * one. Use windowCount >= 3 to always keep at least one complete window.
+    */
+    class LatencyStat : private boost::noncopyable {
+    public:
+        /**
+        * @param window      Length of one window
+        * @param windowCount Number of windows, the snapshot covers between window * (windowCount - 2)
+        *                    and window * (windowCount - 1)
+        */
+        explicit LatencyStat(boost::chrono::milliseconds window = boost::chrono::milliseconds(10000), size_t windowCount = 6)
+            : windowNs_(static_cast<std::uint64_t>(std::max<boost::chrono::milliseconds::rep>(window.count(), 1)) * 1000000u)
+            , windows_(std::max<size_t>(windowCount, 2))
+            , totalCount_(0)
+            , totalSum_(0)
+            , max_(0)
+        {
+            for (size_t i = 0; i < windows_.size(); i++)
+                windows_[i].epoch.store(std::numeric_limits<std::uint64_t>::max(), boost::memory_order_relaxed);
+        }
+
+    public:
+        void record(std::uint64_t ns)
+        {
+            std::uint64_t epoch = currentEpoch_();
+            Window_& window = windowFor_(epoch);
+            window.counts[detail::latencyBucketOf(ns)].fetch_add(1, boost::memory_order_relaxed);
+            window.sum.fetch_add(ns, boost::memory_order_relaxed);
+
+            // prepare the next window, so recorders never race with clearing it
+            Window_& next = windows_[(epoch + 1) % windows_.size()];
+            if (next.epoch.load(boost::memory_order_relaxed) != epoch + 1)
+                reset_(next, epoch + 1);
+
+            totalCount_.fetch_add(1, boost::memory_order_relaxed);
+            totalSum_.fetch_add(ns, boost::memory_order_relaxed);
+            std::uint64_t max = max_.load(boost::memory_order_relaxed);
+            while (ns > max && !max_.compare_exchange_weak(max, ns, boost::memory_order_relaxed))
+                ;
+        }
+
+        template < class Rep, class Period >
+        void record(const boost::chrono::duration<Rep, Period>& duration)
+        {
+            std::int64_t ns = boost::chrono::duration_cast<boost::chrono::nanoseconds>(duration).count();
+            record(static_cast<std::uint64_t>(ns < 0 ? 0 : ns));
+        }
+
+        /**
+        * EventStat style alias of record, in nanoseconds
+        */
+        void push(std::uint64_t ns)
+        {
+            record(ns);
+        }
+
+        /**
+        * Samples of the recent windows
+        */
+        LatencyStatSnapshot snapshot() const
+        {
+            LatencyStatSnapshot result;
+            std::uint64_t epoch = currentEpoch_();
+            for (size_t w = 0; w < windows_.size(); w++)
+            {
+                const Window_& window = windows_[w];
+                std::uint64_t windowEpoch = window.epoch.load(boost::memory_order_acquire);
+                if (windowEpoch > epoch || epoch - windowEpoch >= windows_.size())
+                    continue;
+
+                for (size_t i = 0; i < detail::kLatencyBucketCount; i++)
+                {
+                    std::uint64_t n = window.counts[i].load(boost::memory_order_relaxed);
+                    if (!n)
+                        continue;
+                    result.counts_[i] += n;
+                    result.count_ += n;
+                    result.min_ = std::min(result.min_, detail::latencyBucketLowerBound(i));
+                    result.max_ = std::max(result.max_, detail::latencyBucketUpperBound(i));
+                }
+                result.sum_ += window.sum.load(boost::memory_order_relaxed);
+            }
+            if (result.count_)
+                result.max_ = std::min(result.max_, max_.load(boost::memory_order_relaxed));
+            return result;
+        }
+
+        /**
+        * Samples since construction (or clear)
+        */
+        std::uint64_t totalCount() const
+        {
+            return totalCount_.load(boost::memory_order_relaxed);
+        }
+
+        std::uint64_t totalSum() const
+        {
+            return totalSum_.load(boost::memory_order_relaxed);
+        }
+
+        std::uint64_t max() const
+        {
+            return max_.load(boost::memory_order_relaxed);
+        }
+
+        void clear()
+        {
+            for (size_t i = 0; i < windows_.size(); i++)
+                windows_[i].epoch.store(std::numeric_limits<std::uint64_t>::max(), boost::memory_order_relaxed);
+            totalCount_.store(0, boost::memory_order_relaxed);
+            totalSum_.store(0, boost::memory_order_relaxed);
+            max_.store(0, boost::memory_order_relaxed);
+        }
+
+    public:
+        /**
+        * Records the lifetime of the scope
+        */
+        class Scope : private boost::noncopyable {
+        public:
+            explicit Scope(LatencyStat& stat)
+                : stat_(stat)
+                , start_(boost::chrono::steady_clock::now())
+            {}
+
+            ~Scope()
+            {
+                stat_.record(boost::chrono::steady_clock::now() - start_);
+            }
+
+        private:
+            LatencyStat& stat_;
+            boost::chrono::steady_clock::time_point start_;
+        };
+
+    private:
+        struct Window_ {
+            Window_()
+                : epoch(0)
+                , sum(0)
+            {
+                for (size_t i = 0; i < detail::kLatencyBucketCount; i++)
+                    counts[i].store(0, boost::memory_order_relaxed);
+            }
+
+            boost::atomic<std::uint64_t> epoch;
+            boost::atomic<std::uint64_t> counts[detail::kLatencyBucketCount];
+            boost::atomic<std::uint64_t> sum;
+        };
+
+        std::uint64_t currentEpoch_() const
+        {
+            std::uint64_t now = static_cast<std::uint64_t>(boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                boost::chrono::steady_clock::now().time_since_epoch()).count());
+            return now / windowNs_;
+        }
+
+        Window_& windowFor_(std::uint64_t epoch)
+        {
+            Window_& window = windows_[epoch % windows_.size()];
+            if (window.epoch.load(boost::memory_order_acquire) != epoch)
+                reset_(window, epoch);
+            return window;
+        }
+
+        static void reset_(Window_& window, std::uint64_t epoch)
+        {
+            std::uint64_t current = window.epoch.load(boost::memory_order_acquire);
+            while (current < epoch || current == std::numeric_limits<std::uint64_t>::max())
+            {
+                if (window.epoch.compare_exchange_weak(current, epoch, boost::memory_order_acq_rel))
+                {
+                    // only the winner clears, a sample racing with it may be lost on an idle stat
+                    for (size_t i = 0; i < detail::kLatencyBucketCount; i++)
+                        window.counts[i].store(0, boost::memory_order_relaxed);
+                    window.sum.store(0, boost::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+    private:
+        const std::uint64_t windowNs_;
+        std::vector<Window_> windows_;
+        boost::atomic<std::uint64_t> totalCount_;
+        boost::atomic<std::uint64_t> totalSum_;
+        boost::atomic<std::uint64_t> max_;
+    };
+
+} } }
+
+namespace rpos { namespace system { namespace serialization { namespace json {
+
+    /**
+    * Summary of a snapshot, latencies in microseconds
+    */
+    template <>
+    struct Serializer < rpos::system::util::LatencyStatSnapshot >
+    {
+        static Json::Value serialize(const rpos::system::util::LatencyStatSnapshot& v)
+        {
+            Json::Value result;
+            result["count"] = Json::UInt64(v.count());
+            result["mean_us"] = v.mean() / 1000.0;
+            result["min_us"] = v.min() / 1000.0;
+            result["p50_us"] = v.percentile(0.5) / 1000.0;
+            result["p90_us"] = v.percentile(0.9) / 1000.0;
+            result["p99_us"] = v.percentile(0.99) / 1000.0;
+            result["p999_us"] = v.percentile(0.999) / 1000.0;
+            result["max_us"] = v.max() / 1000.0;
+            return result;
+        }
+
+        static rpos::system::util::LatencyStatSnapshot deserialize(const Json::Value&)
+        {
+            throw std::runtime_error("LatencyStatSnapshot can not be deserialized from its summary");
+        }
+    };
+
+} } } }
+
+namespace rpos { namespace system { namespace util {
+
+    /**
+    * Read only inspect value publishing the windowed percentiles of a LatencyStat
+    */
+    class LatencyStatInspectValue : public BaseInspectValue {
+    public:
+        LatencyStatInspectValue(const std::string& key, const LatencyStat& stat)
+            : BaseInspectValue(key)
+            , stat_(stat)
+        {}
+
+        LatencyStatInspectValue(const std::string& key, const std::string& name, const std::string& description, const LatencyStat& stat)
+            : BaseInspectValue(key, name, description)
+            , stat_(stat)
+        {}
+
+    public:
+        virtual Json::Value getValue() const
+        {
+            return rpos::system::serialization::json::serialize(stat_.snapshot());
+        }
+
+        virtual void setValue(const Json::Value&)
+        {}
+
+    private:
+        const LatencyStat& stat_;
+    };
+
+    inline void registerLatencyStat(DebugServer& server, const std::string& key, const LatencyStat& stat)
+    {
+        server.registerBaseInspectValue(boost::shared_ptr<BaseInspectValue>(new LatencyStatInspectValue(key, stat)));
+    }
+
+} } }
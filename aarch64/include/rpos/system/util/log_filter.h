@@ -0,0 +1,389 @@
+/*
+* log_filter.h
+* Compiled per source log filter, a disabled log call costs one atomic load
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "log.h"
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <algorithm>
+#include <cstdarg>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rpos { namespace system { namespace util {
+
+    /**
+    * Level above LogLevelFatal, the effective level of a source nobody listens to
+    */
+    static const int kLogLevelDisabled = LogLevelFatal + 1;
+
+    /**
+    * Resolves LogConfig into an effective level per log source
+    *
+    * Every source is interned once and gets an atomic slot holding the lowest level any appender
+    * would accept from it, taking the global, console, file and diagnosis publisher filters into
+    * account, as well as appenders registered directly (see addLogAppender). The slots are recomputed
+    * eagerly whenever the configuration or the set of appenders changes, so the hot path never
+    * touches the include / exclude lists. Call refresh() after changing the level or source lists of
+    * an appender which is already registered.
+    *
+    * Sources in includeLogSources / excludeLogSources are matched by exact name.
+    */
+    class LogSourceFilter : private boost::noncopyable {
+    public:
+        typedef const boost::atomic<int>* SlotPointer;
+
+    public:
+        LogSourceFilter()
+            : consoleOutput_(true)
+            , generation_(0)
+        {
+            // until configured, behave like an unfiltered debug log
+            config_.global.logLevel = LogLevelDebug;
+            config_.console.logLevel = LogLevelDebug;
+        }
+
+    public:
+        /**
+        * Intern a source, the returned slot stays valid for the lifetime of the filter
+        */
+        SlotPointer intern(const std::string& source)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            auto iter = index_.find(source);
+            if (iter != index_.end())
+                return &iter->second->level;
+
+            entries_.emplace_back();
+            Entry_& entry = entries_.back();
+            entry.source = source;
+            entry.level.store(computeLevel_(source), boost::memory_order_relaxed);
+            index_[source] = &entry;
+            return &entry.level;
+        }
+
+        static bool isEnabled(SlotPointer slot, LogLevel level)
+        {
+            return static_cast<int>(level) >= slot->load(boost::memory_order_relaxed);
+        }
+
+        bool isEnabled(const std::string& source, LogLevel level)
+        {
+            return isEnabled(intern(source), level);
+        }
+
+        /**
+        * Apply the same configuration as LogManager::configWith
+        */
+        void configWith(const LogConfig& config, bool consoleOutputFlag = true)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            config_ = config;
+            consoleOutput_ = consoleOutputFlag;
+            recompute_();
+        }
+
+        /**
+        * Apply the same change as LogManager::updateDiagnosisPublisherAppenders
+        */
+        void updateDiagnosisPublisherAppenders(const std::vector<DiagnosisPublisherLogAppenderConfig>& config)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            config_.diagnosis_publishers = config;
+            recompute_();
+        }
+
+        /**
+        * Take an appender added with LogManager::addAppender into account
+        */
+        void addAppender(const LogAppender::Pointer& appender)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            if (std::find(appenders_.begin(), appenders_.end(), appender) == appenders_.end())
+                appenders_.push_back(appender);
+            recompute_();
+        }
+
+        void removeAppender(const LogAppender::Pointer& appender)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            appenders_.erase(std::remove(appenders_.begin(), appenders_.end(), appender), appenders_.end());
+            recompute_();
+        }
+
+        /**
+        * Apply the same change as LogManager::clearAppenders, which also drops the configured appenders
+        */
+        void clearAppenders()
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            appenders_.clear();
+            consoleOutput_ = false;
+            config_.files.clear();
+            config_.diagnosis_publishers.clear();
+            recompute_();
+        }
+
+        /**
+        * Recompute every slot, e.g. after the level of a registered appender has changed
+        */
+        void refresh()
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            recompute_();
+        }
+
+        /**
+        * Incremented on every configuration change
+        */
+        std::uint32_t generation() const
+        {
+            return generation_.load(boost::memory_order_acquire);
+        }
+
+    public:
+        static LogSourceFilter& defaultFilter()
+        {
+            static LogSourceFilter filter;
+            return filter;
+        }
+
+    private:
+        struct Entry_ {
+            Entry_()
+                : level(LogLevelDebug)
+            {}
+
+            std::string source;
+            boost::atomic<int> level;
+        };
+
+        static bool contains_(const std::vector<std::string>& sources, const std::string& source)
+        {
+            return std::find(sources.begin(), sources.end(), source) != sources.end();
+        }
+
+        static bool accepts_(const LogAppenderConfig& config, const std::string& source)
+        {
+            if (contains_(config.excludeLogSources, source))
+                return false;
+            return config.includeLogSources.empty() || contains_(config.includeLogSources, source);
+        }
+
+        static void lowerTo_(int& level, const LogAppenderConfig& config, const std::string& source)
+        {
+            if (accepts_(config, source))
+                level = std::min(level, static_cast<int>(config.logLevel));
+        }
+
+        int computeLevel_(const std::string& source) const
+        {
+            if (!accepts_(config_.global, source))
+                return kLogLevelDisabled;
+
+            int level = kLogLevelDisabled;
+            if (consoleOutput_)
+                lowerTo_(level, config_.console, source);
+            for (auto iter = config_.files.begin(); iter != config_.files.end(); ++iter)
+                lowerTo_(level, *iter, source);
+            for (auto iter = config_.diagnosis_publishers.begin(); iter != config_.diagnosis_publishers.end(); ++iter)
+                lowerTo_(level, *iter, source);
+            for (auto iter = appenders_.begin(); iter != appenders_.end(); ++iter)
+            {
+                LogAppender& appender = **iter;
+                if (contains_(appender.excludeSources(), source))
+                    continue;
+                if (appender.includeSources().empty() || contains_(appender.includeSources(), source))
+                    level = std::min(level, static_cast<int>(appender.getLogLevel()));
+            }
+            return std::max(level, static_cast<int>(config_.global.logLevel));
+        }
+
+        void recompute_()
+        {
+            for (auto iter = entries_.begin(); iter != entries_.end(); ++iter)
+                iter->level.store(computeLevel_(iter->source), boost::memory_order_relaxed);
+            generation_.fetch_add(1, boost::memory_order_release);
+        }
+
+    private:
+        boost::mutex lock_;
+        LogConfig config_;
+        bool consoleOutput_;
+        // deque keeps element addresses stable, the slots are handed out as raw pointers
+        std::deque<Entry_> entries_;
+        std::unordered_map<std::string, Entry_*> index_;
+        // appenders added outside of LogConfig
+        std::vector<LogAppender::Pointer> appenders_;
+        boost::atomic<std::uint32_t> generation_;
+    };
+
+    /**
+    * Configure a LogManager and the filter with the same configuration
+    */
+    inline void configureLogging(LogManager& manager, const LogConfig& config, std::string appName = std::string(), bool consoleOutputFlag = true
+        , LogSourceFilter& filter = LogSourceFilter::defaultFilter())
+    {
+        manager.configWith(config, appName, consoleOutputFlag);
+        filter.configWith(config, consoleOutputFlag);
+    }
+
+    /**
+    * Update the diagnosis publisher appenders of a LogManager and the filter together
+    */
+    inline void updateDiagnosisPublisherLogging(LogManager& manager, const std::vector<DiagnosisPublisherLogAppenderConfig>& config
+        , const std::vector<std::string>& reserveTopics, const std::string& defaultTopicPrefix
+        , LogSourceFilter& filter = LogSourceFilter::defaultFilter())
+    {
+        manager.updateDiagnosisPublisherAppenders(config, reserveTopics, defaultTopicPrefix);
+        filter.updateDiagnosisPublisherAppenders(config);
+    }
+
+    /**
+    * Add an appender to a LogManager and the filter together
+    */
+    inline void addLogAppender(LogManager& manager, const LogAppender::Pointer& appender
+        , LogSourceFilter& filter = LogSourceFilter::defaultFilter())
+    {
+        manager.addAppender(appender);
+        filter.addAppender(appender);
+    }
+
+    inline void removeLogAppender(LogManager& manager, const LogAppender::Pointer& appender
+        , LogSourceFilter& filter = LogSourceFilter::defaultFilter())
+    {
+        manager.removeAppender(appender);
+        filter.removeAppender(appender);
+    }
+
+    inline void clearLogAppenders(LogManager& manager, LogSourceFilter& filter = LogSourceFilter::defaultFilter())
+    {
+        manager.clearAppenders();
+        filter.clearAppenders();
+    }
+
+    /**
+    * Drop-in replacement of LogScope for hot paths
+    *
+    * The source is interned on construction, every call first checks the cached effective level
+    * (one relaxed atomic load) and only formats and forwards to rpos::system::util::vlog when some
+    * appender will accept the line.
+    */
+    class FilteredLogScope : private boost::noncopyable {
+    public:
+        explicit FilteredLogScope(const std::string& source, LogSourceFilter& filter = LogSourceFilter::defaultFilter())
+            : source_(source)
+            , slot_(filter.intern(source))
+        {}
+
+    public:
+        bool isEnabled(LogLevel level) const
+        {
+            return LogSourceFilter::isEnabled(slot_, level);
+        }
+
+        void vlog(LogLevel level, const char* msg, va_list args)
+        {
+            if (isEnabled(level))
+                rpos::system::util::vlog(source_.c_str(), level, msg, args);
+        }
+
+        void log(LogLevel level, const char* msg, ...)
+        {
+            if (!isEnabled(level))
+                return;
+            va_list args;
+            va_start(args, msg);
+            rpos::system::util::vlog(source_.c_str(), level, msg, args);
+            va_end(args);
+        }
+
+        void log(LogLevel level, JsonValue_UniquePtr& upJsnLog)
+        {
+            if (isEnabled(level))
+                rpos::system::util::log(source_, level, upJsnLog);
+        }
+
+        void vdebug_out(const char* msg, va_list args) { vlog(LogLevelDebug, msg, args); }
+        void  debug_out(const char* msg, ...)
+        {
+            if (!isEnabled(LogLevelDebug))
+                return;
+            va_list args;
+            va_start(args, msg);
+            rpos::system::util::vlog(source_.c_str(), LogLevelDebug, msg, args);
+            va_end(args);
+        }
+        void  debug_out(JsonValue_UniquePtr& upJsnLog) { log(LogLevelDebug, upJsnLog); }
+
+        void vinfo_out(const char* msg, va_list args) { vlog(LogLevelInfo, msg, args); }
+        void  info_out(const char* msg, ...)
+        {
+            if (!isEnabled(LogLevelInfo))
+                return;
+            va_list args;
+            va_start(args, msg);
+            rpos::system::util::vlog(source_.c_str(), LogLevelInfo, msg, args);
+            va_end(args);
+        }
+        void  info_out(JsonValue_UniquePtr& upJsnLog) { log(LogLevelInfo, upJsnLog); }
+
+        void vwarn_out(const char* msg, va_list args) { vlog(LogLevelWarn, msg, args); }
+        void  warn_out(const char* msg, ...)
+        {
+            if (!isEnabled(LogLevelWarn))
+                return;
+            va_list args;
+            va_start(args, msg);
+            rpos::system::util::vlog(source_.c_str(), LogLevelWarn, msg, args);
+            va_end(args);
+        }
+        void  warn_out(JsonValue_UniquePtr& upJsnLog) { log(LogLevelWarn, upJsnLog); }
+
+        void verror_out(const char* msg, va_list args) { vlog(LogLevelError, msg, args); }
+        void  error_out(const char* msg, ...)
+        {
+            if (!isEnabled(LogLevelError))
+                return;
+            va_list args;
+            va_start(args, msg);
+            rpos::system::util::vlog(source_.c_str(), LogLevelError, msg, args);
+            va_end(args);
+        }
+        void  error_out(JsonValue_UniquePtr& upJsnLog) { log(LogLevelError, upJsnLog); }
+
+        void vfatal_out(const char* msg, va_list args) { vlog(LogLevelFatal, msg, args); }
+        void  fatal_out(const char* msg, ...)
+        {
+            if (!isEnabled(LogLevelFatal))
+                return;
+            va_list args;
+            va_start(args, msg);
+            rpos::system::util::vlog(source_.c_str(), LogLevelFatal, msg, args);
+            va_end(args);
+        }
+        void  fatal_out(JsonValue_UniquePtr& upJsnLog) { log(LogLevelFatal, upJsnLog); }
+
+    public:
+        const std::string& getSource() const
+        {
+            return source_;
+        }
+
+    private:
+        const std::string source_;
+        LogSourceFilter::SlotPointer slot_;
+    };
+
+} } }
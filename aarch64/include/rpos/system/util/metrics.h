@@ -0,0 +1,625 @@
+/*
+* metrics.h
+* Counters, gauges and histograms exported in OpenMetrics text format
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "debug_server.h"
+#include "latency_stat.h"
+
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rpos { namespace system { namespace util {
+
+    typedef std::vector<std::pair<std::string, std::string> > MetricLabels;
+
+    enum MetricType {
+        MetricTypeCounter,
+        MetricTypeGauge,
+        MetricTypeHistogram,
+        MetricTypeSummary
+    };
+
+    namespace detail {
+
+        inline std::uint64_t metricDoubleToBits(double v)
+        {
+            std::uint64_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            return bits;
+        }
+
+        inline double metricBitsToDouble(std::uint64_t bits)
+        {
+            double v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+
+        /**
+        * Shortest round trip representation, integral values keep a ".0" as OpenMetrics recommends
+        */
+        inline void appendMetricValue(std::string& out, double v)
+        {
+            if (std::isnan(v))
+            {
+                out += "NaN";
+                return;
+            }
+            if (std::isinf(v))
+            {
+                out += v > 0 ? "+Inf" : "-Inf";
+                return;
+            }
+
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%.15g", v);
+            if (strtod(buffer, nullptr) != v)
+                snprintf(buffer, sizeof(buffer), "%.17g", v);
+            out += buffer;
+            if (!strpbrk(buffer, ".eE"))
+                out += ".0";
+        }
+
+        inline void appendMetricValue(std::string& out, std::uint64_t v)
+        {
+            char buffer[24];
+            snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(v));
+            out += buffer;
+        }
+
+        inline void appendEscaped(std::string& out, const std::string& text, bool escapeQuote)
+        {
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                char c = text[i];
+                if (c == '\\')
+                    out += "\\\\";
+                else if (c == '\n')
+                    out += "\\n";
+                else if (c == '"' && escapeQuote)
+                    out += "\\\"";
+                else
+                    out += c;
+            }
+        }
+
+        inline std::string formatMetricLabels(const MetricLabels& labels)
+        {
+            std::string result;
+            for (size_t i = 0; i < labels.size(); i++)
+            {
+                if (i)
+                    result += ',';
+                result += labels[i].first;
+                result += "=\"";
+                appendEscaped(result, labels[i].second, true);
+                result += '"';
+            }
+            return result;
+        }
+
+        /**
+        * Append one sample line: <name><suffix>{<labels>,<extraLabel>} <value>
+        */
+        template < class ValueT >
+        inline void appendMetricSample(std::string& out, const std::string& name, const char* suffix, const std::string& labels, const std::string& extraLabel, ValueT value)
+        {
+            out += name;
+            out += suffix;
+            if (!labels.empty() || !extraLabel.empty())
+            {
+                out += '{';
+                out += labels;
+                if (!labels.empty() && !extraLabel.empty())
+                    out += ',';
+                out += extraLabel;
+                out += '}';
+            }
+            out += ' ';
+            appendMetricValue(out, value);
+            out += '\n';
+        }
+
+    }
+
+    /**
+    * Base of all metrics, the render methods must only read atomics
+    */
+    class Metric : private boost::noncopyable {
+    public:
+        virtual ~Metric()
+        {}
+
+    public:
+        virtual MetricType type() const = 0;
+
+        /**
+        * Append the samples of this series
+        *
+        * @param name   Family name
+        * @param labels Formatted labels of this series (without braces), may be empty
+        */
+        virtual void render(std::string& out, const std::string& name, const std::string& labels) const = 0;
+    };
+
+    /**
+    * Monotonic counter, exported as <name>_total
+    */
+    class MetricCounter : public Metric {
+    public:
+        MetricCounter()
+            : value_(0)
+        {}
+
+    public:
+        void inc(std::uint64_t delta = 1)
+        {
+            value_.fetch_add(delta, boost::memory_order_relaxed);
+        }
+
+        std::uint64_t value() const
+        {
+            return value_.load(boost::memory_order_relaxed);
+        }
+
+        virtual MetricType type() const
+        {
+            return MetricTypeCounter;
+        }
+
+        virtual void render(std::string& out, const std::string& name, const std::string& labels) const
+        {
+            detail::appendMetricSample(out, name, "_total", labels, std::string(), value());
+        }
+
+    private:
+        boost::atomic<std::uint64_t> value_;
+    };
+
+    class MetricGauge : public Metric {
+    public:
+        MetricGauge()
+            : bits_(detail::metricDoubleToBits(0.0))
+        {}
+
+    public:
+        void set(double v)
+        {
+            bits_.store(detail::metricDoubleToBits(v), boost::memory_order_relaxed);
+        }
+
+        void add(double delta)
+        {
+            std::uint64_t current = bits_.load(boost::memory_order_relaxed);
+            while (!bits_.compare_exchange_weak(current, detail::metricDoubleToBits(detail::metricBitsToDouble(current) + delta), boost::memory_order_relaxed))
+                ;
+        }
+
+        void inc()
+        {
+            add(1.0);
+        }
+
+        void dec()
+        {
+            add(-1.0);
+        }
+
+        double value() const
+        {
+            return detail::metricBitsToDouble(bits_.load(boost::memory_order_relaxed));
+        }
+
+        virtual MetricType type() const
+        {
+            return MetricTypeGauge;
+        }
+
+        virtual void render(std::string& out, const std::string& name, const std::string& labels) const
+        {
+            detail::appendMetricSample(out, name, "", labels, std::string(), value());
+        }
+
+    private:
+        boost::atomic<std::uint64_t> bits_;
+    };
+
+    /**
+    * Gauge evaluated on every scrape, the callback runs on the exporting thread
+    */
+    class MetricCallbackGauge : public Metric {
+    public:
+        explicit MetricCallbackGauge(boost::function<double()> callback)
+            : callback_(callback)
+        {}
+
+    public:
+        virtual MetricType type() const
+        {
+            return MetricTypeGauge;
+        }
+
+        virtual void render(std::string& out, const std::string& name, const std::string& labels) const
+        {
+            detail::appendMetricSample(out, name, "", labels, std::string(), callback_());
+        }
+
+    private:
+        boost::function<double()> callback_;
+    };
+
+    /**
+    * Cumulative histogram with fixed upper bounds
+    */
+    class MetricHistogram : public Metric {
+    public:
+        /**
+        * @param bounds Bucket upper bounds, sorted and de-duplicated here, +Inf is implicit
+        */
+        explicit MetricHistogram(std::vector<double> bounds)
+            : bounds_(bounds)
+            , sumBits_(detail::metricDoubleToBits(0.0))
+        {
+            std::sort(bounds_.begin(), bounds_.end());
+            bounds_.erase(std::unique(bounds_.begin(), bounds_.end()), bounds_.end());
+            while (!bounds_.empty() && std::isinf(bounds_.back()))
+                bounds_.pop_back();
+
+            counts_.reset(new boost::atomic<std::uint64_t>[bounds_.size() + 1]);
+            for (size_t i = 0; i <= bounds_.size(); i++)
+                counts_[i].store(0, boost::memory_order_relaxed);
+        }
+
+    public:
+        void observe(double v)
+        {
+            size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin();
+            counts_[bucket].fetch_add(1, boost::memory_order_relaxed);
+
+            std::uint64_t current = sumBits_.load(boost::memory_order_relaxed);
+            while (!sumBits_.compare_exchange_weak(current, detail::metricDoubleToBits(detail::metricBitsToDouble(current) + v), boost::memory_order_relaxed))
+                ;
+        }
+
+        const std::vector<double>& bounds() const
+        {
+            return bounds_;
+        }
+
+        virtual MetricType type() const
+        {
+            return MetricTypeHistogram;
+        }
+
+        virtual void render(std::string& out, const std::string& name, const std::string& labels) const
+        {
+            std::uint64_t cumulative = 0;
+            std::string le;
+            for (size_t i = 0; i <= bounds_.size(); i++)
+            {
+                cumulative += counts_[i].load(boost::memory_order_relaxed);
+                le = "le=\"";
+                detail::appendMetricValue(le, i < bounds_.size() ? bounds_[i] : HUGE_VAL);
+                le += '"';
+                detail::appendMetricSample(out, name, "_bucket", labels, le, cumulative);
+            }
+            detail::appendMetricSample(out, name, "_count", labels, std::string(), cumulative);
+            detail::appendMetricSample(out, name, "_sum", labels, std::string(), detail::metricBitsToDouble(sumBits_.load(boost::memory_order_relaxed)));
+        }
+
+    public:
+        static std::vector<double> linearBounds(double start, double width, size_t count)
+        {
+            std::vector<double> result;
+            for (size_t i = 0; i < count; i++)
+                result.push_back(start + width * i);
+            return result;
+        }
+
+        static std::vector<double> exponentialBounds(double start, double factor, size_t count)
+        {
+            std::vector<double> result;
+            for (size_t i = 0; i < count; i++, start *= factor)
+                result.push_back(start);
+            return result;
+        }
+
+    private:
+        std::vector<double> bounds_;
+        boost::scoped_array<boost::atomic<std::uint64_t> > counts_;
+        boost::atomic<std::uint64_t> sumBits_;
+    };
+
+    /**
+    * LatencyStat exported as a summary in seconds: windowed quantiles, count and sum since start
+    */
+    class MetricLatencySummary : public Metric {
+    public:
+        explicit MetricLatencySummary(boost::shared_ptr<LatencyStat> stat)
+            : stat_(stat)
+        {}
+
+    public:
+        boost::shared_ptr<LatencyStat> stat() const
+        {
+            return stat_;
+        }
+
+        virtual MetricType type() const
+        {
+            return MetricTypeSummary;
+        }
+
+        virtual void render(std::string& out, const std::string& name, const std::string& labels) const
+        {
+            static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+            LatencyStatSnapshot snapshot = stat_->snapshot();
+            std::string quantile;
+            for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++)
+            {
+                quantile = "quantile=\"";
+                detail::appendMetricValue(quantile, quantiles[i]);
+                quantile += '"';
+                detail::appendMetricSample(out, name, "", labels, quantile, snapshot.percentile(quantiles[i]) / 1e9);
+            }
+            detail::appendMetricSample(out, name, "_count", labels, std::string(), stat_->totalCount());
+            detail::appendMetricSample(out, name, "_sum", labels, std::string(), stat_->totalSum() / 1e9);
+        }
+
+    private:
+        boost::shared_ptr<LatencyStat> stat_;
+    };
+
+    /**
+    * Registry of metric families
+    *
+    * Registration takes a lock and is meant for start up or the first use of a label set. The
+    * returned metric objects are updated with relaxed atomics only, and render() reads the same
+    * atomics, so a scrape never blocks the threads producing the values.
+    */
+    class MetricsRegistry : private boost::noncopyable {
+    public:
+        MetricsRegistry()
+            : lastRenderSize_(0)
+        {}
+
+    public:
+        static const char* contentType()
+        {
+            return "application/openmetrics-text; version=1.0.0; charset=utf-8";
+        }
+
+    public:
+        /**
+        * Get or create a series, repeated calls with the same name and labels return the same object
+        *
+        * @throw std::runtime_error if the name is already registered with another type
+        */
+        boost::shared_ptr<MetricCounter> counter(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels())
+        {
+            return getOrCreate_<MetricCounter>(name, help, MetricTypeCounter, labels, [] { return new MetricCounter(); });
+        }
+
+        boost::shared_ptr<MetricGauge> gauge(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels())
+        {
+            return getOrCreate_<MetricGauge>(name, help, MetricTypeGauge, labels, [] { return new MetricGauge(); });
+        }
+
+        boost::shared_ptr<MetricCallbackGauge> callbackGauge(const std::string& name, const std::string& help, boost::function<double()> callback, const MetricLabels& labels = MetricLabels())
+        {
+            return getOrCreate_<MetricCallbackGauge>(name, help, MetricTypeGauge, labels, [&callback] { return new MetricCallbackGauge(callback); });
+        }
+
+        boost::shared_ptr<MetricHistogram> histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds, const MetricLabels& labels = MetricLabels())
+        {
+            return getOrCreate_<MetricHistogram>(name, help, MetricTypeHistogram, labels, [&bounds] { return new MetricHistogram(bounds); });
+        }
+
+        /**
+        * Get or create a LatencyStat exported as a summary
+        */
+        boost::shared_ptr<LatencyStat> latency(const std::string& name, const std::string& help, const MetricLabels& labels = MetricLabels())
+        {
+            return getOrCreate_<MetricLatencySummary>(name, help, MetricTypeSummary, labels
+                , [] { return new MetricLatencySummary(boost::shared_ptr<LatencyStat>(new LatencyStat())); })->stat();
+        }
+
+        /**
+        * Export an existing LatencyStat as a summary
+        */
+        void addLatency(const std::string& name, const std::string& help, boost::shared_ptr<LatencyStat> stat, const MetricLabels& labels = MetricLabels())
+        {
+            add(name, help, boost::shared_ptr<Metric>(new MetricLatencySummary(stat)), labels);
+        }
+
+        /**
+        * Add a custom metric, replacing any series with the same name and labels
+        */
+        void add(const std::string& name, const std::string& help, boost::shared_ptr<Metric> metric, const MetricLabels& labels = MetricLabels())
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            Family_& family = family_(name, help, metric->type());
+            std::string formatted = detail::formatMetricLabels(labels);
+            for (auto iter = family.series.begin(); iter != family.series.end(); ++iter)
+            {
+                if (iter->first == formatted)
+                {
+                    iter->second = metric;
+                    return;
+                }
+            }
+            family.series.push_back(std::make_pair(formatted, metric));
+        }
+
+        void remove(const std::string& name, const MetricLabels& labels = MetricLabels())
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            std::string formatted = detail::formatMetricLabels(labels);
+            for (auto family = families_.begin(); family != families_.end(); ++family)
+            {
+                if (family->name != name)
+                    continue;
+                for (auto iter = family->series.begin(); iter != family->series.end(); ++iter)
+                {
+                    if (iter->first == formatted)
+                    {
+                        family->series.erase(iter);
+                        break;
+                    }
+                }
+                if (family->series.empty())
+                    families_.erase(family);
+                return;
+            }
+        }
+
+        /**
+        * Render all families in OpenMetrics text format, terminated by "# EOF"
+        */
+        std::string render() const
+        {
+            // copy the series under the lock and render without it, so callback gauges and slow
+            // metrics neither block registration nor deadlock when they use the registry themselves
+            std::vector<Family_> families;
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                families = families_;
+            }
+
+            std::string out;
+            out.reserve(lastRenderSize_.load(boost::memory_order_relaxed) + 256);
+            for (auto family = families.begin(); family != families.end(); ++family)
+            {
+                out += "# TYPE ";
+                out += family->name;
+                out += ' ';
+                out += typeName_(family->type);
+                out += '\n';
+                if (!family->help.empty())
+                {
+                    out += "# HELP ";
+                    out += family->name;
+                    out += ' ';
+                    // OpenMetrics escapes quotes in HELP text like in label values
+                    detail::appendEscaped(out, family->help, true);
+                    out += '\n';
+                }
+                for (auto iter = family->series.begin(); iter != family->series.end(); ++iter)
+                    iter->second->render(out, family->name, iter->first);
+            }
+            out += "# EOF\n";
+            lastRenderSize_.store(out.size(), boost::memory_order_relaxed);
+            return out;
+        }
+
+    public:
+        static MetricsRegistry& defaultRegistry()
+        {
+            static MetricsRegistry registry;
+            return registry;
+        }
+
+    private:
+        struct Family_ {
+            std::string name;
+            std::string help;
+            MetricType type;
+            std::vector<std::pair<std::string, boost::shared_ptr<Metric> > > series;
+        };
+
+        static const char* typeName_(MetricType type)
+        {
+            switch (type)
+            {
+            case MetricTypeCounter:
+                return "counter";
+            case MetricTypeGauge:
+                return "gauge";
+            case MetricTypeHistogram:
+                return "histogram";
+            case MetricTypeSummary:
+                return "summary";
+            default:
+                return "unknown";
+            }
+        }
+
+        Family_& family_(const std::string& name, const std::string& help, MetricType type)
+        {
+            for (auto family = families_.begin(); family != families_.end(); ++family)
+            {
+                if (family->name != name)
+                    continue;
+                if (family->type != type)
+                    throw std::runtime_error("metric " + name + " is already registered as " + typeName_(family->type));
+                return *family;
+            }
+
+            families_.push_back(Family_());
+            Family_& family = families_.back();
+            family.name = name;
+            family.help = help;
+            family.type = type;
+            return family;
+        }
+
+        template < class MetricT, class FactoryT >
+        boost::shared_ptr<MetricT> getOrCreate_(const std::string& name, const std::string& help, MetricType type, const MetricLabels& labels, FactoryT factory)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            Family_& family = family_(name, help, type);
+            std::string formatted = detail::formatMetricLabels(labels);
+            for (auto iter = family.series.begin(); iter != family.series.end(); ++iter)
+            {
+                if (iter->first != formatted)
+                    continue;
+                boost::shared_ptr<MetricT> existing = boost::dynamic_pointer_cast<MetricT>(iter->second);
+                if (!existing)
+                    throw std::runtime_error("metric " + name + " is already registered with another implementation");
+                return existing;
+            }
+
+            boost::shared_ptr<MetricT> metric(factory());
+            family.series.push_back(std::make_pair(formatted, boost::shared_ptr<Metric>(metric)));
+            return metric;
+        }
+
+    private:
+        mutable boost::mutex lock_;
+        std::vector<Family_> families_;
+        mutable boost::atomic<size_t> lastRenderSize_;
+    };
+
+    /**
+    * Register a "metrics" debug command returning the OpenMetrics text of the registry
+    */
+    inline void registerMetricsCommand(DebugServer& server, MetricsRegistry& registry = MetricsRegistry::defaultRegistry(), const std::string& key = "metrics")
+    {
+        MetricsRegistry* target = &registry;
+        server.registerDebugCommand<Json::Value, std::string>(key
+            , boost::function<std::string(const Json::Value&)>([target](const Json::Value&) { return target->render(); }));
+    }
+
+} } }
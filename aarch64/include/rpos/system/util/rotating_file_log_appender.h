@@ -0,0 +1,449 @@
+/*
+* rotating_file_log_appender.h
+* Buffered, size rotated log file appender with background gzip compaction and time based retention
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "log_queue.h"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#   include <io.h>
+#   include <fcntl.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace rpos { namespace system { namespace util {
+
+    struct RotatingFileLogAppenderOptions {
+        RotatingFileLogAppenderOptions()
+            : logLevel(LogLevelDebug)
+            , append(true)
+            , maxFileSizeMB(1)
+            , maxBackupIndex(5)
+            , compress(true)
+            , compressionLevel(6)
+            , retentionSeconds(0)
+            , bufferSize(1024 * 1024)
+            , fsyncIntervalMs(5000)
+        {}
+
+        LogLevel logLevel;
+        bool append;
+        // rotate when the active file reaches this size
+        uint16_t maxFileSizeMB;
+        // keep at most this many rotated segments: <filename>.1[.gz] (newest) to <filename>.<maxBackupIndex>[.gz]
+        uint16_t maxBackupIndex;
+        // gzip rotated segments on the compaction thread
+        bool compress;
+        int compressionLevel;
+        // also delete rotated segments older than this, 0 to keep them until maxBackupIndex pushes them out
+        int retentionSeconds;
+        // lines are collected in memory and written when this much is pending or on flush
+        size_t bufferSize;
+        // fsync the active file at most this often, 0 to never fsync explicitly
+        int fsyncIntervalMs;
+    };
+
+    /**
+    * Log file appender for long running devices
+    *
+    * - Lines use the BatchFileLogAppender text layout and are written in large chunks
+    * - The active file is fsynced periodically instead of per line
+    * - Rotation only fsyncs and renames the active file on the logging thread; compressing the segment,
+    *   shifting the numbered backups and applying retention happen on a dedicated compaction thread
+    * - If the rename fails the active file is kept and appended to, never truncated
+    * - Segments left behind by a crash are picked up and compacted on the next start
+    *
+    * Intended to be fed by AsyncLogQueue or BinaryLogger, append_ is called from a single thread.
+    */
+    class RotatingFileLogAppender : public LogBatchAppender {
+    public:
+        explicit RotatingFileLogAppender(const std::string& filename, const RotatingFileLogAppenderOptions& options = RotatingFileLogAppenderOptions())
+            : LogBatchAppender(options.logLevel)
+            , filename_(filename)
+            , options_(options)
+            , fd_(-1)
+            , fileSize_(0)
+            , rotateSize_(static_cast<std::uint64_t>(options.maxFileSizeMB) * 1024 * 1024)
+            , lastSync_(boost::chrono::steady_clock::now())
+            , pendingSequence_(0)
+            , compacting_(false)
+            , stop_(false)
+        {
+            if (filename_.has_parent_path())
+            {
+                boost::system::error_code ec;
+                boost::filesystem::create_directories(filename_.parent_path(), ec);
+            }
+            buffer_.reserve(options_.bufferSize + 4096);
+            open_(options_.append);
+
+            std::vector<boost::filesystem::path> leftovers = leftoverSegments_();
+            pendingSegments_.assign(leftovers.begin(), leftovers.end());
+            compactionThread_ = boost::thread(boost::bind(&RotatingFileLogAppender::compactionWorker_, this));
+        }
+
+        virtual ~RotatingFileLogAppender()
+        {
+            flush();
+            sync_();
+            close_();
+            {
+                boost::lock_guard<boost::mutex> guard(compactionLock_);
+                stop_ = true;
+            }
+            compactionCond_.notify_all();
+            compactionThread_.join();
+        }
+
+    public:
+        bool isAvailable() const
+        {
+            return fd_ >= 0;
+        }
+
+        /**
+        * Write the buffered lines, fsync if the interval has elapsed
+        */
+        virtual void flush()
+        {
+            writeBuffer_();
+            if (options_.fsyncIntervalMs > 0 && boost::chrono::steady_clock::now() - lastSync_ >= boost::chrono::milliseconds(options_.fsyncIntervalMs))
+                sync_();
+        }
+
+        /**
+        * Block until every rotated segment has been compacted
+        */
+        void waitForCompaction()
+        {
+            boost::unique_lock<boost::mutex> guard(compactionLock_);
+            while (!pendingSegments_.empty() || compacting_)
+                compactionIdle_.wait(guard);
+        }
+
+    protected:
+        virtual void append_(const std::vector<const LogRecord*>& records)
+        {
+            for (auto iter = records.begin(); iter != records.end(); ++iter)
+            {
+                const LogRecord& record = **iter;
+                timeFormatter_.format(record.timestamp, buffer_);
+                buffer_.append(" [");
+                buffer_.append(logLevelName(record.level));
+                buffer_.append("] [");
+                buffer_.append(record.source);
+                buffer_.append("] ");
+                buffer_.append(record.message);
+                buffer_.push_back('\n');
+
+                if (buffer_.size() >= options_.bufferSize)
+                    writeBuffer_();
+            }
+        }
+
+    private:
+        void open_(bool append)
+        {
+#ifdef _WIN32
+            fd_ = _open(filename_.string().c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | (append ? _O_APPEND : _O_TRUNC), 0644);
+#else
+            fd_ = ::open(filename_.string().c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+#endif
+            boost::system::error_code ec;
+            std::uintmax_t size = boost::filesystem::file_size(filename_, ec);
+            fileSize_ = ec ? 0 : static_cast<std::uint64_t>(size);
+        }
+
+        void close_()
+        {
+            if (fd_ < 0)
+                return;
+#ifdef _WIN32
+            _close(fd_);
+#else
+            ::close(fd_);
+#endif
+            fd_ = -1;
+        }
+
+        void sync_()
+        {
+            if (fd_ >= 0)
+            {
+#ifdef _WIN32
+                _commit(fd_);
+#else
+                ::fsync(fd_);
+#endif
+            }
+            lastSync_ = boost::chrono::steady_clock::now();
+        }
+
+        void writeBuffer_()
+        {
+            if (buffer_.empty())
+                return;
+
+            const char* p = buffer_.data();
+            size_t left = buffer_.size();
+            while (fd_ >= 0 && left)
+            {
+#ifdef _WIN32
+                int n = _write(fd_, p, static_cast<unsigned int>(left));
+#else
+                ssize_t n = ::write(fd_, p, left);
+#endif
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    break;
+                }
+                p += n;
+                left -= static_cast<size_t>(n);
+            }
+            fileSize_ += buffer_.size() - left;
+            buffer_.clear();
+
+            if (options_.maxFileSizeMB && fileSize_ >= rotateSize_)
+                rotate_();
+        }
+
+        void rotate_()
+        {
+            // the segment must be durable before it leaves the active name, flush() may not have synced it yet
+            sync_();
+            close_();
+
+            // a rename is all the logging thread does, the rest is left to the compaction thread
+            boost::filesystem::path segment = pendingPath_(pendingSequence_++);
+            boost::system::error_code ec;
+            boost::filesystem::rename(filename_, segment, ec);
+            std::uint64_t maxFileSize = static_cast<std::uint64_t>(options_.maxFileSizeMB) * 1024 * 1024;
+            if (ec)
+            {
+                // nothing was moved, keep appending to the file and try again after another maxFileSizeMB
+                open_(true);
+                rotateSize_ = fileSize_ + maxFileSize;
+                return;
+            }
+            open_(false);
+            rotateSize_ = maxFileSize;
+
+            {
+                boost::lock_guard<boost::mutex> guard(compactionLock_);
+                pendingSegments_.push_back(segment);
+            }
+            compactionCond_.notify_all();
+        }
+
+        boost::filesystem::path pendingPath_(std::uint64_t sequence) const
+        {
+            char suffix[48];
+            snprintf(suffix, sizeof(suffix), ".pending-%lld-%06llu", static_cast<long long>(time(nullptr)), static_cast<unsigned long long>(sequence));
+            boost::filesystem::path path = filename_;
+            path += suffix;
+            return path;
+        }
+
+        boost::filesystem::path backupPath_(int index, bool compressed) const
+        {
+            boost::filesystem::path path = filename_;
+            path += "." + std::to_string(index);
+            if (compressed)
+                path += ".gz";
+            return path;
+        }
+
+        /**
+        * Segments of a previous run which were rotated but never compacted, oldest first.
+        * Half written compressed files are removed
+        */
+        std::vector<boost::filesystem::path> leftoverSegments_() const
+        {
+            std::vector<boost::filesystem::path> result;
+            boost::filesystem::path folder = filename_.has_parent_path() ? filename_.parent_path() : boost::filesystem::path(".");
+            std::string prefix = filename_.filename().string() + ".pending-";
+
+            boost::system::error_code ec;
+            boost::filesystem::directory_iterator iter(folder, ec), end;
+            for (; !ec && iter != end; iter.increment(ec))
+            {
+                std::string name = iter->path().filename().string();
+                if (name.compare(0, prefix.size(), prefix) != 0)
+                    continue;
+
+                if (iter->path().extension() == ".tmp")
+                {
+                    boost::system::error_code removeEc;
+                    boost::filesystem::remove(iter->path(), removeEc);
+                }
+                else
+                {
+                    result.push_back(iter->path());
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        void compactionWorker_()
+        {
+            applyRetention_();
+            for (;;)
+            {
+                boost::filesystem::path segment;
+                {
+                    boost::unique_lock<boost::mutex> guard(compactionLock_);
+                    while (pendingSegments_.empty() && !stop_)
+                    {
+                        if (options_.retentionSeconds <= 0)
+                        {
+                            compactionCond_.wait(guard);
+                            continue;
+                        }
+
+                        // wake up periodically so retention also applies while no rotation happens
+                        if (compactionCond_.wait_for(guard, boost::chrono::seconds(std::min(options_.retentionSeconds, 60))) == boost::cv_status::timeout)
+                        {
+                            guard.unlock();
+                            applyRetention_();
+                            guard.lock();
+                        }
+                    }
+                    if (pendingSegments_.empty())
+                        break;
+                    segment = pendingSegments_.front();
+                    pendingSegments_.pop_front();
+                    compacting_ = true;
+                }
+
+                compactSegment_(segment);
+                applyRetention_();
+
+                {
+                    boost::lock_guard<boost::mutex> guard(compactionLock_);
+                    compacting_ = false;
+                }
+                compactionIdle_.notify_all();
+            }
+        }
+
+        void compactSegment_(const boost::filesystem::path& segment)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::path source = segment;
+            bool compressed = false;
+
+            if (options_.compress)
+            {
+                boost::filesystem::path temp = segment;
+                temp += ".gz.tmp";
+                try
+                {
+                    std::ifstream in(segment.string().c_str(), std::ios_base::in | std::ios_base::binary);
+                    boost::iostreams::filtering_ostream out;
+                    out.push(boost::iostreams::gzip_compressor(boost::iostreams::gzip_params(options_.compressionLevel)));
+                    out.push(boost::iostreams::file_sink(temp.string(), std::ios_base::out | std::ios_base::binary));
+                    boost::iostreams::copy(in, out);
+                    source = temp;
+                    compressed = true;
+                }
+                catch (const std::exception&)
+                {
+                    // keep the plain segment rather than losing it
+                    boost::filesystem::remove(temp, ec);
+                }
+            }
+
+            if (options_.maxBackupIndex == 0)
+            {
+                boost::filesystem::remove(source, ec);
+                boost::filesystem::remove(segment, ec);
+                return;
+            }
+
+            // shift <filename>.N[.gz] to <filename>.N+1[.gz], dropping the oldest
+            boost::filesystem::remove(backupPath_(options_.maxBackupIndex, true), ec);
+            boost::filesystem::remove(backupPath_(options_.maxBackupIndex, false), ec);
+            for (int i = options_.maxBackupIndex - 1; i >= 1; i--)
+            {
+                boost::filesystem::rename(backupPath_(i, true), backupPath_(i + 1, true), ec);
+                boost::filesystem::rename(backupPath_(i, false), backupPath_(i + 1, false), ec);
+            }
+
+            boost::filesystem::rename(source, backupPath_(1, compressed), ec);
+            if (compressed)
+                boost::filesystem::remove(segment, ec);
+        }
+
+        void applyRetention_()
+        {
+            if (options_.retentionSeconds <= 0)
+                return;
+
+            std::time_t deadline = std::time(nullptr) - options_.retentionSeconds;
+            boost::system::error_code ec;
+            for (int i = 1; i <= options_.maxBackupIndex; i++)
+            {
+                for (int compressed = 0; compressed < 2; compressed++)
+                {
+                    boost::filesystem::path path = backupPath_(i, compressed != 0);
+                    std::time_t modified = boost::filesystem::last_write_time(path, ec);
+                    if (!ec && modified < deadline)
+                        boost::filesystem::remove(path, ec);
+                }
+            }
+        }
+
+    private:
+        boost::filesystem::path filename_;
+        RotatingFileLogAppenderOptions options_;
+
+        // logging thread
+        int fd_;
+        std::uint64_t fileSize_;
+        // fileSize_ at which the next rotation is attempted
+        std::uint64_t rotateSize_;
+        std::string buffer_;
+        LogTimeFormatter timeFormatter_;
+        boost::chrono::steady_clock::time_point lastSync_;
+        std::uint64_t pendingSequence_;
+
+        // compaction thread
+        boost::mutex compactionLock_;
+        boost::condition_variable compactionCond_;
+        boost::condition_variable compactionIdle_;
+        std::deque<boost::filesystem::path> pendingSegments_;
+        bool compacting_;
+        bool stop_;
+        boost::thread compactionThread_;
+    };
+
+} } }
@@ -0,0 +1,106 @@
+/*
+* laser_scan_view_test.cpp
+* Laser scan projection against a scalar reference, invalid points and angle tables
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE laser_scan_view
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/core/laser_scan_view.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace rpos::core;
+
+namespace {
+
+    /**
+    * 130 beams over 2 mask words and a partial one, every 7th point invalid
+    */
+    LaserScanBuffer makeScan()
+    {
+        LaserScanBuffer scan;
+        for (int i = 0; i < 130; i++)
+            scan.push_back(0.5f + 0.01f * i, -3.0f + 0.045f * i, i % 7 != 3, static_cast<std::uint8_t>(i));
+        return scan;
+    }
+
+    void referencePoint(const LaserScanBuffer& scan, size_t i, const Pose& pose, double& x, double& y)
+    {
+        double a = scan.angles()[i] + pose.yaw();
+        x = pose.x() + scan.distances()[i] * std::cos(a);
+        y = pose.y() + scan.distances()[i] * std::sin(a);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(projection_matches_the_scalar_reference)
+{
+    LaserScanBuffer scan = makeScan();
+    LaserScanView view = scan.view();
+    Pose pose(Location(1.5, -2.0, 0.0), Rotation(0.7, 0.0, 0.0));
+    LaserAngleTable table(&scan.angles()[0], scan.size());
+    BOOST_CHECK(table.matches(view));
+
+    std::vector<float> xs(scan.size()), ys(scan.size());
+    std::vector<float> tableXs(scan.size()), tableYs(scan.size());
+    projectLaserScan(view, pose, &xs[0], &ys[0]);
+    projectLaserScan(view, table, pose, &tableXs[0], &tableYs[0]);
+
+    for (size_t i = 0; i < scan.size(); i++)
+    {
+        if (!view.valid(i))
+        {
+            BOOST_CHECK(std::isnan(xs[i]) && std::isnan(ys[i]));
+            BOOST_CHECK(std::isnan(tableXs[i]) && std::isnan(tableYs[i]));
+            continue;
+        }
+        double x, y;
+        referencePoint(scan, i, pose, x, y);
+        BOOST_CHECK_SMALL(xs[i] - x, 1e-4);
+        BOOST_CHECK_SMALL(ys[i] - y, 1e-4);
+        BOOST_CHECK_SMALL(tableXs[i] - x, 1e-4);
+        BOOST_CHECK_SMALL(tableYs[i] - y, 1e-4);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(valid_points_are_packed_in_order)
+{
+    LaserScanBuffer scan = makeScan();
+    Pose pose(Location(0.0, 1.0, 0.0), Rotation(-2.0, 0.0, 0.0));
+    std::vector<float> xs(scan.size()), ys(scan.size());
+    size_t count = projectValidLaserPoints(scan.view(), pose, &xs[0], &ys[0]);
+
+    size_t k = 0;
+    for (size_t i = 0; i < scan.size(); i++)
+    {
+        if (!scan.valid(i))
+            continue;
+        double x, y;
+        referencePoint(scan, i, pose, x, y);
+        BOOST_REQUIRE_LT(k, count);
+        BOOST_CHECK_SMALL(xs[k] - x, 1e-4);
+        BOOST_CHECK_SMALL(ys[k] - y, 1e-4);
+        k++;
+    }
+    BOOST_CHECK_EQUAL(count, k);
+    BOOST_CHECK_EQUAL(count, 130u - 19u);
+}
+
+BOOST_AUTO_TEST_CASE(mismatching_table_is_rejected)
+{
+    LaserScanBuffer scan = makeScan();
+    LaserAngleTable shorter(-3.0f, 0.045f, 64);
+    BOOST_CHECK(!shorter.matches(scan.view()));
+
+    std::vector<float> xs(scan.size()), ys(scan.size());
+    BOOST_CHECK_THROW(projectLaserScan(scan.view(), shorter, Pose(), &xs[0], &ys[0]), std::runtime_error);
+
+    LaserScanBuffer empty;
+    BOOST_CHECK(empty.view().empty());
+    BOOST_CHECK_EQUAL(projectValidLaserPoints(empty.view(), Pose(), &xs[0], &ys[0]), 0u);
+}
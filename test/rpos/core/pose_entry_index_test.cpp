@@ -0,0 +1,310 @@
+/*
+* pose_entry_index_test.cpp
+* PoseEntryIndex queries against brute force, PoseEntryIndexCache keys and platform sync
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE pose_entry_index
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/core/pose_entry_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace rpos::core;
+
+namespace {
+
+    PoseEntry entry(const std::string& name, double x, double y)
+    {
+        PoseEntry result;
+        result.name = name;
+        result.pose = Pose(Location(x, y), Rotation(0));
+        return result;
+    }
+
+    std::vector<double> bruteForce(const std::map<std::string, PoseEntry>& entries, double x, double y)
+    {
+        std::vector<double> distances;
+        for (auto iter = entries.begin(); iter != entries.end(); ++iter)
+            distances.push_back(std::hypot(iter->second.pose.x() - x, iter->second.pose.y() - y));
+        std::sort(distances.begin(), distances.end());
+        return distances;
+    }
+
+    std::vector<double> bruteForce(const std::vector<PoseEntry>& entries, double x, double y)
+    {
+        std::vector<double> distances;
+        for (auto iter = entries.begin(); iter != entries.end(); ++iter)
+            distances.push_back(std::hypot(iter->pose.x() - x, iter->pose.y() - y));
+        std::sort(distances.begin(), distances.end());
+        return distances;
+    }
+
+    void checkMatches(const PoseEntryIndex& index, const std::vector<PoseEntry>& entries)
+    {
+        BOOST_REQUIRE_EQUAL(index.size(), entries.size());
+        for (int i = 0; i < 20; i++)
+        {
+            double x = std::rand() % 100 / 10.0, y = std::rand() % 100 / 10.0;
+            std::vector<double> expected = bruteForce(entries, x, y);
+            std::vector<PoseEntryNeighbor> nearest = index.nearest(x, y, entries.size());
+            BOOST_REQUIRE_EQUAL(nearest.size(), expected.size());
+            for (size_t j = 0; j < nearest.size(); j++)
+            {
+                BOOST_CHECK_CLOSE(nearest[j].distance, expected[j], 1e-9);
+                size_t position = std::stoul(*nearest[j].key);
+                BOOST_REQUIRE_LT(position, entries.size());
+                BOOST_CHECK_EQUAL(nearest[j].entry->name, entries[position].name);
+                BOOST_CHECK_EQUAL(nearest[j].entry->pose.x(), entries[position].pose.x());
+                BOOST_CHECK_EQUAL(nearest[j].entry->pose.y(), entries[position].pose.y());
+            }
+        }
+    }
+
+    /**
+    * In memory stand-in for the robot, the POI map is keyed by an id unrelated to the names
+    */
+    struct FakeRobot {
+        FakeRobot()
+            : nextId(1)
+        {}
+
+        PoseEntryMap pois;
+        std::vector<PoseEntry> docks;
+        std::vector<PoseEntry> landmarks;
+        int nextId;
+        Pose current;
+    };
+
+    class FakePlatform {
+    public:
+        explicit FakePlatform(FakeRobot& robot)
+            : robot_(&robot)
+        {}
+
+        PoseEntryMap getPOIs() { return robot_->pois; }
+        bool setPOIs(const PoseEntryMap& pois) { robot_->pois = pois; return true; }
+
+        bool addPOI(const PoseEntry& poi)
+        {
+            robot_->pois["poi-" + std::to_string(robot_->nextId++)] = poi;
+            return true;
+        }
+
+        bool editPOI(const PoseEntry& poi)
+        {
+            for (auto iter = robot_->pois.begin(); iter != robot_->pois.end(); ++iter)
+            {
+                if (iter->second.name == poi.name)
+                {
+                    iter->second = poi;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        PoseEntry addPOIOnCurrentPose(const std::string& name, const Metadata&)
+        {
+            PoseEntry poi;
+            poi.name = name;
+            poi.pose = robot_->current;
+            addPOI(poi);
+            return poi;
+        }
+
+        bool erasePOI(const std::string& name)
+        {
+            for (auto iter = robot_->pois.begin(); iter != robot_->pois.end(); ++iter)
+            {
+                if (iter->second.name == name)
+                {
+                    robot_->pois.erase(iter);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool clearPOIs() { robot_->pois.clear(); return true; }
+
+        std::vector<PoseEntry> getHomeDocks() { return robot_->docks; }
+        bool setHomeDocks(const std::vector<PoseEntry>& docks) { robot_->docks = docks; return true; }
+
+        PoseEntry registerHomeDock(const Metadata&)
+        {
+            PoseEntry dock;
+            dock.name = "dock-" + std::to_string(robot_->nextId++);
+            dock.pose = robot_->current;
+            robot_->docks.push_back(dock);
+            return dock;
+        }
+
+        PoseEntry addHomeDock(const PoseEntry& dock) { robot_->docks.push_back(dock); return dock; }
+        bool editHomeDock(const PoseEntry&) { return true; }
+        bool eraseHomeDock(const std::string&) { return true; }
+        bool clearHomeDocks() { robot_->docks.clear(); return true; }
+
+        std::vector<PoseEntry> getLaserLandmarks()
+        {
+            return robot_->landmarks;
+        }
+
+        bool setLaserLandmarks(const std::vector<PoseEntry>& landmarks) { robot_->landmarks = landmarks; return true; }
+
+        bool removeLaserLandmarks(const std::vector<SegmentID>& ids)
+        {
+            // landmark i has id i
+            std::vector<PoseEntry> kept;
+            for (size_t i = 0; i < robot_->landmarks.size(); i++)
+            {
+                if (std::find(ids.begin(), ids.end(), static_cast<SegmentID>(i)) == ids.end())
+                    kept.push_back(robot_->landmarks[i]);
+            }
+            robot_->landmarks = kept;
+            return true;
+        }
+
+        bool clearLaserLandmarks() { robot_->landmarks.clear(); return true; }
+
+    private:
+        FakeRobot* robot_;
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(queries_match_brute_force_through_updates)
+{
+    std::srand(7);
+    PoseEntryIndex index;
+    std::map<std::string, PoseEntry> reference;
+    for (int step = 0; step < 2000; step++)
+    {
+        std::string name = "e" + std::to_string(std::rand() % 300);
+        if (std::rand() % 4 == 0)
+        {
+            BOOST_CHECK_EQUAL(index.erase(name), reference.erase(name) != 0);
+        }
+        else
+        {
+            PoseEntry e = entry(name, std::rand() % 1000 / 10.0, std::rand() % 1000 / 10.0);
+            index.insert(e);
+            reference[name] = e;
+        }
+
+        if (step % 50)
+            continue;
+        BOOST_REQUIRE_EQUAL(index.size(), reference.size());
+        double x = std::rand() % 1000 / 10.0, y = std::rand() % 1000 / 10.0;
+        std::vector<double> expected = bruteForce(reference, x, y);
+        std::vector<PoseEntryNeighbor> nearest = index.nearest(x, y, 5);
+        BOOST_REQUIRE_EQUAL(nearest.size(), std::min<size_t>(5, expected.size()));
+        for (size_t i = 0; i < nearest.size(); i++)
+        {
+            BOOST_CHECK_CLOSE(nearest[i].distance, expected[i], 1e-9);
+            BOOST_CHECK_EQUAL(*nearest[i].key, nearest[i].entry->name);
+        }
+
+        std::vector<PoseEntryNeighbor> near = index.withinRadius(x, y, 10);
+        size_t inside = std::upper_bound(expected.begin(), expected.end(), 10.0) - expected.begin();
+        BOOST_CHECK_EQUAL(near.size(), inside);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pois_are_keyed_by_name)
+{
+    FakeRobot robot;
+    robot.pois["poi-100"] = entry("kitchen", 1, 1);
+    PoseEntryIndexCache<FakePlatform> cache((FakePlatform(robot)));
+    cache.reload();
+    BOOST_REQUIRE(cache.pois().find("kitchen"));
+    BOOST_CHECK(!cache.pois().find("poi-100"));
+
+    // an edit replaces the reloaded entry instead of adding a second one
+    BOOST_REQUIRE(cache.editPOI(entry("kitchen", 5, 5)));
+    BOOST_CHECK_EQUAL(cache.pois().size(), 1u);
+    BOOST_CHECK_EQUAL(cache.pois().find("kitchen")->pose.x(), 5.0);
+    BOOST_REQUIRE(cache.erasePOI("kitchen"));
+    BOOST_CHECK(cache.pois().empty());
+
+    PoseEntryMap pois;
+    pois["a"] = entry("lobby", 0, 0);
+    BOOST_REQUIRE(cache.setPOIs(pois));
+    BOOST_CHECK(cache.pois().find("lobby"));
+    BOOST_CHECK(!cache.pois().find("a"));
+
+    robot.current = Pose(Location(3, 4), Rotation(0));
+    PoseEntry added = cache.addPOIOnCurrentPose("desk", Metadata());
+    PoseEntryNeighbor nearest = { nullptr, nullptr, 0 };
+    BOOST_REQUIRE(cache.pois().nearest(3, 4, nearest));
+    BOOST_CHECK_EQUAL(*nearest.key, "desk");
+    BOOST_CHECK_EQUAL(added.name, "desk");
+}
+
+BOOST_AUTO_TEST_CASE(docks_and_landmarks_follow_the_platform)
+{
+    FakeRobot robot;
+    for (int i = 0; i < 4; i++)
+        robot.landmarks.push_back(entry("landmark-" + std::to_string(i), i, 0));
+    PoseEntryIndexCache<FakePlatform> cache((FakePlatform(robot)));
+    cache.reload();
+    BOOST_CHECK_EQUAL(cache.laserLandmarks().size(), 4u);
+
+    robot.current = Pose(Location(7, 7), Rotation(0));
+    PoseEntry dock = cache.registerHomeDock(Metadata());
+    BOOST_REQUIRE(cache.homeDocks().find("0"));
+    BOOST_CHECK_EQUAL(cache.homeDocks().find("0")->name, dock.name);
+    BOOST_CHECK_EQUAL(cache.homeDocks().find("0")->pose.x(), 7.0);
+
+    std::vector<SegmentID> ids;
+    ids.push_back(1);
+    ids.push_back(2);
+    BOOST_REQUIRE(cache.removeLaserLandmarks(ids));
+    BOOST_CHECK_EQUAL(cache.laserLandmarks().size(), 2u);
+    BOOST_REQUIRE(cache.laserLandmarks().find("1"));
+    BOOST_CHECK_EQUAL(cache.laserLandmarks().find("1")->name, "landmark-3");
+    BOOST_CHECK(!cache.laserLandmarks().find("2"));
+
+    BOOST_REQUIRE(cache.clearLaserLandmarks());
+    BOOST_CHECK(cache.laserLandmarks().empty());
+}
+
+BOOST_AUTO_TEST_CASE(docks_and_landmarks_keep_empty_and_duplicate_names)
+{
+    std::srand(11);
+    FakeRobot robot;
+    for (int i = 0; i < 12; i++)
+    {
+        // a third unnamed, the rest sharing two names
+        std::string name = i % 3 == 0 ? std::string() : (i % 2 ? "dock" : "charger");
+        robot.docks.push_back(entry(name, std::rand() % 100 / 10.0, std::rand() % 100 / 10.0));
+        robot.landmarks.push_back(entry(i % 2 ? std::string() : "reflector", std::rand() % 100 / 10.0, std::rand() % 100 / 10.0));
+    }
+    PoseEntryIndexCache<FakePlatform> cache((FakePlatform(robot)));
+    cache.reload();
+    checkMatches(cache.homeDocks(), robot.docks);
+    checkMatches(cache.laserLandmarks(), robot.landmarks);
+
+    robot.current = Pose(Location(2, 2), Rotation(0));
+    cache.addHomeDock(entry("dock", 9.5, 9.5));
+    cache.addHomeDock(entry("", 0.5, 9.5));
+    cache.registerHomeDock(Metadata());
+    checkMatches(cache.homeDocks(), robot.docks);
+
+    std::vector<PoseEntry> docks(3, entry("", 1, 1));
+    docks[1].pose = Pose(Location(4, 4), Rotation(0));
+    BOOST_REQUIRE(cache.setHomeDocks(docks));
+    checkMatches(cache.homeDocks(), robot.docks);
+
+    std::vector<PoseEntry> landmarks(5, entry("reflector", 3, 3));
+    BOOST_REQUIRE(cache.setLaserLandmarks(landmarks));
+    checkMatches(cache.laserLandmarks(), robot.landmarks);
+    BOOST_CHECK_EQUAL(cache.laserLandmarks().withinRadius(3, 3, 0.1).size(), 5u);
+}
@@ -0,0 +1,141 @@
+/*
+* pose_kernels_benchmark.cpp
+* Batch pose kernels against per pose Eigen::Matrix4d math
+*
+* Usage: pose_kernels_benchmark [poses] [rounds]
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#include <rpos/core/pose_kernels.h>
+
+#include <Eigen/Geometry>
+
+#include <boost/chrono.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace rpos::core;
+
+namespace {
+
+    typedef boost::chrono::steady_clock clock_t_;
+
+    double secondsSince(const clock_t_::time_point& start)
+    {
+        return boost::chrono::duration<double>(clock_t_::now() - start).count();
+    }
+
+    void report(const char* name, size_t count, size_t rounds, double seconds, double checksum)
+    {
+        printf("%-40s %8.2f ns/item  (checksum %.3f)\n", name, seconds * 1e9 / (count * rounds), checksum);
+    }
+
+    double randomIn(double low, double high)
+    {
+        return low + (high - low) * (std::rand() / static_cast<double>(RAND_MAX));
+    }
+
+    // what code without the kernels does per pose: to a 4x4 matrix, multiply, back to a yaw
+    Eigen::Matrix4d toMatrix(const PoseSE2d& pose)
+    {
+        Eigen::Matrix4d m = Eigen::Matrix4d::Identity();
+        m.block<3, 3>(0, 0) = Eigen::AngleAxisd(pose.yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+        m(0, 3) = pose.x;
+        m(1, 3) = pose.y;
+        return m;
+    }
+
+    PoseSE2d fromMatrix(const Eigen::Matrix4d& m)
+    {
+        PoseSE2d pose = { m(0, 3), m(1, 3), constraitRadNegativePiToPi(std::atan2(m(1, 0), m(0, 0))) };
+        return pose;
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = static_cast<size_t>(argc > 1 ? atoi(argv[1]) : 10000);
+    size_t rounds = static_cast<size_t>(argc > 2 ? atoi(argv[2]) : 200);
+
+    std::srand(1);
+    std::vector<PoseSE2d> poses(count), out(count);
+    std::vector<PoseSE2f> posesf(count), outf(count);
+    std::vector<PointXYd> points(count), moved(count);
+    std::vector<PointXYf> pointsf(count), movedf(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        PoseSE2d pose = { randomIn(-10, 10), randomIn(-10, 10), randomIn(-M_PI, M_PI) };
+        poses[i] = pose;
+        PoseSE2f posef = { float(pose.x), float(pose.y), float(pose.yaw) };
+        posesf[i] = posef;
+        PointXYd point = { pose.x, pose.y };
+        points[i] = point;
+        PointXYf pointf = { posef.x, posef.y };
+        pointsf[i] = pointf;
+    }
+    PoseSE2d robot = { 1.5, -2.0, 2.5 };
+    PoseSE2f robotf = { 1.5f, -2.0f, 2.5f };
+
+    printf("== robot pose * %u poses, %u rounds\n", static_cast<unsigned>(count), static_cast<unsigned>(rounds));
+    {
+        auto start = clock_t_::now();
+        Eigen::Matrix4d robotMatrix = toMatrix(robot);
+        for (size_t r = 0; r < rounds; r++)
+            for (size_t i = 0; i < count; i++)
+                out[i] = fromMatrix(robotMatrix * toMatrix(poses[i]));
+        report("per pose Eigen::Matrix4d", count, rounds, secondsSince(start), out[count / 2].yaw);
+    }
+    {
+        auto start = clock_t_::now();
+        for (size_t r = 0; r < rounds; r++)
+            for (size_t i = 0; i < count; i++)
+                out[i] = compose(robot, poses[i]);
+        report("compose (double)", count, rounds, secondsSince(start), out[count / 2].yaw);
+    }
+    {
+        auto start = clock_t_::now();
+        for (size_t r = 0; r < rounds; r++)
+            composePoses(robot, poses.data(), out.data(), count);
+        report("composePoses (double)", count, rounds, secondsSince(start), out[count / 2].yaw);
+    }
+    {
+        auto start = clock_t_::now();
+        for (size_t r = 0; r < rounds; r++)
+            composePoses(robotf, posesf.data(), outf.data(), count);
+        report("composePoses (float)", count, rounds, secondsSince(start), outf[count / 2].yaw);
+    }
+
+    printf("== robot pose * %u points\n", static_cast<unsigned>(count));
+    {
+        auto start = clock_t_::now();
+        Eigen::Isometry2d transform = Eigen::Translation2d(robot.x, robot.y) * Eigen::Rotation2Dd(robot.yaw);
+        for (size_t r = 0; r < rounds; r++)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                Eigen::Vector2d p = transform * Eigen::Vector2d(points[i].x, points[i].y);
+                moved[i].x = p.x();
+                moved[i].y = p.y();
+            }
+        }
+        report("per point Eigen::Isometry2d", count, rounds, secondsSince(start), moved[count / 2].x);
+    }
+    {
+        auto start = clock_t_::now();
+        for (size_t r = 0; r < rounds; r++)
+            transformPoints(robot, points.data(), moved.data(), count);
+        report("transformPoints (double)", count, rounds, secondsSince(start), moved[count / 2].x);
+    }
+    {
+        auto start = clock_t_::now();
+        for (size_t r = 0; r < rounds; r++)
+            transformPoints(robotf, pointsf.data(), movedf.data(), count);
+        report("transformPoints (float)", count, rounds, secondsSince(start), movedf[count / 2].x);
+    }
+    return 0;
+}
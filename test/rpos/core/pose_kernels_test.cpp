@@ -0,0 +1,141 @@
+/*
+* pose_kernels_test.cpp
+* SE(2) / SE(3) kernels against the scalar definitions and the yaw range of angle_math
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE pose_kernels
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/core/pose_kernels.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace rpos::core;
+
+namespace {
+
+    double randomIn(double low, double high)
+    {
+        return low + (high - low) * (std::rand() / static_cast<double>(RAND_MAX));
+    }
+
+    PoseSE2d randomPose()
+    {
+        PoseSE2d pose = { randomIn(-10, 10), randomIn(-10, 10), randomIn(-M_PI, M_PI) };
+        return pose;
+    }
+
+    TransformSE3d rotationZ(double yaw, double tx, double ty, double tz)
+    {
+        double c = std::cos(yaw), s = std::sin(yaw);
+        TransformSE3d transform = { { c, -s, 0, s, c, 0, 0, 0, 1 }, { tx, ty, tz } };
+        return transform;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(yaw_range_matches_angle_math)
+{
+    const double pi = M_PI;
+    const double values[] = { 0.0, pi, -pi, pi - 1e-12, -pi + 1e-12, 1.5 * pi, -1.5 * pi, 2 * pi, -2 * pi, 7 * pi + 0.25, -9 * pi - 0.25 };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        double yaw = detail::normalizeYaw(values[i]);
+        BOOST_CHECK_GE(yaw, -pi);
+        BOOST_CHECK_LT(yaw, pi);
+        BOOST_CHECK_SMALL(yaw - constraitRadNegativePiToPi(values[i]), 1e-9);
+    }
+    BOOST_CHECK_EQUAL(detail::normalizeYaw(pi), -pi);
+    BOOST_CHECK_EQUAL(detail::normalizeYaw(-pi), -pi);
+    BOOST_CHECK_EQUAL(detail::normalizeYaw(float(M_PI)), float(-M_PI));
+    BOOST_CHECK_EQUAL(detail::normalizeYaw(float(M_PI)), constraitRadNegativePiToPi(float(M_PI)));
+
+    // half turns compose to the same end of the range as angle_math
+    PoseSE2d half = { 0, 0, pi / 2 };
+    BOOST_CHECK_EQUAL(compose(half, half).yaw, constraitRadNegativePiToPi(pi));
+}
+
+BOOST_AUTO_TEST_CASE(se2_batches_match_single_compose)
+{
+    std::srand(42);
+    const size_t count = 1001;
+    std::vector<PoseSE2d> a(count), b(count), out(count);
+    std::vector<PointXYd> points(count), moved(count);
+    std::vector<PointXYf> pointsf(count), movedf(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        a[i] = randomPose();
+        b[i] = randomPose();
+        PointXYd p = { randomIn(-5, 5), randomIn(-5, 5) };
+        points[i] = p;
+        PointXYf pf = { float(p.x), float(p.y) };
+        pointsf[i] = pf;
+    }
+
+    PoseSE2d robot = randomPose();
+    composePoses(robot, b.data(), out.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        PoseSE2d expected = compose(robot, b[i]);
+        BOOST_CHECK_SMALL(out[i].x - expected.x, 1e-12);
+        BOOST_CHECK_SMALL(out[i].y - expected.y, 1e-12);
+        BOOST_CHECK_EQUAL(out[i].yaw, expected.yaw);
+    }
+
+    composePoses(a.data(), b.data(), out.data(), count);
+    inversePoses(out.data(), out.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        // (a b)^-1 a b is the identity
+        PoseSE2d identity = compose(compose(out[i], a[i]), b[i]);
+        BOOST_CHECK_SMALL(identity.x, 1e-9);
+        BOOST_CHECK_SMALL(identity.y, 1e-9);
+        BOOST_CHECK_SMALL(identity.yaw, 1e-9);
+    }
+
+    transformPoints(robot, points.data(), moved.data(), count);
+    PoseSE2f robotf = { float(robot.x), float(robot.y), float(robot.yaw) };
+    transformPoints(robotf, pointsf.data(), movedf.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        PointXYd expected = apply(robot, points[i]);
+        BOOST_CHECK_SMALL(moved[i].x - expected.x, 1e-12);
+        BOOST_CHECK_SMALL(moved[i].y - expected.y, 1e-12);
+        BOOST_CHECK_SMALL(movedf[i].x - float(expected.x), 1e-4f);
+        BOOST_CHECK_SMALL(movedf[i].y - float(expected.y), 1e-4f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(se3_matches_se2_for_planar_transforms)
+{
+    PoseSE2d a = { 1, 2, 0.5 }, b = { -3, 0.25, 2.5 };
+    TransformSE3d composed = compose(rotationZ(a.yaw, a.x, a.y, 1), rotationZ(b.yaw, b.x, b.y, 2));
+    PoseSE2d expected = compose(a, b);
+    BOOST_CHECK_SMALL(composed.t[0] - expected.x, 1e-12);
+    BOOST_CHECK_SMALL(composed.t[1] - expected.y, 1e-12);
+    BOOST_CHECK_SMALL(composed.t[2] - 3.0, 1e-12);
+    BOOST_CHECK_SMALL(std::atan2(composed.r[3], composed.r[0]) - expected.yaw, 1e-12);
+
+    TransformSE3d identity = compose(inverse(composed), composed);
+    for (int i = 0; i < 9; i++)
+        BOOST_CHECK_SMALL(identity.r[i] - (i % 4 == 0 ? 1.0 : 0.0), 1e-12);
+
+    std::vector<PointXYZd> points(5), moved(5);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        PointXYZd p = { double(i), -double(i), 0.5 };
+        points[i] = p;
+    }
+    transformPoints(composed, points.data(), moved.data(), points.size());
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        PointXYd planar = apply(expected, PointXYd{ points[i].x, points[i].y });
+        BOOST_CHECK_SMALL(moved[i].x - planar.x, 1e-12);
+        BOOST_CHECK_SMALL(moved[i].y - planar.y, 1e-12);
+        BOOST_CHECK_SMALL(moved[i].z - 3.5, 1e-12);
+    }
+}
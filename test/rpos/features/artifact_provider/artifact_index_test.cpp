@@ -0,0 +1,233 @@
+/*
+* artifact_index_test.cpp
+* Spatial queries of ArtifactSpatialIndex and provider sync of ArtifactIndexCache
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE artifact_index
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/features/artifact_provider/artifact_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+using namespace rpos::features::artifact_provider;
+using rpos::core::Line;
+using rpos::core::Point;
+using rpos::core::SegmentID;
+using rpos::core::Vector2f;
+
+namespace {
+
+    /**
+    * In memory stand-in for the robot, assigns ids to added items like the robot does
+    */
+    struct FakeRobot {
+        FakeRobot()
+            : nextId(100)
+            , fetches(0)
+            , failFetches(0)
+        {}
+
+        std::map<ArtifactUsage, std::vector<RectangleArea> > areas;
+        std::map<ArtifactUsage, std::vector<Line> > lines;
+        SegmentID nextId;
+        int fetches;
+        int failFetches;
+        // runs once the areas were read, like a change made by another thread while the reply is in flight
+        std::function<void()> afterFetch;
+    };
+
+    class FakeProvider {
+    public:
+        explicit FakeProvider(FakeRobot& robot)
+            : robot_(&robot)
+        {}
+
+        std::vector<RectangleArea> getRectangleAreas(ArtifactUsage usage)
+        {
+            robot_->fetches++;
+            if (robot_->failFetches > 0)
+            {
+                robot_->failFetches--;
+                throw std::runtime_error("connection lost");
+            }
+            std::vector<RectangleArea> areas = robot_->areas[usage];
+            if (robot_->afterFetch)
+            {
+                std::function<void()> afterFetch;
+                afterFetch.swap(robot_->afterFetch);
+                afterFetch();
+            }
+            return areas;
+        }
+
+        std::vector<Line> getLines(ArtifactUsage usage)
+        {
+            return robot_->lines[usage];
+        }
+
+        bool addRectangleAreas(ArtifactUsage usage, const std::vector<RectangleArea>& areas)
+        {
+            for (auto iter = areas.begin(); iter != areas.end(); ++iter)
+            {
+                robot_->areas[usage].push_back(*iter);
+                robot_->areas[usage].back().id = robot_->nextId++;
+            }
+            return true;
+        }
+
+        bool editRectangleArea(ArtifactUsage usage, const RectangleArea& area)
+        {
+            std::vector<RectangleArea>& areas = robot_->areas[usage];
+            for (auto iter = areas.begin(); iter != areas.end(); ++iter)
+            {
+                if (iter->id == area.id)
+                {
+                    *iter = area;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool removeRectangleAreaByIds(ArtifactUsage usage, const std::vector<SegmentID>& ids)
+        {
+            std::vector<RectangleArea>& areas = robot_->areas[usage];
+            areas.erase(std::remove_if(areas.begin(), areas.end(), [&ids](const RectangleArea& area) {
+                return std::find(ids.begin(), ids.end(), area.id) != ids.end();
+            }), areas.end());
+            return true;
+        }
+
+        bool clearRectangleAreas(ArtifactUsage usage)
+        {
+            robot_->areas[usage].clear();
+            return true;
+        }
+
+        bool addLines(ArtifactUsage usage, const std::vector<Line>& lines)
+        {
+            for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+            {
+                robot_->lines[usage].push_back(*iter);
+                robot_->lines[usage].back().id() = robot_->nextId++;
+            }
+            return true;
+        }
+
+        bool moveLine(ArtifactUsage, const Line&) { return true; }
+        bool moveLines(ArtifactUsage, const std::vector<Line>&) { return true; }
+        bool removeLineById(ArtifactUsage, SegmentID) { return true; }
+        bool clearLines(ArtifactUsage) { return true; }
+
+    private:
+        FakeRobot* robot_;
+    };
+
+    RectangleArea square(float x, float y, float size, SegmentID id = 0)
+    {
+        return RectangleArea(ArtifactUsageForbiddenArea, rpos::core::ORectangleF(Vector2f(x, y), Vector2f(x + size, y), size / 2), id);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(index_answers_point_segment_and_nearest_queries)
+{
+    ArtifactSpatialIndex index;
+    std::vector<RectangleArea> areas;
+    for (int i = 0; i < 100; i++)
+        areas.push_back(square(i * 2.0f, 0, 1, i + 1));
+    index.setRectangleAreas(ArtifactUsageForbiddenArea, areas);
+    std::vector<Line> walls(1, Line(Point(0, 5), Point(10, 5), 7));
+    index.setLines(ArtifactUsageVirtualWall, walls);
+
+    std::vector<SegmentID> inside = index.areasContaining(ArtifactUsageForbiddenArea, Vector2f(10.5f, 0.25f));
+    BOOST_REQUIRE_EQUAL(inside.size(), 1u);
+    BOOST_CHECK_EQUAL(inside[0], 6u);
+    BOOST_CHECK(!index.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(11.5f, 0)));
+    BOOST_CHECK_EQUAL(index.areasIntersecting(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0), Vector2f(4.5f, 0)).size(), 3u);
+
+    BOOST_CHECK(index.crossesLine(ArtifactUsageVirtualWall, Vector2f(3, 0), Vector2f(3, 10)));
+    BOOST_CHECK(!index.crossesLine(ArtifactUsageVirtualWall, Vector2f(11, 0), Vector2f(11, 10)));
+
+    std::vector<ArtifactNeighbor> nearest = index.nearestAreas(ArtifactUsageForbiddenArea, Vector2f(51.5f, 3), 2);
+    BOOST_REQUIRE_EQUAL(nearest.size(), 2u);
+    BOOST_CHECK_CLOSE(nearest[0].distance, std::sqrt(6.5f), 1e-3);
+    BOOST_CHECK_LE(nearest[0].distance, nearest[1].distance);
+
+    index.removeRectangleAreas(ArtifactUsageForbiddenArea, std::vector<SegmentID>(1, 6));
+    BOOST_CHECK(!index.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(10.5f, 0.25f)));
+}
+
+BOOST_AUTO_TEST_CASE(added_items_keep_the_ids_of_the_robot)
+{
+    FakeRobot robot;
+    ArtifactIndexCache<FakeProvider> cache((FakeProvider(robot)));
+    BOOST_CHECK(!cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0, 0)));
+
+    // both new areas carry the default id 0
+    std::vector<RectangleArea> areas;
+    areas.push_back(square(0, 0, 1));
+    areas.push_back(square(10, 0, 1));
+    BOOST_REQUIRE(cache.addRectangleAreas(ArtifactUsageForbiddenArea, areas));
+    BOOST_REQUIRE(cache.addRectangleArea(ArtifactUsageForbiddenArea, square(20, 0, 1)));
+
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0)));
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(10.5f, 0)));
+    std::vector<SegmentID> ids = cache.areasContaining(ArtifactUsageForbiddenArea, Vector2f(20.5f, 0));
+    BOOST_REQUIRE_EQUAL(ids.size(), 1u);
+    BOOST_CHECK_EQUAL(ids[0], 102u);
+
+    // edits and removals by those ids apply in place
+    BOOST_REQUIRE(cache.removeRectangleAreaByIds(ArtifactUsageForbiddenArea, std::vector<SegmentID>(1, 100)));
+    BOOST_CHECK(!cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0)));
+    int fetches = robot.fetches;
+    BOOST_REQUIRE(cache.editRectangleArea(ArtifactUsageForbiddenArea, square(30, 0, 1, 101)));
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(30.5f, 0)));
+    BOOST_CHECK(!cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(10.5f, 0)));
+    BOOST_CHECK_EQUAL(robot.fetches, fetches);
+
+    std::vector<Line> walls;
+    walls.push_back(Line(Point(0, 5), Point(10, 5)));
+    walls.push_back(Line(Point(0, 8), Point(10, 8)));
+    BOOST_REQUIRE(cache.addLines(ArtifactUsageVirtualWall, walls));
+    BOOST_CHECK_EQUAL(cache.linesIntersecting(ArtifactUsageVirtualWall, Vector2f(5, 0), Vector2f(5, 10)).size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(failed_fetch_is_retried)
+{
+    FakeRobot robot;
+    robot.areas[ArtifactUsageForbiddenArea].push_back(square(0, 0, 1, 1));
+    ArtifactIndexCache<FakeProvider> cache((FakeProvider(robot)));
+
+    robot.failFetches = 1;
+    BOOST_CHECK_THROW(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0)), std::runtime_error);
+    // the usage was not marked loaded, the next query fetches it
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0)));
+    BOOST_CHECK_EQUAL(robot.fetches, 2);
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0)));
+    BOOST_CHECK_EQUAL(robot.fetches, 2);
+}
+
+BOOST_AUTO_TEST_CASE(add_during_fetch_is_not_lost)
+{
+    FakeRobot robot;
+    robot.areas[ArtifactUsageForbiddenArea].push_back(square(0, 0, 1, 1));
+    ArtifactIndexCache<FakeProvider> cache((FakeProvider(robot)));
+
+    robot.afterFetch = [&cache]() {
+        BOOST_REQUIRE(cache.addRectangleArea(ArtifactUsageForbiddenArea, square(10, 0, 1)));
+    };
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(0.5f, 0)));
+    // the first reply predates the add, it was dropped and the usage fetched again
+    BOOST_CHECK_EQUAL(robot.fetches, 2);
+    BOOST_CHECK(cache.isInsideArea(ArtifactUsageForbiddenArea, Vector2f(10.5f, 0)));
+    BOOST_CHECK_EQUAL(robot.fetches, 2);
+}
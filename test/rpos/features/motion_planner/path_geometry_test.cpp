@@ -0,0 +1,81 @@
+/*
+* path_geometry_test.cpp
+* Resampling, projection and the shorter last interval in speed profiles and travel time
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE path_geometry
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/features/motion_planner/path_geometry.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace rpos::features::motion_planner;
+
+namespace {
+
+    PathGeometry straightPath(float length)
+    {
+        float xs[] = { 0.0f, length };
+        float ys[] = { 0.0f, 0.0f };
+        PathGeometry geometry;
+        geometry.assign(xs, ys, 2);
+        return geometry;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(resample_ends_on_the_last_point)
+{
+    PathGeometry geometry = straightPath(1.05f);
+    std::vector<float> xs, ys;
+    BOOST_REQUIRE_EQUAL(geometry.resample(0.1, xs, ys), 12u);
+    BOOST_CHECK_CLOSE(xs[10], 1.0f, 1e-3);
+    BOOST_CHECK_CLOSE(xs[11], 1.05f, 1e-3);
+    BOOST_CHECK_CLOSE(geometry.lastStep(0.1), 0.05, 1e-3);
+
+    // a whole number of steps keeps a full last step
+    BOOST_CHECK_CLOSE(geometry.lastStep(0.1, 0.05), 0.1, 1e-3);
+    BOOST_CHECK_EQUAL(geometry.lastStep(0.1, 1.05), 0.0);
+
+    PathProjection projection;
+    BOOST_REQUIRE(geometry.project(0.3f, 0.2f, projection));
+    BOOST_CHECK_CLOSE(projection.s, 0.3, 1e-3);
+    BOOST_CHECK_CLOSE(projection.distance, 0.2f, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(travel_time_uses_the_last_step)
+{
+    PathGeometry geometry = straightPath(1.05f);
+    std::vector<float> xs, ys;
+    size_t count = geometry.resample(0.1, xs, ys);
+    std::vector<float> speeds(count, 0.5f);
+
+    BOOST_CHECK_CLOSE(travelTime(&speeds[0], count, 0.1f, static_cast<float>(geometry.lastStep(0.1))), 1.05 / 0.5, 1e-3);
+    // without it the tail is counted as a full step
+    BOOST_CHECK_CLOSE(travelTime(&speeds[0], count, 0.1f), 1.1 / 0.5, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(speed_profile_decelerates_over_the_last_step)
+{
+    PathGeometry geometry = straightPath(1.01f);
+    std::vector<float> xs, ys;
+    size_t count = geometry.resample(0.1, xs, ys);
+    std::vector<float> curvature(count, 0.0f), speeds(count);
+    float lastStep = static_cast<float>(geometry.lastStep(0.1));
+
+    SpeedProfileLimits limits;
+    limits.maxSpeed = 10.0f;
+    limits.startSpeed = 10.0f;
+    limits.maxDeceleration = 1.0f;
+    speedProfile(&curvature[0], count, 0.1f, limits, &speeds[0], lastStep);
+
+    // 1cm before the end the robot may only be going sqrt(2 * a * 0.01)
+    BOOST_CHECK_EQUAL(speeds[count - 1], 0.0f);
+    BOOST_CHECK_CLOSE(speeds[count - 2], std::sqrt(2.0f * 0.01f), 1e-2);
+    BOOST_CHECK_CLOSE(speeds[count - 3], std::sqrt(2.0f * 0.11f), 1e-2);
+    BOOST_CHECK(travelTime(&speeds[0], count, 0.1f, lastStep) > 0.0);
+}
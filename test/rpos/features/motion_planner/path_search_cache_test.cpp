@@ -0,0 +1,120 @@
+/*
+* path_search_cache_test.cpp
+* Keys, invalidation and failure handling of PathSearchCache
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE path_search_cache
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/features/motion_planner/path_search_cache.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace rpos::features::motion_planner;
+using rpos::core::Location;
+
+namespace {
+
+    /**
+    * Straight line planner from the current location, goals with x < 0 are unreachable and goals
+    * with y < 0 time out
+    */
+    struct FakeRobot {
+        FakeRobot()
+            : searches(0)
+        {}
+
+        Location location;
+        int searches;
+    };
+
+    class FakePlanner {
+    public:
+        explicit FakePlanner(FakeRobot& robot)
+            : robot_(&robot)
+        {}
+
+        Location getLocation()
+        {
+            return robot_->location;
+        }
+
+        Path searchPath(const Location& goal, int)
+        {
+            robot_->searches++;
+            if (goal.y() < 0)
+                throw std::runtime_error("search timed out");
+            if (goal.x() < 0)
+                return Path(std::vector<Location>());
+            std::vector<Location> points(1, goal);
+            return Path(points);
+        }
+
+    private:
+        FakeRobot* robot_;
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(entries_are_keyed_on_the_robot_location)
+{
+    FakeRobot robot;
+    PathSearchCache<FakePlanner> cache((FakePlanner(robot)));
+
+    BOOST_CHECK_CLOSE(cache.pathLength(Location(3, 4)), 5.0f, 1e-4);
+    // a few millimeters off snaps to the same cells
+    robot.location = Location(0.004, 0.003);
+    BOOST_CHECK_EQUAL(cache.searchPath(Location(3.01, 4)).getPoints().size(), 1u);
+    BOOST_CHECK_EQUAL(robot.searches, 1);
+
+    // the robot moved, the path from the old location does not apply
+    robot.location = Location(3, 0);
+    BOOST_CHECK_CLOSE(cache.pathLength(Location(3, 4)), 4.0f, 1e-4);
+    BOOST_CHECK_EQUAL(robot.searches, 2);
+
+    PathSearchCacheStats stats = cache.stats();
+    BOOST_CHECK_EQUAL(stats.hits, 1u);
+    BOOST_CHECK_EQUAL(stats.misses, 2u);
+    BOOST_CHECK_EQUAL(stats.size, 2u);
+
+    cache.invalidateArtifacts(rpos::features::artifact_provider::ArtifactUsagePoi);
+    BOOST_CHECK_EQUAL(cache.stats().size, 2u);
+    cache.invalidateArtifacts(rpos::features::artifact_provider::ArtifactUsageVirtualWall);
+    BOOST_CHECK_EQUAL(cache.stats().size, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(path_lengths_survive_failing_goals)
+{
+    FakeRobot robot;
+    PathSearchCache<FakePlanner> cache((FakePlanner(robot)));
+
+    std::vector<Location> goals;
+    goals.push_back(Location(3, 4));
+    goals.push_back(Location(-1, 1));
+    goals.push_back(Location(1, -1));
+    goals.push_back(Location(0, 2));
+    goals.push_back(Location(3.01, 4));
+
+    std::vector<float> lengths;
+    cache.pathLengths(goals, lengths);
+    BOOST_REQUIRE_EQUAL(lengths.size(), goals.size());
+    BOOST_CHECK_CLOSE(lengths[0], 5.0f, 1e-4);
+    BOOST_CHECK(std::isinf(lengths[1]));
+    BOOST_CHECK(std::isinf(lengths[2]));
+    BOOST_CHECK_CLOSE(lengths[3], 2.0f, 1e-4);
+    BOOST_CHECK_CLOSE(lengths[4], 5.0f, 1e-4);
+    // the last goal shares the cell of the first one
+    BOOST_CHECK_EQUAL(robot.searches, 4);
+
+    // the unreachable goal is cached, the one that threw is searched again
+    cache.pathLengths(goals, lengths);
+    BOOST_CHECK_EQUAL(robot.searches, 5);
+    BOOST_CHECK(std::isinf(lengths[2]));
+
+    BOOST_CHECK_THROW(cache.searchPath(Location(1, -1)), std::runtime_error);
+}
@@ -0,0 +1,164 @@
+/*
+* route_optimizer_test.cpp
+* solveRoute against brute force, with infinite distances and unreachable pass points
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE route_optimizer
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/features/motion_planner/route_optimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+using namespace rpos::features::motion_planner;
+using rpos::core::Location;
+
+namespace {
+
+    const float kInf = std::numeric_limits<float>::infinity();
+
+    double routeCost(const RouteDistanceMatrix& matrix, const std::vector<size_t>& order)
+    {
+        double cost = 0;
+        size_t previous = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            cost += matrix(previous, order[i] + 1);
+            previous = order[i] + 1;
+        }
+        return cost + matrix(previous, matrix.size() - 1);
+    }
+
+    double bruteForce(const RouteDistanceMatrix& matrix)
+    {
+        std::vector<size_t> order(matrix.passPointCount());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        double best = std::numeric_limits<double>::infinity();
+        do
+        {
+            best = std::min(best, routeCost(matrix, order));
+        } while (std::next_permutation(order.begin(), order.end()));
+        return best;
+    }
+
+    std::vector<Location> randomPoints(size_t count)
+    {
+        std::vector<Location> points;
+        for (size_t i = 0; i < count; i++)
+            points.push_back(Location(std::rand() % 100, std::rand() % 100));
+        return points;
+    }
+
+    RouteOptimizerOptions quickOptions()
+    {
+        RouteOptimizerOptions options;
+        options.timeBudgetMs = 20;
+        options.concurrency = 2;
+        return options;
+    }
+
+    bool isPermutation(std::vector<size_t> order, size_t count)
+    {
+        std::sort(order.begin(), order.end());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (order[i] != i)
+                return false;
+        }
+        return order.size() == count;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(small_routes_are_optimal)
+{
+    std::srand(3);
+    for (int round = 0; round < 10; round++)
+    {
+        std::vector<Location> points = randomPoints(7);
+        RouteDistanceMatrix matrix = RouteDistanceMatrix::euclidean(Location(0, 0), points, Location(100, 100));
+        RouteSolution solution = solveRoute(matrix, quickOptions());
+        BOOST_REQUIRE(isPermutation(solution.order, points.size()));
+        BOOST_CHECK(solution.unreachable.empty());
+        BOOST_CHECK_CLOSE(solution.cost, routeCost(matrix, solution.order), 1e-4);
+        BOOST_CHECK_CLOSE(solution.cost, bruteForce(matrix), 1e-4);
+    }
+
+    // an open path without start and end point
+    std::vector<Location> line;
+    for (int i = 0; i < 5; i++)
+        line.push_back(Location((i * 3) % 5, 0));
+    std::vector<Location> route = optimizeRoute(boost::none, line, boost::none, quickOptions());
+    BOOST_REQUIRE_EQUAL(route.size(), 5u);
+    for (size_t i = 1; i < route.size(); i++)
+        BOOST_CHECK_EQUAL(std::fabs(route[i].x() - route[i - 1].x()), 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(unreachable_points_are_reported_and_visited_last)
+{
+    std::srand(5);
+    std::vector<Location> points = randomPoints(10);
+    RouteDistanceMatrix matrix = RouteDistanceMatrix::euclidean(Location(0, 0), points, boost::none);
+
+    // points 2 and 7 failed every path search, point 4 only the one from the start
+    const size_t unreachable[] = { 2, 7 };
+    for (size_t u = 0; u < 2; u++)
+    {
+        for (size_t j = 0; j < matrix.size(); j++)
+        {
+            if (j != unreachable[u] + 1)
+                matrix.set(unreachable[u] + 1, j, kInf);
+        }
+    }
+    matrix.set(0, 5, kInf);
+
+    RouteSolution solution = solveRoute(matrix, quickOptions());
+    BOOST_REQUIRE(isPermutation(solution.order, points.size()));
+    BOOST_REQUIRE_EQUAL(solution.unreachable.size(), 2u);
+    BOOST_CHECK_EQUAL(solution.unreachable[0], 2u);
+    BOOST_CHECK_EQUAL(solution.unreachable[1], 7u);
+    BOOST_CHECK_EQUAL(solution.order[8], 2u);
+    BOOST_CHECK_EQUAL(solution.order[9], 7u);
+    BOOST_CHECK(std::isfinite(solution.cost));
+    BOOST_CHECK(solution.order[0] != 4u);
+
+    // nothing reachable at all
+    RouteDistanceMatrix isolated(3);
+    isolated.set(0, 1, kInf);
+    isolated.set(0, 2, kInf);
+    isolated.set(0, 3, kInf);
+    solution = solveRoute(isolated, quickOptions());
+    BOOST_CHECK_EQUAL(solution.unreachable.size(), 3u);
+    BOOST_CHECK_EQUAL(solution.order.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(infinite_costs_still_yield_a_route)
+{
+    std::vector<Location> points = randomPoints(6);
+    RouteDistanceMatrix matrix = RouteDistanceMatrix::euclidean(Location(0, 0), points, Location(50, 50));
+    // the end point can only be reached from pass point 3, and nothing can reach it from 0 directly
+    for (size_t j = 0; j <= points.size(); j++)
+    {
+        if (j != 4)
+            matrix.set(j, points.size() + 1, kInf);
+    }
+
+    RouteSolution solution = solveRoute(matrix, quickOptions());
+    BOOST_REQUIRE(isPermutation(solution.order, points.size()));
+    BOOST_CHECK(solution.unreachable.empty());
+    BOOST_CHECK_EQUAL(solution.order.back(), 3u);
+    BOOST_CHECK(std::isfinite(solution.cost));
+
+    // with the end point cut off completely the cost is infinite, but every point is still ordered
+    matrix.set(4, points.size() + 1, kInf);
+    solution = solveRoute(matrix, quickOptions());
+    BOOST_CHECK(isPermutation(solution.order, points.size()));
+    BOOST_CHECK(std::isinf(solution.cost));
+}
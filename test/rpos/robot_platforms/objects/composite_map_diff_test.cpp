@@ -0,0 +1,174 @@
+/*
+* composite_map_diff_test.cpp
+* Diff/apply round trips, duplicate area ids and corrupt patches left unapplied
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE composite_map_diff
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/robot_platforms/objects/composite_map_diff.h>
+
+#include <boost/make_shared.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace rpos::robot_platforms::objects;
+using rpos::core::Location;
+using rpos::features::artifact_provider::RectangleArea;
+
+namespace {
+
+    boost::shared_ptr<GridMapLayer> gridLayer(uint8_t fill)
+    {
+        boost::shared_ptr<GridMapLayer> layer = boost::make_shared<GridMapLayer>();
+        layer->setName("explore");
+        layer->setUsage("explore");
+        layer->setDimension(rpos::core::Vector2i(100, 70));
+        layer->setResolution(rpos::core::Vector2f(0.05f, 0.05f));
+        layer->mapData().assign(100 * 70, fill);
+        return layer;
+    }
+
+    rpos::core::PoseEntry poseEntry(const std::string& name, double x)
+    {
+        rpos::core::PoseEntry entry;
+        entry.name = name;
+        entry.pose = rpos::core::Pose(Location(x, 1.0, 0.0), rpos::core::Rotation(0.5, 0.0, 0.0));
+        return entry;
+    }
+
+    RectangleArea rectangleArea(rpos::core::SegmentID id, float x)
+    {
+        return RectangleArea(rpos::features::artifact_provider::ArtifactUsageForbiddenArea,
+            rpos::core::ORectangleF(rpos::core::Vector2f(x, 0.0f), rpos::core::Vector2f(x + 1.0f, 0.0f), 0.5f), id);
+    }
+
+    template <class LayerT>
+    boost::shared_ptr<LayerT> findLayer(CompositeMap& map, const std::string& name)
+    {
+        for (size_t i = 0; i < map.maps().size(); i++)
+        {
+            if (map.maps()[i]->getName() == name)
+                return boost::dynamic_pointer_cast<LayerT>(map.maps()[i]);
+        }
+        return boost::shared_ptr<LayerT>();
+    }
+
+    /**
+    * Grid, line, area and pose layers, the pose layer last so its record ends the patch
+    */
+    void deployedMap(CompositeMap& map)
+    {
+        map.maps().push_back(gridLayer(0x7f));
+
+        boost::shared_ptr<LineMapLayer> lines = boost::make_shared<LineMapLayer>();
+        lines->setName("walls");
+        lines->setUsage("virtual_wall");
+        lines->lines()["1"].start = Location(0.0, 0.0, 0.0);
+        map.maps().push_back(lines);
+
+        boost::shared_ptr<RectangleAreaMapLayer> areas = boost::make_shared<RectangleAreaMapLayer>();
+        areas->setName("forbidden");
+        areas->setUsage("forbidden_area");
+        areas->areas().push_back(rectangleArea(5, 0.0f));
+        areas->areas().push_back(rectangleArea(7, 1.0f));
+        map.maps().push_back(areas);
+
+        boost::shared_ptr<PoseMapLayer> poses = boost::make_shared<PoseMapLayer>();
+        poses->setName("pois");
+        poses->setUsage("pois");
+        poses->poses()["home"] = poseEntry("home", 0.0);
+        map.maps().push_back(poses);
+    }
+
+    void editedMap(CompositeMap& map)
+    {
+        deployedMap(map);
+        boost::shared_ptr<GridMapLayer> grid = findLayer<GridMapLayer>(map, "explore");
+        for (int x = 10; x < 80; x++)
+            grid->mapData()[30 * 100 + x] = 0xff;
+
+        boost::shared_ptr<PolygonAreaMapLayer> polygons = boost::make_shared<PolygonAreaMapLayer>();
+        polygons->setName("rooms");
+        polygons->setUsage("rooms");
+        polygons->areas().resize(1);
+        polygons->areas()[0].id = 3;
+        polygons->areas()[0].count = 3;
+        polygons->areas()[0].locations.resize(3);
+        map.maps().insert(map.maps().end() - 1, polygons);
+
+        // three areas with id 5, the second one changed
+        std::vector<RectangleArea>& areas = findLayer<RectangleAreaMapLayer>(map, "forbidden")->areas();
+        areas.push_back(rectangleArea(5, 2.0f));
+        areas.push_back(rectangleArea(5, 3.0f));
+        areas[2].area = rpos::core::ORectangleF(rpos::core::Vector2f(9.0f, 9.0f), rpos::core::Vector2f(10.0f, 9.0f), 0.5f);
+
+        findLayer<PoseMapLayer>(map, "pois")->poses()["dock"] = poseEntry("dock", 2.0);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(round_trip_reproduces_the_target)
+{
+    CompositeMap deployed, edited;
+    deployedMap(deployed);
+    editedMap(edited);
+
+    CompositeMapPatch patch = CompositeMapPatch::deserialize(CompositeMapPatch::diff(deployed, edited).serialize());
+    BOOST_REQUIRE(!patch.empty());
+    patch.apply(deployed);
+
+    BOOST_CHECK(CompositeMapPatch::diff(deployed, edited).empty());
+    BOOST_CHECK_EQUAL(deployed.maps().size(), 5u);
+    BOOST_CHECK_EQUAL(findLayer<GridMapLayer>(deployed, "explore")->mapData()[30 * 100 + 50], 0xff);
+    BOOST_CHECK_EQUAL(findLayer<PoseMapLayer>(deployed, "pois")->poses().size(), 2u);
+    BOOST_CHECK_EQUAL(findLayer<PolygonAreaMapLayer>(deployed, "rooms")->areas().size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(areas_with_duplicate_ids_are_kept_apart)
+{
+    CompositeMap deployed, edited;
+    deployedMap(deployed);
+    editedMap(edited);
+    CompositeMapPatch::diff(deployed, edited).apply(deployed);
+
+    std::vector<RectangleArea>& areas = findLayer<RectangleAreaMapLayer>(deployed, "forbidden")->areas();
+    BOOST_REQUIRE_EQUAL(areas.size(), 4u);
+    BOOST_CHECK_EQUAL(areas[0].id, 5u);
+    BOOST_CHECK_EQUAL(areas[1].id, 7u);
+    BOOST_CHECK_EQUAL(areas[2].area.start().x(), 9.0f);
+    BOOST_CHECK_EQUAL(areas[3].area.start().x(), 3.0f);
+
+    // and shrink back to a single one
+    CompositeMap original;
+    deployedMap(original);
+    CompositeMapPatch::diff(deployed, original).apply(deployed);
+    BOOST_CHECK_EQUAL(findLayer<RectangleAreaMapLayer>(deployed, "forbidden")->areas().size(), 2u);
+    BOOST_CHECK(CompositeMapPatch::diff(deployed, original).empty());
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_body_leaves_the_map_untouched)
+{
+    CompositeMap deployed, edited;
+    deployedMap(deployed);
+    editedMap(edited);
+
+    // the last byte is the metadata size of the last pose record, claiming an entry runs past its body
+    std::vector<uint8_t> bytes = CompositeMapPatch::diff(deployed, edited).serialize();
+    BOOST_REQUIRE_EQUAL(bytes.back(), 0u);
+    bytes.back() = 1;
+    CompositeMapPatch patch = CompositeMapPatch::deserialize(bytes);
+
+    BOOST_CHECK_THROW(patch.apply(deployed), CompositeMapException);
+    BOOST_CHECK_EQUAL(deployed.maps().size(), 4u);
+    BOOST_CHECK_EQUAL(findLayer<GridMapLayer>(deployed, "explore")->mapData()[30 * 100 + 50], 0x7f);
+    BOOST_CHECK_EQUAL(findLayer<RectangleAreaMapLayer>(deployed, "forbidden")->areas().size(), 2u);
+    BOOST_CHECK_EQUAL(findLayer<PoseMapLayer>(deployed, "pois")->poses().size(), 1u);
+
+    // a truncated patch does not even deserialize
+    bytes.pop_back();
+    BOOST_CHECK_THROW(CompositeMapPatch::deserialize(bytes), CompositeMapException);
+}
@@ -0,0 +1,138 @@
+/*
+* grid_distance_field_test.cpp
+* GridDistanceField against brute force, serial and parallel, incremental update and inflation
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE grid_distance_field
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/robot_platforms/objects/grid_distance_field.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace rpos::robot_platforms::objects;
+
+namespace {
+
+    const int kWidth = 150;
+    const int kHeight = 130;
+    const float kResolution = 0.05f;
+
+    std::vector<uint8_t> randomGrid(unsigned seed)
+    {
+        std::vector<uint8_t> grid(kWidth * kHeight, 20);
+        for (size_t i = 0; i < grid.size(); i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            if ((seed >> 16) % 300 == 0)
+                grid[i] = 255;
+        }
+        return grid;
+    }
+
+    float bruteForceDistance(const std::vector<uint8_t>& grid, int x, int y, float maxDistance)
+    {
+        double best = std::numeric_limits<double>::infinity();
+        for (int oy = 0; oy < kHeight; oy++)
+        {
+            for (int ox = 0; ox < kWidth; ox++)
+            {
+                if (grid[oy * kWidth + ox] >= 128)
+                    best = std::min(best, std::sqrt(static_cast<double>((ox - x) * (ox - x) + (oy - y) * (oy - y))));
+            }
+        }
+        return static_cast<float>(std::min(best * kResolution, static_cast<double>(maxDistance)));
+    }
+
+    void checkAgainstBruteForce(const GridDistanceField& field, const std::vector<uint8_t>& grid)
+    {
+        for (int y = 0; y < kHeight; y += 3)
+        {
+            for (int x = 0; x < kWidth; x += 3)
+                BOOST_CHECK_SMALL(field.distance(x, y) - bruteForceDistance(grid, x, y, field.options().maxDistance), 1e-4f);
+        }
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(serial_and_parallel_match_brute_force)
+{
+    std::vector<uint8_t> grid = randomGrid(7);
+
+    GridDistanceFieldOptions options;
+    options.concurrency = 1;
+    GridDistanceField serial(options);
+    serial.compute(&grid[0], kWidth, kHeight, kResolution);
+    checkAgainstBruteForce(serial, grid);
+
+    options.concurrency = 4;
+    GridDistanceField parallel(options);
+    parallel.compute(&grid[0], kWidth, kHeight, kResolution);
+    BOOST_CHECK(parallel.distances() == serial.distances());
+}
+
+BOOST_AUTO_TEST_CASE(unknown_cells_count_as_obstacles_on_request)
+{
+    std::vector<uint8_t> grid(kWidth * kHeight, 20);
+    grid[40 * kWidth + 40] = 0;
+
+    GridDistanceFieldOptions options;
+    options.maxDistance = 1.0f;
+    GridDistanceField field(options);
+    field.compute(&grid[0], kWidth, kHeight, kResolution);
+    BOOST_CHECK_EQUAL(field.distance(40, 40), 1.0f);
+
+    options.unknownIsOccupied = true;
+    GridDistanceField unknown(options);
+    unknown.compute(&grid[0], kWidth, kHeight, kResolution);
+    BOOST_CHECK_EQUAL(unknown.distance(40, 40), 0.0f);
+    BOOST_CHECK_CLOSE(unknown.distance(43, 44), 5 * kResolution, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(update_matches_a_full_compute)
+{
+    std::vector<uint8_t> grid = randomGrid(11);
+    GridDistanceFieldOptions options;
+    options.maxDistance = 0.4f;
+    GridDistanceField field(options);
+    field.compute(&grid[0], kWidth, kHeight, kResolution);
+
+    // add a wall and clear a block
+    for (int y = 60; y < 70; y++)
+    {
+        grid[y * kWidth + 90] = 255;
+        std::fill(&grid[y * kWidth + 20], &grid[y * kWidth + 30], 20);
+    }
+    field.update(&grid[0], 90, 60, 1, 10);
+    field.update(&grid[0], 20, 60, 10, 10);
+
+    GridDistanceField expected(options);
+    expected.compute(&grid[0], kWidth, kHeight, kResolution);
+    BOOST_CHECK(field.distances() == expected.distances());
+    checkAgainstBruteForce(field, grid);
+}
+
+BOOST_AUTO_TEST_CASE(inflation_marks_cells_within_the_radius)
+{
+    std::vector<uint8_t> grid(kWidth * kHeight, 20);
+    grid[50 * kWidth + 50] = 255;
+    GridDistanceField field;
+    field.compute(&grid[0], kWidth, kHeight, kResolution);
+
+    std::vector<uint8_t> inflated;
+    field.inflate(0.1f, grid, inflated, 200);
+    BOOST_CHECK_EQUAL(inflated[50 * kWidth + 52], 200);
+    BOOST_CHECK_EQUAL(inflated[51 * kWidth + 51], 200);
+    BOOST_CHECK_EQUAL(inflated[52 * kWidth + 51], 20);
+    BOOST_CHECK_EQUAL(inflated[50 * kWidth + 53], 20);
+    BOOST_CHECK_EQUAL(std::count(inflated.begin(), inflated.end(), 200), 13);
+
+    std::vector<uint8_t> wrongSize(10);
+    BOOST_CHECK_THROW(field.inflate(0.1f, wrongSize, inflated), std::runtime_error);
+}
@@ -0,0 +1,127 @@
+/*
+* grid_map_pyramid_test.cpp
+* Pyramid reduction rules, incremental updates and storage in a composite map
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE grid_map_pyramid
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/robot_platforms/objects/grid_map_pyramid.h>
+
+#include <boost/make_shared.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace rpos::robot_platforms::objects;
+
+namespace {
+
+    boost::shared_ptr<GridMapLayer> baseLayer(int width, int height)
+    {
+        boost::shared_ptr<GridMapLayer> layer = boost::make_shared<GridMapLayer>();
+        layer->setName("explore");
+        layer->setUsage("explore");
+        layer->setDimension(rpos::core::Vector2i(width, height));
+        layer->setResolution(rpos::core::Vector2f(0.05f, 0.05f));
+        layer->mapData().assign(static_cast<size_t>(width) * height, 0);
+        return layer;
+    }
+
+    void setCell(GridMapLayer& layer, int x, int y, uint8_t value)
+    {
+        layer.mapData()[static_cast<size_t>(y) * layer.getDimension().x() + x] = value;
+    }
+
+    uint8_t cell(const GridMapLayer& layer, int x, int y)
+    {
+        return layer.mapData()[static_cast<size_t>(y) * layer.getDimension().x() + x];
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(levels_keep_obstacles_and_free_space)
+{
+    boost::shared_ptr<GridMapLayer> base = baseLayer(200, 130);
+    setCell(*base, 10, 10, 40);
+    setCell(*base, 11, 11, 30);
+    setCell(*base, 20, 20, 40);
+    setCell(*base, 21, 20, 200);
+    setCell(*base, 199, 129, 255);
+
+    GridMapPyramid pyramid;
+    pyramid.build(*base);
+    BOOST_REQUIRE_EQUAL(pyramid.levelCount(), 3u);
+    BOOST_CHECK_EQUAL(pyramid.level(1)->getDimension().x(), 100);
+    BOOST_CHECK_EQUAL(pyramid.level(1)->getDimension().y(), 65);
+    BOOST_CHECK_EQUAL(pyramid.level(3)->getDimension().x(), 25);
+    BOOST_CHECK_EQUAL(pyramid.level(3)->getDimension().y(), 17);
+    BOOST_CHECK_CLOSE(pyramid.level(2)->getResolution().x(), 0.2f, 1e-4);
+
+    // lowest free value, occupied wins, all unknown stays unknown
+    const GridMapLayer& level1 = *pyramid.level(1);
+    BOOST_CHECK_EQUAL(cell(level1, 5, 5), 30);
+    BOOST_CHECK_EQUAL(cell(level1, 10, 10), 200);
+    BOOST_CHECK_EQUAL(cell(level1, 0, 0), 0);
+    BOOST_CHECK_EQUAL(cell(level1, 99, 64), 255);
+    BOOST_CHECK_EQUAL(cell(*pyramid.level(3), 24, 16), 255);
+
+    BOOST_CHECK(!pyramid.levelFor(0.05f));
+    BOOST_CHECK(pyramid.levelFor(0.3f) == pyramid.level(2));
+    BOOST_CHECK(pyramid.levelFor(10.0f) == pyramid.level(3));
+}
+
+BOOST_AUTO_TEST_CASE(update_matches_a_rebuild)
+{
+    boost::shared_ptr<GridMapLayer> base = baseLayer(300, 170);
+    GridMapPyramid pyramid;
+    pyramid.build(*base);
+    BOOST_CHECK(!pyramid.dirty());
+
+    for (int x = 70; x < 140; x++)
+        setCell(*base, x, 100, 255);
+    setCell(*base, 299, 169, 60);
+    pyramid.markDirty(70, 100, 70, 1);
+    pyramid.markDirty(299, 169, 1, 1);
+    BOOST_CHECK(pyramid.dirty());
+
+    size_t cells = pyramid.update(*base);
+    BOOST_CHECK(!pyramid.dirty());
+    BOOST_CHECK_GT(cells, 0u);
+    BOOST_CHECK_LT(cells, pyramid.level(1)->mapData().size());
+
+    GridMapPyramid rebuilt;
+    rebuilt.build(*base);
+    BOOST_REQUIRE_EQUAL(rebuilt.levelCount(), pyramid.levelCount());
+    for (size_t level = 1; level <= rebuilt.levelCount(); level++)
+        BOOST_CHECK(rebuilt.level(level)->mapData() == pyramid.level(level)->mapData());
+}
+
+BOOST_AUTO_TEST_CASE(levels_round_trip_through_a_composite_map)
+{
+    boost::shared_ptr<GridMapLayer> base = baseLayer(128, 128);
+    setCell(*base, 64, 64, 255);
+    CompositeMap map;
+    map.maps().push_back(base);
+
+    GridMapPyramid pyramid;
+    pyramid.build(*base);
+    pyramid.attachTo(map);
+    pyramid.attachTo(map);
+    BOOST_CHECK_EQUAL(map.maps().size(), 1u + pyramid.levelCount());
+
+    GridMapPyramid loaded;
+    BOOST_REQUIRE(loaded.load(map, *base));
+    BOOST_CHECK_EQUAL(loaded.levelCount(), pyramid.levelCount());
+    BOOST_CHECK(loaded.level(1) == pyramid.level(1));
+
+    // a base of another size does not match the stored levels
+    boost::shared_ptr<GridMapLayer> other = baseLayer(64, 64);
+    BOOST_CHECK(!loaded.load(map, *other));
+    BOOST_CHECK_EQUAL(loaded.levelCount(), 0u);
+
+    GridMapPyramid::detachFrom(map, "explore");
+    BOOST_CHECK_EQUAL(map.maps().size(), 1u);
+}
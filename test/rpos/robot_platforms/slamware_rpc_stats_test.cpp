@@ -0,0 +1,88 @@
+/*
+* slamware_rpc_stats_test.cpp
+* Recording, export and summary window of RpcInstrumentation
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE slamware_rpc_stats
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/robot_platforms/slamware_rpc_stats.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace rpos::robot_platforms;
+
+namespace {
+
+    RpcInstrumentation::Options privateOptions(int summaryIntervalMs)
+    {
+        RpcInstrumentation::Options options;
+        options.summaryIntervalMs = summaryIntervalMs;
+        options.registry = nullptr;
+        return options;
+    }
+
+    std::uint64_t callsInWindow(const RpcInstrumentation& stats)
+    {
+        std::vector<RpcMethodSummary> summaries = stats.summaries();
+        return summaries.empty() ? 0 : summaries[0].total.count();
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(calls_and_failures_are_recorded)
+{
+    rpos::system::util::MetricsRegistry registry;
+    RpcInstrumentation::Options options = privateOptions(0);
+    options.registry = &registry;
+    RpcInstrumentation stats(options);
+
+    BOOST_CHECK_EQUAL(stats.call("getPose", []() { return 42; }), 42);
+    BOOST_CHECK_THROW(stats.call("getPose", []() -> int { throw std::runtime_error("timeout"); }), std::runtime_error);
+    {
+        RpcCallScope call(stats.method("getMap"));
+        call.setRequestBytes(100);
+        call.markSerialized();
+        call.markReceived(4000, 1000000);
+    }
+
+    std::vector<RpcMethodSummary> summaries = stats.summaries();
+    BOOST_REQUIRE_EQUAL(summaries.size(), 2u);
+    const RpcMethodSummary& pose = summaries[0].method == "getPose" ? summaries[0] : summaries[1];
+    const RpcMethodSummary& map = summaries[0].method == "getMap" ? summaries[0] : summaries[1];
+    BOOST_CHECK_EQUAL(pose.calls, 2u);
+    BOOST_CHECK_EQUAL(pose.failures, 1u);
+    BOOST_CHECK_EQUAL(pose.roundTrip.count(), 0u);
+    BOOST_CHECK_EQUAL(map.requestBytes, 100u);
+    BOOST_CHECK_EQUAL(map.responseBytes, 4000u);
+    BOOST_CHECK_EQUAL(map.server.count(), 1u);
+    BOOST_CHECK_EQUAL(stats.formatSummary().size(), 2u);
+
+    std::string text = registry.render();
+    BOOST_CHECK(text.find("rpos_rpc_calls_total{method=\"getPose\"} 2\n") != std::string::npos);
+    BOOST_CHECK(text.find("rpos_rpc_failures_total{method=\"getPose\"} 1\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(summaries_cover_the_whole_summary_interval)
+{
+    const int intervalMs = 300;
+    RpcInstrumentation stats(privateOptions(intervalMs));
+    stats.method("getPose").record(1000000, false);
+    BOOST_CHECK_EQUAL(callsInWindow(stats), 1u);
+
+    // a call made right after a summary is still in the next one
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(intervalMs));
+    BOOST_CHECK_EQUAL(callsInWindow(stats), 1u);
+
+    // older than two windows it is gone, but still counted in the totals
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(intervalMs * 2 + 50));
+    stats.method("getPose").record(1000000, false);
+    BOOST_CHECK_EQUAL(callsInWindow(stats), 1u);
+    BOOST_CHECK_EQUAL(stats.summaries()[0].calls, 2u);
+}
@@ -0,0 +1,172 @@
+/*
+* fast_digest_benchmark.cpp
+* CRC32C and xxHash64 against SHA-256, and digestBatch against a serial digest() loop
+*
+* Usage: fast_digest_benchmark [megabytes]
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#include <rpos/system/crypto/batch_digest.h>
+#include <rpos/system/crypto/digest.h>
+#include <rpos/system/crypto/fast_digest.h>
+
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace rpos::system::crypto;
+
+namespace {
+
+    typedef boost::chrono::steady_clock clock_t_;
+
+    double secondsSince(const clock_t_::time_point& start)
+    {
+        return boost::chrono::duration<double>(clock_t_::now() - start).count();
+    }
+
+    void report(const char* name, size_t bytes, double seconds, unsigned checksum)
+    {
+        printf("%-36s %9.1f MB/s  (checksum %02x)\n", name, bytes / seconds / (1024.0 * 1024.0), checksum & 0xff);
+    }
+
+    std::vector<std::uint8_t> pattern(size_t size, std::uint32_t seed)
+    {
+        std::vector<std::uint8_t> data(size);
+        std::uint32_t x = seed * 2654435761u + 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            data[i] = static_cast<std::uint8_t>(x);
+        }
+        return data;
+    }
+
+    unsigned fold(const std::vector<std::uint8_t>& digest)
+    {
+        unsigned checksum = 0;
+        for (size_t i = 0; i < digest.size(); i++)
+            checksum += digest[i];
+        return checksum;
+    }
+
+    unsigned fold(const std::vector<std::vector<std::uint8_t>>& digests)
+    {
+        unsigned checksum = 0;
+        for (size_t i = 0; i < digests.size(); i++)
+            checksum += fold(digests[i]);
+        return checksum;
+    }
+
+    /**
+    * Hash `total` bytes as consecutive blocks of one buffer
+    */
+    template < class DigestFunctionT >
+    void singleBufferThroughput(const char* name, const std::vector<std::uint8_t>& data, size_t block, size_t total, DigestFunctionT digestFunction)
+    {
+        char label[64];
+        unsigned checksum = 0;
+        size_t blocks = data.size() / block;
+        clock_t_::time_point start = clock_t_::now();
+        for (size_t done = 0, i = 0; done < total; done += block, i++)
+            checksum += digestFunction(&data[(i % blocks) * block], block);
+        snprintf(label, sizeof(label), "%s, %u byte blocks", name, static_cast<unsigned>(block));
+        report(label, total, secondsSince(start), checksum);
+    }
+
+    unsigned sha256Of(const void* buffer, size_t size)
+    {
+        return fold(digest(DigestAlgorithmSHA256, buffer, size));
+    }
+
+    unsigned crc32cOf(const void* buffer, size_t size)
+    {
+        return crc32c(buffer, size);
+    }
+
+    unsigned xxhash64Of(const void* buffer, size_t size)
+    {
+        return static_cast<unsigned>(xxhash64(buffer, size));
+    }
+
+    /**
+    * What callers do without digestBatch: one digest() per input on the calling thread
+    */
+    std::vector<std::vector<std::uint8_t>> serialDigests(DigestAlgorithm algorithm, const std::vector<DigestInput>& inputs)
+    {
+        std::vector<std::vector<std::uint8_t>> results;
+        results.reserve(inputs.size());
+        for (auto iter = inputs.begin(); iter != inputs.end(); ++iter)
+            results.push_back(digest(algorithm, iter->buffer, iter->size));
+        return results;
+    }
+
+    std::vector<std::vector<std::uint8_t>> serialDigests(FastDigestAlgorithm algorithm, const std::vector<DigestInput>& inputs)
+    {
+        std::vector<std::vector<std::uint8_t>> results;
+        results.reserve(inputs.size());
+        for (auto iter = inputs.begin(); iter != inputs.end(); ++iter)
+            results.push_back(fastDigest(algorithm, iter->buffer, iter->size));
+        return results;
+    }
+
+    template < class AlgorithmT >
+    void batchThroughput(const char* name, AlgorithmT algorithm, const std::vector<DigestInput>& inputs, size_t bytes)
+    {
+        char label[64];
+        clock_t_::time_point start = clock_t_::now();
+        unsigned checksum = fold(serialDigests(algorithm, inputs));
+        snprintf(label, sizeof(label), "%s, serial digest()", name);
+        report(label, bytes, secondsSince(start), checksum);
+
+        start = clock_t_::now();
+        checksum = fold(digestBatch(algorithm, inputs));
+        snprintf(label, sizeof(label), "%s, digestBatch", name);
+        report(label, bytes, secondsSince(start), checksum);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t total = static_cast<size_t>(argc > 1 ? atoi(argv[1]) : 256) * 1024 * 1024;
+    const size_t blocks[] = { 64, 4096, 1024 * 1024 };
+
+    std::vector<std::uint8_t> data = pattern(4 * 1024 * 1024, 1);
+    printf("== single buffer, %u MB\n", static_cast<unsigned>(total >> 20));
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        // SHA-256 is an order of magnitude slower, keep its run short
+        singleBufferThroughput("SHA-256", data, blocks[i], total / 8, &sha256Of);
+        singleBufferThroughput("CRC32C", data, blocks[i], total, &crc32cOf);
+        singleBufferThroughput("xxHash64", data, blocks[i], total, &xxhash64Of);
+    }
+
+    // a firmware upload next to a map sync: a few large blobs and many small tiles
+    std::vector<std::vector<std::uint8_t>> buffers;
+    size_t bytes = 0;
+    for (std::uint32_t i = 0; bytes < total / 4; i++)
+    {
+        buffers.push_back(pattern(i % 64 == 0 ? 4 * 1024 * 1024 : 16 * 1024, i));
+        bytes += buffers.back().size();
+    }
+    std::vector<DigestInput> inputs(buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        inputs[i].buffer = &buffers[i][0];
+        inputs[i].size = buffers[i].size();
+    }
+
+    printf("== %u inputs, %u MB, %u hardware threads\n", static_cast<unsigned>(inputs.size()), static_cast<unsigned>(bytes >> 20), boost::thread::hardware_concurrency());
+    batchThroughput("SHA-256", DigestAlgorithmSHA256, inputs, bytes);
+    batchThroughput("CRC32C", FastDigestAlgorithmCRC32C, inputs, bytes);
+    batchThroughput("xxHash64", FastDigestAlgorithmXXHash64, inputs, bytes);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+* fast_digest_test.cpp
+* Known answer tests for CRC32C and xxHash64, and digestBatch
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE fast_digest
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/crypto/batch_digest.h>
+#include <rpos/system/crypto/fast_digest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace rpos::system::crypto;
+
+namespace {
+
+    std::vector<std::uint8_t> pattern(size_t size, std::uint32_t seed)
+    {
+        std::vector<std::uint8_t> data(size);
+        std::uint32_t x = seed * 2654435761u + 1;
+        for (size_t i = 0; i < size; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            data[i] = static_cast<std::uint8_t>(x);
+        }
+        return data;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_known_answers)
+{
+    // check value of the CRC-32C catalogue entry and the RFC 3720 (iSCSI) vectors
+    BOOST_CHECK_EQUAL(crc32c("123456789", 9), 0xE3069283u);
+    BOOST_CHECK_EQUAL(crc32c("", 0), 0u);
+
+    std::uint8_t zeros[32] = { 0 };
+    std::uint8_t ones[32];
+    std::uint8_t ascending[32];
+    std::uint8_t descending[32];
+    memset(ones, 0xFF, sizeof(ones));
+    for (int i = 0; i < 32; i++)
+    {
+        ascending[i] = static_cast<std::uint8_t>(i);
+        descending[i] = static_cast<std::uint8_t>(31 - i);
+    }
+    BOOST_CHECK_EQUAL(crc32c(zeros, 32), 0x8A9136AAu);
+    BOOST_CHECK_EQUAL(crc32c(ones, 32), 0x62A8AB43u);
+    BOOST_CHECK_EQUAL(crc32c(ascending, 32), 0x46DD794Eu);
+    BOOST_CHECK_EQUAL(crc32c(descending, 32), 0x113FDB5Cu);
+}
+
+BOOST_AUTO_TEST_CASE(crc32c_hardware_matches_software)
+{
+    std::vector<std::uint8_t> data = pattern(4099, 1);
+    for (size_t offset = 0; offset < 9; offset++)
+    {
+        for (size_t size = 0; size + offset <= data.size(); size += 37)
+        {
+            std::uint32_t software = detail::crc32cSoftware(0xFFFFFFFFu, &data[offset], size);
+            std::uint32_t dispatched = detail::crc32cUpdate(0xFFFFFFFFu, &data[offset], size);
+            BOOST_REQUIRE_EQUAL(software, dispatched);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(xxhash64_known_answers)
+{
+    BOOST_CHECK_EQUAL(xxhash64("", 0), 0xEF46DB3751D8E999ULL);
+    BOOST_CHECK_EQUAL(xxhash64("a", 1), 0xD24EC4F1A98C6E5BULL);
+    BOOST_CHECK_EQUAL(xxhash64("abc", 3), 0x44BC2CF5AD770999ULL);
+
+    const char* sentence = "Nobody inspects the spammish repetition";
+    BOOST_CHECK_EQUAL(xxhash64(sentence, strlen(sentence)), 0xFBCEA83C8A378BF1ULL);
+}
+
+BOOST_AUTO_TEST_CASE(digest_bytes_are_big_endian)
+{
+    std::vector<std::uint8_t> crc = fastDigest(FastDigestAlgorithmCRC32C, "123456789", 9);
+    std::uint8_t expectedCrc[] = { 0xE3, 0x06, 0x92, 0x83 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(crc.begin(), crc.end(), expectedCrc, expectedCrc + 4);
+
+    std::vector<std::uint8_t> xxh = fastDigest(FastDigestAlgorithmXXHash64, "abc", 3);
+    std::uint8_t expectedXXH[] = { 0x44, 0xBC, 0x2C, 0xF5, 0xAD, 0x77, 0x09, 0x99 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(xxh.begin(), xxh.end(), expectedXXH, expectedXXH + 8);
+}
+
+BOOST_AUTO_TEST_CASE(incremental_updates_match_one_shot)
+{
+    std::vector<std::uint8_t> data = pattern(10000, 2);
+    std::uint64_t expectedXXH = xxhash64(&data[0], data.size(), 42);
+    std::uint32_t expectedCrc = crc32c(&data[0], data.size());
+
+    const size_t splits[] = { 1, 3, 31, 32, 33, 64, 1000 };
+    for (size_t s = 0; s < sizeof(splits) / sizeof(splits[0]); s++)
+    {
+        XXHash64Digest xxh(42);
+        Crc32cDigest crc;
+        for (size_t offset = 0; offset < data.size(); offset += splits[s])
+        {
+            size_t size = std::min(splits[s], data.size() - offset);
+            xxh.update(&data[offset], size);
+            crc.update(&data[offset], size);
+        }
+        BOOST_CHECK_EQUAL(xxh.value(), expectedXXH);
+        BOOST_CHECK_EQUAL(crc.value(), expectedCrc);
+
+        xxh.reset();
+        xxh.update(&data[0], data.size());
+        BOOST_CHECK_EQUAL(xxh.value(), expectedXXH);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_digest_matches_individual_digests)
+{
+    // enough data to take the parallel path
+    std::vector<std::vector<std::uint8_t>> buffers;
+    for (int i = 0; i < 200; i++)
+        buffers.push_back(pattern((i % 7 == 0) ? 64 * 1024 + i : 100 + i, i));
+    buffers.push_back(std::vector<std::uint8_t>());
+
+    std::vector<DigestInput> inputs(buffers.size());
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        inputs[i].buffer = buffers[i].empty() ? nullptr : &buffers[i][0];
+        inputs[i].size = buffers[i].size();
+    }
+
+    const int concurrencies[] = { 1, 4 };
+    for (int c = 0; c < 2; c++)
+    {
+        std::vector<std::vector<std::uint8_t>> results = digestBatch(FastDigestAlgorithmXXHash64, inputs, concurrencies[c]);
+        BOOST_REQUIRE_EQUAL(results.size(), inputs.size());
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            std::vector<std::uint8_t> expected = fastDigest(FastDigestAlgorithmXXHash64, inputs[i].buffer, inputs[i].size);
+            BOOST_CHECK(results[i] == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_digest_reports_factory_failure)
+{
+    std::vector<std::uint8_t> data = pattern(1024, 3);
+    std::vector<DigestInput> inputs(3);
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        inputs[i].buffer = &data[0];
+        inputs[i].size = data.size();
+    }
+
+    digest_factory_t failing = []() -> boost::shared_ptr<IDigest> { throw std::runtime_error("no digest"); };
+    BOOST_CHECK_THROW(digestBatch(failing, inputs), std::runtime_error);
+}
@@ -0,0 +1,179 @@
+/*
+* content_addressed_blob_store_test.cpp
+* Tests for ContentAddressedBlobStore
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE content_addressed_blob_store
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/diagnosis/content_addressed_blob_store.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace rpos::system;
+using namespace rpos::system::diagnosis;
+
+namespace {
+
+    struct TempFolder {
+        TempFolder()
+            : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("blob-store-test-%%%%-%%%%"))
+        {}
+
+        ~TempFolder()
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(path, ec);
+        }
+
+        boost::filesystem::path path;
+    };
+
+    std::string repeated(const std::string& text, int count)
+    {
+        std::string result;
+        for (int i = 0; i < count; i++)
+            result += text;
+        return result;
+    }
+
+    void fill(io::MemoryWriteStream& blob, const std::string& text, int count)
+    {
+        std::string data = repeated(text, count);
+        blob.write(data.data(), data.size());
+    }
+
+    std::string readAll(const boost::shared_ptr<io::IStream>& stream)
+    {
+        std::string data;
+        char buffer[4096];
+        for (;;)
+        {
+            int n = stream->read(buffer, sizeof(buffer));
+            if (n <= 0)
+                break;
+            data.append(buffer, n);
+        }
+        return data;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(identical_blobs_are_stored_once)
+{
+    TempFolder folder;
+    ContentAddressedBlobStore store(folder.path.string());
+
+    io::MemoryWriteStream a, b, c;
+    fill(a, "scan", 100);
+    fill(b, "scan", 100);
+    fill(c, "map", 100);
+
+    std::string idA = store.store(a);
+    std::string idB = store.store(b);
+    std::string idC = store.store(c);
+
+    BOOST_CHECK_EQUAL(idA, idB);
+    BOOST_CHECK_NE(idA, idC);
+    BOOST_CHECK_EQUAL(idA.size(), 64u);
+    BOOST_CHECK_EQUAL(store.blobCount(), 2u);
+    BOOST_CHECK_EQUAL(store.dedupedStores(), 1u);
+    BOOST_CHECK(boost::filesystem::exists(folder.path / idA.substr(0, 2) / idA));
+}
+
+BOOST_AUTO_TEST_CASE(index_is_reloaded_from_disk)
+{
+    TempFolder folder;
+    std::string id;
+    {
+        ContentAddressedBlobStore store(folder.path.string());
+        io::MemoryWriteStream blob;
+        fill(blob, "persisted", 10);
+        id = store.store(blob);
+    }
+
+    // stray files in the folder are not blobs
+    boost::filesystem::create_directories(folder.path / "zz");
+    io::FileStream stray;
+    BOOST_REQUIRE(stray.open((folder.path / "zz" / "not-a-blob").string(), io::OpenFileModeWrite));
+    stray.close();
+
+    ContentAddressedBlobStore reopened(folder.path.string());
+    std::list<std::string> ids;
+    reopened.enumerate(ids);
+    BOOST_REQUIRE_EQUAL(ids.size(), 1u);
+    BOOST_CHECK_EQUAL(ids.front(), id);
+    BOOST_CHECK(reopened.has(id));
+    BOOST_CHECK_EQUAL(readAll(reopened.load(id)), repeated("persisted", 10));
+}
+
+BOOST_AUTO_TEST_CASE(compressed_blobs_round_trip)
+{
+    TempFolder folder;
+    ContentAddressedBlobStore::Options options;
+    options.compress = true;
+    ContentAddressedBlobStore store(folder.path.string(), options);
+
+    std::string expected = repeated("compressible line of log text\n", 1000);
+    io::MemoryWriteStream blob;
+    fill(blob, "compressible line of log text\n", 1000);
+
+    std::string id = store.store(blob);
+    boost::filesystem::path file = folder.path / id.substr(0, 2) / (id + ".gz");
+    BOOST_REQUIRE(boost::filesystem::exists(file));
+    BOOST_CHECK_LT(boost::filesystem::file_size(file), blob.size() / 10);
+    BOOST_CHECK_EQUAL(readAll(store.load(id)), expected);
+
+    // a plain store reads blobs in whichever form they were stored
+    ContentAddressedBlobStore plain(folder.path.string());
+    BOOST_CHECK_EQUAL(readAll(plain.load(id)), expected);
+    BOOST_CHECK(!plain.load(std::string(64, '0')));
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_stores_deduplicate)
+{
+    TempFolder folder;
+    ContentAddressedBlobStore store(folder.path.string());
+
+    const int threads = 8;
+    const int blobsPerThread = 50;
+    std::vector<std::vector<std::string>> ids(threads);
+    std::vector<boost::thread*> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.push_back(new boost::thread([&store, &ids, t, blobsPerThread]() {
+            for (int i = 0; i < blobsPerThread; i++)
+            {
+                // every thread stores the same 25 distinct blobs twice
+                io::MemoryWriteStream blob;
+                fill(blob, "blob-" + std::to_string(i % 25), 20);
+                ids[t].push_back(store.store(blob));
+            }
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+
+    std::set<std::string> unique;
+    for (int t = 0; t < threads; t++)
+    {
+        BOOST_REQUIRE_EQUAL(ids[t].size(), static_cast<size_t>(blobsPerThread));
+        unique.insert(ids[t].begin(), ids[t].end());
+        BOOST_CHECK(ids[t] == ids[0]);
+    }
+    BOOST_CHECK_EQUAL(unique.size(), 25u);
+    BOOST_CHECK_EQUAL(store.blobCount(), 25u);
+    BOOST_CHECK_EQUAL(store.dedupedStores(), static_cast<size_t>(threads * blobsPerThread - 25));
+}
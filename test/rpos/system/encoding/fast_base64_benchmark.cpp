@@ -0,0 +1,151 @@
+/*
+* fast_base64_benchmark.cpp
+* Vectorized base64 encode and decode against Base64Encoder and Base64Decoder
+*
+* Usage: fast_base64_benchmark [megabytes]
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#include <rpos/system/encoding/base64_decoder.h>
+#include <rpos/system/encoding/base64_encoder.h>
+#include <rpos/system/encoding/fast_base64.h>
+
+#include <boost/chrono.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace rpos::system::encoding;
+
+namespace {
+
+    typedef boost::chrono::steady_clock clock_t_;
+
+    double secondsSince(const clock_t_::time_point& start)
+    {
+        return boost::chrono::duration<double>(clock_t_::now() - start).count();
+    }
+
+    void report(const char* name, size_t size, size_t bytes, double seconds, unsigned checksum)
+    {
+        printf("%-28s buffer %8u  %9.1f MB/s  (checksum %02x)\n", name, static_cast<unsigned>(size), bytes / seconds / (1024.0 * 1024.0), checksum & 0xff);
+    }
+
+    std::vector<std::uint8_t> pattern(size_t size)
+    {
+        std::vector<std::uint8_t> data(size);
+        std::uint32_t x = 0x12345678;
+        for (size_t i = 0; i < size; i++)
+        {
+            x = x * 1103515245 + 12345;
+            data[i] = static_cast<std::uint8_t>(x >> 16);
+        }
+        return data;
+    }
+
+    /**
+    * One encode() call over the whole buffer, the way EncodingStream feeds a complete message
+    */
+    size_t encodeWith(IEncoder& encoder, const void* src, size_t size, void* dest, size_t destSize)
+    {
+        size_t consumedSrc = 0, consumedDest = 0;
+        encoder.reset();
+        if (!encoder.encode(src, size, dest, destSize, StreamPositionEnd, consumedSrc, consumedDest) || consumedSrc != size)
+        {
+            fprintf(stderr, "encoder failed on a %u byte buffer\n", static_cast<unsigned>(size));
+            exit(1);
+        }
+        return consumedDest;
+    }
+
+    /**
+    * Run `rounds` conversions of src with each encoder and check they agree with the first one
+    */
+    void compare(const char* names[], IEncoder* encoders[], size_t count, const std::vector<std::uint8_t>& src, size_t destSize, size_t rounds, size_t bytesPerRound)
+    {
+        std::vector<std::uint8_t> expected;
+        std::vector<std::uint8_t> dest(destSize);
+        for (size_t i = 0; i < count; i++)
+        {
+            unsigned checksum = 0;
+            size_t written = 0;
+            clock_t_::time_point start = clock_t_::now();
+            for (size_t round = 0; round < rounds; round++)
+            {
+                written = encodeWith(*encoders[i], src.data(), src.size(), dest.data(), dest.size());
+                checksum += dest[round % written];
+            }
+            report(names[i], bytesPerRound, bytesPerRound * rounds, secondsSince(start), checksum);
+
+            std::vector<std::uint8_t> output(dest.begin(), dest.begin() + written);
+            if (!i)
+                expected.swap(output);
+            else if (output != expected)
+                printf("  output differs from %s\n", names[0]);
+        }
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t total = static_cast<size_t>(argc > 1 ? atoi(argv[1]) : 256) * 1024 * 1024;
+    const size_t sizes[] = { 48, 1024, 64 * 1024, 4 * 1024 * 1024 };
+
+    Base64Encoder encoder;
+    FastBase64Encoder fastEncoder;
+    Base64Decoder decoder;
+    FastBase64Decoder fastDecoder;
+    const char* encoderNames[] = { "Base64Encoder", "FastBase64Encoder" };
+    IEncoder* encoders[] = { &encoder, &fastEncoder };
+    const char* decoderNames[] = { "Base64Decoder", "FastBase64Decoder" };
+    IEncoder* decoders[] = { &decoder, &fastDecoder };
+
+    printf("== encode, %u MB of raw bytes\n", static_cast<unsigned>(total >> 20));
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        std::vector<std::uint8_t> raw = pattern(sizes[i]);
+        size_t rounds = total / sizes[i];
+        compare(encoderNames, encoders, 2, raw, base64EncodedSize(raw.size()), rounds, raw.size());
+
+        std::vector<char> text(base64EncodedSize(raw.size()));
+        unsigned checksum = 0;
+        clock_t_::time_point start = clock_t_::now();
+        for (size_t round = 0; round < rounds; round++)
+        {
+            size_t written = base64Encode(raw.data(), raw.size(), text.data());
+            checksum += static_cast<std::uint8_t>(text[round % written]);
+        }
+        report("base64Encode()", raw.size(), raw.size() * rounds, secondsSince(start), checksum);
+    }
+
+    printf("== decode, %u MB of raw bytes\n", static_cast<unsigned>(total >> 20));
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        std::vector<std::uint8_t> raw = pattern(sizes[i]);
+        std::string text = base64Encode(raw);
+        std::vector<std::uint8_t> encoded(text.begin(), text.end());
+        size_t rounds = total / sizes[i];
+        compare(decoderNames, decoders, 2, encoded, base64MaxDecodedSize(text.size()), rounds, raw.size());
+
+        std::vector<std::uint8_t> out(base64MaxDecodedSize(text.size()));
+        unsigned checksum = 0;
+        clock_t_::time_point start = clock_t_::now();
+        for (size_t round = 0; round < rounds; round++)
+        {
+            size_t decodedSize = 0;
+            if (!base64Decode(text.data(), text.size(), out.data(), decodedSize) || decodedSize != raw.size())
+            {
+                fprintf(stderr, "base64Decode failed on a %u byte buffer\n", static_cast<unsigned>(raw.size()));
+                return 1;
+            }
+            checksum += out[round % decodedSize];
+        }
+        report("base64Decode()", raw.size(), raw.size() * rounds, secondsSince(start), checksum);
+    }
+    return 0;
+}
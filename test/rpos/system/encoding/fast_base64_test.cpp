@@ -0,0 +1,193 @@
+/*
+* fast_base64_test.cpp
+* Known answer and malformed input tests for the vectorized base64 encoder and decoder
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE fast_base64
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/encoding/fast_base64.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace rpos::system::encoding;
+
+namespace {
+
+    std::vector<std::uint8_t> bytes(const std::string& text)
+    {
+        return std::vector<std::uint8_t>(text.begin(), text.end());
+    }
+
+    std::vector<std::uint8_t> pattern(size_t size)
+    {
+        std::vector<std::uint8_t> data(size);
+        std::uint32_t x = 0x12345678;
+        for (size_t i = 0; i < size; i++)
+        {
+            x = x * 1103515245 + 12345;
+            data[i] = static_cast<std::uint8_t>(x >> 16);
+        }
+        return data;
+    }
+
+    bool decodes(const std::string& text)
+    {
+        std::vector<std::uint8_t> out;
+        return base64Decode(text, out);
+    }
+
+    /**
+    * Feed the decoder in pieces of `step` chars, the way EncodingStream does
+    */
+    bool streamDecode(const std::string& text, size_t step, std::vector<std::uint8_t>& out)
+    {
+        FastBase64Decoder decoder;
+        out.assign(base64MaxDecodedSize(text.size()) + 3, 0);
+        size_t srcOffset = 0, destOffset = 0, available = 0;
+        for (;;)
+        {
+            available = std::min(text.size(), available + step);
+            bool end = (available == text.size());
+            size_t consumedSrc = 0, consumedDest = 0;
+            if (!decoder.encode(text.data() + srcOffset, available - srcOffset, &out[destOffset], out.size() - destOffset,
+                end ? StreamPositionEnd : StreamPositionBody, consumedSrc, consumedDest))
+                return false;
+            srcOffset += consumedSrc;
+            destOffset += consumedDest;
+            if (end)
+                break;
+        }
+        out.resize(destOffset);
+        return srcOffset == text.size();
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(rfc4648_vectors)
+{
+    const char* vectors[][2] = {
+        { "", "" },
+        { "f", "Zg==" },
+        { "fo", "Zm8=" },
+        { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" },
+        { "fooba", "Zm9vYmE=" },
+        { "foobar", "Zm9vYmFy" },
+    };
+
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        std::vector<std::uint8_t> plain = bytes(vectors[i][0]);
+        BOOST_CHECK_EQUAL(base64Encode(plain), vectors[i][1]);
+
+        std::vector<std::uint8_t> decoded;
+        BOOST_CHECK(base64Decode(vectors[i][1], decoded));
+        BOOST_CHECK(decoded == plain);
+    }
+
+    // unpadded input is accepted as well
+    std::vector<std::uint8_t> decoded;
+    BOOST_CHECK(base64Decode("Zm9vYg", decoded));
+    BOOST_CHECK(decoded == bytes("foob"));
+    BOOST_CHECK(base64Decode("Zm9vYmE", decoded));
+    BOOST_CHECK(decoded == bytes("fooba"));
+}
+
+BOOST_AUTO_TEST_CASE(all_byte_values_round_trip)
+{
+    std::vector<std::uint8_t> data(256);
+    for (int i = 0; i < 256; i++)
+        data[i] = static_cast<std::uint8_t>(i);
+
+    std::string text = base64Encode(data);
+    BOOST_CHECK_EQUAL(text.substr(0, 12), "AAECAwQFBgcI");
+    BOOST_CHECK_EQUAL(text.substr(text.size() - 8), "/P3+/w==");
+
+    std::vector<std::uint8_t> decoded;
+    BOOST_REQUIRE(base64Decode(text, decoded));
+    BOOST_CHECK(decoded == data);
+}
+
+BOOST_AUTO_TEST_CASE(vector_paths_match_scalar)
+{
+    // long enough to go through the AVX2 / SSSE3 / NEON loops, with every tail length
+    for (size_t size = 0; size < 400; size += 7)
+    {
+        std::vector<std::uint8_t> data = pattern(size);
+        std::string text = base64Encode(data);
+        BOOST_REQUIRE_EQUAL(text.size(), base64EncodedSize(size));
+
+        std::string scalar(size / 3 * 4, '\0');
+        if (!scalar.empty())
+            detail::base64EncodeScalar(&data[0], size / 3, &scalar[0]);
+        BOOST_REQUIRE_EQUAL(text.substr(0, scalar.size()), scalar);
+
+        std::vector<std::uint8_t> decoded;
+        BOOST_REQUIRE(base64Decode(text, decoded));
+        BOOST_REQUIRE(decoded == data);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(invalid_characters_are_rejected)
+{
+    std::string text = base64Encode(pattern(300));
+    const size_t positions[] = { 0, 5, 63, 150, 250, text.size() - 3 };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+        std::string broken = text;
+        broken[positions[i]] = '*';
+        BOOST_CHECK(!decodes(broken));
+        broken[positions[i]] = '\x80';
+        BOOST_CHECK(!decodes(broken));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(malformed_padding_is_rejected)
+{
+    const char* malformed[] = {
+        "====",
+        "A===",
+        "AAAA=",
+        "AAAA==",
+        "AA=",
+        "AAA==",
+        "A",
+        "AAAAA",
+        "AA=A",
+        "A=AA",
+        "Zg==Zm8=",
+        "Zm8=Zm9v",
+        "Zm9v====",
+    };
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    {
+        BOOST_TEST_CONTEXT(malformed[i])
+        {
+            BOOST_CHECK(!decodes(malformed[i]));
+            std::vector<std::uint8_t> out;
+            BOOST_CHECK(!streamDecode(malformed[i], 4, out));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(streaming_decoder_matches_one_shot)
+{
+    std::vector<std::uint8_t> data = pattern(1000);
+    for (size_t size = 1; size < 40; size++)
+    {
+        std::vector<std::uint8_t> expected(data.begin(), data.begin() + size * 23);
+        std::string text = base64Encode(expected);
+        const size_t steps[] = { 1, 3, 4, 17, 64 };
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++)
+        {
+            std::vector<std::uint8_t> decoded;
+            BOOST_REQUIRE(streamDecode(text, steps[s], decoded));
+            BOOST_REQUIRE(decoded == expected);
+        }
+    }
+}
@@ -0,0 +1,253 @@
+/*
+* pipelined_encoding_stream_test.cpp
+* Tests for PipelinedEncodingStream with serial and parallel stages
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE pipelined_encoding_stream
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/encoding/pipelined_encoding_stream.h>
+
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace rpos::system::encoding;
+
+namespace {
+
+    /**
+    * XOR with a constant, blocks are independent so it can run in a parallel stage
+    */
+    class XorEncoder : public IEncoder {
+    public:
+        explicit XorEncoder(std::uint8_t key, boost::atomic<int>* instances = nullptr)
+            : key_(key)
+        {
+            if (instances)
+                (*instances)++;
+        }
+
+        virtual bool encode(const void* srcBuffer, size_t srcSize, void* destBuffer, size_t destSize, StreamPosition, size_t& consumedSrcSize, size_t& consumedDestSize)
+        {
+            size_t n = std::min(srcSize, destSize);
+            const std::uint8_t* src = static_cast<const std::uint8_t*>(srcBuffer);
+            std::uint8_t* dest = static_cast<std::uint8_t*>(destBuffer);
+            for (size_t i = 0; i < n; i++)
+                dest[i] = src[i] ^ key_;
+            consumedSrcSize = n;
+            consumedDestSize = n;
+            return true;
+        }
+
+        virtual size_t estimateEncodedSize(const void*, size_t srcSize) { return srcSize; }
+        virtual size_t estimateEncodedSize(size_t srcSize) { return srcSize; }
+        virtual void reset() {}
+
+    private:
+        std::uint8_t key_;
+    };
+
+    /**
+    * Running sum, every output byte depends on all previous input, so chunk order matters.
+    * Appends a trailer byte at the end of the stream
+    */
+    class RunningSumEncoder : public IEncoder {
+    public:
+        RunningSumEncoder()
+            : sum_(0)
+            , ended_(false)
+        {}
+
+        virtual bool encode(const void* srcBuffer, size_t srcSize, void* destBuffer, size_t destSize, StreamPosition position, size_t& consumedSrcSize, size_t& consumedDestSize)
+        {
+            const std::uint8_t* src = static_cast<const std::uint8_t*>(srcBuffer);
+            std::uint8_t* dest = static_cast<std::uint8_t*>(destBuffer);
+            size_t n = std::min(srcSize, destSize);
+            for (size_t i = 0; i < n; i++)
+            {
+                sum_ = static_cast<std::uint8_t>(sum_ + src[i]);
+                dest[i] = sum_;
+            }
+            consumedSrcSize = n;
+            consumedDestSize = n;
+            if (position == StreamPositionEnd && n == srcSize && !ended_ && destSize > n)
+            {
+                dest[consumedDestSize++] = 0xEE;
+                ended_ = true;
+            }
+            return true;
+        }
+
+        virtual size_t estimateEncodedSize(const void*, size_t srcSize) { return srcSize + 1; }
+        virtual size_t estimateEncodedSize(size_t srcSize) { return srcSize + 1; }
+
+        virtual void reset()
+        {
+            sum_ = 0;
+            ended_ = false;
+        }
+
+    private:
+        std::uint8_t sum_;
+        bool ended_;
+    };
+
+    class FailingEncoder : public XorEncoder {
+    public:
+        FailingEncoder()
+            : XorEncoder(0)
+        {}
+
+        virtual bool encode(const void*, size_t, void*, size_t, StreamPosition, size_t&, size_t&)
+        {
+            return false;
+        }
+    };
+
+    std::vector<std::uint8_t> pattern(size_t size)
+    {
+        std::vector<std::uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+            data[i] = static_cast<std::uint8_t>(i * 131 + (i >> 9));
+        return data;
+    }
+
+    std::vector<std::uint8_t> expectedOutput(const std::vector<std::uint8_t>& input, std::uint8_t key)
+    {
+        std::vector<std::uint8_t> output(input.size());
+        std::uint8_t sum = 0;
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            sum = static_cast<std::uint8_t>(sum + input[i]);
+            output[i] = sum ^ key;
+        }
+        output.push_back(0xEE ^ key);
+        return output;
+    }
+
+    std::vector<std::uint8_t> encodeAll(PipelinedEncodingStream& stream, const std::vector<std::uint8_t>& input, size_t writeSize)
+    {
+        std::vector<std::uint8_t> output;
+        std::vector<std::uint8_t> buffer(8192);
+        for (size_t offset = 0; offset < input.size(); offset += writeSize)
+        {
+            size_t n = std::min(writeSize, input.size() - offset);
+            BOOST_REQUIRE_EQUAL(stream.write(&input[offset], n), static_cast<int>(n));
+
+            // interleaved non-blocking reads
+            int got = stream.read(&buffer[0], buffer.size());
+            BOOST_REQUIRE_GE(got, 0);
+            output.insert(output.end(), buffer.begin(), buffer.begin() + got);
+        }
+        stream.endWrite();
+
+        for (;;)
+        {
+            int got = stream.read(&buffer[0], buffer.size());
+            BOOST_REQUIRE_GE(got, 0);
+            if (!got)
+                break;
+            output.insert(output.end(), buffer.begin(), buffer.begin() + got);
+        }
+        BOOST_CHECK(stream.endOfStream());
+        return output;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(serial_then_parallel_stage_matches_sequential_encoding)
+{
+    RunningSumEncoder sum;
+    boost::atomic<int> instances(0);
+    std::vector<EncodingStage> stages;
+    stages.push_back(EncodingStage::serial(sum));
+    stages.push_back(EncodingStage::parallel([&instances]() { return boost::make_shared<XorEncoder>(0x5A, &instances); }, 4096, 3));
+
+    PipelinedEncodingStream stream(stages, 1000, 2);
+    std::vector<std::uint8_t> input = pattern(1024 * 1024 + 17);
+    std::vector<std::uint8_t> output = encodeAll(stream, input, 3001);
+
+    BOOST_CHECK(output == expectedOutput(input, 0x5A));
+    BOOST_CHECK(!stream.failed());
+    // one encoder per pool worker, created once for the whole stream
+    BOOST_CHECK_EQUAL(instances.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(reset_reuses_the_stream)
+{
+    RunningSumEncoder sum;
+    std::vector<EncodingStage> stages;
+    stages.push_back(EncodingStage::parallel([]() { return boost::make_shared<XorEncoder>(0x0F); }, 512, 4));
+    stages.push_back(EncodingStage::serial(sum));
+
+    PipelinedEncodingStream stream(stages, 4096, 2);
+    for (int round = 0; round < 3; round++)
+    {
+        std::vector<std::uint8_t> input = pattern(100000 + round * 333);
+        std::vector<std::uint8_t> xored(input);
+        for (size_t i = 0; i < xored.size(); i++)
+            xored[i] ^= 0x0F;
+
+        std::vector<std::uint8_t> output = encodeAll(stream, input, 777);
+        BOOST_CHECK(output == expectedOutput(xored, 0));
+        stream.reset();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(empty_input_still_flushes_the_end)
+{
+    RunningSumEncoder sum;
+    std::vector<EncodingStage> stages;
+    stages.push_back(EncodingStage::serial(sum));
+
+    PipelinedEncodingStream stream(stages);
+    std::vector<std::uint8_t> output = encodeAll(stream, std::vector<std::uint8_t>(), 1);
+    BOOST_REQUIRE_EQUAL(output.size(), 1u);
+    BOOST_CHECK_EQUAL(output[0], 0xEE);
+}
+
+BOOST_AUTO_TEST_CASE(encoder_failure_fails_the_stream)
+{
+    std::vector<EncodingStage> stages;
+    stages.push_back(EncodingStage::parallel([]() { return boost::make_shared<FailingEncoder>(); }, 1024, 2));
+
+    PipelinedEncodingStream stream(stages, 1024, 1);
+    std::vector<std::uint8_t> input = pattern(64 * 1024);
+    for (size_t offset = 0; offset < input.size(); offset += 1024)
+    {
+        if (stream.write(&input[offset], 1024) < 0)
+            break;
+    }
+    stream.endWrite();
+
+    std::uint8_t buffer[256];
+    BOOST_CHECK_EQUAL(stream.read(buffer, sizeof(buffer)), -1);
+    BOOST_CHECK(stream.failed());
+}
+
+BOOST_AUTO_TEST_CASE(worker_pool_runs_every_item_once)
+{
+    detail::EncodingWorkerPool pool(4);
+    for (int round = 0; round < 200; round++)
+    {
+        size_t count = static_cast<size_t>(round % 13);
+        std::vector<boost::atomic<int>> hits(count);
+        std::vector<int> workers(count, -1);
+        pool.run(count, [&](size_t item, size_t worker) {
+            hits[item]++;
+            workers[item] = static_cast<int>(worker);
+        });
+        for (size_t i = 0; i < count; i++)
+        {
+            BOOST_REQUIRE_EQUAL(hits[i].load(), 1);
+            BOOST_REQUIRE(workers[i] >= 0 && workers[i] < 4);
+        }
+    }
+}
@@ -0,0 +1,234 @@
+/*
+* snapshot_exporter_test.cpp
+* Tests for exportSnapshot, exportSnapshotToFile and SnapshotExporter
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE snapshot_exporter
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/io/snapshot_exporter.h>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace rpos::system::io;
+
+namespace {
+
+    SnapshotLoopBufferMemoryWriteStream::Options streamOptions()
+    {
+        SnapshotLoopBufferMemoryWriteStream::Options options;
+        options.capcity = 4 * 1024 * 1024;
+        options.split_size = 64 * 1024;
+        return options;
+    }
+
+    void writePattern(SnapshotLoopBufferMemoryWriteStream& stream, std::uint32_t seed, size_t size)
+    {
+        std::vector<std::uint8_t> block(4096);
+        for (size_t written = 0; written < size; written += block.size())
+        {
+            for (size_t i = 0; i < block.size(); i++)
+                block[i] = static_cast<std::uint8_t>((seed + written + i) * 31 >> 3);
+            stream.write(&block[0], std::min(block.size(), size - written));
+        }
+    }
+
+    std::vector<std::uint8_t> readSnapshot(const SnapshotLoopBufferMemoryWriteStream::Snapshot& snapshot)
+    {
+        std::vector<std::uint8_t> data(snapshot.size());
+        if (!data.empty())
+            BOOST_REQUIRE_EQUAL(snapshot.read(0, &data[0], data.size()), static_cast<int>(data.size()));
+        return data;
+    }
+
+    std::string readFile(const std::string& filename)
+    {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::string gunzip(const std::string& compressed)
+    {
+        std::istringstream in(compressed);
+        boost::iostreams::filtering_streambuf<boost::iostreams::input> filter;
+        filter.push(boost::iostreams::gzip_decompressor());
+        filter.push(in);
+        std::ostringstream out;
+        boost::iostreams::copy(filter, out);
+        return out.str();
+    }
+
+    std::string tempFile(const char* name)
+    {
+        return (boost::format("snapshot_exporter_test_%s_%d.bin") % name % ::getpid()).str();
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(export_to_file_writes_snapshot_bytes)
+{
+    SnapshotLoopBufferMemoryWriteStream stream(streamOptions());
+    writePattern(stream, 1, 1000 * 1000);
+    SnapshotLoopBufferMemoryWriteStream::Snapshot snapshot = stream.snapshot();
+    std::vector<std::uint8_t> expected = readSnapshot(snapshot);
+
+    std::string filename = tempFile("plain");
+    exportSnapshotToFile(snapshot, filename);
+    std::string actual = readFile(filename);
+    remove(filename.c_str());
+
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), actual.begin(), [](std::uint8_t a, char b) { return a == static_cast<std::uint8_t>(b); }));
+}
+
+BOOST_AUTO_TEST_CASE(compressed_export_is_a_valid_gzip_stream)
+{
+    SnapshotLoopBufferMemoryWriteStream stream(streamOptions());
+    writePattern(stream, 2, 700 * 1000);
+    SnapshotLoopBufferMemoryWriteStream::Snapshot snapshot = stream.snapshot();
+    std::vector<std::uint8_t> expected = readSnapshot(snapshot);
+
+    SnapshotExportOptions options;
+    options.compress = true;
+    options.compressionLevel = 1;
+    std::string filename = tempFile("gzip");
+    exportSnapshotToFile(SnapshotImage(snapshot), filename, options);
+    std::string actual = gunzip(readFile(filename));
+    remove(filename.c_str());
+
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), actual.begin(), [](std::uint8_t a, char b) { return a == static_cast<std::uint8_t>(b); }));
+}
+
+BOOST_AUTO_TEST_CASE(async_export_is_not_affected_by_later_writes)
+{
+    SnapshotLoopBufferMemoryWriteStream stream(streamOptions());
+    writePattern(stream, 3, 3 * 1024 * 1024 + 123);
+    SnapshotLoopBufferMemoryWriteStream::Snapshot snapshot = stream.snapshot();
+    std::vector<std::uint8_t> expected = readSnapshot(snapshot);
+
+    std::string filenames[2] = { tempFile("async_plain"), tempFile("async_gzip") };
+    SnapshotExportOptions compressed;
+    compressed.compress = true;
+    compressed.compressionLevel = 1;
+
+    bool succeed[2] = { false, false };
+    SnapshotExporter exporter;
+    exporter.exportToFileAsync(snapshot, filenames[0], SnapshotExportOptions(), [&](bool ok, const std::string&) { succeed[0] = ok; });
+    exporter.exportToFileAsync(snapshot, filenames[1], compressed, [&](bool ok, const std::string&) { succeed[1] = ok; });
+
+    // keep writing (the stream wraps around several times) while the exports are running
+    boost::atomic<bool> stop(false);
+    boost::thread writer([&]() {
+        for (std::uint32_t seed = 100; !stop.load(); seed++)
+            writePattern(stream, seed, 256 * 1024);
+    });
+    exporter.waitForIdle();
+    stop.store(true);
+    writer.join();
+
+    BOOST_CHECK(succeed[0]);
+    BOOST_CHECK(succeed[1]);
+
+    std::string plain = readFile(filenames[0]);
+    std::string unzipped = gunzip(readFile(filenames[1]));
+    remove(filenames[0].c_str());
+    remove(filenames[1].c_str());
+
+    BOOST_REQUIRE_EQUAL(plain.size(), expected.size());
+    BOOST_CHECK(plain == unzipped);
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), plain.begin(), [](std::uint8_t a, char b) { return a == static_cast<std::uint8_t>(b); }));
+}
+
+BOOST_AUTO_TEST_CASE(async_export_reports_open_failure)
+{
+    SnapshotLoopBufferMemoryWriteStream stream(streamOptions());
+    writePattern(stream, 4, 1000);
+
+    bool called = false;
+    bool succeed = true;
+    std::string error;
+    SnapshotExporter exporter;
+    exporter.exportToFileAsync(stream.snapshot(), "/nonexistent-dir/snapshot.bin", SnapshotExportOptions(), [&](bool ok, const std::string& message) {
+        called = true;
+        succeed = ok;
+        error = message;
+    });
+    exporter.waitForIdle();
+
+    BOOST_CHECK(called);
+    BOOST_CHECK(!succeed);
+    BOOST_CHECK(!error.empty());
+    BOOST_CHECK_EQUAL(exporter.pendingJobs(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(image_shares_full_chunks_and_copies_the_last_one)
+{
+    SnapshotLoopBufferMemoryWriteStream stream(streamOptions());
+    writePattern(stream, 5, 300 * 1000);
+    SnapshotLoopBufferMemoryWriteStream::Snapshot snapshot = stream.snapshot();
+    std::vector<std::uint8_t> expected = readSnapshot(snapshot);
+
+    SnapshotImage image(snapshot);
+    std::vector<detail::SnapshotSegment> segments = image.segments();
+    const SnapshotLoopBufferMemoryWriteStream::Snapshot::buffer_list_t& buffers = snapshot.buffers();
+    BOOST_REQUIRE_EQUAL(segments.size(), buffers.size());
+    BOOST_REQUIRE_EQUAL(image.size(), expected.size());
+
+    size_t index = 0;
+    size_t offset = 0;
+    for (auto iter = buffers.begin(); iter != buffers.end(); ++iter, ++index)
+    {
+        bool last = (index + 1 == buffers.size());
+        BOOST_CHECK_EQUAL(segments[index].data == (*iter)->buffer(), !last);
+        const std::uint8_t* data = static_cast<const std::uint8_t*>(segments[index].data);
+        BOOST_CHECK(std::equal(data, data + segments[index].size, expected.begin() + offset));
+        offset += segments[index].size;
+    }
+    BOOST_CHECK_EQUAL(offset, expected.size());
+}
+
+BOOST_AUTO_TEST_CASE(throwing_callback_does_not_stop_the_worker)
+{
+    SnapshotLoopBufferMemoryWriteStream stream(streamOptions());
+    writePattern(stream, 6, 1000);
+    SnapshotLoopBufferMemoryWriteStream::Snapshot snapshot = stream.snapshot();
+
+    std::string filename = tempFile("callback");
+    int calls = 0;
+    bool lastSucceed = false;
+    SnapshotExporter exporter;
+    exporter.exportToFileAsync(snapshot, filename, SnapshotExportOptions(), [&](bool, const std::string&) {
+        calls++;
+        throw std::runtime_error("callback failed");
+    });
+    exporter.exportToFileAsync(snapshot, filename, SnapshotExportOptions(), [&](bool, const std::string&) {
+        calls++;
+        throw 42;
+    });
+    exporter.exportToFileAsync(snapshot, filename, SnapshotExportOptions(), [&](bool ok, const std::string&) {
+        calls++;
+        lastSucceed = ok;
+    });
+    exporter.waitForIdle();
+    remove(filename.c_str());
+
+    BOOST_CHECK_EQUAL(calls, 3);
+    BOOST_CHECK(lastSucceed);
+    BOOST_CHECK_EQUAL(exporter.pendingJobs(), 0u);
+}
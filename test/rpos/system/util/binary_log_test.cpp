@@ -0,0 +1,190 @@
+/*
+* binary_log_test.cpp
+* printf parity of formatBinaryLogMessage, BinaryLogger delivery and binary file round trip
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE binary_log
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/binary_log.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    template < class... ArgsT >
+    std::string format(const char* text, const ArgsT&... args)
+    {
+        std::vector<std::uint8_t> encoded(detail::binaryLogArgsSize(args...) + 1);
+        std::uint8_t* p = encoded.data();
+        detail::binaryLogWriteArgs(p, args...);
+
+        std::string result;
+        BOOST_CHECK(formatBinaryLogMessage(text, encoded.data(), p - encoded.data(), result));
+        return result;
+    }
+
+#if defined(__GNUC__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#   pragma GCC diagnostic ignored "-Wformat-security"
+#endif
+    template < class... ArgsT >
+    std::string printfFormat(const char* text, const ArgsT&... args)
+    {
+        char buffer[1024];
+        snprintf(buffer, sizeof(buffer), text, args...);
+        return buffer;
+    }
+#if defined(__GNUC__)
+#   pragma GCC diagnostic pop
+#endif
+
+#define CHECK_PRINTF_PARITY(text, ...) BOOST_CHECK_EQUAL(format(text, __VA_ARGS__), printfFormat(text, __VA_ARGS__))
+
+    class CollectingAppender : public LogBatchAppender {
+    public:
+        std::vector<LogRecord> records;
+        size_t batches;
+
+        CollectingAppender()
+            : batches(0)
+        {}
+
+    protected:
+        virtual void append_(const std::vector<const LogRecord*>& batch)
+        {
+            batches++;
+            for (auto iter = batch.begin(); iter != batch.end(); ++iter)
+                records.push_back(**iter);
+        }
+    };
+
+}
+
+BOOST_AUTO_TEST_CASE(integer_conversions_match_printf)
+{
+    BOOST_CHECK_EQUAL(format("%u", -1), "4294967295");
+    BOOST_CHECK_EQUAL(format("%x", -1), "ffffffff");
+    BOOST_CHECK_EQUAL(format("%llu", -1), "18446744073709551615");
+
+    CHECK_PRINTF_PARITY("%d %i %u %o %x %X", -1, -2, -3, -4, -5, -6);
+    CHECK_PRINTF_PARITY("%hhd %hhu %hhx", 300, 300, -1);
+    CHECK_PRINTF_PARITY("%hd %hu %hx", 70000, 70000, -1);
+    CHECK_PRINTF_PARITY("%ld %lu %lx", -7L, static_cast<unsigned long>(-7L), -7L);
+    CHECK_PRINTF_PARITY("%lld %llu %llX", -8LL, static_cast<unsigned long long>(-8LL), 0x123456789abcdefLL);
+    CHECK_PRINTF_PARITY("%zu %zd %zx", static_cast<size_t>(-9), static_cast<ptrdiff_t>(-9), static_cast<size_t>(255));
+    CHECK_PRINTF_PARITY("%td %jd %ju", static_cast<ptrdiff_t>(-10), static_cast<std::intmax_t>(-11), static_cast<std::uintmax_t>(12));
+    CHECK_PRINTF_PARITY("%d %u", 0x7fffffff, 0xffffffffu);
+    CHECK_PRINTF_PARITY("%hhu %hu %u", static_cast<unsigned char>(200), static_cast<unsigned short>(60000), 4000000000u);
+}
+
+BOOST_AUTO_TEST_CASE(flags_width_and_precision_match_printf)
+{
+    CHECK_PRINTF_PARITY("[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, 42, 42, 42);
+    CHECK_PRINTF_PARITY("[%#o] [%#x] [%#X] [%.3d]", 8, 255, 255, 7);
+    CHECK_PRINTF_PARITY("[%*d] [%-*d] [%.*f]", 6, 1, 6, 2, 3, 3.14159);
+    CHECK_PRINTF_PARITY("[%8.3f] [%-10.2e] [%g] [%G] [%a]", 3.14159, 12345.678, 0.0001, 1e20, 1.5);
+    CHECK_PRINTF_PARITY("[%f] [%lf] [%Lf]", 2.5f, 2.5, 2.5L);
+    CHECK_PRINTF_PARITY("[%s] [%10s] [%-10s] [%.3s]", "text", "right", "left", "truncated");
+    CHECK_PRINTF_PARITY("[%c%c%c] [%lc]", 'a', 'b', 'c', 'd');
+    CHECK_PRINTF_PARITY("100%% of %d", 3);
+
+    int value = 0;
+    CHECK_PRINTF_PARITY("%p", static_cast<void*>(&value));
+}
+
+BOOST_AUTO_TEST_CASE(mismatched_arguments_are_reported)
+{
+    std::string result;
+    BOOST_CHECK(!formatBinaryLogMessage("%d %d", nullptr, 0, result));
+    BOOST_CHECK_EQUAL(result, "%d %d");
+
+    std::vector<std::uint8_t> encoded(detail::binaryLogArgsSize(std::string("x")));
+    std::uint8_t* p = encoded.data();
+    detail::binaryLogWriteArgs(p, std::string("x"));
+    result.clear();
+    BOOST_CHECK(formatBinaryLogMessage("[%s]", encoded.data(), encoded.size(), result));
+    BOOST_CHECK_EQUAL(result, "[x]");
+}
+
+BOOST_AUTO_TEST_CASE(logger_formats_with_its_registry)
+{
+    BinaryLogFormatRegistry registry;
+    // shift the ids so a lookup in the wrong registry would not find them
+    registry.intern("padding", LogLevelInfo, "padding");
+
+    BinaryLogger::Options options;
+    options.maxBatchSize = 0;
+    BinaryLogger logger(options, registry);
+    boost::shared_ptr<CollectingAppender> appender(new CollectingAppender());
+    logger.addAppender(appender);
+
+    for (int i = 0; i < 3; i++)
+        RPOS_BINARY_LOG(registry, logger, "test", LogLevelWarn, "line %d of %s, %u", i, "three", -1);
+    logger.flush();
+    logger.stop();
+
+    BOOST_REQUIRE_EQUAL(appender->records.size(), 3u);
+    BOOST_CHECK_EQUAL(appender->batches, 3u);
+    BOOST_CHECK_EQUAL(appender->records[2].message, "line 2 of three, 4294967295");
+    BOOST_CHECK_EQUAL(appender->records[2].source, "test");
+    BOOST_CHECK_EQUAL(appender->records[2].level, LogLevelWarn);
+    BOOST_CHECK_EQUAL(registry.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(binary_file_round_trip)
+{
+    boost::filesystem::path filename = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("binary-log-test-%%%%-%%%%.bin");
+    BinaryLogFormatRegistry registry;
+    {
+        BinaryLogger::Options options;
+        options.binaryFilename = filename.string();
+        BinaryLogger logger(options, registry);
+
+        std::vector<boost::thread*> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.push_back(new boost::thread([&logger, &registry, t]() {
+                for (int i = 0; i < 1000; i++)
+                    RPOS_BINARY_LOG(registry, logger, "worker", LogLevelInfo, "thread %d line %hu %s", t, i, std::string(i % 50, 'x'));
+            }));
+        }
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i]->join();
+            delete threads[i];
+        }
+        logger.stop();
+        BOOST_CHECK_EQUAL(logger.droppedRecords(), 0u);
+    }
+
+    CollectingAppender appender;
+    {
+        BinaryLogReader reader(filename.string());
+        BOOST_CHECK_EQUAL(reader.decodeTo(appender, 100), 4000u);
+    }
+    boost::system::error_code ec;
+    boost::filesystem::remove(filename, ec);
+
+    std::vector<int> next(4, 0);
+    for (size_t i = 0; i < appender.records.size(); i++)
+    {
+        int t = -1, line = -1;
+        BOOST_REQUIRE_EQUAL(sscanf(appender.records[i].message.c_str(), "thread %d line %d", &t, &line), 2);
+        BOOST_REQUIRE(t >= 0 && t < 4);
+        BOOST_CHECK_EQUAL(line, next[t]++);
+        BOOST_CHECK_EQUAL(appender.records[i].source, "worker");
+        BOOST_CHECK_EQUAL(appender.records[i].message.size(), printfFormat("thread %d line %hu ", t, line).size() + line % 50);
+    }
+}
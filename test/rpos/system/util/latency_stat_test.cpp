@@ -0,0 +1,82 @@
+/*
+* latency_stat_test.cpp
+* Percentile accuracy and window rotation of LatencyStat
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE latency_stat
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/latency_stat.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    /**
+    * Sleep until the middle of the next window of the given length
+    */
+    void sleepToNextWindow(std::uint64_t windowMs)
+    {
+        std::uint64_t windowNs = windowMs * 1000000u;
+        std::uint64_t now = static_cast<std::uint64_t>(boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+            boost::chrono::steady_clock::now().time_since_epoch()).count());
+        std::uint64_t target = (now / windowNs + 1) * windowNs + windowNs / 2;
+        boost::this_thread::sleep_for(boost::chrono::nanoseconds(target - now));
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(percentiles_are_within_bucket_resolution)
+{
+    LatencyStat stat(boost::chrono::milliseconds(60000), 3);
+    for (std::uint64_t i = 1; i <= 1000; i++)
+        stat.record(i * 1000);
+
+    LatencyStatSnapshot snapshot = stat.snapshot();
+    BOOST_CHECK_EQUAL(snapshot.count(), 1000u);
+    BOOST_CHECK_EQUAL(snapshot.sum(), 500500u * 1000u);
+    BOOST_CHECK_CLOSE(static_cast<double>(snapshot.percentile(0.5)), 500000.0, 3.5);
+    BOOST_CHECK_CLOSE(static_cast<double>(snapshot.percentile(0.99)), 990000.0, 3.5);
+    BOOST_CHECK_EQUAL(snapshot.percentile(1.0), 1000000u);
+    BOOST_CHECK_EQUAL(snapshot.max(), 1000000u);
+    BOOST_CHECK_EQUAL(stat.totalCount(), 1000u);
+
+    LatencyStatSnapshot merged = snapshot;
+    merged.merge(snapshot);
+    BOOST_CHECK_EQUAL(merged.count(), 2000u);
+    BOOST_CHECK_EQUAL(merged.percentile(0.5), snapshot.percentile(0.5));
+
+    stat.clear();
+    BOOST_CHECK_EQUAL(stat.snapshot().count(), 0u);
+    BOOST_CHECK_EQUAL(stat.totalCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_keeps_one_complete_window_with_three_windows)
+{
+    const std::uint64_t windowMs = 200;
+    LatencyStat stat(boost::chrono::milliseconds(windowMs), 3);
+
+    sleepToNextWindow(windowMs);
+    stat.record(1000);
+    BOOST_CHECK_EQUAL(stat.snapshot().count(), 1u);
+
+    sleepToNextWindow(windowMs);
+    stat.record(2000);
+    // the previous, now complete window is still visible
+    BOOST_CHECK_EQUAL(stat.snapshot().count(), 2u);
+
+    sleepToNextWindow(windowMs);
+    stat.record(3000);
+    // the slot of the first window was prepared for the next one
+    LatencyStatSnapshot snapshot = stat.snapshot();
+    BOOST_CHECK_EQUAL(snapshot.count(), 2u);
+    BOOST_CHECK_EQUAL(snapshot.sum(), 2000u + 3000u);
+    BOOST_CHECK_EQUAL(stat.totalCount(), 3u);
+}
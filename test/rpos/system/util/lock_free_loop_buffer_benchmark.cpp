@@ -0,0 +1,229 @@
+/*
+* lock_free_loop_buffer_benchmark.cpp
+* Throughput and latency of SpscLoopBuffer and MpscLoopBuffer against io::Pipe and a locked util::LoopBuffer
+*
+* Usage: lock_free_loop_buffer_benchmark [megabytes]
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#include <rpos/system/io/memory_read_stream.h>
+#include <rpos/system/io/memory_write_stream.h>
+#include <rpos/system/io/pipe.h>
+#include <rpos/system/util/lock_free_loop_buffer.h>
+#include <rpos/system/util/loop_buffer.h>
+
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace rpos::system;
+
+namespace {
+
+    typedef boost::chrono::steady_clock clock_t_;
+
+    double secondsSince(const clock_t_::time_point& start)
+    {
+        return boost::chrono::duration<double>(clock_t_::now() - start).count();
+    }
+
+    void report(const char* name, size_t chunk, size_t bytes, double seconds)
+    {
+        printf("%-36s chunk %6u  %9.1f MB/s\n", name, static_cast<unsigned>(chunk), bytes / seconds / (1024.0 * 1024.0));
+    }
+
+    /**
+    * The pattern used by the receive thread today: util::LoopBuffer behind a mutex, one push per byte
+    */
+    class LockedLoopBuffer {
+    public:
+        explicit LockedLoopBuffer(size_t capacity)
+            : buffer_(capacity)
+            , closed_(false)
+        {}
+
+        void blockingWrite(const std::uint8_t* data, size_t size)
+        {
+            boost::unique_lock<boost::mutex> guard(lock_);
+            for (size_t i = 0; i < size; i++)
+            {
+                while (buffer_.full())
+                    notFull_.wait(guard);
+                buffer_.push_back(data[i]);
+                notEmpty_.notify_one();
+            }
+        }
+
+        size_t blockingRead(std::uint8_t* data, size_t size)
+        {
+            boost::unique_lock<boost::mutex> guard(lock_);
+            while (buffer_.empty() && !closed_)
+                notEmpty_.wait(guard);
+            size_t n = std::min(size, buffer_.size());
+            for (size_t i = 0; i < n; i++)
+            {
+                data[i] = buffer_.front();
+                buffer_.pop_front();
+            }
+            notFull_.notify_one();
+            return n;
+        }
+
+        void close()
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            closed_ = true;
+            notEmpty_.notify_all();
+        }
+
+    private:
+        util::LoopBuffer buffer_;
+        bool closed_;
+        boost::mutex lock_;
+        boost::condition_variable notEmpty_;
+        boost::condition_variable notFull_;
+    };
+
+    template < class RingT >
+    double crossThreadThroughput(RingT& ring, size_t total, size_t chunk, int producers)
+    {
+        std::vector<std::uint8_t> source(chunk, 0x5a);
+        boost::atomic<int> running(producers);
+
+        auto start = clock_t_::now();
+        std::vector<boost::thread*> threads;
+        for (int p = 0; p < producers; p++)
+        {
+            threads.push_back(new boost::thread([&]() {
+                for (size_t sent = 0; sent < total / producers; sent += chunk)
+                    ring.blockingWrite(&source[0], chunk);
+                if (--running == 0)
+                    ring.close();
+            }));
+        }
+
+        std::vector<std::uint8_t> sink(64 * 1024);
+        size_t received = 0;
+        while (size_t n = ring.blockingRead(&sink[0], sink.size()))
+            received += n;
+        double seconds = secondsSince(start);
+
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i]->join();
+            delete threads[i];
+        }
+        if (!received)
+            fprintf(stderr, "no data received\n");
+        return seconds;
+    }
+
+    void pipeThroughput(size_t total, size_t chunk)
+    {
+        std::vector<std::uint8_t> payload(total, 0x5a);
+
+        {
+            io::MemoryReadStream src(payload);
+            io::MemoryWriteStream dest(total);
+            io::Pipe pipe(src, dest, chunk);
+            auto start = clock_t_::now();
+            pipe.pumpTillEnd();
+            report("io::Pipe memory -> memory", chunk, dest.size(), secondsSince(start));
+        }
+
+        {
+            util::SpscLoopBuffer<> ring(chunk * 2);
+            std::vector<std::uint8_t> dest(total);
+            auto start = clock_t_::now();
+            for (size_t offset = 0; offset < total; offset += chunk)
+            {
+                size_t n = std::min(chunk, total - offset);
+                ring.write(&payload[offset], n);
+                ring.read(&dest[offset], n);
+            }
+            report("SpscLoopBuffer memory -> memory", chunk, total, secondsSince(start));
+        }
+    }
+
+    template < class RingT >
+    void pingPongLatency(const char* name, int rounds)
+    {
+        RingT ping(4096), pong(4096);
+        std::uint8_t message[64] = { 0 };
+
+        boost::thread echo([&]() {
+            std::uint8_t buffer[64];
+            for (int i = 0; i < rounds; i++)
+            {
+                size_t received = 0;
+                while (received < sizeof(buffer))
+                    received += ping.blockingRead(buffer + received, sizeof(buffer) - received);
+                pong.blockingWrite(buffer, sizeof(buffer));
+            }
+        });
+
+        std::vector<double> samples;
+        samples.reserve(rounds);
+        for (int i = 0; i < rounds; i++)
+        {
+            auto start = clock_t_::now();
+            ping.blockingWrite(message, sizeof(message));
+            size_t received = 0;
+            while (received < sizeof(message))
+                received += pong.blockingRead(message + received, sizeof(message) - received);
+            samples.push_back(secondsSince(start) * 1e6);
+        }
+        echo.join();
+
+        std::sort(samples.begin(), samples.end());
+        printf("%-36s round trip p50 %8.2f us  p99 %8.2f us\n", name, samples[samples.size() / 2], samples[samples.size() * 99 / 100]);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t total = static_cast<size_t>(argc > 1 ? atoi(argv[1]) : 64) * 1024 * 1024;
+    const size_t capacity = 64 * 1024;
+    const size_t chunks[] = { 64, 1500, 16384 };
+
+    printf("== single thread copy, %u MB\n", static_cast<unsigned>(total >> 20));
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+        pipeThroughput(total, chunks[i]);
+
+    printf("== producer -> consumer thread, %u MB\n", static_cast<unsigned>(total >> 20));
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+    {
+        size_t chunk = chunks[i];
+        {
+            // per byte pushes under a lock are slow, keep the run short
+            LockedLoopBuffer ring(capacity);
+            size_t bytes = std::min<size_t>(total, 16 * 1024 * 1024);
+            report("locked util::LoopBuffer", chunk, bytes, crossThreadThroughput(ring, bytes, chunk, 1));
+        }
+        {
+            util::SpscLoopBuffer<> ring(capacity);
+            report("SpscLoopBuffer (default wait)", chunk, total, crossThreadThroughput(ring, total, chunk, 1));
+        }
+        {
+            util::SpscLoopBuffer<util::ConditionVariableWaitStrategy> ring(capacity);
+            report("SpscLoopBuffer (condition variable)", chunk, total, crossThreadThroughput(ring, total, chunk, 1));
+        }
+        {
+            util::MpscLoopBuffer<> ring(capacity);
+            report("MpscLoopBuffer, 4 producers", chunk, total, crossThreadThroughput(ring, total, chunk, 4));
+        }
+    }
+
+    printf("== latency, 64 byte messages\n");
+    pingPongLatency<LockedLoopBuffer>("locked util::LoopBuffer", 20000);
+    pingPongLatency<util::SpscLoopBuffer<> >("SpscLoopBuffer (default wait)", 20000);
+    pingPongLatency<util::SpscLoopBuffer<util::ConditionVariableWaitStrategy> >("SpscLoopBuffer (condition variable)", 20000);
+    return 0;
+}
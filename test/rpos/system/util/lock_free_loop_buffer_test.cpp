@@ -0,0 +1,218 @@
+/*
+* lock_free_loop_buffer_test.cpp
+* Tests for SpscLoopBuffer and MpscLoopBuffer
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE lock_free_loop_buffer
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/lock_free_loop_buffer.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    inline std::uint8_t patternAt(std::uint64_t i)
+    {
+        return static_cast<std::uint8_t>((i * 2654435761u) >> 13);
+    }
+
+    // Boost.Test assertions are not thread safe, worker threads only report through flags
+    template < class BufferT >
+    void checkSpscTransfer(BufferT& ring, size_t total)
+    {
+        bool written = true;
+        boost::thread producer([&]() {
+            std::vector<std::uint8_t> chunk(1500);
+            size_t sent = 0;
+            size_t step = 1;
+            while (sent < total)
+            {
+                size_t n = std::min(total - sent, step);
+                for (size_t i = 0; i < n; i++)
+                    chunk[i] = patternAt(sent + i);
+                if (ring.blockingWrite(&chunk[0], n) != n)
+                {
+                    written = false;
+                    break;
+                }
+                sent += n;
+                step = (step + 97) % chunk.size() + 1;
+            }
+            ring.close();
+        });
+
+        std::vector<std::uint8_t> buffer(777);
+        size_t received = 0;
+        bool matches = true;
+        for (;;)
+        {
+            size_t n = ring.blockingRead(&buffer[0], buffer.size());
+            if (!n)
+                break;
+            for (size_t i = 0; i < n; i++)
+                matches = matches && buffer[i] == patternAt(received + i);
+            received += n;
+        }
+        producer.join();
+
+        BOOST_CHECK(written);
+        BOOST_CHECK(matches);
+        BOOST_CHECK_EQUAL(received, total);
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(capacity_is_rounded_up_to_power_of_2)
+{
+    SpscLoopBuffer<> ring(1000);
+    BOOST_CHECK_EQUAL(ring.capacity(), 1024u);
+    BOOST_CHECK(ring.empty());
+}
+
+BOOST_AUTO_TEST_CASE(spsc_wraps_around)
+{
+    SpscLoopBuffer<> ring(16);
+    std::uint8_t in[12], out[12];
+    for (int round = 0; round < 10; round++)
+    {
+        for (int i = 0; i < 12; i++)
+            in[i] = static_cast<std::uint8_t>(round * 12 + i);
+        BOOST_REQUIRE_EQUAL(ring.write(in, sizeof(in)), sizeof(in));
+        BOOST_REQUIRE_EQUAL(ring.size(), sizeof(in));
+        BOOST_REQUIRE_EQUAL(ring.peek(out, sizeof(out)), sizeof(out));
+        ring.consume(sizeof(out));
+        BOOST_CHECK_EQUAL_COLLECTIONS(in, in + 12, out, out + 12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(spsc_write_is_limited_by_free_space)
+{
+    SpscLoopBuffer<> ring(8);
+    std::uint8_t data[20] = { 0 };
+    BOOST_CHECK_EQUAL(ring.write(data, sizeof(data)), 8u);
+    BOOST_CHECK_EQUAL(ring.write(data, 1), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(spsc_transfer_with_futex_or_default_wait)
+{
+    SpscLoopBuffer<> ring(4096);
+    checkSpscTransfer(ring, 8 * 1024 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(spsc_transfer_with_condition_variable_wait)
+{
+    SpscLoopBuffer<ConditionVariableWaitStrategy> ring(4096);
+    checkSpscTransfer(ring, 8 * 1024 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(blocking_read_times_out_on_empty_buffer)
+{
+    SpscLoopBuffer<> ring(64);
+    std::uint8_t byte;
+    auto start = boost::chrono::steady_clock::now();
+    BOOST_CHECK_EQUAL(ring.blockingReadFor(&byte, 1, boost::chrono::milliseconds(20)), 0u);
+    BOOST_CHECK(boost::chrono::steady_clock::now() - start >= boost::chrono::milliseconds(20));
+    BOOST_CHECK(!ring.waitForReadable(1, boost::chrono::milliseconds(1)));
+}
+
+BOOST_AUTO_TEST_CASE(close_wakes_blocked_reader_and_keeps_data)
+{
+    SpscLoopBuffer<> ring(64);
+    std::uint8_t data[3] = { 1, 2, 3 };
+    ring.write(data, sizeof(data));
+
+    std::uint8_t out[8];
+    BOOST_CHECK_EQUAL(ring.blockingRead(out, 2), 2u);
+
+    boost::thread closer([&]() {
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+        ring.close();
+    });
+    BOOST_CHECK_EQUAL(ring.blockingRead(out, sizeof(out)), 1u);
+    BOOST_CHECK_EQUAL(out[0], 3);
+    BOOST_CHECK_EQUAL(ring.blockingRead(out, sizeof(out)), 0u);
+    closer.join();
+
+    BOOST_CHECK_EQUAL(ring.write(data, 1), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_records_never_interleave)
+{
+    struct Record {
+        std::uint32_t producer;
+        std::uint32_t sequence;
+        std::uint32_t check;
+    };
+
+    const int producers = 4;
+    const std::uint32_t perProducer = 200000;
+    MpscLoopBuffer<> ring(1024);
+
+    boost::atomic<int> failedWrites(0);
+    std::vector<boost::thread*> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.push_back(new boost::thread([&ring, &failedWrites, p, perProducer]() {
+            for (std::uint32_t i = 0; i < perProducer; i++)
+            {
+                Record record = { static_cast<std::uint32_t>(p), i, static_cast<std::uint32_t>(p) * 7919u + i };
+                if (!ring.blockingWrite(&record, sizeof(record)))
+                    failedWrites++;
+            }
+        }));
+    }
+
+    std::vector<std::uint32_t> next(producers, 0);
+    bool ordered = true;
+    for (std::uint64_t received = 0; received < producers * static_cast<std::uint64_t>(perProducer); received++)
+    {
+        Record record;
+        BOOST_REQUIRE(ring.waitForReadable(sizeof(record), boost::chrono::seconds(10)));
+        BOOST_REQUIRE_EQUAL(ring.read(&record, sizeof(record)), sizeof(record));
+        BOOST_REQUIRE(record.producer < static_cast<std::uint32_t>(producers));
+        ordered = ordered && record.check == record.producer * 7919u + record.sequence;
+        ordered = ordered && record.sequence == next[record.producer]++;
+    }
+
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    BOOST_CHECK_EQUAL(failedWrites.load(), 0);
+    BOOST_CHECK(ordered);
+    BOOST_CHECK(ring.empty());
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_rejects_records_larger_than_capacity)
+{
+    MpscLoopBuffer<> ring(16);
+    std::uint8_t data[32] = { 0 };
+    BOOST_CHECK_EQUAL(ring.write(data, sizeof(data)), 0u);
+    BOOST_CHECK(!ring.blockingWrite(data, sizeof(data)));
+    BOOST_CHECK_EQUAL(ring.write(data, 16), 16u);
+    BOOST_CHECK_EQUAL(ring.write(data, 1), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(mpsc_empty_records_complete_immediately)
+{
+    MpscLoopBuffer<> ring(16);
+    std::uint8_t data[16] = { 0 };
+    BOOST_CHECK(ring.blockingWrite(data, 0));
+
+    // also while the buffer is full, nothing has to wait for free space
+    BOOST_CHECK_EQUAL(ring.write(data, 16), 16u);
+    BOOST_CHECK(ring.blockingWrite(data, 0));
+    auto start = boost::chrono::steady_clock::now();
+    BOOST_CHECK(ring.blockingWriteFor(data, 0, boost::chrono::seconds(2)));
+    BOOST_CHECK(boost::chrono::steady_clock::now() - start < boost::chrono::seconds(1));
+    BOOST_CHECK_EQUAL(ring.size(), 16u);
+}
@@ -0,0 +1,126 @@
+/*
+* log_filter_test.cpp
+* Tests for the effective per source levels computed by LogSourceFilter
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE log_filter
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/log_filter.h>
+
+#include <string>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    class NullAppender : public LogAppender {
+    public:
+        explicit NullAppender(LogLevel level)
+            : LogAppender(level)
+        {}
+
+    protected:
+        virtual void append_(const ConstLogData_SharedPtr&)
+        {}
+    };
+
+    LogAppenderConfig appenderConfig(LogLevel level)
+    {
+        LogAppenderConfig config;
+        config.logLevel = level;
+        return config;
+    }
+
+    LogConfig warnConsoleConfig()
+    {
+        LogConfig config;
+        config.global = appenderConfig(LogLevelDebug);
+        config.console = appenderConfig(LogLevelWarn);
+        return config;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(configured_appenders_set_the_level)
+{
+    LogSourceFilter filter;
+    LogSourceFilter::SlotPointer slot = filter.intern("planner");
+    BOOST_CHECK(LogSourceFilter::isEnabled(slot, LogLevelDebug));
+
+    LogConfig config = warnConsoleConfig();
+    FileLogAppenderConfig file;
+    static_cast<LogAppenderConfig&>(file) = appenderConfig(LogLevelInfo);
+    file.includeLogSources.push_back("slam");
+    config.files.push_back(file);
+    filter.configWith(config);
+
+    BOOST_CHECK(!LogSourceFilter::isEnabled(slot, LogLevelInfo));
+    BOOST_CHECK(LogSourceFilter::isEnabled(slot, LogLevelWarn));
+    BOOST_CHECK(filter.isEnabled("slam", LogLevelInfo));
+    BOOST_CHECK(!filter.isEnabled("slam", LogLevelDebug));
+
+    config.global.excludeLogSources.push_back("slam");
+    filter.configWith(config);
+    BOOST_CHECK(!filter.isEnabled("slam", LogLevelFatal));
+
+    // nobody listens without the console
+    filter.configWith(warnConsoleConfig(), false);
+    BOOST_CHECK(!LogSourceFilter::isEnabled(slot, LogLevelFatal));
+}
+
+BOOST_AUTO_TEST_CASE(directly_added_appenders_lower_the_level)
+{
+    LogSourceFilter filter;
+    filter.configWith(warnConsoleConfig());
+    LogSourceFilter::SlotPointer planner = filter.intern("planner");
+    LogSourceFilter::SlotPointer slam = filter.intern("slam");
+    std::uint32_t generation = filter.generation();
+
+    boost::shared_ptr<NullAppender> appender(new NullAppender(LogLevelDebug));
+    appender->includeSources().push_back("planner");
+    filter.addAppender(appender);
+
+    BOOST_CHECK_GT(filter.generation(), generation);
+    BOOST_CHECK(LogSourceFilter::isEnabled(planner, LogLevelDebug));
+    BOOST_CHECK(!LogSourceFilter::isEnabled(slam, LogLevelInfo));
+
+    // changes made to a registered appender apply on refresh
+    appender->setLogLevel(LogLevelInfo);
+    appender->includeSources().clear();
+    appender->excludeSources().push_back("planner");
+    filter.refresh();
+    BOOST_CHECK(!LogSourceFilter::isEnabled(planner, LogLevelInfo));
+    BOOST_CHECK(LogSourceFilter::isEnabled(slam, LogLevelInfo));
+    BOOST_CHECK(!LogSourceFilter::isEnabled(slam, LogLevelDebug));
+
+    filter.removeAppender(appender);
+    BOOST_CHECK(!LogSourceFilter::isEnabled(slam, LogLevelInfo));
+    BOOST_CHECK(LogSourceFilter::isEnabled(slam, LogLevelWarn));
+}
+
+BOOST_AUTO_TEST_CASE(global_level_still_applies_to_added_appenders)
+{
+    LogSourceFilter filter;
+    LogConfig config = warnConsoleConfig();
+    config.global.logLevel = LogLevelError;
+    filter.configWith(config);
+
+    filter.addAppender(boost::shared_ptr<NullAppender>(new NullAppender(LogLevelDebug)));
+    BOOST_CHECK(!filter.isEnabled("planner", LogLevelWarn));
+    BOOST_CHECK(filter.isEnabled("planner", LogLevelError));
+}
+
+BOOST_AUTO_TEST_CASE(clear_appenders_disables_every_source)
+{
+    LogSourceFilter filter;
+    filter.configWith(warnConsoleConfig());
+    filter.addAppender(boost::shared_ptr<NullAppender>(new NullAppender(LogLevelDebug)));
+    BOOST_CHECK(filter.isEnabled("planner", LogLevelDebug));
+
+    filter.clearAppenders();
+    BOOST_CHECK(!filter.isEnabled("planner", LogLevelFatal));
+}
@@ -0,0 +1,265 @@
+/*
+* log_queue_test.cpp
+* Concurrency tests for LogRecordQueue and AsyncLogQueue, rollover tests for BatchFileLogAppender
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE log_queue
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/log_queue.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    struct TempFolder {
+        TempFolder()
+            : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("log-queue-test-%%%%-%%%%"))
+        {
+            boost::filesystem::create_directories(path);
+        }
+
+        ~TempFolder()
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(path, ec);
+        }
+
+        boost::filesystem::path path;
+    };
+
+    /**
+    * Parses "<producer>:<index>" messages and checks every producer's lines arrive once and in order
+    */
+    class OrderCheckingAppender : public LogBatchAppender {
+    public:
+        explicit OrderCheckingAppender(int producers)
+            : next_(producers, 0)
+            , errors_(0)
+            , received_(0)
+        {}
+
+        size_t errors() const { return errors_; }
+        size_t received() const { return received_; }
+        const std::vector<int>& next() const { return next_; }
+
+        void check(const LogRecord& record)
+        {
+            int producer = -1, index = -1;
+            if (sscanf(record.message.c_str(), "%d:%d", &producer, &index) != 2
+                || producer < 0 || producer >= static_cast<int>(next_.size())
+                || next_[producer] != index)
+            {
+                errors_++;
+                return;
+            }
+            next_[producer]++;
+            received_++;
+        }
+
+    protected:
+        virtual void append_(const std::vector<const LogRecord*>& records)
+        {
+            for (auto iter = records.begin(); iter != records.end(); ++iter)
+                check(**iter);
+        }
+
+    private:
+        std::vector<int> next_;
+        size_t errors_;
+        size_t received_;
+    };
+
+    std::string message(int producer, int index)
+    {
+        return std::to_string(producer) + ":" + std::to_string(index);
+    }
+
+    std::string readFile(const boost::filesystem::path& path)
+    {
+        std::ifstream in(path.string().c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(record_queue_keeps_per_producer_order)
+{
+    const int producers = 4;
+    const int perProducer = 20000;
+    LogRecordQueue<> queue(64);
+    OrderCheckingAppender checker(producers);
+
+    std::vector<boost::thread*> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.push_back(new boost::thread([&queue, p]() {
+            for (int i = 0; i < perProducer; i++)
+            {
+                std::string text = message(p, i);
+                while (!queue.push([&](LogRecord& record) { record.assign("test", 4, LogLevelInfo, text.data(), text.size()); }))
+                    boost::this_thread::yield();
+            }
+        }));
+    }
+
+    std::vector<const LogRecord*> batch;
+    while (checker.received() + checker.errors() < static_cast<size_t>(producers * perProducer))
+    {
+        size_t count = queue.peekBatch(batch, 16);
+        if (!count)
+        {
+            queue.waitForRecords(boost::chrono::milliseconds(10));
+            continue;
+        }
+        BOOST_REQUIRE_EQUAL(batch.size(), count);
+        for (size_t i = 0; i < batch.size(); i++)
+            checker.check(*batch[i]);
+        queue.release(count);
+    }
+
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    BOOST_CHECK_EQUAL(checker.errors(), 0u);
+    BOOST_CHECK_EQUAL(queue.claimed(), static_cast<std::uint64_t>(producers * perProducer));
+}
+
+BOOST_AUTO_TEST_CASE(throwing_fill_publishes_a_dropped_slot)
+{
+    LogRecordQueue<> queue(4);
+    std::string before = "before", after = "after";
+
+    BOOST_CHECK(queue.push([&](LogRecord& record) { record.assign("s", 1, LogLevelInfo, before.data(), before.size()); }));
+    BOOST_CHECK_THROW(queue.push([](LogRecord&) { throw std::runtime_error("format failed"); }), std::runtime_error);
+    BOOST_CHECK(queue.push([&](LogRecord& record) { record.assign("s", 1, LogLevelInfo, after.data(), after.size()); }));
+
+    // the consumer moves past the dropped slot instead of waiting for it
+    std::vector<const LogRecord*> batch;
+    BOOST_REQUIRE_EQUAL(queue.peekBatch(batch, 16), 3u);
+    BOOST_REQUIRE_EQUAL(batch.size(), 2u);
+    BOOST_CHECK_EQUAL(batch[0]->message, before);
+    BOOST_CHECK_EQUAL(batch[1]->message, after);
+    queue.release(3);
+
+    // the slot is reusable after wrapping around
+    for (int i = 0; i < 8; i++)
+    {
+        std::string text = message(0, i);
+        BOOST_REQUIRE(queue.push([&](LogRecord& record) { record.assign("s", 1, LogLevelInfo, text.data(), text.size()); }));
+        BOOST_REQUIRE_EQUAL(queue.peekBatch(batch, 16), 1u);
+        BOOST_REQUIRE_EQUAL(batch.size(), 1u);
+        BOOST_CHECK_EQUAL(batch[0]->message, text);
+        queue.release(1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(async_queue_delivers_every_line_in_order)
+{
+    const int producers = 4;
+    const int perProducer = 5000;
+    AsyncLogQueue::Options options;
+    options.capacity = 256;
+    options.blockWhenFull = true;
+    options.maxBatchSize = 32;
+    AsyncLogQueue queue(options);
+    boost::shared_ptr<OrderCheckingAppender> checker(new OrderCheckingAppender(producers));
+    queue.addAppender(checker);
+
+    std::vector<boost::thread*> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.push_back(new boost::thread([&queue, p]() {
+            for (int i = 0; i < perProducer; i++)
+                queue.log("test", LogLevelInfo, "%d:%d", p, i);
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+    queue.flush();
+
+    BOOST_CHECK_EQUAL(checker->errors(), 0u);
+    BOOST_CHECK_EQUAL(checker->received(), static_cast<size_t>(producers * perProducer));
+    BOOST_CHECK_EQUAL(queue.droppedRecords(), 0u);
+
+    queue.stop();
+    BOOST_CHECK(!queue.append("test", LogLevelInfo, "after stop"));
+}
+
+BOOST_AUTO_TEST_CASE(async_queue_drops_when_full)
+{
+    AsyncLogQueue::Options options;
+    options.capacity = 2;
+    options.maxBatchSize = 0;
+    options.logLevel = LogLevelInfo;
+    AsyncLogQueue queue(options);
+
+    BOOST_CHECK(!queue.append("test", LogLevelDebug, "filtered"));
+    size_t accepted = 0;
+    for (int i = 0; i < 10000; i++)
+        accepted += queue.append("test", LogLevelInfo, "line") ? 1 : 0;
+    queue.flush();
+    BOOST_CHECK_EQUAL(accepted + queue.droppedRecords(), 10000u);
+}
+
+BOOST_AUTO_TEST_CASE(file_appender_rolls_over)
+{
+    TempFolder folder;
+    boost::filesystem::path filename = folder.path / "test.log";
+    AsyncLogQueue queue;
+    queue.addAppender(boost::shared_ptr<BatchFileLogAppender>(new BatchFileLogAppender(filename.string(), LogLevelDebug, false, 1, 2)));
+
+    std::string line(1000, 'x');
+    for (int i = 0; i < 3000; i++)
+        queue.append("test", LogLevelInfo, line);
+    queue.stop();
+
+    BOOST_CHECK(boost::filesystem::exists(filename));
+    BOOST_CHECK(boost::filesystem::exists(folder.path / "test.log.1"));
+    BOOST_CHECK(boost::filesystem::exists(folder.path / "test.log.2"));
+    BOOST_CHECK(!boost::filesystem::exists(folder.path / "test.log.3"));
+    BOOST_CHECK_GE(boost::filesystem::file_size(folder.path / "test.log.1"), 1024u * 1024u);
+}
+
+BOOST_AUTO_TEST_CASE(failed_rollover_does_not_truncate)
+{
+    TempFolder folder;
+    boost::filesystem::path filename = folder.path / "test.log";
+
+    // a non-empty directory in place of the backup makes the rename fail
+    boost::filesystem::create_directories(folder.path / "test.log.1" / "blocker");
+
+    AsyncLogQueue queue;
+    queue.addAppender(boost::shared_ptr<BatchFileLogAppender>(new BatchFileLogAppender(filename.string(), LogLevelDebug, false, 1, 1)));
+
+    std::string line(1000, 'x');
+    const int lines = 1500;
+    for (int i = 0; i < lines; i++)
+        queue.append("test", LogLevelInfo, message(0, i) + line);
+    queue.stop();
+
+    // every line is still in the active file
+    std::string content = readFile(filename);
+    size_t count = 0;
+    for (size_t pos = content.find('\n'); pos != std::string::npos; pos = content.find('\n', pos + 1))
+        count++;
+    BOOST_CHECK_EQUAL(count, static_cast<size_t>(lines));
+    BOOST_CHECK(content.find("] 0:0x") != std::string::npos);
+    BOOST_CHECK(boost::filesystem::is_directory(folder.path / "test.log.1"));
+}
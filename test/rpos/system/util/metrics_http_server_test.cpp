@@ -0,0 +1,91 @@
+/*
+* metrics_http_server_test.cpp
+* Scrapes of MetricsHttpServer over a loopback connection
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE metrics_http_server
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/metrics_http_server.h>
+
+#include <boost/asio.hpp>
+
+#include <string>
+
+using namespace rpos::system::util;
+using boost::asio::ip::tcp;
+
+namespace {
+
+    unsigned short freePort()
+    {
+        boost::asio::io_service io;
+        tcp::acceptor acceptor(io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+        return acceptor.local_endpoint().port();
+    }
+
+    /**
+    * Send a raw request and read until the server closes the connection
+    */
+    std::string request(unsigned short port, const std::string& text)
+    {
+        boost::asio::io_service io;
+        tcp::socket socket(io);
+        socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+        boost::asio::write(socket, boost::asio::buffer(text));
+
+        std::string response;
+        boost::system::error_code ec;
+        char buffer[4096];
+        for (;;)
+        {
+            size_t n = socket.read_some(boost::asio::buffer(buffer), ec);
+            response.append(buffer, n);
+            if (ec)
+                break;
+        }
+        return response;
+    }
+
+    struct ServerFixture {
+        ServerFixture()
+            : port(freePort())
+            , server(new MetricsHttpServer(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port), registry))
+        {
+            registry.counter("scrapes", "Scrapes served")->inc(2);
+            server->start();
+        }
+
+        ~ServerFixture()
+        {
+            server->stop();
+        }
+
+        MetricsRegistry registry;
+        unsigned short port;
+        boost::shared_ptr<MetricsHttpServer> server;
+    };
+
+}
+
+BOOST_FIXTURE_TEST_CASE(get_metrics_returns_the_registry, ServerFixture)
+{
+    std::string response = request(port, "GET /metrics?format=text HTTP/1.1\r\nHost: robot\r\n\r\n");
+    BOOST_CHECK_EQUAL(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+    BOOST_CHECK(response.find("Content-Type: " + std::string(MetricsRegistry::contentType())) != std::string::npos);
+
+    std::string body = registry.render();
+    BOOST_CHECK(response.find("Content-Length: " + std::to_string(body.size()) + "\r\n") != std::string::npos);
+    BOOST_CHECK_EQUAL(response.substr(response.size() - body.size()), body);
+    BOOST_CHECK(body.find("scrapes_total 2\n") != std::string::npos);
+}
+
+BOOST_FIXTURE_TEST_CASE(other_requests_are_rejected, ServerFixture)
+{
+    BOOST_CHECK_EQUAL(request(port, "GET /other HTTP/1.1\r\n\r\n").compare(0, 22, "HTTP/1.1 404 Not Found"), 0);
+    BOOST_CHECK_EQUAL(request(port, "POST /metrics HTTP/1.1\r\n\r\n").compare(0, 31, "HTTP/1.1 405 Method Not Allowed"), 0);
+    BOOST_CHECK_EQUAL(request(port, "garbage\r\n\r\n").compare(0, 24, "HTTP/1.1 400 Bad Request"), 0);
+    BOOST_CHECK_EQUAL(request(port, "GET /metrics HTTP/1.1\r\nX: " + std::string(9000, 'x')).compare(0, 12, "HTTP/1.1 431"), 0);
+}
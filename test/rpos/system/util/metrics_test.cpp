@@ -0,0 +1,118 @@
+/*
+* metrics_test.cpp
+* OpenMetrics rendering of MetricsRegistry and rendering concurrently with registration
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE metrics
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/metrics.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    size_t occurrences(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+            count++;
+        return count;
+    }
+
+    MetricLabels label(const std::string& key, const std::string& value)
+    {
+        MetricLabels labels;
+        labels.push_back(std::make_pair(key, value));
+        return labels;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(families_are_rendered_in_registration_order)
+{
+    MetricsRegistry registry;
+    registry.counter("requests", "Handled requests", label("method", "get"))->inc(3);
+    registry.counter("requests", "Handled requests", label("method", "put"))->inc();
+    registry.gauge("battery", "")->set(0.5);
+
+    std::string text = registry.render();
+    BOOST_CHECK_EQUAL(text.compare(0, 23, "# TYPE requests counter"), 0);
+    BOOST_CHECK_EQUAL(occurrences(text, "# TYPE "), 2u);
+    BOOST_CHECK_EQUAL(occurrences(text, "# HELP requests Handled requests\n"), 1u);
+    BOOST_CHECK_EQUAL(occurrences(text, "# HELP battery"), 0u);
+    BOOST_CHECK_EQUAL(occurrences(text, "requests_total{method=\"get\"} 3\n"), 1u);
+    BOOST_CHECK_EQUAL(occurrences(text, "requests_total{method=\"put\"} 1\n"), 1u);
+    BOOST_CHECK(text.find("requests_total") < text.find("# TYPE battery"));
+    BOOST_CHECK_EQUAL(text.substr(text.size() - 6), "# EOF\n");
+
+    BOOST_CHECK_THROW(registry.gauge("requests", ""), std::runtime_error);
+
+    registry.remove("requests", label("method", "get"));
+    registry.remove("requests", label("method", "put"));
+    BOOST_CHECK_EQUAL(occurrences(registry.render(), "requests"), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(help_and_label_values_are_escaped)
+{
+    MetricsRegistry registry;
+    registry.gauge("temperature", "Motor \"driver\" temperature\nin C:\\", label("path", "a\"b\\c"))->set(40);
+
+    std::string text = registry.render();
+    BOOST_CHECK_EQUAL(occurrences(text, "# HELP temperature Motor \\\"driver\\\" temperature\\nin C:\\\\\n"), 1u);
+    BOOST_CHECK_EQUAL(occurrences(text, "temperature{path=\"a\\\"b\\\\c\"} 40.0\n"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(callbacks_may_use_the_registry)
+{
+    MetricsRegistry registry;
+    MetricsRegistry* target = &registry;
+    // the callback runs while rendering, registering from it must not deadlock
+    registry.callbackGauge("scrapes", "", [target]() {
+        boost::shared_ptr<MetricCounter> counter = target->counter("scrape_calls", "");
+        counter->inc();
+        return static_cast<double>(counter->value());
+    });
+
+    registry.render();
+    std::string text = registry.render();
+    BOOST_CHECK_EQUAL(occurrences(text, "scrapes 2.0\n"), 1u);
+    // registered during the first render, sampled by the second one
+    BOOST_CHECK_EQUAL(occurrences(text, "scrape_calls_total "), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(render_while_registering)
+{
+    MetricsRegistry registry;
+    boost::atomic<bool> done(false);
+    boost::atomic<int> malformed(0);
+
+    boost::thread renderer([&]() {
+        while (!done.load())
+        {
+            std::string text = registry.render();
+            if (text.size() < 6 || text.compare(text.size() - 6, 6, "# EOF\n") != 0)
+                malformed++;
+        }
+    });
+
+    for (int i = 0; i < 2000; i++)
+    {
+        registry.counter("events", "", label("id", std::to_string(i % 50)))->inc();
+        registry.histogram("latency", "", std::vector<double>(1, 1.0), label("id", std::to_string(i % 10)))->observe(0.5);
+        if (i % 7 == 0)
+            registry.remove("events", label("id", std::to_string(i % 50)));
+    }
+    done = true;
+    renderer.join();
+
+    BOOST_CHECK_EQUAL(malformed.load(), 0);
+    BOOST_CHECK_EQUAL(occurrences(registry.render(), "latency_count{"), 10u);
+}
@@ -0,0 +1,127 @@
+/*
+* rotating_file_log_appender_test.cpp
+* Rotation, compaction and failed rename tests for RotatingFileLogAppender
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE rotating_file_log_appender
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/rotating_file_log_appender.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    struct TempFolder {
+        TempFolder()
+            : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rotating-log-test-%%%%-%%%%"))
+        {
+            boost::filesystem::create_directories(path);
+        }
+
+        ~TempFolder()
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(path, ec);
+        }
+
+        boost::filesystem::path path;
+    };
+
+    void appendLines(LogBatchAppender& appender, int first, int count, size_t lineSize)
+    {
+        std::vector<LogRecord> records(count);
+        std::vector<const LogRecord*> batch;
+        for (int i = 0; i < count; i++)
+        {
+            std::string text = std::to_string(first + i) + ":" + std::string(lineSize, 'x');
+            records[i].assign("test", 4, LogLevelInfo, text.data(), text.size());
+            batch.push_back(&records[i]);
+        }
+        appender.append(batch);
+    }
+
+    size_t countLines(const boost::filesystem::path& path)
+    {
+        std::ifstream in(path.string().c_str(), std::ios::binary);
+        std::string line;
+        size_t count = 0;
+        while (std::getline(in, line))
+            count++;
+        return count;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(rotated_segments_are_compacted_and_shifted)
+{
+    TempFolder folder;
+    boost::filesystem::path filename = folder.path / "robot.log";
+    RotatingFileLogAppenderOptions options;
+    options.maxBackupIndex = 2;
+    options.bufferSize = 64 * 1024;
+    {
+        RotatingFileLogAppender appender(filename.string(), options);
+        for (int i = 0; i < 4; i++)
+            appendLines(appender, i * 1000, 1000, 1000);
+        appender.flush();
+        appender.waitForCompaction();
+
+        BOOST_CHECK(appender.isAvailable());
+        BOOST_CHECK(boost::filesystem::exists(folder.path / "robot.log.1.gz"));
+        BOOST_CHECK(boost::filesystem::exists(folder.path / "robot.log.2.gz"));
+        BOOST_CHECK(!boost::filesystem::exists(folder.path / "robot.log.3.gz"));
+        BOOST_CHECK_LT(boost::filesystem::file_size(filename), 1024u * 1024u);
+        BOOST_CHECK_LT(boost::filesystem::file_size(folder.path / "robot.log.1.gz"), 64u * 1024u);
+    }
+
+    // no pending segment is left behind
+    boost::filesystem::directory_iterator iter(folder.path), end;
+    for (; iter != end; ++iter)
+        BOOST_CHECK(iter->path().filename().string().find(".pending-") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(failed_rename_keeps_appending)
+{
+    TempFolder folder;
+    boost::filesystem::path filename = folder.path / "robot.log";
+    RotatingFileLogAppenderOptions options;
+    options.append = false;
+    options.compress = false;
+    options.bufferSize = 64 * 1024;
+
+    const int lines = 3000;
+    {
+        RotatingFileLogAppender appender(filename.string(), options);
+
+        // occupy every segment name the next seconds could produce with non-empty directories, so the rename fails
+        std::time_t now = std::time(nullptr);
+        for (std::time_t t = now; t < now + 30; t++)
+        {
+            for (int sequence = 0; sequence < 4; sequence++)
+            {
+                char suffix[64];
+                snprintf(suffix, sizeof(suffix), "robot.log.pending-%lld-%06d", static_cast<long long>(t), sequence);
+                boost::filesystem::create_directories(folder.path / suffix / "blocker");
+            }
+        }
+
+        appendLines(appender, 0, lines, 1000);
+        appender.flush();
+        BOOST_CHECK(appender.isAvailable());
+    }
+
+    // every line is still in the active file, nothing was truncated
+    BOOST_CHECK_EQUAL(countLines(filename), static_cast<size_t>(lines));
+    BOOST_CHECK(!boost::filesystem::exists(folder.path / "robot.log.1"));
+}
@@ -0,0 +1,139 @@
+/*
+* trace_recorder_test.cpp
+* Tests for TraceRecorder export, per thread buffer recycling and bounded name interning
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#define BOOST_TEST_MODULE trace_recorder
+#include <boost/test/unit_test.hpp>
+
+#include <rpos/system/util/trace_recorder.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace rpos::system::util;
+
+namespace {
+
+    size_t occurrences(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+            count++;
+        return count;
+    }
+
+    void recordScopes(int count)
+    {
+        for (int i = 0; i < count; i++)
+            TraceScope scope("test", "worker");
+    }
+
+    size_t exportAll(std::string* json = nullptr)
+    {
+        std::ostringstream out;
+        size_t count = TraceRecorder::instance().exportChromeTrace(out);
+        if (json)
+            *json = out.str();
+        return count;
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(scopes_are_exported_as_chrome_trace_events)
+{
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.setEnabled(true);
+    recorder.setCurrentThreadName("main \"thread\"");
+    {
+        TraceScope scope("planner", "search");
+        scope.addArgument("goal 1");
+        scope.addCheckPoint("expanded");
+    }
+    {
+        TraceScope interned(std::string("dynamic"), std::string("name"));
+    }
+
+    std::string json;
+    BOOST_CHECK_EQUAL(exportAll(&json), 3u);
+    BOOST_CHECK_EQUAL(json.compare(0, 15, "{\"displayTimeUn"), 0);
+    BOOST_CHECK_EQUAL(occurrences(json, "\"ph\":\"X\""), 2u);
+    BOOST_CHECK_EQUAL(occurrences(json, "\"ph\":\"i\""), 1u);
+    BOOST_CHECK_EQUAL(occurrences(json, "\"name\":\"search\""), 1u);
+    BOOST_CHECK_EQUAL(occurrences(json, "\"args\":{\"arg\":\"goal 1\"}"), 1u);
+    BOOST_CHECK_EQUAL(occurrences(json, "main \\\"thread\\\""), 1u);
+
+    // drained, a second export is empty
+    BOOST_CHECK_EQUAL(exportAll(), 0u);
+
+    recorder.setEnabled(false);
+    recordScopes(10);
+    BOOST_CHECK_EQUAL(exportAll(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(buffers_of_exited_threads_are_reused)
+{
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.setEnabled(true);
+    recorder.setBufferCapacity(1024);
+    recorder.setMaxRetiredBuffers(16, 4);
+
+    size_t exported = 0;
+    for (int round = 0; round < 20; round++)
+    {
+        for (int t = 0; t < 5; t++)
+        {
+            boost::thread thread(boost::bind(&recordScopes, 10));
+            thread.join();
+        }
+        exported += exportAll();
+        // the main thread, at most 4 free buffers and nothing retired after the export
+        BOOST_REQUIRE_LE(recorder.allocatedBuffers(), 5u);
+    }
+    BOOST_CHECK_EQUAL(exported, 20u * 5u * 10u);
+    recorder.setEnabled(false);
+}
+
+BOOST_AUTO_TEST_CASE(retired_buffers_are_capped_without_export)
+{
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.setEnabled(true);
+    recorder.setMaxRetiredBuffers(3, 2);
+    std::uint64_t droppedBefore = recorder.droppedEvents();
+
+    for (int t = 0; t < 50; t++)
+    {
+        boost::thread thread(boost::bind(&recordScopes, 10));
+        thread.join();
+    }
+    BOOST_CHECK_LE(recorder.allocatedBuffers(), 1u + 3u + 2u);
+    // only the events of the 3 newest exited threads are kept
+    BOOST_CHECK_EQUAL(recorder.droppedEvents() - droppedBefore, 47u * 10u);
+    BOOST_CHECK_EQUAL(exportAll(), 3u * 10u);
+    recorder.setEnabled(false);
+}
+
+BOOST_AUTO_TEST_CASE(interned_names_are_bounded)
+{
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.setMaxInternedStrings(8);
+    std::uint64_t overflowsBefore = recorder.internOverflows();
+
+    const char* first = recorder.intern("name-0");
+    BOOST_CHECK_EQUAL(std::string(first), "name-0");
+    BOOST_CHECK_EQUAL(recorder.intern("name-0"), first);
+
+    const char* last = nullptr;
+    for (int i = 0; i < 100; i++)
+        last = recorder.intern("name-" + std::to_string(i));
+    BOOST_CHECK_EQUAL(std::string(last), "(too many trace names)");
+    BOOST_CHECK_GE(recorder.internOverflows() - overflowsBefore, 90u);
+
+    // names interned before the limit keep resolving
+    BOOST_CHECK_EQUAL(recorder.intern("name-0"), first);
+}
@@ -0,0 +1,809 @@
+/*
+* artifact_index.h
+* Client side spatial index of artifact rectangles and lines, kept per ArtifactUsage
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "feature.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace rpos { namespace features { namespace artifact_provider {
+
+    namespace detail {
+
+        struct ArtifactBox {
+            float minX, minY, maxX, maxY;
+
+            float distanceSquaredTo(float x, float y) const
+            {
+                float dx = std::max(std::max(minX - x, 0.0f), x - maxX);
+                float dy = std::max(std::max(minY - y, 0.0f), y - maxY);
+                return dx * dx + dy * dy;
+            }
+
+            bool contains(float x, float y) const
+            {
+                return x >= minX && x <= maxX && y >= minY && y <= maxY;
+            }
+
+            bool overlaps(const ArtifactBox& that) const
+            {
+                return minX <= that.maxX && that.minX <= maxX && minY <= that.maxY && that.minY <= maxY;
+            }
+        };
+
+        /**
+        * Static bounding volume hierarchy over item boxes, median split on the longer axis
+        */
+        class ArtifactBvh {
+        public:
+            static const int kLeafSize = 4;
+
+            struct Node {
+                ArtifactBox box;
+                // leaf when count > 0: items_[first, first + count), otherwise children first and first + 1
+                int first;
+                int count;
+            };
+
+        public:
+            void build(const std::vector<ArtifactBox>& boxes)
+            {
+                nodes_.clear();
+                items_.resize(boxes.size());
+                for (size_t i = 0; i < boxes.size(); i++)
+                    items_[i] = static_cast<int>(i);
+                if (boxes.empty())
+                    return;
+                nodes_.reserve(2 * boxes.size() / kLeafSize + 2);
+                nodes_.push_back(Node());
+                build_(boxes, 0, 0, static_cast<int>(boxes.size()));
+            }
+
+            /**
+            * Visit every item whose box overlaps the query box
+            */
+            template < class VisitorT >
+            void query(const ArtifactBox& box, VisitorT visitor) const
+            {
+                if (nodes_.empty())
+                    return;
+                int stack[64];
+                int top = 0;
+                stack[top++] = 0;
+                while (top)
+                {
+                    const Node& node = nodes_[stack[--top]];
+                    if (!node.box.overlaps(box))
+                        continue;
+                    if (node.count)
+                    {
+                        for (int i = node.first; i < node.first + node.count; i++)
+                            visitor(items_[i]);
+                    }
+                    else
+                    {
+                        stack[top++] = node.first;
+                        stack[top++] = node.first + 1;
+                    }
+                }
+            }
+
+            /**
+            * Best first search, distance(item) returns the exact squared distance of an item
+            *
+            * @return Up to k (item, squared distance) pairs, nearest first
+            */
+            template < class DistanceT >
+            std::vector<std::pair<int, float> > nearest(float x, float y, size_t k, DistanceT distance) const
+            {
+                typedef std::pair<float, int> Entry;
+                std::vector<std::pair<int, float> > result;
+                if (nodes_.empty() || !k)
+                    return result;
+
+                // negative ids are nodes, non-negative ones are items with their exact distance
+                std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+                queue.push(Entry(nodes_[0].box.distanceSquaredTo(x, y), -1));
+                while (!queue.empty() && result.size() < k)
+                {
+                    Entry entry = queue.top();
+                    queue.pop();
+                    if (entry.second >= 0)
+                    {
+                        result.push_back(std::make_pair(entry.second, entry.first));
+                        continue;
+                    }
+
+                    const Node& node = nodes_[-entry.second - 1];
+                    if (node.count)
+                    {
+                        for (int i = node.first; i < node.first + node.count; i++)
+                            queue.push(Entry(distance(items_[i]), items_[i]));
+                    }
+                    else
+                    {
+                        queue.push(Entry(nodes_[node.first].box.distanceSquaredTo(x, y), -node.first - 1));
+                        queue.push(Entry(nodes_[node.first + 1].box.distanceSquaredTo(x, y), -node.first - 2));
+                    }
+                }
+                return result;
+            }
+
+        private:
+            void build_(const std::vector<ArtifactBox>& boxes, int nodeIndex, int begin, int end)
+            {
+                ArtifactBox bounds = boxes[items_[begin]];
+                for (int i = begin + 1; i < end; i++)
+                {
+                    const ArtifactBox& b = boxes[items_[i]];
+                    bounds.minX = std::min(bounds.minX, b.minX);
+                    bounds.minY = std::min(bounds.minY, b.minY);
+                    bounds.maxX = std::max(bounds.maxX, b.maxX);
+                    bounds.maxY = std::max(bounds.maxY, b.maxY);
+                }
+                nodes_[nodeIndex].box = bounds;
+
+                if (end - begin <= kLeafSize)
+                {
+                    nodes_[nodeIndex].first = begin;
+                    nodes_[nodeIndex].count = end - begin;
+                    return;
+                }
+
+                bool splitX = bounds.maxX - bounds.minX >= bounds.maxY - bounds.minY;
+                int middle = begin + (end - begin) / 2;
+                std::nth_element(items_.begin() + begin, items_.begin() + middle, items_.begin() + end, [&boxes, splitX](int a, int b) {
+                    const ArtifactBox& ba = boxes[a];
+                    const ArtifactBox& bb = boxes[b];
+                    return splitX ? ba.minX + ba.maxX < bb.minX + bb.maxX : ba.minY + ba.maxY < bb.minY + bb.maxY;
+                });
+
+                int left = static_cast<int>(nodes_.size());
+                nodes_.push_back(Node());
+                nodes_.push_back(Node());
+                nodes_[nodeIndex].first = left;
+                nodes_[nodeIndex].count = 0;
+                build_(boxes, left, begin, middle);
+                build_(boxes, left + 1, middle, end);
+            }
+
+        private:
+            std::vector<Node> nodes_;
+            std::vector<int> items_;
+        };
+
+        inline float artifactSegmentDistanceSquared(float px, float py, float ax, float ay, float bx, float by)
+        {
+            float dx = bx - ax, dy = by - ay;
+            float length2 = dx * dx + dy * dy;
+            float t = length2 > 0 ? ((px - ax) * dx + (py - ay) * dy) / length2 : 0.0f;
+            t = std::min(std::max(t, 0.0f), 1.0f);
+            float ex = ax + t * dx - px, ey = ay + t * dy - py;
+            return ex * ex + ey * ey;
+        }
+
+        inline float artifactCross(float ax, float ay, float bx, float by, float cx, float cy)
+        {
+            return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        }
+
+        inline bool artifactSegmentsIntersect(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy)
+        {
+            float d1 = artifactCross(cx, cy, dx, dy, ax, ay);
+            float d2 = artifactCross(cx, cy, dx, dy, bx, by);
+            float d3 = artifactCross(ax, ay, bx, by, cx, cy);
+            float d4 = artifactCross(ax, ay, bx, by, dx, dy);
+            if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+                return true;
+
+            // collinear or touching
+            if (d1 == 0 && artifactSegmentDistanceSquared(ax, ay, cx, cy, dx, dy) == 0) return true;
+            if (d2 == 0 && artifactSegmentDistanceSquared(bx, by, cx, cy, dx, dy) == 0) return true;
+            if (d3 == 0 && artifactSegmentDistanceSquared(cx, cy, ax, ay, bx, by) == 0) return true;
+            if (d4 == 0 && artifactSegmentDistanceSquared(dx, dy, ax, ay, bx, by) == 0) return true;
+            return false;
+        }
+
+        /**
+        * Oriented rectangle in its own frame: u along start -> end in [0, length], v across in [-halfWidth, halfWidth]
+        */
+        struct ArtifactOrientedRect {
+            float sx, sy;
+            float ux, uy;
+            float length;
+            float halfWidth;
+
+            explicit ArtifactOrientedRect(const rpos::core::ORectangleF& rect)
+                : sx(rect.start().x())
+                , sy(rect.start().y())
+                , halfWidth(std::fabs(rect.halfWidth()))
+            {
+                float dx = rect.end().x() - sx, dy = rect.end().y() - sy;
+                length = std::sqrt(dx * dx + dy * dy);
+                ux = length > 0 ? dx / length : 1.0f;
+                uy = length > 0 ? dy / length : 0.0f;
+            }
+
+            void toLocal(float x, float y, float& u, float& v) const
+            {
+                float dx = x - sx, dy = y - sy;
+                u = dx * ux + dy * uy;
+                v = -dx * uy + dy * ux;
+            }
+
+            ArtifactBox box() const
+            {
+                float ex = sx + ux * length, ey = sy + uy * length;
+                float wx = std::fabs(uy) * halfWidth, wy = std::fabs(ux) * halfWidth;
+                ArtifactBox result = { std::min(sx, ex) - wx, std::min(sy, ey) - wy, std::max(sx, ex) + wx, std::max(sy, ey) + wy };
+                return result;
+            }
+
+            bool contains(float x, float y) const
+            {
+                float u, v;
+                toLocal(x, y, u, v);
+                return u >= 0 && u <= length && std::fabs(v) <= halfWidth;
+            }
+
+            float distanceSquaredTo(float x, float y) const
+            {
+                float u, v;
+                toLocal(x, y, u, v);
+                float du = std::max(std::max(-u, 0.0f), u - length);
+                float dv = std::max(std::fabs(v) - halfWidth, 0.0f);
+                return du * du + dv * dv;
+            }
+
+            /**
+            * Liang-Barsky clip of the segment against the rectangle in local coordinates
+            */
+            bool intersectsSegment(float ax, float ay, float bx, float by) const
+            {
+                float u0, v0, u1, v1;
+                toLocal(ax, ay, u0, v0);
+                toLocal(bx, by, u1, v1);
+                float du = u1 - u0, dv = v1 - v0;
+                float t0 = 0, t1 = 1;
+                const float p[4] = { -du, du, -dv, dv };
+                const float q[4] = { u0, length - u0, v0 + halfWidth, halfWidth - v0 };
+                for (int i = 0; i < 4; i++)
+                {
+                    if (p[i] == 0)
+                    {
+                        if (q[i] < 0)
+                            return false;
+                        continue;
+                    }
+                    float t = q[i] / p[i];
+                    if (p[i] < 0)
+                        t0 = std::max(t0, t);
+                    else
+                        t1 = std::min(t1, t);
+                    if (t0 > t1)
+                        return false;
+                }
+                return true;
+            }
+        };
+
+    }
+
+    /**
+    * Result of a nearest query, distance is 0 for a point inside an area
+    */
+    struct ArtifactNeighbor {
+        rpos::core::SegmentID id;
+        float distance;
+    };
+
+    /**
+    * Spatial index of the rectangles and lines of each ArtifactUsage
+    *
+    * Mutations only mark the usage dirty, its BVH is rebuilt on the next query, which suits
+    * artifacts that are edited rarely and queried on every goal or path check. All methods are
+    * thread safe.
+    */
+    class ArtifactSpatialIndex : private boost::noncopyable {
+    public:
+        void setRectangleAreas(ArtifactUsage usage, const std::vector<RectangleArea>& areas)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_& index = usages_[usage];
+            index.rects.clear();
+            for (auto iter = areas.begin(); iter != areas.end(); ++iter)
+                index.rects.push_back(Rect_(iter->id, iter->area));
+            index.rectsDirty = true;
+        }
+
+        void setLines(ArtifactUsage usage, const std::vector<rpos::core::Line>& lines)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_& index = usages_[usage];
+            index.lines.clear();
+            for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+                index.lines.push_back(Line_(*iter));
+            index.linesDirty = true;
+        }
+
+        /**
+        * Insert or replace (by id) rectangle areas
+        */
+        void upsertRectangleAreas(ArtifactUsage usage, const std::vector<RectangleArea>& areas)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_& index = usages_[usage];
+            for (auto iter = areas.begin(); iter != areas.end(); ++iter)
+            {
+                Rect_ rect(iter->id, iter->area);
+                auto existing = std::find_if(index.rects.begin(), index.rects.end(), [&rect](const Rect_& r) { return r.id == rect.id; });
+                if (existing != index.rects.end())
+                    *existing = rect;
+                else
+                    index.rects.push_back(rect);
+            }
+            index.rectsDirty = true;
+        }
+
+        void removeRectangleAreas(ArtifactUsage usage, const std::vector<rpos::core::SegmentID>& ids)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_& index = usages_[usage];
+            eraseIds_(index.rects, ids);
+            index.rectsDirty = true;
+        }
+
+        /**
+        * Insert or replace (by id) lines
+        */
+        void upsertLines(ArtifactUsage usage, const std::vector<rpos::core::Line>& lines)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_& index = usages_[usage];
+            for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+            {
+                Line_ line(*iter);
+                auto existing = std::find_if(index.lines.begin(), index.lines.end(), [&line](const Line_& l) { return l.id == line.id; });
+                if (existing != index.lines.end())
+                    *existing = line;
+                else
+                    index.lines.push_back(line);
+            }
+            index.linesDirty = true;
+        }
+
+        void removeLines(ArtifactUsage usage, const std::vector<rpos::core::SegmentID>& ids)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_& index = usages_[usage];
+            eraseIds_(index.lines, ids);
+            index.linesDirty = true;
+        }
+
+        void clear(ArtifactUsage usage)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            usages_.erase(usage);
+        }
+
+    public:
+        /**
+        * Ids of the areas containing the point
+        */
+        std::vector<rpos::core::SegmentID> areasContaining(ArtifactUsage usage, const rpos::core::Vector2f& point)
+        {
+            std::vector<rpos::core::SegmentID> result;
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_* index = rectIndex_(usage);
+            if (!index)
+                return result;
+            detail::ArtifactBox box = { point.x(), point.y(), point.x(), point.y() };
+            index->rectTree.query(box, [&](int i) {
+                if (index->rects[i].shape.contains(point.x(), point.y()))
+                    result.push_back(index->rects[i].id);
+            });
+            return result;
+        }
+
+        bool isInsideArea(ArtifactUsage usage, const rpos::core::Vector2f& point)
+        {
+            return !areasContaining(usage, point).empty();
+        }
+
+        /**
+        * Ids of the areas the segment touches
+        */
+        std::vector<rpos::core::SegmentID> areasIntersecting(ArtifactUsage usage, const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            std::vector<rpos::core::SegmentID> result;
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_* index = rectIndex_(usage);
+            if (!index)
+                return result;
+            index->rectTree.query(segmentBox_(a, b), [&](int i) {
+                if (index->rects[i].shape.intersectsSegment(a.x(), a.y(), b.x(), b.y()))
+                    result.push_back(index->rects[i].id);
+            });
+            return result;
+        }
+
+        /**
+        * Ids of the lines (e.g. virtual walls) the segment crosses or touches
+        */
+        std::vector<rpos::core::SegmentID> linesIntersecting(ArtifactUsage usage, const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            std::vector<rpos::core::SegmentID> result;
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_* index = lineIndex_(usage);
+            if (!index)
+                return result;
+            index->lineTree.query(segmentBox_(a, b), [&](int i) {
+                const Line_& line = index->lines[i];
+                if (detail::artifactSegmentsIntersect(a.x(), a.y(), b.x(), b.y(), line.ax, line.ay, line.bx, line.by))
+                    result.push_back(line.id);
+            });
+            return result;
+        }
+
+        bool crossesLine(ArtifactUsage usage, const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            return !linesIntersecting(usage, a, b).empty();
+        }
+
+        std::vector<ArtifactNeighbor> nearestAreas(ArtifactUsage usage, const rpos::core::Vector2f& point, size_t k)
+        {
+            std::vector<ArtifactNeighbor> result;
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_* index = rectIndex_(usage);
+            if (!index)
+                return result;
+            std::vector<std::pair<int, float> > items = index->rectTree.nearest(point.x(), point.y(), k, [&](int i) {
+                return index->rects[i].shape.distanceSquaredTo(point.x(), point.y());
+            });
+            for (auto iter = items.begin(); iter != items.end(); ++iter)
+            {
+                ArtifactNeighbor neighbor = { index->rects[iter->first].id, std::sqrt(iter->second) };
+                result.push_back(neighbor);
+            }
+            return result;
+        }
+
+        std::vector<ArtifactNeighbor> nearestLines(ArtifactUsage usage, const rpos::core::Vector2f& point, size_t k)
+        {
+            std::vector<ArtifactNeighbor> result;
+            boost::lock_guard<boost::mutex> guard(lock_);
+            UsageIndex_* index = lineIndex_(usage);
+            if (!index)
+                return result;
+            std::vector<std::pair<int, float> > items = index->lineTree.nearest(point.x(), point.y(), k, [&](int i) {
+                const Line_& line = index->lines[i];
+                return detail::artifactSegmentDistanceSquared(point.x(), point.y(), line.ax, line.ay, line.bx, line.by);
+            });
+            for (auto iter = items.begin(); iter != items.end(); ++iter)
+            {
+                ArtifactNeighbor neighbor = { index->lines[iter->first].id, std::sqrt(iter->second) };
+                result.push_back(neighbor);
+            }
+            return result;
+        }
+
+    private:
+        struct Rect_ {
+            Rect_(rpos::core::SegmentID id, const rpos::core::ORectangleF& area)
+                : id(id)
+                , shape(area)
+            {}
+
+            rpos::core::SegmentID id;
+            detail::ArtifactOrientedRect shape;
+        };
+
+        struct Line_ {
+            explicit Line_(const rpos::core::Line& line)
+                : id(line.id())
+                , ax(line.startP().x())
+                , ay(line.startP().y())
+                , bx(line.endP().x())
+                , by(line.endP().y())
+            {}
+
+            rpos::core::SegmentID id;
+            float ax, ay, bx, by;
+        };
+
+        struct UsageIndex_ {
+            UsageIndex_()
+                : rectsDirty(false)
+                , linesDirty(false)
+            {}
+
+            std::vector<Rect_> rects;
+            std::vector<Line_> lines;
+            detail::ArtifactBvh rectTree;
+            detail::ArtifactBvh lineTree;
+            bool rectsDirty;
+            bool linesDirty;
+        };
+
+        template < class ItemT >
+        static void eraseIds_(std::vector<ItemT>& items, const std::vector<rpos::core::SegmentID>& ids)
+        {
+            items.erase(std::remove_if(items.begin(), items.end(), [&ids](const ItemT& item) {
+                return std::find(ids.begin(), ids.end(), item.id) != ids.end();
+            }), items.end());
+        }
+
+        static detail::ArtifactBox segmentBox_(const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            detail::ArtifactBox box = { std::min(a.x(), b.x()), std::min(a.y(), b.y()), std::max(a.x(), b.x()), std::max(a.y(), b.y()) };
+            return box;
+        }
+
+        UsageIndex_* rectIndex_(ArtifactUsage usage)
+        {
+            auto iter = usages_.find(usage);
+            if (iter == usages_.end())
+                return nullptr;
+            UsageIndex_& index = iter->second;
+            if (index.rectsDirty)
+            {
+                std::vector<detail::ArtifactBox> boxes;
+                boxes.reserve(index.rects.size());
+                for (auto rect = index.rects.begin(); rect != index.rects.end(); ++rect)
+                    boxes.push_back(rect->shape.box());
+                index.rectTree.build(boxes);
+                index.rectsDirty = false;
+            }
+            return &index;
+        }
+
+        UsageIndex_* lineIndex_(ArtifactUsage usage)
+        {
+            auto iter = usages_.find(usage);
+            if (iter == usages_.end())
+                return nullptr;
+            UsageIndex_& index = iter->second;
+            if (index.linesDirty)
+            {
+                std::vector<detail::ArtifactBox> boxes;
+                boxes.reserve(index.lines.size());
+                for (auto line = index.lines.begin(); line != index.lines.end(); ++line)
+                {
+                    detail::ArtifactBox box = { std::min(line->ax, line->bx), std::min(line->ay, line->by), std::max(line->ax, line->bx), std::max(line->ay, line->by) };
+                    boxes.push_back(box);
+                }
+                index.lineTree.build(boxes);
+                index.linesDirty = false;
+            }
+            return &index;
+        }
+
+    private:
+        boost::mutex lock_;
+        std::map<ArtifactUsage, UsageIndex_> usages_;
+    };
+
+    /**
+    * ArtifactSpatialIndex kept in sync with a provider
+    *
+    * ProviderT is features::ArtifactProvider or robot_platforms::SlamwareCorePlatform. Mutations go
+    * through this object, are forwarded to the provider and applied to the index when the provider
+    * accepts them. Added items get their ids from the robot, so an add makes the next query fetch the
+    * usage again. A usage is fetched from the provider on its first query; call refresh() after
+    * changes made by other clients.
+    */
+    template < class ProviderT >
+    class ArtifactIndexCache : private boost::noncopyable {
+    public:
+        explicit ArtifactIndexCache(ProviderT provider)
+            : provider_(provider)
+        {}
+
+    public:
+        ArtifactSpatialIndex& index()
+        {
+            return index_;
+        }
+
+        /**
+        * Make sure a usage is loaded, fetching it from the provider the first time
+        */
+        ArtifactSpatialIndex& index(ArtifactUsage usage)
+        {
+            if (!isLoaded_(usage))
+                refresh(usage);
+            return index_;
+        }
+
+        /**
+        * Fetch a usage from the provider, it stays unloaded (and is fetched again on the next query)
+        * if the provider throws
+        *
+        * An add that lands while the fetch is in flight may be missing from the result, so the result
+        * is only stored if the usage was not invalidated meanwhile, otherwise it is fetched again
+        */
+        void refresh(ArtifactUsage usage)
+        {
+            for (;;)
+            {
+                std::uint64_t generation;
+                {
+                    boost::lock_guard<boost::mutex> guard(lock_);
+                    generation = generations_[usage];
+                }
+
+                std::vector<RectangleArea> areas = provider_.getRectangleAreas(usage);
+                std::vector<rpos::core::Line> lines = provider_.getLines(usage);
+
+                boost::lock_guard<boost::mutex> guard(lock_);
+                if (generations_[usage] != generation)
+                    continue;
+                index_.setRectangleAreas(usage, areas);
+                index_.setLines(usage, lines);
+                loaded_.insert(usage);
+                return;
+            }
+        }
+
+    public:
+        bool addRectangleArea(ArtifactUsage usage, const RectangleArea& area)
+        {
+            return addRectangleAreas(usage, std::vector<RectangleArea>(1, area));
+        }
+
+        bool editRectangleArea(ArtifactUsage usage, const RectangleArea& area)
+        {
+            if (!provider_.editRectangleArea(usage, area))
+                return false;
+            index_.upsertRectangleAreas(usage, std::vector<RectangleArea>(1, area));
+            return true;
+        }
+
+        bool addRectangleAreas(ArtifactUsage usage, const std::vector<RectangleArea>& areas)
+        {
+            if (!provider_.addRectangleAreas(usage, areas))
+                return false;
+            invalidate_(usage);
+            return true;
+        }
+
+        bool removeRectangleAreaByIds(ArtifactUsage usage, const std::vector<rpos::core::SegmentID>& ids)
+        {
+            if (!provider_.removeRectangleAreaByIds(usage, ids))
+                return false;
+            index_.removeRectangleAreas(usage, ids);
+            return true;
+        }
+
+        bool clearRectangleAreas(ArtifactUsage usage)
+        {
+            if (!provider_.clearRectangleAreas(usage))
+                return false;
+            index_.setRectangleAreas(usage, std::vector<RectangleArea>());
+            return true;
+        }
+
+        bool addLine(ArtifactUsage usage, const rpos::core::Line& line)
+        {
+            return addLines(usage, std::vector<rpos::core::Line>(1, line));
+        }
+
+        bool addLines(ArtifactUsage usage, const std::vector<rpos::core::Line>& lines)
+        {
+            if (!provider_.addLines(usage, lines))
+                return false;
+            invalidate_(usage);
+            return true;
+        }
+
+        bool moveLine(ArtifactUsage usage, const rpos::core::Line& line)
+        {
+            if (!provider_.moveLine(usage, line))
+                return false;
+            index_.upsertLines(usage, std::vector<rpos::core::Line>(1, line));
+            return true;
+        }
+
+        bool moveLines(ArtifactUsage usage, const std::vector<rpos::core::Line>& lines)
+        {
+            if (!provider_.moveLines(usage, lines))
+                return false;
+            index_.upsertLines(usage, lines);
+            return true;
+        }
+
+        bool removeLineById(ArtifactUsage usage, rpos::core::SegmentID id)
+        {
+            if (!provider_.removeLineById(usage, id))
+                return false;
+            index_.removeLines(usage, std::vector<rpos::core::SegmentID>(1, id));
+            return true;
+        }
+
+        bool clearLines(ArtifactUsage usage)
+        {
+            if (!provider_.clearLines(usage))
+                return false;
+            index_.setLines(usage, std::vector<rpos::core::Line>());
+            return true;
+        }
+
+    public:
+        bool isInsideArea(ArtifactUsage usage, const rpos::core::Vector2f& point)
+        {
+            return index(usage).isInsideArea(usage, point);
+        }
+
+        std::vector<rpos::core::SegmentID> areasContaining(ArtifactUsage usage, const rpos::core::Vector2f& point)
+        {
+            return index(usage).areasContaining(usage, point);
+        }
+
+        std::vector<rpos::core::SegmentID> areasIntersecting(ArtifactUsage usage, const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            return index(usage).areasIntersecting(usage, a, b);
+        }
+
+        bool crossesLine(ArtifactUsage usage, const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            return index(usage).crossesLine(usage, a, b);
+        }
+
+        std::vector<rpos::core::SegmentID> linesIntersecting(ArtifactUsage usage, const rpos::core::Vector2f& a, const rpos::core::Vector2f& b)
+        {
+            return index(usage).linesIntersecting(usage, a, b);
+        }
+
+        std::vector<ArtifactNeighbor> nearestAreas(ArtifactUsage usage, const rpos::core::Vector2f& point, size_t k)
+        {
+            return index(usage).nearestAreas(usage, point, k);
+        }
+
+        std::vector<ArtifactNeighbor> nearestLines(ArtifactUsage usage, const rpos::core::Vector2f& point, size_t k)
+        {
+            return index(usage).nearestLines(usage, point, k);
+        }
+
+    private:
+        bool isLoaded_(ArtifactUsage usage)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            return loaded_.count(usage) != 0;
+        }
+
+        // the ids of added items are only known to the provider, upserting them by id would collapse
+        // every new item onto the same default id, so the usage is fetched again on its next query
+        void invalidate_(ArtifactUsage usage)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            loaded_.erase(usage);
+            generations_[usage]++;
+        }
+
+    private:
+        ProviderT provider_;
+        ArtifactSpatialIndex index_;
+        boost::mutex lock_;
+        std::set<ArtifactUsage> loaded_;
+        std::map<ArtifactUsage, std::uint64_t> generations_;
+    };
+
+} } }
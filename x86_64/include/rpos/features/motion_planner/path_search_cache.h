@@ -0,0 +1,380 @@
+/*
+* path_search_cache.h
+* LRU cache of searchPath results keyed by the quantized robot location and goal
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/core/geometry.h>
+#include <rpos/features/artifact_provider/feature.h>
+#include <rpos/features/motion_planner/path.h>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rpos { namespace features { namespace motion_planner {
+
+    struct PathSearchCacheOptions {
+        PathSearchCacheOptions()
+            : capacity(4096)
+            , resolution(0.05f)
+            , timeoutMs(10000)
+            , cacheFailures(true)
+        {}
+
+        /**
+        * Maximum number of cached paths, the least recently used one is evicted first
+        */
+        size_t capacity;
+
+        /**
+        * Grid size in meters the robot location and goal are snapped to before lookup
+        */
+        float resolution;
+
+        /**
+        * Timeout passed to searchPath on a miss
+        */
+        int timeoutMs;
+
+        /**
+        * Remember unreachable goals (empty paths) as well, so they are not searched again until invalidated
+        */
+        bool cacheFailures;
+    };
+
+    struct PathSearchCacheStats {
+        boost::uint64_t hits;
+        boost::uint64_t misses;
+        boost::uint64_t evictions;
+        boost::uint64_t invalidations;
+        size_t size;
+    };
+
+    /**
+    * Whether a change to artifacts of this usage may change the result of a path search
+    */
+    inline bool artifactUsageAffectsPathSearch(artifact_provider::ArtifactUsage usage)
+    {
+        switch (usage)
+        {
+        case artifact_provider::ArtifactUsagePoi:
+        case artifact_provider::ArtifactUsageLandmark:
+        case artifact_provider::ArtifactUsageCoverageArea:
+        case artifact_provider::ArtifactUsageScheduleArea:
+        case artifact_provider::ArtifactUsageSensorDisableArea:
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    /**
+    * Length of a path as driven from start, infinity for an empty (failed) path
+    */
+    inline float pathLength(const core::Location& start, const Path& path)
+    {
+        if (!path || path.getPoints().empty())
+            return std::numeric_limits<float>::infinity();
+
+        const std::vector<core::Location>& points = path.getPoints();
+        double length = start.distanceTo(points.front());
+        for (size_t i = 1; i < points.size(); i++)
+            length += points[i - 1].distanceTo(points[i]);
+        return static_cast<float>(length);
+    }
+
+    /**
+    * Client side LRU cache in front of searchPath()
+    *
+    * PlannerT is anything with `Path searchPath(const core::Location&, int)` and
+    * `core::Location getLocation()`, typically SlamwareCorePlatform. The server always plans from
+    * the current robot location, so the cache reads it from the planner and keys on it together
+    * with the goal.
+    *
+    * Both are snapped to a grid of options.resolution, so queries a few centimeters apart share an
+    * entry. The server does not report a map revision, so the owner calls invalidate() (or
+    * invalidateArtifacts()) whenever the map, virtual walls or forbidden areas are changed; a
+    * search that was in flight during an invalidation is not stored.
+    *
+    * Usage:
+    *   PathSearchCache<SlamwareCorePlatform> cache(platform);
+    *   std::vector<float> lengths;
+    *   cache.pathLengths(shelves, lengths);
+    *   ...
+    *   platform.addLines(ArtifactUsageVirtualWall, walls);
+    *   cache.invalidateArtifacts(ArtifactUsageVirtualWall);
+    *
+    * All methods are thread safe, the lock is not held while searching.
+    */
+    template <class PlannerT>
+    class PathSearchCache : private boost::noncopyable {
+    public:
+        explicit PathSearchCache(PlannerT planner, const PathSearchCacheOptions& options = PathSearchCacheOptions())
+            : planner_(planner)
+            , options_(options)
+            , revision_(0)
+            , hits_(0)
+            , misses_(0)
+            , evictions_(0)
+            , invalidations_(0)
+        {}
+
+    public:
+        /**
+        * Path from the current location to goal, served from the cache when possible
+        */
+        Path searchPath(const core::Location& goal)
+        {
+            return searchPath_(planner_.getLocation(), goal);
+        }
+
+        float pathLength(const core::Location& goal)
+        {
+            core::Location start = planner_.getLocation();
+            return motion_planner::pathLength(start, searchPath_(start, goal));
+        }
+
+        /**
+        * Path lengths from the current location to many goals, lengths[i] belongs to goals[i]
+        *
+        * Hits are answered under a single lock, goals falling into the same cell are searched once,
+        * and only the remaining misses reach the planner. Unreachable goals, and goals whose search
+        * threw, yield infinity.
+        */
+        void pathLengths(const std::vector<core::Location>& goals, std::vector<float>& lengths)
+        {
+            core::Location start = planner_.getLocation();
+            lengths.assign(goals.size(), std::numeric_limits<float>::infinity());
+
+            std::vector<Key> keys(goals.size());
+            std::vector<size_t> pending;
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                for (size_t i = 0; i < goals.size(); i++)
+                {
+                    keys[i] = makeKey_(start, goals[i]);
+                    typename map_t::iterator it = entries_.find(keys[i]);
+                    if (it == entries_.end())
+                    {
+                        pending.push_back(i);
+                        continue;
+                    }
+                    touch_(it->second);
+                    lengths[i] = motion_planner::pathLength(start, it->second->path);
+                    hits_++;
+                }
+            }
+
+            std::unordered_map<Key, float, KeyHash> searched;
+            for (size_t n = 0; n < pending.size(); n++)
+            {
+                size_t i = pending[n];
+                typename std::unordered_map<Key, float, KeyHash>::const_iterator done = searched.find(keys[i]);
+                if (done != searched.end())
+                {
+                    lengths[i] = done->second;
+                    continue;
+                }
+
+                boost::uint64_t revision = revision_.load(boost::memory_order_acquire);
+                Path path;
+                try
+                {
+                    path = planner_.searchPath(goals[i], options_.timeoutMs);
+                }
+                catch (const std::exception&)
+                {
+                    // e.g. a timeout, not a verdict on reachability, so nothing is stored
+                    searched[keys[i]] = lengths[i];
+                    continue;
+                }
+                store_(keys[i], path, revision);
+                lengths[i] = motion_planner::pathLength(start, path);
+                searched[keys[i]] = lengths[i];
+            }
+        }
+
+        /**
+        * Drop every entry, call after the map was changed
+        */
+        void invalidate()
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            revision_.fetch_add(1, boost::memory_order_acq_rel);
+            entries_.clear();
+            lru_.clear();
+            invalidations_++;
+        }
+
+        /**
+        * Invalidate if artifacts of this usage can change search results
+        */
+        void invalidateArtifacts(artifact_provider::ArtifactUsage usage)
+        {
+            if (artifactUsageAffectsPathSearch(usage))
+                invalidate();
+        }
+
+        boost::uint64_t revision() const
+        {
+            return revision_.load(boost::memory_order_acquire);
+        }
+
+        PathSearchCacheStats stats() const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            PathSearchCacheStats result;
+            result.hits = hits_;
+            result.misses = misses_;
+            result.evictions = evictions_;
+            result.invalidations = invalidations_;
+            result.size = lru_.size();
+            return result;
+        }
+
+        const PathSearchCacheOptions& options() const
+        {
+            return options_;
+        }
+
+        PlannerT& planner()
+        {
+            return planner_;
+        }
+
+    private:
+        struct Key {
+            boost::int32_t sx, sy, gx, gy;
+
+            bool operator==(const Key& that) const
+            {
+                return sx == that.sx && sy == that.sy && gx == that.gx && gy == that.gy;
+            }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const
+            {
+                boost::uint64_t h = 1469598103934665603ULL;
+                const boost::int32_t parts[4] = { key.sx, key.sy, key.gx, key.gy };
+                for (int i = 0; i < 4; i++)
+                {
+                    h ^= static_cast<boost::uint32_t>(parts[i]);
+                    h *= 1099511628211ULL;
+                }
+                return static_cast<size_t>(h ^ (h >> 32));
+            }
+        };
+
+        struct Entry {
+            Key key;
+            Path path;
+        };
+
+        typedef std::list<Entry> list_t;
+        typedef std::unordered_map<Key, typename list_t::iterator, KeyHash> map_t;
+
+        boost::int32_t quantize_(float v) const
+        {
+            return static_cast<boost::int32_t>(std::floor(v / options_.resolution + 0.5f));
+        }
+
+        Key makeKey_(const core::Location& start, const core::Location& goal) const
+        {
+            Key key;
+            key.sx = quantize_(start.x());
+            key.sy = quantize_(start.y());
+            key.gx = quantize_(goal.x());
+            key.gy = quantize_(goal.y());
+            return key;
+        }
+
+        Path searchPath_(const core::Location& start, const core::Location& goal)
+        {
+            Key key = makeKey_(start, goal);
+            Path path;
+            if (lookup_(key, path))
+                return path;
+
+            boost::uint64_t revision = revision_.load(boost::memory_order_acquire);
+            path = planner_.searchPath(goal, options_.timeoutMs);
+            store_(key, path, revision);
+            return path;
+        }
+
+        void touch_(typename list_t::iterator it)
+        {
+            lru_.splice(lru_.begin(), lru_, it);
+        }
+
+        bool lookup_(const Key& key, Path& path)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            typename map_t::iterator it = entries_.find(key);
+            if (it == entries_.end())
+                return false;
+            touch_(it->second);
+            path = it->second->path;
+            hits_++;
+            return true;
+        }
+
+        void store_(const Key& key, const Path& path, boost::uint64_t revision)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            misses_++;
+            if (revision != revision_.load(boost::memory_order_acquire))
+                return;
+            if (options_.capacity == 0 || ((!path || path.getPoints().empty()) && !options_.cacheFailures))
+                return;
+
+            typename map_t::iterator it = entries_.find(key);
+            if (it != entries_.end())
+            {
+                it->second->path = path;
+                touch_(it->second);
+                return;
+            }
+
+            Entry entry = { key, path };
+            lru_.push_front(entry);
+            entries_[key] = lru_.begin();
+
+            while (lru_.size() > options_.capacity)
+            {
+                entries_.erase(lru_.back().key);
+                lru_.pop_back();
+                evictions_++;
+            }
+        }
+
+    private:
+        PlannerT planner_;
+        PathSearchCacheOptions options_;
+
+        mutable boost::mutex lock_;
+        list_t lru_;
+        map_t entries_;
+        boost::atomic<boost::uint64_t> revision_;
+        boost::uint64_t hits_;
+        boost::uint64_t misses_;
+        boost::uint64_t evictions_;
+        boost::uint64_t invalidations_;
+    };
+
+} } }
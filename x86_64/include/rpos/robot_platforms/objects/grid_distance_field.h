@@ -0,0 +1,436 @@
+/*
+* grid_distance_field.h
+* Exact Euclidean distance transform and inflation over bitmap maps and grid map layers
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/features/location_provider/map.h>
+#include <rpos/robot_platforms/objects/grid_map_layer.h>
+#include <rpos/system/parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace rpos { namespace robot_platforms { namespace objects {
+
+    struct GridDistanceFieldOptions {
+        GridDistanceFieldOptions()
+            : occupiedThreshold(128)
+            , unknownIsOccupied(false)
+            , maxDistance(std::numeric_limits<float>::infinity())
+            , concurrency(0)
+        {}
+
+        /**
+        * Cells with a value at or above the threshold are obstacles, 0 is unknown
+        */
+        uint8_t occupiedThreshold;
+
+        bool unknownIsOccupied;
+
+        /**
+        * Distances are clamped to this many meters, a finite value lets update() recompute only the
+        * neighbourhood of a dirty region instead of the whole map
+        */
+        float maxDistance;
+
+        /**
+        * Worker threads, 0 means hardware concurrency and 1 runs on the calling thread
+        */
+        int concurrency;
+    };
+
+    namespace detail {
+
+        const float kGridDistanceInfinity = 1e20f;
+        const int kGridDistanceStrip = 64;
+
+        /**
+        * Distance in cells to the nearest obstacle in the same column, swept row by row so the inner
+        * loop runs over contiguous columns and vectorizes
+        */
+        inline void gridDistanceColumns(const uint8_t* src, int stride, int width, int height, const GridDistanceFieldOptions& options, float* out, int x0, int x1)
+        {
+            const uint8_t threshold = options.occupiedThreshold;
+            const bool unknown = options.unknownIsOccupied;
+
+            for (int y = 0; y < height; y++)
+            {
+                const uint8_t* row = src + static_cast<size_t>(y) * stride;
+                float* dst = out + static_cast<size_t>(y) * width;
+                if (y == 0)
+                {
+                    for (int x = x0; x < x1; x++)
+                        dst[x] = kGridDistanceInfinity;
+                }
+                else
+                {
+                    const float* prev = dst - width;
+                    for (int x = x0; x < x1; x++)
+                        dst[x] = prev[x] + 1.0f;
+                }
+                for (int x = x0; x < x1; x++)
+                {
+                    bool occupied = row[x] >= threshold || (unknown && row[x] == 0);
+                    dst[x] = occupied ? 0.0f : dst[x];
+                }
+            }
+
+            for (int y = height - 2; y >= 0; y--)
+            {
+                float* dst = out + static_cast<size_t>(y) * width;
+                const float* next = dst + width;
+                for (int x = x0; x < x1; x++)
+                    dst[x] = std::min(dst[x], next[x] + 1.0f);
+            }
+
+            for (int y = 0; y < height; y++)
+            {
+                float* dst = out + static_cast<size_t>(y) * width;
+                for (int x = x0; x < x1; x++)
+                    dst[x] = dst[x] >= kGridDistanceInfinity ? kGridDistanceInfinity : dst[x] * dst[x];
+            }
+        }
+
+        /**
+        * Felzenszwalb-Huttenlocher lower envelope of parabolas over one row of squared column
+        * distances, in place
+        */
+        inline void gridDistanceRow(float* f, int n, std::vector<float>& d, std::vector<int>& v, std::vector<double>& z)
+        {
+            d.resize(n);
+            v.resize(n);
+            z.resize(n + 1);
+
+            int k = -1;
+            for (int q = 0; q < n; q++)
+            {
+                if (f[q] >= kGridDistanceInfinity)
+                    continue;
+                if (k < 0)
+                {
+                    k = 0;
+                    v[0] = q;
+                    z[0] = -std::numeric_limits<double>::infinity();
+                    z[1] = std::numeric_limits<double>::infinity();
+                    continue;
+                }
+
+                double s;
+                for (;;)
+                {
+                    int p = v[k];
+                    s = ((f[q] + static_cast<double>(q) * q) - (f[p] + static_cast<double>(p) * p)) / (2.0 * (q - p));
+                    if (s > z[k])
+                        break;
+                    k--;
+                }
+                k++;
+                v[k] = q;
+                z[k] = s;
+                z[k + 1] = std::numeric_limits<double>::infinity();
+            }
+
+            if (k < 0)
+                return;
+
+            k = 0;
+            for (int q = 0; q < n; q++)
+            {
+                while (z[k + 1] < q)
+                    k++;
+                float dq = static_cast<float>(q - v[k]);
+                d[q] = dq * dq + f[v[k]];
+            }
+            std::copy(d.begin(), d.end(), f);
+        }
+
+        /**
+        * Exact squared distances in cells over a window of the source grid
+        */
+        inline void gridDistanceSquared(const uint8_t* src, int stride, int width, int height, const GridDistanceFieldOptions& options, std::vector<float>& out)
+        {
+            out.resize(static_cast<size_t>(width) * height);
+            if (width == 0 || height == 0)
+                return;
+            float* buffer = &out[0];
+
+            const int strips = (width + kGridDistanceStrip - 1) / kGridDistanceStrip;
+            const int rowBlocks = (height + kGridDistanceStrip - 1) / kGridDistanceStrip;
+            const int concurrency = options.concurrency;
+
+            if (concurrency == 1 || strips == 1)
+            {
+                gridDistanceColumns(src, stride, width, height, options, buffer, 0, width);
+            }
+            else
+            {
+                rpos::system::parallel_for(strips, [&](int strip) {
+                    int x0 = strip * kGridDistanceStrip;
+                    gridDistanceColumns(src, stride, width, height, options, buffer, x0, std::min(width, x0 + kGridDistanceStrip));
+                }, concurrency);
+            }
+
+            auto rows = [&](int block) {
+                std::vector<float> d;
+                std::vector<int> v;
+                std::vector<double> z;
+                int y1 = std::min(height, (block + 1) * kGridDistanceStrip);
+                for (int y = block * kGridDistanceStrip; y < y1; y++)
+                    gridDistanceRow(buffer + static_cast<size_t>(y) * width, width, d, v, z);
+            };
+            if (concurrency == 1 || rowBlocks == 1)
+            {
+                for (int block = 0; block < rowBlocks; block++)
+                    rows(block);
+            }
+            else
+            {
+                rpos::system::parallel_for(rowBlocks, rows, concurrency);
+            }
+        }
+
+    }
+
+    /**
+    * Distance in meters from every cell to the nearest obstacle cell
+    *
+    * compute() runs the exact Felzenszwalb-Huttenlocher transform in O(width * height): a column
+    * pass swept over contiguous memory, then the lower envelope pass per row, both split into
+    * blocks across worker threads. With a finite options.maxDistance, update() recomputes only the
+    * cells within maxDistance of a changed region.
+    *
+    * Usage:
+    *   GridDistanceFieldOptions options;
+    *   options.maxDistance = 2.0f;
+    *   GridDistanceField field(options);
+    *   field.compute(layer);
+    *   if (field.distanceAt(goal.x(), goal.y()) < 0.4f) ...
+    *   layer.mapData()[...] = ...;
+    *   field.update(layer, x, y, w, h);
+    *   field.inflate(0.3f, layer.mapData(), inflated);
+    */
+    class GridDistanceField {
+    public:
+        explicit GridDistanceField(const GridDistanceFieldOptions& options = GridDistanceFieldOptions())
+            : options_(options)
+            , width_(0)
+            , height_(0)
+            , resolution_(0.0f)
+            , originX_(0.0f)
+            , originY_(0.0f)
+        {}
+
+    public:
+        void compute(const features::location_provider::BitmapMap& map)
+        {
+            const std::vector<system::types::_u8>& data = map.getMapData();
+            const core::Vector2i& dimension = map.getMapDimension();
+            checkSize_(data.size(), dimension.x(), dimension.y());
+            setGeometry_(dimension.x(), dimension.y(), map.getMapResolution().x(), map.getMapPosition().x(), map.getMapPosition().y());
+            compute(data.empty() ? NULL : &data[0], width_, height_, resolution_);
+        }
+
+        void compute(const GridMapLayer& layer)
+        {
+            const std::vector<uint8_t>& data = layer.mapData();
+            const core::Vector2i& dimension = layer.getDimension();
+            checkSize_(data.size(), dimension.x(), dimension.y());
+            setGeometry_(dimension.x(), dimension.y(), layer.getResolution().x(), static_cast<float>(layer.getOrigin().x()), static_cast<float>(layer.getOrigin().y()));
+            compute(data.empty() ? NULL : &data[0], width_, height_, resolution_);
+        }
+
+        /**
+        * Row major cells, row 0 first, width cells per row
+        */
+        void compute(const uint8_t* data, int width, int height, float resolution)
+        {
+            if (width < 0 || height < 0 || resolution <= 0.0f || (!data && width * height > 0))
+                throw std::runtime_error("Invalid grid geometry for distance transform");
+            width_ = width;
+            height_ = height;
+            resolution_ = resolution;
+
+            detail::gridDistanceSquared(data, width, width, height, options_, distances_);
+            if (!distances_.empty())
+                finish_(&distances_[0], width, 0, 0, width, height, &distances_[0], width);
+        }
+
+        void update(const features::location_provider::BitmapMap& map, int x, int y, int w, int h)
+        {
+            const std::vector<system::types::_u8>& data = map.getMapData();
+            checkSize_(data.size(), width_, height_);
+            update(data.empty() ? NULL : &data[0], x, y, w, h);
+        }
+
+        void update(const GridMapLayer& layer, int x, int y, int w, int h)
+        {
+            const std::vector<uint8_t>& data = layer.mapData();
+            checkSize_(data.size(), width_, height_);
+            update(data.empty() ? NULL : &data[0], x, y, w, h);
+        }
+
+        /**
+        * Refresh after cells [x, x + w) x [y, y + h) of the same sized grid changed
+        *
+        * Only cells within maxDistance of the region can change, and those only depend on obstacles
+        * within another maxDistance, so the transform runs on that window alone. Without a finite
+        * maxDistance the whole grid is recomputed.
+        */
+        void update(const uint8_t* data, int x, int y, int w, int h)
+        {
+            if (!std::isfinite(options_.maxDistance))
+            {
+                compute(data, width_, height_, resolution_);
+                return;
+            }
+
+            const int margin = static_cast<int>(std::ceil(options_.maxDistance / resolution_)) + 1;
+            int ox0 = std::max(0, x - margin);
+            int oy0 = std::max(0, y - margin);
+            int ox1 = std::min(width_, x + w + margin);
+            int oy1 = std::min(height_, y + h + margin);
+            if (ox0 >= ox1 || oy0 >= oy1)
+                return;
+
+            int ix0 = std::max(0, ox0 - margin);
+            int iy0 = std::max(0, oy0 - margin);
+            int ix1 = std::min(width_, ox1 + margin);
+            int iy1 = std::min(height_, oy1 + margin);
+            int iw = ix1 - ix0;
+            int ih = iy1 - iy0;
+
+            detail::gridDistanceSquared(data + static_cast<size_t>(iy0) * width_ + ix0, width_, iw, ih, options_, scratch_);
+            finish_(&scratch_[0] + static_cast<size_t>(oy0 - iy0) * iw + (ox0 - ix0), iw, ox0, oy0, ox1 - ox0, oy1 - oy0, &distances_[0], width_);
+        }
+
+    public:
+        int width() const
+        {
+            return width_;
+        }
+
+        int height() const
+        {
+            return height_;
+        }
+
+        float resolution() const
+        {
+            return resolution_;
+        }
+
+        const GridDistanceFieldOptions& options() const
+        {
+            return options_;
+        }
+
+        /**
+        * Distances in meters, row major
+        */
+        const std::vector<float>& distances() const
+        {
+            return distances_;
+        }
+
+        float distance(int x, int y) const
+        {
+            return distances_[static_cast<size_t>(y) * width_ + x];
+        }
+
+        /**
+        * Distance at a world position, 0 outside the grid
+        */
+        float distanceAt(float x, float y) const
+        {
+            int cx = static_cast<int>(std::floor((x - originX_) / resolution_));
+            int cy = static_cast<int>(std::floor((y - originY_) / resolution_));
+            if (cx < 0 || cy < 0 || cx >= width_ || cy >= height_)
+                return 0.0f;
+            return distance(cx, cy);
+        }
+
+        /**
+        * Copy src into dst, setting every cell within radius meters of an obstacle to occupiedValue
+        */
+        void inflate(float radius, const uint8_t* src, uint8_t* dst, uint8_t occupiedValue = 255) const
+        {
+            const size_t count = distances_.size();
+            const float* distances = count ? &distances_[0] : NULL;
+            for (size_t i = 0; i < count; i++)
+                dst[i] = distances[i] <= radius ? occupiedValue : src[i];
+        }
+
+        void inflate(float radius, const std::vector<uint8_t>& src, std::vector<uint8_t>& dst, uint8_t occupiedValue = 255) const
+        {
+            if (src.size() != distances_.size())
+                throw std::runtime_error("Grid size does not match the distance field");
+            dst.resize(src.size());
+            if (!src.empty())
+                inflate(radius, &src[0], &dst[0], occupiedValue);
+        }
+
+        /**
+        * Inflate a grid map layer in place
+        */
+        void inflate(float radius, GridMapLayer& layer, uint8_t occupiedValue = 255) const
+        {
+            std::vector<uint8_t>& data = layer.mapData();
+            if (data.size() != distances_.size())
+                throw std::runtime_error("Grid size does not match the distance field");
+            if (!data.empty())
+                inflate(radius, &data[0], &data[0], occupiedValue);
+        }
+
+    private:
+        static void checkSize_(size_t size, int width, int height)
+        {
+            if (width < 0 || height < 0 || size != static_cast<size_t>(width) * height)
+                throw std::runtime_error("Grid data does not match its dimension");
+        }
+
+        void setGeometry_(int width, int height, float resolution, float originX, float originY)
+        {
+            width_ = width;
+            height_ = height;
+            resolution_ = resolution;
+            originX_ = originX;
+            originY_ = originY;
+        }
+
+        /**
+        * Convert squared cell distances to clamped meters, src and dst may alias
+        */
+        void finish_(const float* src, int srcStride, int x0, int y0, int w, int h, float* dst, int dstStride) const
+        {
+            const float resolution = resolution_;
+            const float maxDistance = options_.maxDistance;
+            for (int y = 0; y < h; y++)
+            {
+                const float* in = src + static_cast<size_t>(y) * srcStride;
+                float* out = dst + static_cast<size_t>(y0 + y) * dstStride + x0;
+                for (int x = 0; x < w; x++)
+                    out[x] = std::min(std::sqrt(in[x]) * resolution, maxDistance);
+            }
+        }
+
+    private:
+        GridDistanceFieldOptions options_;
+        int width_;
+        int height_;
+        float resolution_;
+        float originX_;
+        float originY_;
+        std::vector<float> distances_;
+        std::vector<float> scratch_;
+    };
+
+} } }
@@ -0,0 +1,439 @@
+/*
+* grid_map_pyramid.h
+* Multi-resolution pyramid over grid map layers, stored as extra composite map layers
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <rpos/robot_platforms/objects/composite_map.h>
+#include <rpos/robot_platforms/objects/composite_map_defs.h>
+#include <rpos/robot_platforms/objects/grid_map_layer.h>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define RPOS_COMPOSITEMAP_USAGE_MAP_PYRAMID                     "map_pyramid"
+#define RPOS_COMPOSITEMAP_METADATA_KEY_PYRAMID_LEVEL            "pyramid_level"
+#define RPOS_COMPOSITEMAP_METADATA_KEY_PYRAMID_SOURCE           "pyramid_source"
+
+namespace rpos { namespace robot_platforms { namespace objects {
+
+    struct GridMapPyramidOptions {
+        GridMapPyramidOptions()
+            : maxLevels(8)
+            , minDimension(32)
+            , tileSize(64)
+            , occupiedThreshold(128)
+        {}
+
+        /**
+        * Number of reduced levels at most, the base layer is not counted
+        */
+        int maxLevels;
+
+        /**
+        * No level is added once the previous one is this small on both axes
+        */
+        int minDimension;
+
+        /**
+        * Dirty tracking granularity in base cells
+        */
+        int tileSize;
+
+        /**
+        * Cells with a value at or above the threshold are occupied, 0 is unknown, the rest is free
+        */
+        uint8_t occupiedThreshold;
+    };
+
+    namespace detail {
+
+        /**
+        * Reduce cells [x0, x1) x [y0, y1) of dst from the 2x2 blocks of src underneath
+        *
+        * Any occupied child makes the parent occupied with the highest value, otherwise any free child
+        * makes it free with the lowest value, so obstacles never vanish and thin free corridors stay
+        * visible where the whole block was seen. Only all-unknown blocks stay unknown.
+        */
+        inline void gridPyramidReduce(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst, int dstWidth, int x0, int y0, int x1, int y1, uint8_t occupiedThreshold)
+        {
+            for (int y = y0; y < y1; y++)
+            {
+                const int sy0 = 2 * y;
+                const int sy1 = std::min(sy0 + 1, srcHeight - 1);
+                const uint8_t* row0 = src + static_cast<size_t>(sy0) * srcWidth;
+                const uint8_t* row1 = src + static_cast<size_t>(sy1) * srcWidth;
+                uint8_t* out = dst + static_cast<size_t>(y) * dstWidth;
+
+                for (int x = x0; x < x1; x++)
+                {
+                    const int sx0 = 2 * x;
+                    const int sx1 = std::min(sx0 + 1, srcWidth - 1);
+                    const uint8_t c[4] = { row0[sx0], row0[sx1], row1[sx0], row1[sx1] };
+
+                    uint8_t occupied = 0;
+                    uint8_t freeValue = 0xff;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (c[i] >= occupiedThreshold)
+                            occupied = std::max(occupied, c[i]);
+                        else if (c[i] != 0)
+                            freeValue = std::min(freeValue, c[i]);
+                    }
+                    out[x] = occupied ? occupied : (freeValue != 0xff ? freeValue : 0);
+                }
+            }
+        }
+
+    }
+
+    /**
+    * Mipmap style pyramid of a grid map layer, level k has 2^k times the cell size of the base
+    *
+    * The levels are ordinary GridMapLayers with usage RPOS_COMPOSITEMAP_USAGE_MAP_PYRAMID, named
+    * after the base layer and tagged with their level, so attachTo() can store them in the same
+    * CompositeMap and readers that do not know about them simply skip an unknown usage.
+    *
+    * After cells of the base change, markDirty() records the affected tiles and update() reduces
+    * only those tiles level by level; the levels are shared with the CompositeMap they were attached
+    * to, so it sees the new data without attaching again. Like the other map objects it is not
+    * synchronized.
+    *
+    * Usage:
+    *   GridMapPyramid pyramid;
+    *   pyramid.build(*exploreLayer);
+    *   pyramid.attachTo(compositeMap);
+    *   ...
+    *   pyramid.markDirty(x, y, w, h);
+    *   pyramid.update(*exploreLayer);
+    *   boost::shared_ptr<GridMapLayer> overview = pyramid.levelFor(0.4f);
+    */
+    class GridMapPyramid {
+    public:
+        explicit GridMapPyramid(const GridMapPyramidOptions& options = GridMapPyramidOptions())
+            : options_(options)
+            , baseWidth_(0)
+            , baseHeight_(0)
+            , tilesX_(0)
+            , tilesY_(0)
+        {}
+
+    public:
+        /**
+        * Rebuild every level from scratch
+        */
+        void build(const GridMapLayer& base)
+        {
+            const core::Vector2i& dimension = base.getDimension();
+            checkBase_(base);
+
+            sourceName_ = base.getName();
+            baseWidth_ = dimension.x();
+            baseHeight_ = dimension.y();
+            levels_.clear();
+
+            const GridMapLayer* previous = &base;
+            int width = baseWidth_;
+            int height = baseHeight_;
+            for (int level = 1; level <= options_.maxLevels; level++)
+            {
+                if (width <= options_.minDimension && height <= options_.minDimension)
+                    break;
+                width = (width + 1) / 2;
+                height = (height + 1) / 2;
+
+                boost::shared_ptr<GridMapLayer> layer = makeLevel_(base, level, width, height);
+                reduce_(*previous, *layer, 0, 0, width, height);
+                levels_.push_back(layer);
+                previous = layer.get();
+            }
+
+            resetTiles_();
+        }
+
+        /**
+        * Record that base cells [x, x + w) x [y, y + h) changed
+        */
+        void markDirty(int x, int y, int w, int h)
+        {
+            if (tilesX_ == 0 || tilesY_ == 0 || w <= 0 || h <= 0)
+                return;
+            int tx0 = std::max(0, x / options_.tileSize);
+            int ty0 = std::max(0, y / options_.tileSize);
+            int tx1 = std::min(tilesX_ - 1, (x + w - 1) / options_.tileSize);
+            int ty1 = std::min(tilesY_ - 1, (y + h - 1) / options_.tileSize);
+            for (int ty = ty0; ty <= ty1; ty++)
+                for (int tx = tx0; tx <= tx1; tx++)
+                    dirty_[static_cast<size_t>(ty) * tilesX_ + tx] = 1;
+        }
+
+        void markAllDirty()
+        {
+            std::fill(dirty_.begin(), dirty_.end(), 1);
+        }
+
+        bool dirty() const
+        {
+            return std::find(dirty_.begin(), dirty_.end(), 1) != dirty_.end();
+        }
+
+        /**
+        * Reduce the dirty tiles into every level, returns the number of level cells written
+        *
+        * A base of a different size (or a different layer) is rebuilt completely.
+        */
+        size_t update(const GridMapLayer& base)
+        {
+            const core::Vector2i& dimension = base.getDimension();
+            if (dimension.x() != baseWidth_ || dimension.y() != baseHeight_ || base.getName() != sourceName_)
+            {
+                build(base);
+                size_t cells = 0;
+                for (size_t i = 0; i < levels_.size(); i++)
+                    cells += levels_[i]->mapData().size();
+                return cells;
+            }
+            checkBase_(base);
+
+            size_t cells = 0;
+            for (int ty = 0; ty < tilesY_; ty++)
+            {
+                for (int tx = 0; tx < tilesX_; tx++)
+                {
+                    uint8_t& flag = dirty_[static_cast<size_t>(ty) * tilesX_ + tx];
+                    if (!flag)
+                        continue;
+                    flag = 0;
+
+                    int x0 = tx * options_.tileSize;
+                    int y0 = ty * options_.tileSize;
+                    int x1 = std::min(baseWidth_, x0 + options_.tileSize);
+                    int y1 = std::min(baseHeight_, y0 + options_.tileSize);
+
+                    const GridMapLayer* previous = &base;
+                    for (size_t level = 0; level < levels_.size(); level++)
+                    {
+                        GridMapLayer& layer = *levels_[level];
+                        x0 /= 2;
+                        y0 /= 2;
+                        x1 = std::min(layer.getDimension().x(), (x1 + 1) / 2);
+                        y1 = std::min(layer.getDimension().y(), (y1 + 1) / 2);
+                        reduce_(*previous, layer, x0, y0, x1, y1);
+                        cells += static_cast<size_t>(x1 - x0) * (y1 - y0);
+                        previous = &layer;
+                    }
+                }
+            }
+            return cells;
+        }
+
+    public:
+        const GridMapPyramidOptions& options() const
+        {
+            return options_;
+        }
+
+        const std::string& sourceName() const
+        {
+            return sourceName_;
+        }
+
+        size_t levelCount() const
+        {
+            return levels_.size();
+        }
+
+        /**
+        * Level 1 is half the base resolution, level levelCount() the coarsest
+        */
+        boost::shared_ptr<GridMapLayer> level(size_t level) const
+        {
+            if (level == 0 || level > levels_.size())
+                return boost::shared_ptr<GridMapLayer>();
+            return levels_[level - 1];
+        }
+
+        /**
+        * Coarsest level whose cells are not larger than metersPerCell, empty if the base itself is
+        * needed
+        */
+        boost::shared_ptr<GridMapLayer> levelFor(float metersPerCell) const
+        {
+            boost::shared_ptr<GridMapLayer> result;
+            for (size_t i = 0; i < levels_.size(); i++)
+            {
+                if (levels_[i]->getResolution().x() > metersPerCell)
+                    break;
+                result = levels_[i];
+            }
+            return result;
+        }
+
+        /**
+        * Replace the pyramid layers of the same source in a composite map with this one
+        */
+        void attachTo(CompositeMap& map) const
+        {
+            detachFrom(map, sourceName_);
+            std::vector< boost::shared_ptr<MapLayer> >& layers = map.maps();
+            layers.insert(layers.end(), levels_.begin(), levels_.end());
+        }
+
+        /**
+        * Remove the pyramid layers built from a source from a composite map
+        */
+        static void detachFrom(CompositeMap& map, const std::string& sourceName)
+        {
+            std::vector< boost::shared_ptr<MapLayer> >& layers = map.maps();
+            layers.erase(std::remove_if(layers.begin(), layers.end(), [&sourceName](const boost::shared_ptr<MapLayer>& layer) {
+                return isLevelOf_(layer, sourceName);
+            }), layers.end());
+        }
+
+        /**
+        * Adopt the levels stored in a composite map for this base instead of building them, returns
+        * false (and leaves the pyramid empty) when they are missing or do not match the base
+        */
+        bool load(const CompositeMap& map, const GridMapLayer& base)
+        {
+            checkBase_(base);
+
+            std::vector< boost::shared_ptr<GridMapLayer> > found;
+            const std::vector< boost::shared_ptr<MapLayer> >& layers = map.maps();
+            for (size_t i = 0; i < layers.size(); i++)
+            {
+                if (!isLevelOf_(layers[i], base.getName()))
+                    continue;
+                boost::shared_ptr<GridMapLayer> layer = boost::dynamic_pointer_cast<GridMapLayer>(layers[i]);
+                if (layer)
+                    found.push_back(layer);
+            }
+            std::sort(found.begin(), found.end(), [](const boost::shared_ptr<GridMapLayer>& a, const boost::shared_ptr<GridMapLayer>& b) {
+                return levelOf_(*a) < levelOf_(*b);
+            });
+
+            int width = base.getDimension().x();
+            int height = base.getDimension().y();
+            for (size_t i = 0; i < found.size(); i++)
+            {
+                width = (width + 1) / 2;
+                height = (height + 1) / 2;
+                const GridMapLayer& layer = *found[i];
+                if (levelOf_(layer) != static_cast<int>(i) + 1
+                    || layer.getDimension().x() != width || layer.getDimension().y() != height
+                    || layer.mapData().size() != static_cast<size_t>(width) * height)
+                {
+                    clear();
+                    return false;
+                }
+            }
+            if (found.empty())
+            {
+                clear();
+                return false;
+            }
+
+            sourceName_ = base.getName();
+            baseWidth_ = base.getDimension().x();
+            baseHeight_ = base.getDimension().y();
+            levels_.swap(found);
+            resetTiles_();
+            return true;
+        }
+
+        void clear()
+        {
+            sourceName_.clear();
+            baseWidth_ = 0;
+            baseHeight_ = 0;
+            levels_.clear();
+            resetTiles_();
+        }
+
+    private:
+        static int levelOf_(const MapLayer& layer)
+        {
+            std::string value;
+            if (!layer.metadata().tryGet(RPOS_COMPOSITEMAP_METADATA_KEY_PYRAMID_LEVEL, value))
+                return 0;
+            try
+            {
+                return boost::lexical_cast<int>(value);
+            }
+            catch (const boost::bad_lexical_cast&)
+            {
+                return 0;
+            }
+        }
+
+        static bool isLevelOf_(const boost::shared_ptr<MapLayer>& layer, const std::string& sourceName)
+        {
+            if (!layer || layer->getUsage() != RPOS_COMPOSITEMAP_USAGE_MAP_PYRAMID)
+                return false;
+            std::string source;
+            return layer->metadata().tryGet(RPOS_COMPOSITEMAP_METADATA_KEY_PYRAMID_SOURCE, source) && source == sourceName;
+        }
+
+        static void checkBase_(const GridMapLayer& base)
+        {
+            const core::Vector2i& dimension = base.getDimension();
+            if (dimension.x() < 0 || dimension.y() < 0 || base.mapData().size() != static_cast<size_t>(dimension.x()) * dimension.y())
+                RPOS_COMPOSITEMAP_THROW_EXCEPTION("grid map layer data does not match its dimension");
+        }
+
+        boost::shared_ptr<GridMapLayer> makeLevel_(const GridMapLayer& base, int level, int width, int height) const
+        {
+            boost::shared_ptr<GridMapLayer> layer = boost::make_shared<GridMapLayer>();
+            const std::string suffix = boost::lexical_cast<std::string>(level);
+            layer->setName(base.getName() + "_lod" + suffix);
+            layer->setUsage(RPOS_COMPOSITEMAP_USAGE_MAP_PYRAMID);
+            layer->setType(GridMapLayer::Type);
+            layer->metadata().set(RPOS_COMPOSITEMAP_METADATA_KEY_PYRAMID_LEVEL, suffix);
+            layer->metadata().set(RPOS_COMPOSITEMAP_METADATA_KEY_PYRAMID_SOURCE, base.getName());
+            layer->setOrigin(base.getOrigin());
+            layer->setDimension(core::Vector2i(width, height));
+            const float scale = static_cast<float>(1 << level);
+            layer->setResolution(core::Vector2f(base.getResolution().x() * scale, base.getResolution().y() * scale));
+            layer->mapData().assign(static_cast<size_t>(width) * height, 0);
+            return layer;
+        }
+
+        void reduce_(const GridMapLayer& src, GridMapLayer& dst, int x0, int y0, int x1, int y1) const
+        {
+            if (x0 >= x1 || y0 >= y1)
+                return;
+            detail::gridPyramidReduce(&src.mapData()[0], src.getDimension().x(), src.getDimension().y(),
+                &dst.mapData()[0], dst.getDimension().x(), x0, y0, x1, y1, options_.occupiedThreshold);
+        }
+
+        void resetTiles_()
+        {
+            const int tile = std::max(1, options_.tileSize);
+            options_.tileSize = tile;
+            tilesX_ = (baseWidth_ + tile - 1) / tile;
+            tilesY_ = (baseHeight_ + tile - 1) / tile;
+            dirty_.assign(static_cast<size_t>(tilesX_) * tilesY_, 0);
+        }
+
+    private:
+        GridMapPyramidOptions options_;
+        std::string sourceName_;
+        int baseWidth_;
+        int baseHeight_;
+        int tilesX_;
+        int tilesY_;
+        std::vector<uint8_t> dirty_;
+        std::vector< boost::shared_ptr<GridMapLayer> > levels_;
+    };
+
+} } }
@@ -0,0 +1,432 @@
+/*
+* slamware_rpc_stats.h
+* Per method client side statistics of Slamware RPCs
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+/*
+* Usage
+*
+* rpos::robot_platforms::RpcInstrumentation& stats = rpos::robot_platforms::RpcInstrumentation::defaultInstrumentation();
+* auto map = RPOS_INSTRUMENTED_CALL(stats, platform, getMap, type, area, kind);
+*
+* // a transport that knows more fills a call scope itself
+* rpos::robot_platforms::RpcCallScope call(stats.method("getMap"));
+* call.setRequestBytes(request.size());
+* call.markSerialized();
+* ...
+* call.markReceived(response.size(), serverTimeNs);
+*/
+
+#pragma once
+
+#include <rpos/system/util/latency_stat.h>
+#include <rpos/system/util/log.h>
+#include <rpos/system/util/metrics.h>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#define RPOS_INSTRUMENTED_CALL(Instrumentation, Platform, Method, ...) \
+    (Instrumentation).call(#Method, [&]() { return (Platform).Method(__VA_ARGS__); })
+
+namespace rpos { namespace robot_platforms {
+
+    /**
+    * Aggregated statistics of one method, latencies in nanoseconds
+    */
+    struct RpcMethodSummary {
+        RpcMethodSummary()
+            : calls(0)
+            , failures(0)
+            , requestBytes(0)
+            , responseBytes(0)
+        {}
+
+        std::string method;
+        std::uint64_t calls;
+        std::uint64_t failures;
+        std::uint64_t requestBytes;
+        std::uint64_t responseBytes;
+        // client observed duration of the whole call
+        rpos::system::util::LatencyStatSnapshot total;
+        // the phases are only filled when the transport reports them
+        rpos::system::util::LatencyStatSnapshot serialization;
+        rpos::system::util::LatencyStatSnapshot roundTrip;
+        rpos::system::util::LatencyStatSnapshot server;
+    };
+
+    /**
+    * Statistics of one RPC method, safe to update from any thread
+    */
+    class RpcMethodStats : private boost::noncopyable {
+    public:
+        /**
+        * @param window Length of one percentile window, the summaries cover between one and two windows
+        */
+        explicit RpcMethodStats(const std::string& method, boost::chrono::milliseconds window = boost::chrono::milliseconds(60000))
+            : method_(method)
+            , total_(new rpos::system::util::LatencyStat(window, kWindowCount))
+            , serialization_(new rpos::system::util::LatencyStat(window, kWindowCount))
+            , roundTrip_(new rpos::system::util::LatencyStat(window, kWindowCount))
+            , server_(new rpos::system::util::LatencyStat(window, kWindowCount))
+            , calls_(new rpos::system::util::MetricCounter())
+            , failures_(new rpos::system::util::MetricCounter())
+            , requestBytes_(new rpos::system::util::MetricCounter())
+            , responseBytes_(new rpos::system::util::MetricCounter())
+        {}
+
+    public:
+        const std::string& method() const
+        {
+            return method_;
+        }
+
+        /**
+        * Record one finished call, phases left at 0 are not recorded
+        */
+        void record(std::uint64_t totalNs, bool failed, std::uint64_t requestBytes = 0, std::uint64_t responseBytes = 0
+            , std::uint64_t serializationNs = 0, std::uint64_t roundTripNs = 0, std::uint64_t serverNs = 0)
+        {
+            total_->record(totalNs);
+            if (serializationNs)
+                serialization_->record(serializationNs);
+            if (roundTripNs)
+                roundTrip_->record(roundTripNs);
+            if (serverNs)
+                server_->record(serverNs);
+
+            calls_->inc();
+            if (failed)
+                failures_->inc();
+            if (requestBytes)
+                requestBytes_->inc(requestBytes);
+            if (responseBytes)
+                responseBytes_->inc(responseBytes);
+        }
+
+        RpcMethodSummary summary() const
+        {
+            RpcMethodSummary result;
+            result.method = method_;
+            result.calls = calls_->value();
+            result.failures = failures_->value();
+            result.requestBytes = requestBytes_->value();
+            result.responseBytes = responseBytes_->value();
+            result.total = total_->snapshot();
+            result.serialization = serialization_->snapshot();
+            result.roundTrip = roundTrip_->snapshot();
+            result.server = server_->snapshot();
+            return result;
+        }
+
+        /**
+        * Export as rpos_rpc_* families labelled with method (and phase for the durations)
+        */
+        void exportTo(rpos::system::util::MetricsRegistry& registry) const
+        {
+            using rpos::system::util::MetricLabels;
+
+            MetricLabels labels(1, std::make_pair(std::string("method"), method_));
+            registry.add("rpos_rpc_calls", "Slamware RPCs issued", calls_, labels);
+            registry.add("rpos_rpc_failures", "Slamware RPCs that threw", failures_, labels);
+            registry.add("rpos_rpc_request_bytes", "Bytes sent in Slamware RPC requests", requestBytes_, labels);
+            registry.add("rpos_rpc_response_bytes", "Bytes received in Slamware RPC responses", responseBytes_, labels);
+
+            const char* help = "Slamware RPC duration by phase";
+            registry.addLatency("rpos_rpc_duration_seconds", help, total_, withPhase_(labels, "total"));
+            registry.addLatency("rpos_rpc_duration_seconds", help, serialization_, withPhase_(labels, "serialization"));
+            registry.addLatency("rpos_rpc_duration_seconds", help, roundTrip_, withPhase_(labels, "round_trip"));
+            registry.addLatency("rpos_rpc_duration_seconds", help, server_, withPhase_(labels, "server"));
+        }
+
+    private:
+        // one slot of a LatencyStat holds the upcoming window, so three windows keep the last complete
+        // window plus the current one at ~30KB per histogram
+        static const size_t kWindowCount = 3;
+
+        static rpos::system::util::MetricLabels withPhase_(rpos::system::util::MetricLabels labels, const char* phase)
+        {
+            labels.push_back(std::make_pair(std::string("phase"), std::string(phase)));
+            return labels;
+        }
+
+    private:
+        const std::string method_;
+        boost::shared_ptr<rpos::system::util::LatencyStat> total_;
+        boost::shared_ptr<rpos::system::util::LatencyStat> serialization_;
+        boost::shared_ptr<rpos::system::util::LatencyStat> roundTrip_;
+        boost::shared_ptr<rpos::system::util::LatencyStat> server_;
+        boost::shared_ptr<rpos::system::util::MetricCounter> calls_;
+        boost::shared_ptr<rpos::system::util::MetricCounter> failures_;
+        boost::shared_ptr<rpos::system::util::MetricCounter> requestBytes_;
+        boost::shared_ptr<rpos::system::util::MetricCounter> responseBytes_;
+    };
+
+    /**
+    * Measures one call and records it into RpcMethodStats on destruction
+    *
+    * Without any of the mark calls only the total duration is recorded, which is what a caller
+    * wrapping the public SlamwareCorePlatform API can observe.
+    */
+    class RpcCallScope : private boost::noncopyable {
+    public:
+        explicit RpcCallScope(RpcMethodStats& stats)
+            : stats_(stats)
+            , start_(now_())
+            , serialized_(0)
+            , requestBytes_(0)
+            , responseBytes_(0)
+            , roundTripNs_(0)
+            , serverNs_(0)
+            , failed_(false)
+        {}
+
+        ~RpcCallScope()
+        {
+            std::uint64_t total = now_() - start_;
+            stats_.record(total, failed_, requestBytes_, responseBytes_, serialized_ ? serialized_ - start_ : 0, roundTripNs_, serverNs_);
+        }
+
+    public:
+        void setRequestBytes(std::uint64_t bytes)
+        {
+            requestBytes_ = bytes;
+        }
+
+        /**
+        * The request is encoded, the round trip starts here
+        */
+        void markSerialized()
+        {
+            serialized_ = now_();
+        }
+
+        /**
+        * The response arrived
+        *
+        * @param responseBytes Size of the response on the wire
+        * @param serverNs      Processing time reported by the server, 0 if unknown
+        */
+        void markReceived(std::uint64_t responseBytes, std::uint64_t serverNs = 0)
+        {
+            std::uint64_t sent = serialized_ ? serialized_ : start_;
+            roundTripNs_ = now_() - sent;
+            responseBytes_ = responseBytes;
+            serverNs_ = serverNs;
+        }
+
+        void fail()
+        {
+            failed_ = true;
+        }
+
+    private:
+        static std::uint64_t now_()
+        {
+            return static_cast<std::uint64_t>(boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                boost::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+    private:
+        RpcMethodStats& stats_;
+        std::uint64_t start_;
+        std::uint64_t serialized_;
+        std::uint64_t requestBytes_;
+        std::uint64_t responseBytes_;
+        std::uint64_t roundTripNs_;
+        std::uint64_t serverNs_;
+        bool failed_;
+    };
+
+    /**
+    * Per method statistics of all RPCs issued through one or more platforms
+    */
+    class RpcInstrumentation : private boost::noncopyable {
+    public:
+        struct Options {
+            Options()
+                : summaryIntervalMs(60000)
+                , logSource("rpos.robot_platforms.rpc_stats")
+                , registry(&rpos::system::util::MetricsRegistry::defaultRegistry())
+            {}
+
+            // period of the info level summary log, 0 disables it
+            int summaryIntervalMs;
+            std::string logSource;
+            // methods are exported here on first use, nullptr to keep them private
+            rpos::system::util::MetricsRegistry* registry;
+        };
+
+    public:
+        explicit RpcInstrumentation(const Options& options = Options())
+            : options_(options)
+        {
+            if (options_.summaryIntervalMs > 0)
+                summaryThread_ = boost::thread(&RpcInstrumentation::summaryWorker_, this);
+        }
+
+        ~RpcInstrumentation()
+        {
+            if (summaryThread_.joinable())
+            {
+                summaryThread_.interrupt();
+                summaryThread_.join();
+            }
+        }
+
+    public:
+        /**
+        * Get or create the statistics of a method, the reference stays valid for the lifetime of this object
+        */
+        RpcMethodStats& method(const std::string& name)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            boost::shared_ptr<RpcMethodStats>& stats = methods_[name];
+            if (!stats)
+            {
+                stats.reset(new RpcMethodStats(name, statWindow_()));
+                if (options_.registry)
+                    stats->exportTo(*options_.registry);
+            }
+            return *stats;
+        }
+
+        /**
+        * Invoke f and record its duration, exceptions are counted as failures and rethrown
+        */
+        template < class FunctionT >
+        auto call(const std::string& name, FunctionT f) -> decltype(f())
+        {
+            RpcCallScope scope(method(name));
+            try
+            {
+                return f();
+            }
+            catch (...)
+            {
+                scope.fail();
+                throw;
+            }
+        }
+
+        /**
+        * Summaries of all methods, the most expensive (calls * mean) first
+        */
+        std::vector<RpcMethodSummary> summaries() const
+        {
+            std::vector<boost::shared_ptr<RpcMethodStats> > methods;
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                for (auto iter = methods_.begin(); iter != methods_.end(); ++iter)
+                    methods.push_back(iter->second);
+            }
+
+            std::vector<RpcMethodSummary> result;
+            result.reserve(methods.size());
+            for (auto iter = methods.begin(); iter != methods.end(); ++iter)
+                result.push_back((*iter)->summary());
+            std::sort(result.begin(), result.end(), [](const RpcMethodSummary& a, const RpcMethodSummary& b) {
+                return a.total.sum() > b.total.sum();
+            });
+            return result;
+        }
+
+        /**
+        * One line per method with calls in the recent windows
+        */
+        std::vector<std::string> formatSummary() const
+        {
+            std::vector<RpcMethodSummary> methods = summaries();
+            std::vector<std::string> lines;
+            for (auto iter = methods.begin(); iter != methods.end(); ++iter)
+            {
+                if (!iter->total.count())
+                    continue;
+
+                char line[512];
+                int size = snprintf(line, sizeof(line), "%s: %llu calls (%llu failed total), p50 %.2fms p90 %.2fms p99 %.2fms max %.2fms, sent %llu B received %llu B total"
+                    , iter->method.c_str()
+                    , static_cast<unsigned long long>(iter->total.count())
+                    , static_cast<unsigned long long>(iter->failures)
+                    , iter->total.percentile(0.5) / 1e6
+                    , iter->total.percentile(0.9) / 1e6
+                    , iter->total.percentile(0.99) / 1e6
+                    , iter->total.max() / 1e6
+                    , static_cast<unsigned long long>(iter->requestBytes)
+                    , static_cast<unsigned long long>(iter->responseBytes));
+                std::string text(line, std::min<size_t>(std::max(size, 0), sizeof(line) - 1));
+                appendPhase_(text, "serialize", iter->serialization);
+                appendPhase_(text, "rtt", iter->roundTrip);
+                appendPhase_(text, "server", iter->server);
+                lines.push_back(text);
+            }
+            return lines;
+        }
+
+        void logSummary() const
+        {
+            std::vector<std::string> lines = formatSummary();
+            for (auto iter = lines.begin(); iter != lines.end(); ++iter)
+                rpos::system::util::info_out(options_.logSource.c_str(), "%s", iter->c_str());
+        }
+
+    public:
+        static RpcInstrumentation& defaultInstrumentation()
+        {
+            static RpcInstrumentation instrumentation;
+            return instrumentation;
+        }
+
+    private:
+        // a window per summary interval, so every summary sees at least the whole last interval
+        boost::chrono::milliseconds statWindow_() const
+        {
+            return boost::chrono::milliseconds(options_.summaryIntervalMs > 0 ? options_.summaryIntervalMs : 60000);
+        }
+
+        static void appendPhase_(std::string& text, const char* phase, const rpos::system::util::LatencyStatSnapshot& snapshot)
+        {
+            if (!snapshot.count())
+                return;
+            char buffer[96];
+            snprintf(buffer, sizeof(buffer), ", %s p50 %.2fms p99 %.2fms", phase, snapshot.percentile(0.5) / 1e6, snapshot.percentile(0.99) / 1e6);
+            text += buffer;
+        }
+
+        void summaryWorker_()
+        {
+            try
+            {
+                for (;;)
+                {
+                    boost::this_thread::sleep_for(boost::chrono::milliseconds(options_.summaryIntervalMs));
+                    logSummary();
+                }
+            }
+            catch (const boost::thread_interrupted&)
+            {
+            }
+        }
+
+    private:
+        const Options options_;
+        mutable boost::mutex lock_;
+        std::map<std::string, boost::shared_ptr<RpcMethodStats> > methods_;
+        boost::thread summaryThread_;
+    };
+
+} }
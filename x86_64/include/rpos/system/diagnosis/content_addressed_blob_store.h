@@ -0,0 +1,255 @@
+/*
+* content_addressed_blob_store.h
+* Content addressed blob store, blobs are keyed by their SHA-256 so identical blobs are stored once
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "i_blob_store.h"
+#include "../crypto/digest.h"
+#include "../io/file_stream.h"
+#include "../io/memory_read_stream.h"
+
+#include <boost/atomic.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace rpos { namespace system { namespace diagnosis {
+
+	/**
+	* ContentAddressedBlobStore stores every blob as <folder>/<first 2 hex digits>/<sha256 hex>[.gz]
+	*
+	* - Storing a blob that already exists is a no-op returning the same id (deduplication)
+	* - The index of stored blobs is loaded from disk once, enumerate and has never touch the disk
+	* - Concurrent stores only serialize when their ids fall into the same lock stripe
+	* - Blobs are written to a temporary file and renamed, so a crash never leaves a partial blob
+	*/
+	class ContentAddressedBlobStore : public IBlobStore {
+	public:
+		struct Options {
+			Options()
+				: compress(false)
+				, compressionLevel(6)
+			{}
+
+			// gzip new blobs, existing blobs are read back in whichever form they were stored
+			bool compress;
+			int compressionLevel;
+		};
+
+		explicit ContentAddressedBlobStore(const std::string& folder, const Options& options = Options())
+			: folder_(folder)
+			, options_(options)
+			, dedupedStores_(0)
+		{
+			boost::filesystem::create_directories(folder_);
+			loadIndex_();
+		}
+
+		virtual ~ContentAddressedBlobStore()
+		{}
+
+	public:
+		virtual void enumerate(std::list<std::string>& blobIds)
+		{
+			boost::shared_lock<boost::shared_mutex> guard(indexLock_);
+			for (auto iter = index_.begin(); iter != index_.end(); ++iter)
+				blobIds.push_back(iter->first);
+		}
+
+		virtual bool has(const std::string& blobId)
+		{
+			boost::shared_lock<boost::shared_mutex> guard(indexLock_);
+			return index_.find(blobId) != index_.end();
+		}
+
+		virtual boost::shared_ptr<io::IStream> load(const std::string& blobId)
+		{
+			bool compressed;
+			{
+				boost::shared_lock<boost::shared_mutex> guard(indexLock_);
+				auto iter = index_.find(blobId);
+				if (iter == index_.end())
+					return boost::shared_ptr<io::IStream>();
+				compressed = iter->second;
+			}
+
+			if (!compressed)
+			{
+				boost::shared_ptr<io::FileStream> file(new io::FileStream());
+				if (!file->open(blobPath_(blobId, false).string(), io::OpenFileModeRead))
+					return boost::shared_ptr<io::IStream>();
+				return file;
+			}
+
+			std::vector<std::uint8_t> raw;
+			if (!readFile_(blobPath_(blobId, true), raw))
+				return boost::shared_ptr<io::IStream>();
+
+			std::vector<std::uint8_t> blob;
+			boost::iostreams::filtering_istream in;
+			in.push(boost::iostreams::gzip_decompressor());
+			in.push(boost::iostreams::array_source(reinterpret_cast<const char*>(raw.data()), raw.size()));
+			char buffer[16 * 1024];
+			while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+				blob.insert(blob.end(), reinterpret_cast<const std::uint8_t*>(buffer), reinterpret_cast<const std::uint8_t*>(buffer) + in.gcount());
+			if (in.bad())
+				return boost::shared_ptr<io::IStream>();
+			return boost::shared_ptr<io::IStream>(new io::MemoryReadStream(std::move(blob)));
+		}
+
+		virtual std::string store(const io::MemoryWriteStream& blob)
+		{
+			std::string blobId = crypto::digestToHex(crypto::DigestAlgorithmSHA256, blob.buffer(), blob.size());
+			if (has(blobId))
+			{
+				dedupedStores_.fetch_add(1, boost::memory_order_relaxed);
+				return blobId;
+			}
+
+			boost::lock_guard<boost::mutex> stripeGuard(stripeFor_(blobId));
+			if (has(blobId))
+			{
+				dedupedStores_.fetch_add(1, boost::memory_order_relaxed);
+				return blobId;
+			}
+
+			bool compressed = options_.compress;
+			boost::filesystem::path target = blobPath_(blobId, compressed);
+			boost::filesystem::create_directories(target.parent_path());
+
+			std::vector<char> compressedBuffer;
+			const void* data = blob.buffer();
+			size_t size = blob.size();
+			if (compressed)
+			{
+				boost::iostreams::filtering_ostream out;
+				out.push(boost::iostreams::gzip_compressor(boost::iostreams::gzip_params(options_.compressionLevel)));
+				out.push(boost::iostreams::back_inserter(compressedBuffer));
+				out.write(reinterpret_cast<const char*>(blob.buffer()), blob.size());
+				boost::iostreams::close(out);
+				data = compressedBuffer.data();
+				size = compressedBuffer.size();
+			}
+
+			boost::filesystem::path temp = target;
+			temp += ".tmp";
+			{
+				io::FileStream file;
+				if (!file.open(temp.string(), io::OpenFileModeWrite))
+					throw std::runtime_error("Failed to create blob file " + temp.string());
+				file.exactWrite(data, size);
+				file.close();
+			}
+			boost::filesystem::rename(temp, target);
+
+			boost::unique_lock<boost::shared_mutex> guard(indexLock_);
+			index_[blobId] = compressed;
+			return blobId;
+		}
+
+	public:
+		size_t blobCount() const
+		{
+			boost::shared_lock<boost::shared_mutex> guard(indexLock_);
+			return index_.size();
+		}
+
+		/**
+		* Number of store calls answered by an existing blob
+		*/
+		size_t dedupedStores() const
+		{
+			return dedupedStores_.load(boost::memory_order_relaxed);
+		}
+
+	private:
+		static const size_t kLockStripes = 64;
+
+		boost::mutex& stripeFor_(const std::string& blobId)
+		{
+			// blob ids are uniformly distributed hex, the leading digits are a good stripe key
+			size_t v = static_cast<size_t>(strtoul(blobId.substr(0, 4).c_str(), nullptr, 16));
+			return stripes_[v % kLockStripes];
+		}
+
+		boost::filesystem::path blobPath_(const std::string& blobId, bool compressed) const
+		{
+			boost::filesystem::path path = boost::filesystem::path(folder_) / blobId.substr(0, 2) / blobId;
+			if (compressed)
+				path += ".gz";
+			return path;
+		}
+
+		static bool isBlobId_(const std::string& name)
+		{
+			if (name.size() != 64)
+				return false;
+			for (auto iter = name.begin(); iter != name.end(); ++iter)
+			{
+				if (!isxdigit(static_cast<unsigned char>(*iter)))
+					return false;
+			}
+			return true;
+		}
+
+		void loadIndex_()
+		{
+			boost::unique_lock<boost::shared_mutex> guard(indexLock_);
+			boost::filesystem::directory_iterator end;
+			for (boost::filesystem::directory_iterator shard(folder_); shard != end; ++shard)
+			{
+				if (!boost::filesystem::is_directory(shard->status()) || shard->path().filename().string().size() != 2)
+					continue;
+
+				for (boost::filesystem::directory_iterator blob(shard->path()); blob != end; ++blob)
+				{
+					std::string name = blob->path().filename().string();
+					bool compressed = (blob->path().extension() == ".gz");
+					if (compressed)
+						name = blob->path().stem().string();
+					if (!isBlobId_(name))
+						continue;
+					index_[name] = compressed;
+				}
+			}
+		}
+
+		static bool readFile_(const boost::filesystem::path& path, std::vector<std::uint8_t>& data)
+		{
+			io::FileStream file;
+			if (!file.open(path.string(), io::OpenFileModeRead))
+				return false;
+			data.resize(static_cast<size_t>(file.size()));
+			if (!data.empty())
+				file.exactRead(data.data(), data.size());
+			return true;
+		}
+
+	private:
+		std::string folder_;
+		Options options_;
+		boost::atomic<size_t> dedupedStores_;
+
+		// blob id => stored compressed
+		std::unordered_map<std::string, bool> index_;
+		mutable boost::shared_mutex indexLock_;
+		boost::mutex stripes_[kLockStripes];
+	};
+
+} } }
@@ -81,8 +81,17 @@ namespace rpos { namespace system { namespace io {
             void writeTo(IStream& target) const;
             void writeToFile(const std::string& filename) const;
 
+        public:
+            typedef std::list<boost::shared_ptr<MemoryWriteStream>> buffer_list_t;
+
+            /**
+            * The chunks backing this snapshot, in order (only the first size() bytes are valid)
+            * Used by SnapshotExporter for gather writes without copying
+            */
+            const buffer_list_t& buffers() const { return buffers_; }
+
         private:
-            std::list<boost::shared_ptr<MemoryWriteStream>> buffers_;
+            buffer_list_t buffers_;
             size_t size_;
         };
 
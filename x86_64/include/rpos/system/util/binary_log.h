@@ -0,0 +1,1072 @@
+/*
+* binary_log.h
+* Binary log with deferred formatting: call sites record a format id and raw arguments,
+* the text is produced on the appender thread or offline from the binary file
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "log_queue.h"
+#include "lock_free_loop_buffer.h"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+* Log a printf style line through a BinaryLogger
+*
+* The format string, source and level are registered in registry once per call site, so they must be
+* constant for a given call site, and registry must be the one the logger was created with (usually
+* BinaryLogFormatRegistry::defaultRegistry()). Only the arguments are copied on the calling thread.
+*/
+#define RPOS_BINARY_LOG(registry, logger, source, level, format, ...)                                       \
+do                                                                                                          \
+{                                                                                                           \
+    if ((logger).isEnabled(level))                                                                          \
+    {                                                                                                       \
+        static const ::std::uint32_t rposBinaryLogFormatId_ = (registry).intern((source), (level), (format)); \
+        (logger).log(rposBinaryLogFormatId_, ##__VA_ARGS__);                                                \
+    }                                                                                                       \
+}                                                                                                           \
+while (false)
+
+namespace rpos { namespace system { namespace util {
+
+    /**
+    * A registered call site
+    */
+    struct BinaryLogFormat {
+        std::uint32_t id;
+        std::string source;
+        LogLevel level;
+        std::string format;
+    };
+
+    /**
+    * Maps format ids to (source, level, format string)
+    */
+    class BinaryLogFormatRegistry : private boost::noncopyable {
+    public:
+        typedef boost::shared_ptr<const BinaryLogFormat> FormatPointer;
+
+    public:
+        BinaryLogFormatRegistry()
+        {}
+
+    public:
+        std::uint32_t intern(const std::string& source, LogLevel level, const std::string& format)
+        {
+            std::string key = source;
+            key.push_back('\0');
+            key.push_back(static_cast<char>('0' + level));
+            key.push_back('\0');
+            key.append(format);
+
+            boost::lock_guard<boost::mutex> guard(lock_);
+            auto iter = ids_.find(key);
+            if (iter != ids_.end())
+                return iter->second;
+
+            boost::shared_ptr<BinaryLogFormat> entry(new BinaryLogFormat());
+            entry->id = static_cast<std::uint32_t>(formats_.size());
+            entry->source = source;
+            entry->level = level;
+            entry->format = format;
+            formats_.push_back(entry);
+            ids_[key] = entry->id;
+            return entry->id;
+        }
+
+        FormatPointer find(std::uint32_t id) const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            return id < formats_.size() ? formats_[id] : FormatPointer();
+        }
+
+        /**
+        * Append formats with id >= cache.size() to cache, lets readers avoid the lock for known ids
+        */
+        void update(std::vector<FormatPointer>& cache) const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            for (size_t i = cache.size(); i < formats_.size(); i++)
+                cache.push_back(formats_[i]);
+        }
+
+        size_t size() const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            return formats_.size();
+        }
+
+    public:
+        static BinaryLogFormatRegistry& defaultRegistry()
+        {
+            static BinaryLogFormatRegistry registry;
+            return registry;
+        }
+
+    private:
+        mutable boost::mutex lock_;
+        std::vector<FormatPointer> formats_;
+        std::unordered_map<std::string, std::uint32_t> ids_;
+    };
+
+    namespace detail {
+
+        enum BinaryLogArgTag {
+            BinaryLogArgInt = 1,
+            BinaryLogArgUInt = 2,
+            BinaryLogArgDouble = 3,
+            BinaryLogArgString = 4,
+            BinaryLogArgPointer = 5
+        };
+
+        // record header: total size, format id, timestamp
+        static const size_t kBinaryLogHeaderSize = 16;
+        // format id of the dictionary entries in binary log files
+        static const std::uint32_t kBinaryLogDictionaryId = 0xffffffffu;
+        static const char kBinaryLogFileMagic[8] = { 'R', 'P', 'B', 'L', 'O', 'G', '0', '1' };
+
+        template < class T >
+        inline void binaryLogStore(std::uint8_t*& p, const T& v)
+        {
+            memcpy(p, &v, sizeof(T));
+            p += sizeof(T);
+        }
+
+        template < class T >
+        inline T binaryLogLoad(const std::uint8_t* p)
+        {
+            T v;
+            memcpy(&v, p, sizeof(T));
+            return v;
+        }
+
+        template < class T, class Enable = void >
+        struct BinaryLogArg;
+
+        template < class T >
+        struct BinaryLogArg<T, typename std::enable_if<(std::is_integral<T>::value && std::is_signed<T>::value) || std::is_enum<T>::value>::type> {
+            static size_t size(const T&) { return 9; }
+            static void write(std::uint8_t*& p, const T& v)
+            {
+                *p++ = BinaryLogArgInt;
+                binaryLogStore(p, static_cast<std::int64_t>(v));
+            }
+        };
+
+        template < class T >
+        struct BinaryLogArg<T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type> {
+            static size_t size(const T&) { return 9; }
+            static void write(std::uint8_t*& p, const T& v)
+            {
+                *p++ = BinaryLogArgUInt;
+                binaryLogStore(p, static_cast<std::uint64_t>(v));
+            }
+        };
+
+        template < class T >
+        struct BinaryLogArg<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+            static size_t size(const T&) { return 9; }
+            static void write(std::uint8_t*& p, const T& v)
+            {
+                *p++ = BinaryLogArgDouble;
+                binaryLogStore(p, static_cast<double>(v));
+            }
+        };
+
+        struct BinaryLogStringArg {
+            static size_t size(const char* s, size_t n) { (void)s; return 5 + n; }
+            static void write(std::uint8_t*& p, const char* s, size_t n)
+            {
+                *p++ = BinaryLogArgString;
+                binaryLogStore(p, static_cast<std::uint32_t>(n));
+                memcpy(p, s, n);
+                p += n;
+            }
+        };
+
+        template < class T >
+        struct BinaryLogArg<T, typename std::enable_if<std::is_same<T, const char*>::value || std::is_same<T, char*>::value>::type> {
+            static const char* str(const char* v) { return v ? v : "(null)"; }
+            static size_t size(const char* v) { return BinaryLogStringArg::size(str(v), strlen(str(v))); }
+            static void write(std::uint8_t*& p, const char* v) { BinaryLogStringArg::write(p, str(v), strlen(str(v))); }
+        };
+
+        template <>
+        struct BinaryLogArg<std::string> {
+            static size_t size(const std::string& v) { return BinaryLogStringArg::size(v.data(), v.size()); }
+            static void write(std::uint8_t*& p, const std::string& v) { BinaryLogStringArg::write(p, v.data(), v.size()); }
+        };
+
+        template < class T >
+        struct BinaryLogArg<T, typename std::enable_if<std::is_pointer<T>::value
+            && !std::is_same<T, const char*>::value && !std::is_same<T, char*>::value>::type> {
+            static size_t size(const T&) { return 9; }
+            static void write(std::uint8_t*& p, const T& v)
+            {
+                *p++ = BinaryLogArgPointer;
+                binaryLogStore(p, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(v)));
+            }
+        };
+
+        inline size_t binaryLogArgsSize()
+        {
+            return 0;
+        }
+
+        template < class T, class... RestT >
+        inline size_t binaryLogArgsSize(const T& v, const RestT&... rest)
+        {
+            typedef typename std::decay<T>::type arg_t;
+            return BinaryLogArg<arg_t>::size(v) + binaryLogArgsSize(rest...);
+        }
+
+        inline void binaryLogWriteArgs(std::uint8_t*&)
+        {}
+
+        template < class T, class... RestT >
+        inline void binaryLogWriteArgs(std::uint8_t*& p, const T& v, const RestT&... rest)
+        {
+            typedef typename std::decay<T>::type arg_t;
+            BinaryLogArg<arg_t>::write(p, v);
+            binaryLogWriteArgs(p, rest...);
+        }
+
+        /**
+        * Sequential reader of encoded arguments
+        */
+        class BinaryLogArgReader {
+        public:
+            BinaryLogArgReader(const std::uint8_t* data, size_t size)
+                : p_(data)
+                , end_(data + size)
+            {}
+
+        public:
+            bool next(std::uint8_t& tag, std::uint64_t& bits, std::string& str)
+            {
+                if (p_ >= end_)
+                    return false;
+                tag = *p_++;
+                if (tag == BinaryLogArgString)
+                {
+                    if (end_ - p_ < 4)
+                        return false;
+                    std::uint32_t n = binaryLogLoad<std::uint32_t>(p_);
+                    p_ += 4;
+                    if (static_cast<size_t>(end_ - p_) < n)
+                        return false;
+                    str.assign(reinterpret_cast<const char*>(p_), n);
+                    p_ += n;
+                    return true;
+                }
+
+                if (end_ - p_ < 8 || tag < BinaryLogArgInt || tag > BinaryLogArgPointer)
+                    return false;
+                bits = binaryLogLoad<std::uint64_t>(p_);
+                p_ += 8;
+                return true;
+            }
+
+        private:
+            const std::uint8_t* p_;
+            const std::uint8_t* end_;
+        };
+
+        inline long long binaryLogAsInt(std::uint8_t tag, std::uint64_t bits, const std::string& str)
+        {
+            switch (tag)
+            {
+            case BinaryLogArgDouble:
+                return static_cast<long long>(binaryLogLoad<double>(reinterpret_cast<const std::uint8_t*>(&bits)));
+            case BinaryLogArgString:
+                return atoll(str.c_str());
+            default:
+                return static_cast<long long>(bits);
+            }
+        }
+
+        inline double binaryLogAsDouble(std::uint8_t tag, std::uint64_t bits, const std::string& str)
+        {
+            switch (tag)
+            {
+            case BinaryLogArgDouble:
+                return binaryLogLoad<double>(reinterpret_cast<const std::uint8_t*>(&bits));
+            case BinaryLogArgInt:
+                return static_cast<double>(static_cast<std::int64_t>(bits));
+            case BinaryLogArgString:
+                return atof(str.c_str());
+            default:
+                return static_cast<double>(bits);
+            }
+        }
+
+        template < class T >
+        inline void binaryLogAppendFormatted(std::string& dest, const std::string& spec, T value)
+        {
+            char buffer[128];
+            int n = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+            if (n < 0)
+                return;
+            if (static_cast<size_t>(n) < sizeof(buffer))
+            {
+                dest.append(buffer, static_cast<size_t>(n));
+                return;
+            }
+
+            std::vector<char> large(static_cast<size_t>(n) + 1);
+            snprintf(large.data(), large.size(), spec.c_str(), value);
+            dest.append(large.data(), static_cast<size_t>(n));
+        }
+
+        /**
+        * printf length modifiers
+        */
+        enum BinaryLogLength {
+            BinaryLogLengthNone,
+            BinaryLogLengthChar,       // hh
+            BinaryLogLengthShort,      // h
+            BinaryLogLengthLong,       // l
+            BinaryLogLengthLongLong,   // ll, q
+            BinaryLogLengthIntMax,     // j
+            BinaryLogLengthSize,       // z
+            BinaryLogLengthPtrDiff,    // t
+            BinaryLogLengthLongDouble  // L
+        };
+
+        inline BinaryLogLength binaryLogParseLength(const char*& p, const char* end)
+        {
+            if (p >= end)
+                return BinaryLogLengthNone;
+            switch (*p)
+            {
+            case 'h':
+                p++;
+                if (p < end && *p == 'h')
+                {
+                    p++;
+                    return BinaryLogLengthChar;
+                }
+                return BinaryLogLengthShort;
+            case 'l':
+                p++;
+                if (p < end && *p == 'l')
+                {
+                    p++;
+                    return BinaryLogLengthLongLong;
+                }
+                return BinaryLogLengthLong;
+            case 'q':
+                p++;
+                return BinaryLogLengthLongLong;
+            case 'j':
+                p++;
+                return BinaryLogLengthIntMax;
+            case 'z':
+                p++;
+                return BinaryLogLengthSize;
+            case 't':
+                p++;
+                return BinaryLogLengthPtrDiff;
+            case 'L':
+                p++;
+                return BinaryLogLengthLongDouble;
+            default:
+                return BinaryLogLengthNone;
+            }
+        }
+
+        template < class SignedT, class UnsignedT >
+        inline void binaryLogAppendInteger(std::string& dest, const std::string& spec, bool isSigned, long long value)
+        {
+            // converting to the unsigned type wraps, so %u of -1 gives 4294967295 as with printf
+            if (isSigned)
+                binaryLogAppendFormatted(dest, spec, static_cast<SignedT>(value));
+            else
+                binaryLogAppendFormatted(dest, spec, static_cast<UnsignedT>(static_cast<unsigned long long>(value)));
+        }
+
+        /**
+        * Format an integer conversion (d i u o x X) as the argument type named by the length modifier
+        */
+        inline void binaryLogAppendInteger(std::string& dest, const std::string& spec, BinaryLogLength length, char conversion, long long value)
+        {
+            bool isSigned = (conversion == 'd' || conversion == 'i');
+            switch (length)
+            {
+            case BinaryLogLengthChar:
+                binaryLogAppendInteger<signed char, unsigned char>(dest, spec + "hh" + conversion, isSigned, value);
+                break;
+            case BinaryLogLengthShort:
+                binaryLogAppendInteger<short, unsigned short>(dest, spec + "h" + conversion, isSigned, value);
+                break;
+            case BinaryLogLengthLong:
+                binaryLogAppendInteger<long, unsigned long>(dest, spec + "l" + conversion, isSigned, value);
+                break;
+            case BinaryLogLengthLongLong:
+            case BinaryLogLengthLongDouble:
+                binaryLogAppendInteger<long long, unsigned long long>(dest, spec + "ll" + conversion, isSigned, value);
+                break;
+            case BinaryLogLengthIntMax:
+                binaryLogAppendInteger<std::intmax_t, std::uintmax_t>(dest, spec + "j" + conversion, isSigned, value);
+                break;
+            case BinaryLogLengthSize:
+                binaryLogAppendInteger<std::make_signed<size_t>::type, size_t>(dest, spec + "z" + conversion, isSigned, value);
+                break;
+            case BinaryLogLengthPtrDiff:
+                binaryLogAppendInteger<std::ptrdiff_t, std::make_unsigned<std::ptrdiff_t>::type>(dest, spec + "t" + conversion, isSigned, value);
+                break;
+            default:
+                binaryLogAppendInteger<int, unsigned int>(dest, spec + conversion, isSigned, value);
+                break;
+            }
+        }
+
+    }
+
+    /**
+    * Render a printf style format with encoded arguments, the same way vsnprintf would
+    *
+    * Arguments are converted to the type the conversion and its length modifier name (e.g. int for %d,
+    * unsigned char for %hhu, long double for %Lf), so the text matches vsnprintf called with arguments
+    * of those types. %lc and %ls are treated as %c and %s. Missing arguments leave the conversion
+    * specification as is.
+    *
+    * @return false if the arguments do not match the format
+    */
+    inline bool formatBinaryLogMessage(const std::string& format, const std::uint8_t* args, size_t argsSize, std::string& dest)
+    {
+        detail::BinaryLogArgReader reader(args, argsSize);
+        std::uint8_t tag = 0;
+        std::uint64_t bits = 0;
+        std::string str;
+        bool ok = true;
+
+        const char* p = format.c_str();
+        const char* end = p + format.size();
+        while (p < end)
+        {
+            const char* percent = static_cast<const char*>(memchr(p, '%', end - p));
+            if (!percent)
+            {
+                dest.append(p, end);
+                break;
+            }
+            dest.append(p, percent);
+            p = percent + 1;
+            if (p < end && *p == '%')
+            {
+                dest.push_back('%');
+                p++;
+                continue;
+            }
+
+            std::string spec("%");
+            while (p < end && strchr("-+ #0'", *p))
+                spec.push_back(*p++);
+            for (int part = 0; part < 2 && p < end; part++)
+            {
+                if (part == 1)
+                {
+                    if (*p != '.')
+                        break;
+                    spec.push_back(*p++);
+                }
+
+                if (p < end && *p == '*')
+                {
+                    p++;
+                    if (!reader.next(tag, bits, str))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    spec.append(std::to_string(detail::binaryLogAsInt(tag, bits, str)));
+                    continue;
+                }
+                while (p < end && *p >= '0' && *p <= '9')
+                    spec.push_back(*p++);
+            }
+            detail::BinaryLogLength length = detail::binaryLogParseLength(p, end);
+            if (p >= end)
+            {
+                dest.append(spec);
+                break;
+            }
+
+            char conversion = *p++;
+            if (conversion == 'n')
+                continue;
+            if (!reader.next(tag, bits, str))
+            {
+                ok = false;
+                dest.append(spec);
+                dest.push_back(conversion);
+                continue;
+            }
+
+            switch (conversion)
+            {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                detail::binaryLogAppendInteger(dest, spec, length, conversion, detail::binaryLogAsInt(tag, bits, str));
+                break;
+            case 'c':
+                detail::binaryLogAppendFormatted(dest, spec + conversion, static_cast<int>(detail::binaryLogAsInt(tag, bits, str)));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (length == detail::BinaryLogLengthLongDouble)
+                    detail::binaryLogAppendFormatted(dest, spec + 'L' + conversion, static_cast<long double>(detail::binaryLogAsDouble(tag, bits, str)));
+                else
+                    detail::binaryLogAppendFormatted(dest, spec + conversion, detail::binaryLogAsDouble(tag, bits, str));
+                break;
+            case 's':
+                if (tag != detail::BinaryLogArgString)
+                {
+                    ok = false;
+                    str = (tag == detail::BinaryLogArgDouble)
+                        ? std::to_string(detail::binaryLogAsDouble(tag, bits, str))
+                        : std::to_string(detail::binaryLogAsInt(tag, bits, str));
+                }
+                detail::binaryLogAppendFormatted(dest, spec + conversion, str.c_str());
+                break;
+            case 'p':
+                detail::binaryLogAppendFormatted(dest, spec + conversion, reinterpret_cast<void*>(static_cast<std::uintptr_t>(bits)));
+                break;
+            default:
+                ok = false;
+                dest.append(spec);
+                dest.push_back(conversion);
+                break;
+            }
+        }
+        return ok;
+    }
+
+    /**
+    * Writes binary log files readable by BinaryLogReader
+    *
+    * A file starts with an 8 bytes magic, followed by records in the same layout as the in memory
+    * ring. The first time a format id appears in the file, its dictionary entry is written before it,
+    * so the file can be decoded without the registry of the process which wrote it.
+    */
+    class BinaryLogFileWriter : private boost::noncopyable {
+    public:
+        BinaryLogFileWriter(const std::string& filename, BinaryLogFormatRegistry& registry)
+            : registry_(registry)
+            , file_(fopen(filename.c_str(), "wb"))
+        {
+            if (!file_)
+                throw std::runtime_error("Failed to create binary log file " + filename);
+            buffer_.append(detail::kBinaryLogFileMagic, sizeof(detail::kBinaryLogFileMagic));
+        }
+
+        ~BinaryLogFileWriter()
+        {
+            flush();
+            fclose(file_);
+        }
+
+    public:
+        /**
+        * Buffer a record, as produced by BinaryLogger
+        */
+        void write(const std::uint8_t* record, size_t size)
+        {
+            std::uint32_t id = detail::binaryLogLoad<std::uint32_t>(record + 4);
+            if (id >= written_.size())
+                written_.resize(id + 1, false);
+            if (!written_[id])
+            {
+                writeDictionaryEntry_(id);
+                written_[id] = true;
+            }
+
+            buffer_.append(reinterpret_cast<const char*>(record), size);
+            if (buffer_.size() >= kFlushSize)
+                flush();
+        }
+
+        void flush()
+        {
+            if (buffer_.empty())
+                return;
+            fwrite(buffer_.data(), 1, buffer_.size(), file_);
+            fflush(file_);
+            buffer_.clear();
+        }
+
+    private:
+        static const size_t kFlushSize = 256 * 1024;
+
+        void writeDictionaryEntry_(std::uint32_t id)
+        {
+            BinaryLogFormatRegistry::FormatPointer format = registry_.find(id);
+            if (!format)
+                return;
+
+            size_t size = detail::kBinaryLogHeaderSize + 4 + 1 + 4 + format->source.size() + 4 + format->format.size();
+            std::vector<std::uint8_t> entry(size);
+            std::uint8_t* p = entry.data();
+            detail::binaryLogStore(p, static_cast<std::uint32_t>(size));
+            detail::binaryLogStore(p, detail::kBinaryLogDictionaryId);
+            detail::binaryLogStore(p, static_cast<std::uint64_t>(0));
+            detail::binaryLogStore(p, id);
+            *p++ = static_cast<std::uint8_t>(format->level);
+            detail::binaryLogStore(p, static_cast<std::uint32_t>(format->source.size()));
+            memcpy(p, format->source.data(), format->source.size());
+            p += format->source.size();
+            detail::binaryLogStore(p, static_cast<std::uint32_t>(format->format.size()));
+            memcpy(p, format->format.data(), format->format.size());
+            buffer_.append(reinterpret_cast<const char*>(entry.data()), entry.size());
+        }
+
+    private:
+        BinaryLogFormatRegistry& registry_;
+        FILE* file_;
+        std::string buffer_;
+        std::vector<bool> written_;
+    };
+
+    /**
+    * Offline decoder of files produced by BinaryLogger, e.g. to convert them into text with
+    * BatchFileLogAppender after pulling them from a robot
+    */
+    class BinaryLogReader : private boost::noncopyable {
+    public:
+        explicit BinaryLogReader(const std::string& filename)
+            : file_(fopen(filename.c_str(), "rb"))
+        {
+            if (!file_)
+                throw std::runtime_error("Failed to open binary log file " + filename);
+
+            char magic[sizeof(detail::kBinaryLogFileMagic)];
+            if (fread(magic, 1, sizeof(magic), file_) != sizeof(magic) || memcmp(magic, detail::kBinaryLogFileMagic, sizeof(magic)))
+            {
+                fclose(file_);
+                throw std::runtime_error("Not a binary log file " + filename);
+            }
+        }
+
+        ~BinaryLogReader()
+        {
+            fclose(file_);
+        }
+
+    public:
+        /**
+        * Decode the next log line
+        *
+        * @return false at the end of file or on a truncated record
+        */
+        bool next(LogRecord& record)
+        {
+            for (;;)
+            {
+                std::uint8_t header[detail::kBinaryLogHeaderSize];
+                if (fread(header, 1, sizeof(header), file_) != sizeof(header))
+                    return false;
+
+                std::uint32_t size = detail::binaryLogLoad<std::uint32_t>(header);
+                std::uint32_t id = detail::binaryLogLoad<std::uint32_t>(header + 4);
+                if (size < sizeof(header))
+                    return false;
+                body_.resize(size - sizeof(header));
+                if (!body_.empty() && fread(body_.data(), 1, body_.size(), file_) != body_.size())
+                    return false;
+
+                if (id == detail::kBinaryLogDictionaryId)
+                {
+                    readDictionaryEntry_();
+                    continue;
+                }
+
+                record.timestamp = detail::binaryLogLoad<std::uint64_t>(header + 8);
+                record.message.clear();
+                auto iter = formats_.find(id);
+                if (iter == formats_.end())
+                {
+                    record.source = "binary_log";
+                    record.level = LogLevelWarn;
+                    record.message = "<unknown format id " + std::to_string(id) + ">";
+                    return true;
+                }
+
+                record.source = iter->second.source;
+                record.level = iter->second.level;
+                formatBinaryLogMessage(iter->second.format, body_.data(), body_.size(), record.message);
+                return true;
+            }
+        }
+
+        /**
+        * Decode the whole file into an appender
+        *
+        * @return lines decoded
+        */
+        size_t decodeTo(LogBatchAppender& appender, size_t batchSize = 512)
+        {
+            std::vector<LogRecord> records(batchSize);
+            std::vector<const LogRecord*> batch;
+            size_t total = 0;
+            for (;;)
+            {
+                batch.clear();
+                while (batch.size() < batchSize && next(records[batch.size()]))
+                    batch.push_back(&records[batch.size()]);
+                if (batch.empty())
+                    break;
+                appender.append(batch);
+                total += batch.size();
+            }
+            appender.flush();
+            return total;
+        }
+
+    private:
+        void readDictionaryEntry_()
+        {
+            const std::uint8_t* p = body_.data();
+            const std::uint8_t* end = p + body_.size();
+            if (end - p < 9)
+                return;
+
+            BinaryLogFormat format;
+            format.id = detail::binaryLogLoad<std::uint32_t>(p);
+            format.level = static_cast<LogLevel>(p[4]);
+            p += 5;
+            std::uint32_t n = detail::binaryLogLoad<std::uint32_t>(p);
+            p += 4;
+            if (static_cast<size_t>(end - p) < n + 4u)
+                return;
+            format.source.assign(reinterpret_cast<const char*>(p), n);
+            p += n;
+            n = detail::binaryLogLoad<std::uint32_t>(p);
+            p += 4;
+            if (static_cast<size_t>(end - p) < n)
+                return;
+            format.format.assign(reinterpret_cast<const char*>(p), n);
+            formats_[format.id] = format;
+        }
+
+    private:
+        FILE* file_;
+        std::vector<std::uint8_t> body_;
+        std::unordered_map<std::uint32_t, BinaryLogFormat> formats_;
+    };
+
+    /**
+    * Deferred formatting logger
+    *
+    * log() only encodes the arguments (a few bytes each, strings are copied) into a lock-free ring,
+    * vsnprintf never runs on the calling thread. The worker thread formats the lines for the
+    * LogBatchAppender instances, so the text output is the same as with AsyncLogQueue, and/or
+    * writes the raw records into a binary file for BinaryLogReader.
+    */
+    class BinaryLogger : private boost::noncopyable {
+    public:
+        typedef LogBatchAppender::Pointer AppenderPointer;
+
+        struct Options {
+            Options()
+                : capacity(1024 * 1024)
+                , maxBatchSize(512)
+                , blockWhenFull(false)
+                , flushIntervalMs(100)
+                , logLevel(LogLevelDebug)
+            {}
+
+            // ring size in bytes
+            size_t capacity;
+            // lines handed to the appenders at once, 0 is treated as 1
+            size_t maxBatchSize;
+            // wait for the worker when the ring is full instead of dropping the line
+            bool blockWhenFull;
+            int flushIntervalMs;
+            LogLevel logLevel;
+            // write raw records to this file, empty to disable
+            std::string binaryFilename;
+        };
+
+    public:
+        explicit BinaryLogger(const Options& options = Options(), BinaryLogFormatRegistry& registry = BinaryLogFormatRegistry::defaultRegistry())
+            : options_(options)
+            , registry_(registry)
+            , ring_(options.capacity)
+            , logLevel_(options.logLevel)
+            , appenders_(new std::vector<AppenderPointer>())
+            , accepted_(0)
+            , processed_(0)
+            , dropped_(0)
+        {
+            if (!options_.maxBatchSize)
+                options_.maxBatchSize = 1;
+            if (!options_.binaryFilename.empty())
+                binaryFile_.reset(new BinaryLogFileWriter(options_.binaryFilename, registry_));
+            workerThread_ = boost::thread(boost::bind(&BinaryLogger::worker_, this));
+        }
+
+        ~BinaryLogger()
+        {
+            stop();
+        }
+
+    public:
+        LogLevel getLogLevel() const
+        {
+            return logLevel_.load(boost::memory_order_relaxed);
+        }
+
+        void setLogLevel(LogLevel logLevel)
+        {
+            logLevel_.store(logLevel, boost::memory_order_relaxed);
+        }
+
+        bool isEnabled(LogLevel level) const
+        {
+            return level >= getLogLevel();
+        }
+
+        /**
+        * The registry format ids passed to log() must come from
+        */
+        BinaryLogFormatRegistry& registry() const
+        {
+            return registry_;
+        }
+
+        /**
+        * Record a line, formatId comes from BinaryLogFormatRegistry::intern (see RPOS_BINARY_LOG)
+        *
+        * @return false if the line is dropped
+        */
+        template < class... ArgsT >
+        bool log(std::uint32_t formatId, const ArgsT&... args)
+        {
+            size_t size = detail::kBinaryLogHeaderSize + detail::binaryLogArgsSize(args...);
+            std::uint8_t stackBuffer[512];
+            std::vector<std::uint8_t> heapBuffer;
+            std::uint8_t* record = stackBuffer;
+            if (size > sizeof(stackBuffer))
+            {
+                heapBuffer.resize(size);
+                record = heapBuffer.data();
+            }
+
+            std::uint8_t* p = record;
+            detail::binaryLogStore(p, static_cast<std::uint32_t>(size));
+            detail::binaryLogStore(p, formatId);
+            detail::binaryLogStore(p, LogRecord::now());
+            detail::binaryLogWriteArgs(p, args...);
+
+            bool written = options_.blockWhenFull ? ring_.blockingWrite(record, size) : (ring_.write(record, size) != 0);
+            if (!written)
+            {
+                dropped_.fetch_add(1, boost::memory_order_relaxed);
+                return false;
+            }
+            accepted_.fetch_add(1, boost::memory_order_release);
+            return true;
+        }
+
+    public:
+        void addAppender(const AppenderPointer& appender)
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            boost::shared_ptr<std::vector<AppenderPointer>> appenders(new std::vector<AppenderPointer>(*appenders_));
+            appenders->push_back(appender);
+            appenders_ = appenders;
+        }
+
+        void removeAppender(const AppenderPointer& appender)
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            boost::shared_ptr<std::vector<AppenderPointer>> appenders(new std::vector<AppenderPointer>());
+            for (auto iter = appenders_->begin(); iter != appenders_->end(); ++iter)
+            {
+                if (*iter != appender)
+                    appenders->push_back(*iter);
+            }
+            appenders_ = appenders;
+        }
+
+        /**
+        * Block until every line recorded before this call has been processed
+        */
+        void flush()
+        {
+            std::uint64_t target = accepted_.load(boost::memory_order_acquire);
+            while (processed_.load(boost::memory_order_acquire) < target && !ring_.isClosed())
+            {
+                std::uint32_t epoch = flushed_.prepareWait();
+                if (processed_.load(boost::memory_order_acquire) >= target)
+                {
+                    flushed_.cancelWait();
+                    break;
+                }
+                flushed_.waitUntil(epoch, detail::deadlineAfter(boost::chrono::milliseconds(options_.flushIntervalMs)));
+            }
+        }
+
+        /**
+        * Process the remaining lines and stop the worker, later lines are dropped
+        */
+        void stop()
+        {
+            if (ring_.isClosed())
+                return;
+            ring_.close();
+            if (workerThread_.joinable())
+                workerThread_.join();
+        }
+
+        std::uint64_t droppedRecords() const
+        {
+            return dropped_.load(boost::memory_order_relaxed);
+        }
+
+    private:
+        void worker_()
+        {
+            std::vector<std::uint8_t> pending;
+            std::vector<std::uint8_t> chunk(64 * 1024);
+            std::vector<BinaryLogFormatRegistry::FormatPointer> formats;
+            std::vector<LogRecord> records(options_.maxBatchSize);
+            std::vector<const LogRecord*> batch;
+            boost::chrono::milliseconds interval(options_.flushIntervalMs);
+
+            for (;;)
+            {
+                size_t n = ring_.blockingReadFor(chunk.data(), chunk.size(), interval);
+                if (!n)
+                {
+                    if (binaryFile_)
+                        binaryFile_->flush();
+                    flushAppenders_();
+                    flushed_.notify();
+                    if (ring_.isClosed() && ring_.empty())
+                        break;
+                    continue;
+                }
+                pending.insert(pending.end(), chunk.begin(), chunk.begin() + n);
+
+                boost::shared_ptr<const std::vector<AppenderPointer>> appenders = appendersSnapshot_();
+                size_t offset = 0;
+                size_t count = 0;
+                while (pending.size() - offset >= detail::kBinaryLogHeaderSize)
+                {
+                    const std::uint8_t* record = pending.data() + offset;
+                    std::uint32_t size = detail::binaryLogLoad<std::uint32_t>(record);
+                    if (pending.size() - offset < size)
+                        break;
+
+                    if (binaryFile_)
+                        binaryFile_->write(record, size);
+
+                    if (!appenders->empty())
+                    {
+                        decode_(record, size, formats, records[batch.size()]);
+                        batch.push_back(&records[batch.size()]);
+                        if (batch.size() == records.size())
+                            deliver_(*appenders, batch);
+                    }
+                    offset += size;
+                    count++;
+                }
+                deliver_(*appenders, batch);
+                pending.erase(pending.begin(), pending.begin() + offset);
+                processed_.fetch_add(count, boost::memory_order_release);
+            }
+        }
+
+        void decode_(const std::uint8_t* record, size_t size, std::vector<BinaryLogFormatRegistry::FormatPointer>& formats, LogRecord& out)
+        {
+            std::uint32_t id = detail::binaryLogLoad<std::uint32_t>(record + 4);
+            out.timestamp = detail::binaryLogLoad<std::uint64_t>(record + 8);
+            out.message.clear();
+            if (id >= formats.size())
+                registry_.update(formats);
+            if (id >= formats.size())
+            {
+                out.source = "binary_log";
+                out.level = LogLevelWarn;
+                out.message = "<unknown format id " + std::to_string(id) + ">";
+                return;
+            }
+
+            const BinaryLogFormat& format = *formats[id];
+            out.source = format.source;
+            out.level = format.level;
+            formatBinaryLogMessage(format.format, record + detail::kBinaryLogHeaderSize, size - detail::kBinaryLogHeaderSize, out.message);
+        }
+
+        static void deliver_(const std::vector<AppenderPointer>& appenders, std::vector<const LogRecord*>& batch)
+        {
+            if (batch.empty())
+                return;
+            for (auto iter = appenders.begin(); iter != appenders.end(); ++iter)
+                (*iter)->append(batch);
+            batch.clear();
+        }
+
+        void flushAppenders_()
+        {
+            boost::shared_ptr<const std::vector<AppenderPointer>> appenders = appendersSnapshot_();
+            for (auto iter = appenders->begin(); iter != appenders->end(); ++iter)
+                (*iter)->flush();
+        }
+
+        boost::shared_ptr<const std::vector<AppenderPointer>> appendersSnapshot_()
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            return appenders_;
+        }
+
+    private:
+        Options options_;
+        BinaryLogFormatRegistry& registry_;
+        MpscLoopBuffer<> ring_;
+        boost::atomic<LogLevel> logLevel_;
+
+        boost::mutex appendersLock_;
+        boost::shared_ptr<const std::vector<AppenderPointer>> appenders_;
+        boost::scoped_ptr<BinaryLogFileWriter> binaryFile_;
+
+        boost::atomic<std::uint64_t> accepted_;
+        boost::atomic<std::uint64_t> processed_;
+        boost::atomic<std::uint64_t> dropped_;
+        ConditionVariableWaitStrategy flushed_;
+        boost::thread workerThread_;
+    };
+
+} } }
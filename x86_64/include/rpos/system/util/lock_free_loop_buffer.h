@@ -0,0 +1,635 @@
+/*
+* lock_free_loop_buffer.h
+* Lock-free byte loop buffers for single producer (SPSC) and multiple producers (MPSC)
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
+#if defined(__linux__)
+#   include <linux/futex.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   include <time.h>
+#   include <climits>
+#endif
+
+namespace rpos { namespace system { namespace util {
+
+    static const size_t kCacheLineSize = 64;
+
+    /**
+    * Wait strategy based on boost::condition_variable, available on every platform
+    *
+    * A wait strategy wraps an event counter. A waiter registers with prepareWait(), which returns
+    * a snapshot of the counter, checks its condition, then either calls waitUntil() with the
+    * snapshot or cancelWait() if it does not need to sleep. The notifier publishes its data, then
+    * calls notify(): a full fence pairs with the registration so either the notifier sees the
+    * waiter or the waiter sees the data, and the counter is only bumped when somebody waits.
+    */
+    class ConditionVariableWaitStrategy : private boost::noncopyable {
+    public:
+        ConditionVariableWaitStrategy()
+            : epoch_(0)
+            , waiters_(0)
+        {}
+
+    public:
+        /**
+        * Register as a waiter, must be followed by exactly one waitUntil() or cancelWait()
+        */
+        std::uint32_t prepareWait()
+        {
+            waiters_.fetch_add(1, boost::memory_order_seq_cst);
+            return epoch_.load(boost::memory_order_seq_cst);
+        }
+
+        void cancelWait()
+        {
+            waiters_.fetch_sub(1, boost::memory_order_relaxed);
+        }
+
+        /**
+        * @return false if the deadline is reached before notified
+        */
+        bool waitUntil(std::uint32_t epoch, const boost::chrono::steady_clock::time_point& deadline)
+        {
+            bool notified = true;
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                while (epoch_.load(boost::memory_order_relaxed) == epoch)
+                {
+                    if (cond_.wait_until(guard, deadline) == boost::cv_status::timeout)
+                    {
+                        notified = (epoch_.load(boost::memory_order_relaxed) != epoch);
+                        break;
+                    }
+                }
+            }
+            waiters_.fetch_sub(1, boost::memory_order_relaxed);
+            return notified;
+        }
+
+        void notify()
+        {
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (!waiters_.load(boost::memory_order_relaxed))
+                return;
+
+            boost::lock_guard<boost::mutex> guard(lock_);
+            epoch_.fetch_add(1, boost::memory_order_seq_cst);
+            cond_.notify_all();
+        }
+
+    private:
+        boost::atomic<std::uint32_t> epoch_;
+        boost::atomic<std::uint32_t> waiters_;
+        boost::mutex lock_;
+        boost::condition_variable cond_;
+    };
+
+#if defined(__linux__)
+    /**
+    * Wait strategy based on Linux futex, waking up a waiter costs one syscall and no mutex
+    */
+    class FutexWaitStrategy : private boost::noncopyable {
+    public:
+        FutexWaitStrategy()
+            : epoch_(0)
+            , waiters_(0)
+        {}
+
+    public:
+        /**
+        * Register as a waiter, must be followed by exactly one waitUntil() or cancelWait()
+        */
+        std::uint32_t prepareWait()
+        {
+            waiters_.fetch_add(1, boost::memory_order_seq_cst);
+            return epoch_.load(boost::memory_order_seq_cst);
+        }
+
+        void cancelWait()
+        {
+            waiters_.fetch_sub(1, boost::memory_order_relaxed);
+        }
+
+        /**
+        * @return false if the deadline is reached before notified
+        */
+        bool waitUntil(std::uint32_t epoch, const boost::chrono::steady_clock::time_point& deadline)
+        {
+            bool notified = true;
+            while (epoch_.load(boost::memory_order_seq_cst) == epoch)
+            {
+                auto now = boost::chrono::steady_clock::now();
+                if (now >= deadline)
+                {
+                    notified = false;
+                    break;
+                }
+
+                auto ns = boost::chrono::duration_cast<boost::chrono::nanoseconds>(deadline - now).count();
+                struct timespec timeout;
+                timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+                timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+                syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, &timeout, nullptr, 0);
+            }
+            waiters_.fetch_sub(1, boost::memory_order_relaxed);
+            return notified;
+        }
+
+        void notify()
+        {
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (!waiters_.load(boost::memory_order_relaxed))
+                return;
+
+            epoch_.fetch_add(1, boost::memory_order_seq_cst);
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+    private:
+        // futex operates on the raw 32bit word, so the atomic must be lock free and unpadded
+        BOOST_STATIC_ASSERT(sizeof(boost::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+        boost::atomic<std::uint32_t> epoch_;
+        boost::atomic<std::uint32_t> waiters_;
+    };
+
+    typedef FutexWaitStrategy DefaultLoopBufferWaitStrategy;
+#else
+    typedef ConditionVariableWaitStrategy DefaultLoopBufferWaitStrategy;
+#endif
+
+    namespace detail {
+
+        inline size_t roundUpToPowerOf2(size_t v)
+        {
+            size_t result = 1;
+            while (result < v)
+                result <<= 1;
+            return result;
+        }
+
+        inline boost::chrono::steady_clock::time_point infiniteDeadline()
+        {
+            return boost::chrono::steady_clock::time_point::max();
+        }
+
+        template < class DurationT >
+        inline boost::chrono::steady_clock::time_point deadlineAfter(const DurationT& timeout)
+        {
+            return boost::chrono::steady_clock::now() + boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(timeout);
+        }
+
+        /**
+        * Shared storage and consumer side of SpscLoopBuffer and MpscLoopBuffer
+        *
+        * Positions are free running counters, the physical offset is (position & mask_).
+        * Fields written by the producer(s) and by the consumer live on separate cache lines.
+        */
+        template < class WaitStrategyT >
+        class LoopBufferBase : private boost::noncopyable {
+        protected:
+            explicit LoopBufferBase(size_t capacity)
+                : capacity_(roundUpToPowerOf2(capacity < 2 ? 2 : capacity))
+                , mask_(capacity_ - 1)
+                , buffer_(capacity_)
+                , closed_(false)
+                , head_(0)
+                , cachedTail_(0)
+                , tail_(0)
+            {}
+
+        public:
+            size_t capacity() const
+            {
+                return capacity_;
+            }
+
+            size_t size() const
+            {
+                return static_cast<size_t>(tail_.load(boost::memory_order_acquire) - head_.load(boost::memory_order_acquire));
+            }
+
+            bool empty() const
+            {
+                return size() == 0;
+            }
+
+            /**
+            * Wake up all blocking readers and writers, no further data can be written after close.
+            * Data already in the buffer can still be read
+            */
+            void close()
+            {
+                closed_.store(true, boost::memory_order_seq_cst);
+                notEmpty_.notify();
+                notFull_.notify();
+            }
+
+            bool isClosed() const
+            {
+                return closed_.load(boost::memory_order_acquire);
+            }
+
+        public:
+            /**
+            * Read as much data as available without blocking (consumer thread only)
+            *
+            * @return bytes read
+            */
+            size_t read(void* buffer, size_t size)
+            {
+                size_t n = peek(buffer, size);
+                if (n)
+                    consume(n);
+                return n;
+            }
+
+            /**
+            * Copy as much data as available without removing it from the buffer (consumer thread only)
+            *
+            * @return bytes copied
+            */
+            size_t peek(void* buffer, size_t size)
+            {
+                std::uint64_t head = head_.load(boost::memory_order_relaxed);
+                size_t available = static_cast<size_t>(cachedTail_ - head);
+                if (available < size)
+                {
+                    cachedTail_ = tail_.load(boost::memory_order_acquire);
+                    available = static_cast<size_t>(cachedTail_ - head);
+                }
+
+                size_t n = (size < available) ? size : available;
+                if (!n)
+                    return 0;
+
+                size_t offset = static_cast<size_t>(head & mask_);
+                size_t firstPart = capacity_ - offset;
+                if (firstPart >= n)
+                {
+                    memcpy(buffer, &buffer_[offset], n);
+                }
+                else
+                {
+                    memcpy(buffer, &buffer_[offset], firstPart);
+                    memcpy(static_cast<std::uint8_t*>(buffer) + firstPart, &buffer_[0], n - firstPart);
+                }
+                return n;
+            }
+
+            /**
+            * Drop bytes previously returned by peek (consumer thread only)
+            */
+            void consume(size_t size)
+            {
+                head_.store(head_.load(boost::memory_order_relaxed) + size, boost::memory_order_release);
+                notFull_.notify();
+            }
+
+            /**
+            * Block until at least 1 byte is available or the buffer is closed (consumer thread only)
+            *
+            * @return bytes read, 0 means the buffer is closed and drained
+            */
+            size_t blockingRead(void* buffer, size_t size)
+            {
+                return blockingReadUntil_(buffer, size, infiniteDeadline());
+            }
+
+            /**
+            * Block until at least 1 byte is available, the buffer is closed or timeout (consumer thread only)
+            *
+            * @return bytes read, 0 for timeout or closed and drained
+            */
+            template < class DurationT >
+            size_t blockingReadFor(void* buffer, size_t size, const DurationT& timeout)
+            {
+                return blockingReadUntil_(buffer, size, deadlineAfter(timeout));
+            }
+
+            /**
+            * Block until at least `bytes` bytes are available to read
+            *
+            * @return false for timeout or closed with less data than requested
+            */
+            template < class DurationT >
+            bool waitForReadable(size_t bytes, const DurationT& timeout)
+            {
+                if (size() >= bytes)
+                    return true;
+
+                auto deadline = deadlineAfter(timeout);
+                for (;;)
+                {
+                    std::uint32_t epoch = notEmpty_.prepareWait();
+                    if (size() >= bytes || isClosed())
+                    {
+                        notEmpty_.cancelWait();
+                        return size() >= bytes;
+                    }
+                    if (!notEmpty_.waitUntil(epoch, deadline))
+                        return size() >= bytes;
+                }
+            }
+
+        protected:
+            size_t blockingReadUntil_(void* buffer, size_t size, const boost::chrono::steady_clock::time_point& deadline)
+            {
+                size_t n = read(buffer, size);
+                if (n || !size)
+                    return n;
+
+                for (;;)
+                {
+                    std::uint32_t epoch = notEmpty_.prepareWait();
+                    n = read(buffer, size);
+                    if (n || isClosed())
+                    {
+                        notEmpty_.cancelWait();
+                        return n ? n : read(buffer, size);
+                    }
+                    if (!notEmpty_.waitUntil(epoch, deadline))
+                        return read(buffer, size);
+                }
+            }
+
+            size_t freeSpace_(std::uint64_t tail) const
+            {
+                return capacity_ - static_cast<size_t>(tail - head_.load(boost::memory_order_acquire));
+            }
+
+            void copyIn_(std::uint64_t position, const void* buffer, size_t size)
+            {
+                size_t offset = static_cast<size_t>(position & mask_);
+                size_t firstPart = capacity_ - offset;
+                if (firstPart >= size)
+                {
+                    memcpy(&buffer_[offset], buffer, size);
+                }
+                else
+                {
+                    memcpy(&buffer_[offset], buffer, firstPart);
+                    memcpy(&buffer_[0], static_cast<const std::uint8_t*>(buffer) + firstPart, size - firstPart);
+                }
+            }
+
+        protected:
+            const size_t capacity_;
+            const size_t mask_;
+            std::vector<std::uint8_t> buffer_;
+            boost::atomic<bool> closed_;
+
+            // waiter counters are written by the side that blocks, keep them off the hot lines
+            char padBeforeNotEmpty_[kCacheLineSize];
+            WaitStrategyT notEmpty_;
+            char padBeforeNotFull_[kCacheLineSize];
+            WaitStrategyT notFull_;
+
+            char padBeforeHead_[kCacheLineSize];
+            // consumer side
+            boost::atomic<std::uint64_t> head_;
+            std::uint64_t cachedTail_;
+
+            char padBeforeTail_[kCacheLineSize];
+            // published data end, written by producer(s)
+            boost::atomic<std::uint64_t> tail_;
+        };
+
+    }
+
+    /**
+    * Lock-free single producer single consumer byte loop buffer
+    *
+    * Exactly one thread may call the write family and exactly one thread may call the read family.
+    * Capacity is rounded up to a power of 2.
+    * Blocking operations use WaitStrategyT (futex on Linux, condition variable elsewhere),
+    * a notification costs one fence and a load of the waiter count when nobody is waiting
+    */
+    template < class WaitStrategyT = DefaultLoopBufferWaitStrategy >
+    class SpscLoopBuffer : public detail::LoopBufferBase<WaitStrategyT> {
+    private:
+        typedef detail::LoopBufferBase<WaitStrategyT> base_t;
+
+    public:
+        explicit SpscLoopBuffer(size_t capacity)
+            : base_t(capacity)
+            , cachedHead_(0)
+        {}
+
+    public:
+        /**
+        * Write as much data as there is free space without blocking (producer thread only)
+        *
+        * @return bytes written, 0 if the buffer is full or closed
+        */
+        size_t write(const void* buffer, size_t size)
+        {
+            if (this->isClosed())
+                return 0;
+
+            std::uint64_t tail = this->tail_.load(boost::memory_order_relaxed);
+            size_t space = this->capacity_ - static_cast<size_t>(tail - cachedHead_);
+            if (space < size)
+            {
+                cachedHead_ = this->head_.load(boost::memory_order_acquire);
+                space = this->capacity_ - static_cast<size_t>(tail - cachedHead_);
+            }
+
+            size_t n = (size < space) ? size : space;
+            if (!n)
+                return 0;
+
+            this->copyIn_(tail, buffer, n);
+            this->tail_.store(tail + n, boost::memory_order_release);
+            this->notEmpty_.notify();
+            return n;
+        }
+
+        /**
+        * Write all data, blocking while the buffer is full (producer thread only)
+        *
+        * @return bytes written, less than size only if the buffer is closed
+        */
+        size_t blockingWrite(const void* buffer, size_t size)
+        {
+            return blockingWriteUntil_(buffer, size, detail::infiniteDeadline());
+        }
+
+        /**
+        * Write all data, blocking while the buffer is full until timeout (producer thread only)
+        *
+        * @return bytes written, less than size for timeout or closed
+        */
+        template < class DurationT >
+        size_t blockingWriteFor(const void* buffer, size_t size, const DurationT& timeout)
+        {
+            return blockingWriteUntil_(buffer, size, detail::deadlineAfter(timeout));
+        }
+
+    private:
+        size_t blockingWriteUntil_(const void* buffer, size_t size, const boost::chrono::steady_clock::time_point& deadline)
+        {
+            const std::uint8_t* ptr = static_cast<const std::uint8_t*>(buffer);
+            size_t written = 0;
+            while (written < size)
+            {
+                size_t n = write(ptr + written, size - written);
+                written += n;
+                if (n)
+                    continue;
+
+                std::uint32_t epoch = this->notFull_.prepareWait();
+                n = write(ptr + written, size - written);
+                written += n;
+                if (n || this->isClosed())
+                {
+                    this->notFull_.cancelWait();
+                    if (n)
+                        continue;
+                    break;
+                }
+                if (!this->notFull_.waitUntil(epoch, deadline))
+                {
+                    written += write(ptr + written, size - written);
+                    break;
+                }
+            }
+            return written;
+        }
+
+    private:
+        char padBeforeCachedHead_[kCacheLineSize];
+        // producer side
+        std::uint64_t cachedHead_;
+    };
+
+    /**
+    * Lock-free multiple producers single consumer byte loop buffer
+    *
+    * Every write is all-or-nothing so records written by different producers never interleave.
+    * Producers reserve space with a CAS on reserved_, copy without any lock, then publish in
+    * reservation order; a producer only waits for predecessors that are still copying.
+    */
+    template < class WaitStrategyT = DefaultLoopBufferWaitStrategy >
+    class MpscLoopBuffer : public detail::LoopBufferBase<WaitStrategyT> {
+    private:
+        typedef detail::LoopBufferBase<WaitStrategyT> base_t;
+
+    public:
+        explicit MpscLoopBuffer(size_t capacity)
+            : base_t(capacity)
+            , reserved_(0)
+        {}
+
+    public:
+        /**
+        * Write the whole record without blocking (any thread)
+        *
+        * @return size if written, 0 if there is not enough free space or the buffer is closed
+        */
+        size_t write(const void* buffer, size_t size)
+        {
+            if (!size || size > this->capacity_ || this->isClosed())
+                return 0;
+
+            std::uint64_t start = reserved_.load(boost::memory_order_relaxed);
+            do
+            {
+                if (this->freeSpace_(start) < size)
+                    return 0;
+            } while (!reserved_.compare_exchange_weak(start, start + size, boost::memory_order_acq_rel, boost::memory_order_relaxed));
+
+            this->copyIn_(start, buffer, size);
+
+            // publish in reservation order, yield if a predecessor got preempted while copying
+            for (int spins = 0; this->tail_.load(boost::memory_order_acquire) != start; spins++)
+            {
+                if (spins < kPublishSpins_)
+                    spinPause_();
+                else
+                    boost::this_thread::yield();
+            }
+            this->tail_.store(start + size, boost::memory_order_release);
+            this->notEmpty_.notify();
+            return size;
+        }
+
+        /**
+        * Write the whole record, blocking while there is not enough free space (any thread)
+        *
+        * @return false if the buffer is closed or the record is larger than the capacity
+        */
+        bool blockingWrite(const void* buffer, size_t size)
+        {
+            return blockingWriteUntil_(buffer, size, detail::infiniteDeadline());
+        }
+
+        /**
+        * Write the whole record, blocking while there is not enough free space until timeout (any thread)
+        *
+        * @return false for timeout, closed or the record is larger than the capacity
+        */
+        template < class DurationT >
+        bool blockingWriteFor(const void* buffer, size_t size, const DurationT& timeout)
+        {
+            return blockingWriteUntil_(buffer, size, detail::deadlineAfter(timeout));
+        }
+
+    private:
+        bool blockingWriteUntil_(const void* buffer, size_t size, const boost::chrono::steady_clock::time_point& deadline)
+        {
+            // write() reports an empty record as 0 bytes written, which is not a full buffer
+            if (!size)
+                return true;
+            if (size > this->capacity_)
+                return false;
+            if (write(buffer, size))
+                return true;
+
+            for (;;)
+            {
+                std::uint32_t epoch = this->notFull_.prepareWait();
+                bool written = write(buffer, size) != 0;
+                if (written || this->isClosed())
+                {
+                    this->notFull_.cancelWait();
+                    return written;
+                }
+                if (!this->notFull_.waitUntil(epoch, deadline))
+                    return write(buffer, size) != 0;
+            }
+        }
+
+        static void spinPause_()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            __asm__ __volatile__("yield");
+#endif
+        }
+
+    private:
+        static const int kPublishSpins_ = 128;
+
+        char padBeforeReserved_[kCacheLineSize];
+        // reservation end, shared by producers
+        boost::atomic<std::uint64_t> reserved_;
+    };
+
+} } }
@@ -0,0 +1,838 @@
+/*
+* log_queue.h
+* Lock-free multiple producer log queue with preallocated records and batched appenders
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "log.h"
+#include "lock_free_loop_buffer.h"
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace rpos { namespace system { namespace util {
+
+    /**
+    * A log line as stored in the queue
+    *
+    * Records are allocated once when the queue is created and reused, the strings keep their capacity
+    * so steady state logging does not allocate. The timestamp is captured as a raw value and only
+    * formatted on the appender thread.
+    */
+    struct LogRecord {
+        std::string source;
+        LogLevel level;
+        // nanoseconds since 1970-01-01 UTC
+        std::uint64_t timestamp;
+        std::string message;
+
+        void assign(const char* src, size_t srcSize, LogLevel lvl, const char* msg, size_t msgSize)
+        {
+            source.assign(src, srcSize);
+            level = lvl;
+            timestamp = now();
+            message.assign(msg, msgSize);
+        }
+
+        void vformat(const char* src, size_t srcSize, LogLevel lvl, const char* format, va_list args)
+        {
+            source.assign(src, srcSize);
+            level = lvl;
+            timestamp = now();
+
+            // format in place, using the capacity kept from previous lines
+            va_list copy;
+            va_copy(copy, args);
+            message.resize(message.capacity());
+            int n = vsnprintf(&message[0], message.size() + 1, format, copy);
+            va_end(copy);
+            if (n < 0)
+            {
+                message.clear();
+                return;
+            }
+
+            if (static_cast<size_t>(n) > message.size())
+            {
+                message.resize(static_cast<size_t>(n));
+                va_copy(copy, args);
+                vsnprintf(&message[0], message.size() + 1, format, copy);
+                va_end(copy);
+            }
+            message.resize(static_cast<size_t>(n));
+        }
+
+        static std::uint64_t now()
+        {
+            return static_cast<std::uint64_t>(boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                boost::chrono::system_clock::now().time_since_epoch()).count());
+        }
+    };
+
+    inline const char* logLevelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevelDebug:
+            return "DEBUG";
+        case LogLevelInfo:
+            return "INFO";
+        case LogLevelWarn:
+            return "WARN";
+        case LogLevelError:
+            return "ERROR";
+        case LogLevelFatal:
+            return "FATAL";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    /**
+    * Formats record timestamps as local time "YYYY-MM-DD hh:mm:ss.mmm"
+    *
+    * The date part is cached per second, so formatting a burst of lines costs one localtime call.
+    * Not thread safe, every appender thread owns its formatter.
+    */
+    class LogTimeFormatter {
+    public:
+        LogTimeFormatter()
+            : cachedSecond_(-1)
+        {}
+
+    public:
+        void format(std::uint64_t timestamp, std::string& dest)
+        {
+            time_t second = static_cast<time_t>(timestamp / 1000000000u);
+            if (second != cachedSecond_)
+            {
+                struct tm local;
+#ifdef _WIN32
+                localtime_s(&local, &second);
+#else
+                localtime_r(&second, &local);
+#endif
+                char buffer[32];
+                size_t n = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+                cachedPrefix_.assign(buffer, n);
+                cachedSecond_ = second;
+            }
+
+            char millis[8];
+            snprintf(millis, sizeof(millis), ".%03u", static_cast<unsigned>((timestamp / 1000000u) % 1000u));
+            dest.append(cachedPrefix_);
+            dest.append(millis);
+        }
+
+        std::string format(std::uint64_t timestamp)
+        {
+            std::string result;
+            format(timestamp, result);
+            return result;
+        }
+
+    private:
+        time_t cachedSecond_;
+        std::string cachedPrefix_;
+    };
+
+    /**
+    * Bounded multiple producer single consumer queue of LogRecord
+    *
+    * Every slot carries a sequence number: producers claim a slot with one CAS on the tail, fill the
+    * record in place and publish it by bumping the sequence. The consumer walks published slots and
+    * hands them out as a batch without copying, then releases them in one pass.
+    */
+    template < class WaitStrategyT = DefaultLoopBufferWaitStrategy >
+    class LogRecordQueue : private boost::noncopyable {
+    public:
+        /**
+        * @param capacity       Number of records, rounded up to a power of 2
+        * @param messageReserve Capacity reserved in every record for the message text
+        */
+        explicit LogRecordQueue(size_t capacity, size_t messageReserve = 256)
+            : capacity_(detail::roundUpToPowerOf2(capacity < 2 ? 2 : capacity))
+            , mask_(capacity_ - 1)
+            , slots_(capacity_)
+            , consumerSleeping_(false)
+            , head_(0)
+            , tail_(0)
+        {
+            for (size_t i = 0; i < capacity_; i++)
+            {
+                slots_[i].sequence.store(i, boost::memory_order_relaxed);
+                slots_[i].record.source.reserve(32);
+                slots_[i].record.message.reserve(messageReserve);
+            }
+        }
+
+    public:
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+        * Claim a slot, fill it with fill(LogRecord&) and publish it
+        *
+        * If fill throws, the slot is published as dropped (the consumer skips it) and the exception is rethrown
+        *
+        * @return false if the queue is full
+        */
+        template < class FillT >
+        bool push(FillT fill)
+        {
+            std::uint64_t position = tail_.load(boost::memory_order_relaxed);
+            Slot_* slot;
+            for (;;)
+            {
+                slot = &slots_[position & mask_];
+                std::uint64_t sequence = slot->sequence.load(boost::memory_order_acquire);
+                std::int64_t diff = static_cast<std::int64_t>(sequence - position);
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = tail_.load(boost::memory_order_relaxed);
+                }
+            }
+
+            try
+            {
+                fill(slot->record);
+                slot->dropped = false;
+            }
+            catch (...)
+            {
+                // the slot is claimed, it has to be published or the consumer would wait for it forever
+                slot->dropped = true;
+                publish_(*slot, position);
+                throw;
+            }
+            publish_(*slot, position);
+            return true;
+        }
+
+        /**
+        * Consumer side: collect the records of up to maxCount published slots, in order
+        *
+        * Slots dropped by a throwing fill are skipped, so batch may hold fewer records than the returned
+        * count. The records stay valid until release() is called with the returned count
+        *
+        * @return number of slots consumed
+        */
+        size_t peekBatch(std::vector<const LogRecord*>& batch, size_t maxCount)
+        {
+            batch.clear();
+            size_t count = 0;
+            while (count < maxCount)
+            {
+                std::uint64_t position = head_ + count;
+                const Slot_& slot = slots_[position & mask_];
+                if (slot.sequence.load(boost::memory_order_acquire) != position + 1)
+                    break;
+                if (!slot.dropped)
+                    batch.push_back(&slot.record);
+                count++;
+            }
+            return count;
+        }
+
+        void release(size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                std::uint64_t position = head_ + i;
+                slots_[position & mask_].sequence.store(position + capacity_, boost::memory_order_release);
+            }
+            head_ += count;
+        }
+
+        /**
+        * Consumer side: block until a record is published, notify() is called or the timeout expires
+        */
+        template < class DurationT >
+        void waitForRecords(const DurationT& timeout)
+        {
+            std::uint32_t epoch = wait_.prepareWait();
+            consumerSleeping_.store(true, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (!hasPublished_())
+                wait_.waitUntil(epoch, detail::deadlineAfter(timeout));
+            else
+                wait_.cancelWait();
+            consumerSleeping_.store(false, boost::memory_order_relaxed);
+        }
+
+        /**
+        * Wake up the consumer
+        */
+        void notify()
+        {
+            wait_.notify();
+        }
+
+        /**
+        * Number of records claimed by producers so far
+        */
+        std::uint64_t claimed() const
+        {
+            return tail_.load(boost::memory_order_acquire);
+        }
+
+    private:
+        struct Slot_ {
+            Slot_()
+                : sequence(0)
+                , dropped(false)
+            {}
+
+            boost::atomic<std::uint64_t> sequence;
+            // written by the producer before publishing, read by the consumer after
+            bool dropped;
+            LogRecord record;
+        };
+
+        void publish_(Slot_& slot, std::uint64_t position)
+        {
+            slot.sequence.store(position + 1, boost::memory_order_release);
+
+            // pairs with the fence in waitForRecords, only pay for a wake up when the consumer sleeps
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (consumerSleeping_.load(boost::memory_order_relaxed))
+                wait_.notify();
+        }
+
+        bool hasPublished_() const
+        {
+            return slots_[head_ & mask_].sequence.load(boost::memory_order_acquire) == head_ + 1;
+        }
+
+    private:
+        const size_t capacity_;
+        const size_t mask_;
+        std::vector<Slot_> slots_;
+        WaitStrategyT wait_;
+        boost::atomic<bool> consumerSleeping_;
+
+        // consumer only
+        char padding0_[kCacheLineSize];
+        std::uint64_t head_;
+
+        char padding1_[kCacheLineSize];
+        boost::atomic<std::uint64_t> tail_;
+        char padding2_[kCacheLineSize];
+    };
+
+    /**
+    * Appender receiving batches of records from AsyncLogQueue
+    */
+    class LogBatchAppender : private boost::noncopyable {
+    public:
+        typedef boost::shared_ptr<LogBatchAppender> Pointer;
+
+    protected:
+        explicit LogBatchAppender(LogLevel logLevel = LogLevelDebug)
+            : logLevel_(logLevel)
+        {}
+
+    public:
+        virtual ~LogBatchAppender()
+        {}
+
+    public:
+        LogLevel getLogLevel() const
+        {
+            return logLevel_.load(boost::memory_order_relaxed);
+        }
+
+        void setLogLevel(LogLevel logLevel)
+        {
+            logLevel_.store(logLevel, boost::memory_order_relaxed);
+        }
+
+        void append(const std::vector<const LogRecord*>& records)
+        {
+            LogLevel level = getLogLevel();
+            filtered_.clear();
+            for (auto iter = records.begin(); iter != records.end(); ++iter)
+            {
+                if ((*iter)->level >= level)
+                    filtered_.push_back(*iter);
+            }
+            if (!filtered_.empty())
+                append_(filtered_);
+        }
+
+        /**
+        * Called when the queue has been drained, e.g. on flush or stop
+        */
+        virtual void flush()
+        {}
+
+    protected:
+        virtual void append_(const std::vector<const LogRecord*>& records) = 0;
+
+    private:
+        boost::atomic<LogLevel> logLevel_;
+        std::vector<const LogRecord*> filtered_;
+    };
+
+    /**
+    * Forwards batches to an existing LogAppender, one LogData per record
+    *
+    * LogAppender applies its own level and source filters. Use the native batch appenders when the
+    * per line LogData allocation matters.
+    */
+    class LogAppenderBatchAdapter : public LogBatchAppender {
+    public:
+        explicit LogAppenderBatchAdapter(const LogAppender::Pointer& appender)
+            : appender_(appender)
+        {}
+
+    protected:
+        virtual void append_(const std::vector<const LogRecord*>& records)
+        {
+            for (auto iter = records.begin(); iter != records.end(); ++iter)
+            {
+                const LogRecord& record = **iter;
+                LogData_SharedPtr data(new LogData(record.source, record.level, record.message));
+                timeFormatter_.format(record.timestamp, data->logTime);
+                appender_->append(data);
+            }
+        }
+
+    private:
+        LogAppender::Pointer appender_;
+        LogTimeFormatter timeFormatter_;
+    };
+
+    /**
+    * Text file appender writing a whole batch with one write call
+    *
+    * Lines are "<time> [<LEVEL>] [<source>] <message>". When the file grows over maxFileSizeMB it is
+    * renamed to <filename>.1 (shifting older backups up to maxBackupIndex) and a new file is started.
+    * If the rename fails the file is kept and appended to, the next attempt is made after another
+    * maxFileSizeMB has been written.
+    */
+    class BatchFileLogAppender : public LogBatchAppender {
+    public:
+        explicit BatchFileLogAppender(const std::string& filename,
+                                      LogLevel logLevel = LogLevelDebug,
+                                      bool append = true,
+                                      uint16_t maxFileSizeMB = 1, // 1MB
+                                      uint16_t maxBackupIndex = 5)
+            : LogBatchAppender(logLevel)
+            , filename_(filename)
+            , file_(nullptr)
+            , fileSize_(0)
+            , maxFileSize_(static_cast<std::uint64_t>(maxFileSizeMB) * 1024 * 1024)
+            , rolloverSize_(maxFileSize_)
+            , maxBackupIndex_(maxBackupIndex)
+        {
+            if (filename_.has_parent_path())
+            {
+                boost::system::error_code ec;
+                boost::filesystem::create_directories(filename_.parent_path(), ec);
+            }
+            open_(append);
+        }
+
+        virtual ~BatchFileLogAppender()
+        {
+            if (file_)
+                fclose(file_);
+        }
+
+    public:
+        bool isAvailable() const
+        {
+            return file_ != nullptr;
+        }
+
+    protected:
+        virtual void append_(const std::vector<const LogRecord*>& records)
+        {
+            if (!file_)
+                return;
+
+            buffer_.clear();
+            for (auto iter = records.begin(); iter != records.end(); ++iter)
+            {
+                const LogRecord& record = **iter;
+                timeFormatter_.format(record.timestamp, buffer_);
+                buffer_.append(" [");
+                buffer_.append(logLevelName(record.level));
+                buffer_.append("] [");
+                buffer_.append(record.source);
+                buffer_.append("] ");
+                buffer_.append(record.message);
+                buffer_.push_back('\n');
+            }
+
+            // the stream is unbuffered, so this is a single write syscall for the whole batch
+            fwrite(buffer_.data(), 1, buffer_.size(), file_);
+            fileSize_ += buffer_.size();
+
+            if (maxFileSize_ && fileSize_ >= rolloverSize_)
+                rolloverFiles_();
+        }
+
+        void rolloverFiles_()
+        {
+            // the backup must hold everything written so far before it replaces the active file
+#ifdef _WIN32
+            _commit(_fileno(file_));
+#else
+            ::fsync(fileno(file_));
+#endif
+            fclose(file_);
+            file_ = nullptr;
+
+            boost::system::error_code ec;
+            if (maxBackupIndex_ == 0)
+            {
+                // no backups are kept, truncating discards the same lines a successful remove would
+                boost::filesystem::remove(filename_, ec);
+            }
+            else
+            {
+                boost::system::error_code shiftEc;
+                boost::filesystem::remove(backupPath_(maxBackupIndex_), shiftEc);
+                for (int i = maxBackupIndex_ - 1; i >= 1; i--)
+                    boost::filesystem::rename(backupPath_(i), backupPath_(i + 1), shiftEc);
+                boost::filesystem::rename(filename_, backupPath_(1), ec);
+                if (ec)
+                {
+                    // the lines were not moved anywhere, keep appending instead of truncating them
+                    open_(true);
+                    rolloverSize_ = fileSize_ + maxFileSize_;
+                    return;
+                }
+            }
+            open_(false);
+            rolloverSize_ = maxFileSize_;
+        }
+
+        boost::filesystem::path backupPath_(int index) const
+        {
+            boost::filesystem::path path = filename_;
+            path += "." + std::to_string(index);
+            return path;
+        }
+
+    private:
+        void open_(bool append)
+        {
+            file_ = fopen(filename_.string().c_str(), append ? "ab" : "wb");
+            if (!file_)
+                return;
+
+            setvbuf(file_, nullptr, _IONBF, 0);
+            boost::system::error_code ec;
+            std::uintmax_t size = boost::filesystem::file_size(filename_, ec);
+            fileSize_ = ec ? 0 : static_cast<std::uint64_t>(size);
+        }
+
+    protected:
+        boost::filesystem::path filename_;
+        FILE* file_;
+        std::uint64_t fileSize_;
+        std::uint64_t maxFileSize_;
+        // fileSize_ at which the next rollover is attempted
+        std::uint64_t rolloverSize_;
+        uint16_t maxBackupIndex_;
+        std::string buffer_;
+        LogTimeFormatter timeFormatter_;
+    };
+
+    /**
+    * Asynchronous log pipeline: any thread appends without taking a lock, a single worker thread
+    * drains the queue and hands batches to the appenders
+    *
+    * Compared with LogManager, a line costs one CAS and a copy into a preallocated record, no
+    * LogData or shared_ptr is created, and the time string is produced on the worker thread.
+    */
+    class AsyncLogQueue : private boost::noncopyable {
+    public:
+        typedef LogBatchAppender::Pointer AppenderPointer;
+
+        struct Options {
+            Options()
+                : capacity(8192)
+                , messageReserve(256)
+                , maxBatchSize(512)
+                , blockWhenFull(false)
+                , flushIntervalMs(100)
+                , logLevel(LogLevelDebug)
+            {}
+
+            // number of preallocated records
+            size_t capacity;
+            // text capacity reserved in every record, longer lines allocate once and keep the capacity
+            size_t messageReserve;
+            // records handed to the appenders at once, 0 is treated as 1
+            size_t maxBatchSize;
+            // wait for the worker when the queue is full instead of dropping the line
+            bool blockWhenFull;
+            // the worker also wakes up at this interval even when nobody notifies it
+            int flushIntervalMs;
+            // lines below this level are rejected before touching the queue
+            LogLevel logLevel;
+        };
+
+    public:
+        explicit AsyncLogQueue(const Options& options = Options())
+            : options_(options)
+            , queue_(options.capacity, options.messageReserve)
+            , logLevel_(options.logLevel)
+            , appenders_(new std::vector<AppenderPointer>())
+            , stop_(false)
+            , delivered_(0)
+            , dropped_(0)
+        {
+            if (!options_.maxBatchSize)
+                options_.maxBatchSize = 1;
+            workerThread_ = boost::thread(boost::bind(&AsyncLogQueue::worker_, this));
+        }
+
+        ~AsyncLogQueue()
+        {
+            stop();
+        }
+
+    public:
+        LogLevel getLogLevel() const
+        {
+            return logLevel_.load(boost::memory_order_relaxed);
+        }
+
+        void setLogLevel(LogLevel logLevel)
+        {
+            logLevel_.store(logLevel, boost::memory_order_relaxed);
+        }
+
+        bool isEnabled(LogLevel level) const
+        {
+            return level >= getLogLevel();
+        }
+
+        /**
+        * @return false if the line is filtered out, dropped because the queue is full or the queue is stopped
+        */
+        bool append(const char* source, size_t sourceSize, LogLevel level, const char* message, size_t messageSize)
+        {
+            if (!isEnabled(level))
+                return false;
+            return push_([=](LogRecord& record) {
+                record.assign(source, sourceSize, level, message, messageSize);
+            });
+        }
+
+        bool append(const std::string& source, LogLevel level, const std::string& message)
+        {
+            return append(source.data(), source.size(), level, message.data(), message.size());
+        }
+
+        bool append(const std::string& source, LogLevel level, const char* message)
+        {
+            return append(source.data(), source.size(), level, message, strlen(message));
+        }
+
+        bool vlog(const std::string& source, LogLevel level, const char* format, va_list args)
+        {
+            if (!isEnabled(level))
+                return false;
+            return push_([&](LogRecord& record) {
+                record.vformat(source.data(), source.size(), level, format, args);
+            });
+        }
+
+        bool log(const std::string& source, LogLevel level, const char* format, ...)
+        {
+            va_list args;
+            va_start(args, format);
+            bool result = vlog(source, level, format, args);
+            va_end(args);
+            return result;
+        }
+
+    public:
+        void addAppender(const AppenderPointer& appender)
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            boost::shared_ptr<std::vector<AppenderPointer>> appenders(new std::vector<AppenderPointer>(*appenders_));
+            appenders->push_back(appender);
+            appenders_ = appenders;
+        }
+
+        void removeAppender(const AppenderPointer& appender)
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            boost::shared_ptr<std::vector<AppenderPointer>> appenders(new std::vector<AppenderPointer>());
+            for (auto iter = appenders_->begin(); iter != appenders_->end(); ++iter)
+            {
+                if (*iter != appender)
+                    appenders->push_back(*iter);
+            }
+            appenders_ = appenders;
+        }
+
+        void clearAppenders()
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            appenders_.reset(new std::vector<AppenderPointer>());
+        }
+
+        /**
+        * Block until every line appended before this call has been handed to the appenders
+        */
+        void flush()
+        {
+            std::uint64_t target = queue_.claimed();
+            while (delivered_.load(boost::memory_order_acquire) < target && !stop_.load(boost::memory_order_acquire))
+            {
+                std::uint32_t epoch = flushed_.prepareWait();
+                queue_.notify();
+                if (delivered_.load(boost::memory_order_acquire) >= target)
+                {
+                    flushed_.cancelWait();
+                    break;
+                }
+                flushed_.waitUntil(epoch, detail::deadlineAfter(boost::chrono::milliseconds(options_.flushIntervalMs)));
+            }
+        }
+
+        /**
+        * Drain the queue and stop the worker, later appends are rejected
+        */
+        void stop()
+        {
+            if (stop_.exchange(true))
+                return;
+            queue_.notify();
+            if (workerThread_.joinable())
+                workerThread_.join();
+        }
+
+        /**
+        * Number of lines dropped because the queue was full
+        */
+        std::uint64_t droppedRecords() const
+        {
+            return dropped_.load(boost::memory_order_relaxed);
+        }
+
+    private:
+        template < class FillT >
+        bool push_(FillT fill)
+        {
+            if (stop_.load(boost::memory_order_acquire))
+                return false;
+
+            while (!queue_.push(fill))
+            {
+                if (!options_.blockWhenFull || stop_.load(boost::memory_order_acquire))
+                {
+                    dropped_.fetch_add(1, boost::memory_order_relaxed);
+                    return false;
+                }
+                queue_.notify();
+                boost::this_thread::yield();
+            }
+            return true;
+        }
+
+        void worker_()
+        {
+            std::vector<const LogRecord*> batch;
+            batch.reserve(options_.maxBatchSize);
+            boost::chrono::milliseconds interval(options_.flushIntervalMs);
+
+            for (;;)
+            {
+                bool stopping = stop_.load(boost::memory_order_acquire);
+                size_t count = queue_.peekBatch(batch, options_.maxBatchSize);
+                if (count)
+                {
+                    if (!batch.empty())
+                        deliver_(batch);
+                    queue_.release(count);
+                    delivered_.fetch_add(count, boost::memory_order_release);
+                    continue;
+                }
+
+                flushAppenders_();
+                flushed_.notify();
+                // records claimed before stop() are published shortly after, so check again
+                if (stopping && delivered_.load(boost::memory_order_acquire) == queue_.claimed())
+                    break;
+                queue_.waitForRecords(stopping ? boost::chrono::milliseconds(1) : interval);
+            }
+        }
+
+        void deliver_(const std::vector<const LogRecord*>& batch)
+        {
+            boost::shared_ptr<const std::vector<AppenderPointer>> appenders = appendersSnapshot_();
+            for (auto iter = appenders->begin(); iter != appenders->end(); ++iter)
+                (*iter)->append(batch);
+        }
+
+        void flushAppenders_()
+        {
+            boost::shared_ptr<const std::vector<AppenderPointer>> appenders = appendersSnapshot_();
+            for (auto iter = appenders->begin(); iter != appenders->end(); ++iter)
+                (*iter)->flush();
+        }
+
+        boost::shared_ptr<const std::vector<AppenderPointer>> appendersSnapshot_()
+        {
+            boost::lock_guard<boost::mutex> guard(appendersLock_);
+            return appenders_;
+        }
+
+    private:
+        Options options_;
+        LogRecordQueue<> queue_;
+        boost::atomic<LogLevel> logLevel_;
+
+        boost::mutex appendersLock_;
+        boost::shared_ptr<const std::vector<AppenderPointer>> appenders_;
+
+        boost::atomic<bool> stop_;
+        boost::atomic<std::uint64_t> delivered_;
+        boost::atomic<std::uint64_t> dropped_;
+        ConditionVariableWaitStrategy flushed_;
+        boost::thread workerThread_;
+    };
+
+} } }
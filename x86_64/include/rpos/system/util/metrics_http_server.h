@@ -0,0 +1,150 @@
+/*
+* metrics_http_server.h
+* Minimal HTTP endpoint serving a MetricsRegistry at /metrics
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+/*
+* Usage
+*
+* boost::shared_ptr<MetricsHttpServer> server(new MetricsHttpServer(boost::asio::ip::tcp::endpoint(boost::asio::ip::v4(), 9464)));
+* server->start();
+*/
+
+#pragma once
+
+#include "metrics.h"
+#include "tcp_server.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace rpos { namespace system { namespace util {
+
+    class MetricsHttpConnectionHandler;
+
+    class MetricsHttpServer : public TcpServer<MetricsHttpConnectionHandler>
+    {
+    public:
+        MetricsHttpServer(const boost::asio::ip::tcp::endpoint& listenPoint, MetricsRegistry& registry = MetricsRegistry::defaultRegistry())
+            : TcpServer<MetricsHttpConnectionHandler>(listenPoint)
+            , registry_(registry)
+        {}
+
+    public:
+        MetricsRegistry& registry()
+        {
+            return registry_;
+        }
+
+    private:
+        MetricsRegistry& registry_;
+    };
+
+    /**
+    * Handles one request per connection: GET /metrics, anything else is answered with an error
+    */
+    class MetricsHttpConnectionHandler : public TcpServer<MetricsHttpConnectionHandler>::ITcpConnectionHandler
+    {
+    public:
+        typedef TcpServer<MetricsHttpConnectionHandler>::TcpConnection TcpConnection;
+
+        // request line and headers of a scrape are a few hundred bytes
+        static const size_t kMaxRequestSize = 8192;
+
+    public:
+        MetricsHttpConnectionHandler()
+            : responded_(false)
+        {}
+
+        virtual ~MetricsHttpConnectionHandler()
+        {}
+
+    public:
+        virtual void onConnectionStarting(boost::shared_ptr<TcpConnection> connection)
+        {}
+
+        virtual void onSendError(boost::shared_ptr<TcpConnection> connection, const boost::system::error_code& ec)
+        {}
+
+        virtual void onSendComplete(boost::shared_ptr<TcpConnection> connection)
+        {
+            if (responded_)
+                connection->close();
+        }
+
+        virtual void onReceiveError(boost::shared_ptr<TcpConnection> connection, const boost::system::error_code& ec)
+        {}
+
+        virtual void onReceiveComplete(boost::shared_ptr<TcpConnection> connection, const unsigned char* buffer, size_t readBytes)
+        {
+            if (responded_)
+                return;
+
+            request_.append(reinterpret_cast<const char*>(buffer), readBytes);
+            size_t headerEnd = request_.find("\r\n\r\n");
+            if (headerEnd == std::string::npos)
+            {
+                if (request_.size() > kMaxRequestSize)
+                    respond_(connection, "431 Request Header Fields Too Large", "text/plain", "request too large\n");
+                return;
+            }
+
+            size_t lineEnd = request_.find("\r\n");
+            std::string line = request_.substr(0, lineEnd);
+            size_t methodEnd = line.find(' ');
+            size_t targetEnd = methodEnd == std::string::npos ? std::string::npos : line.find(' ', methodEnd + 1);
+            if (targetEnd == std::string::npos)
+            {
+                respond_(connection, "400 Bad Request", "text/plain", "bad request\n");
+                return;
+            }
+
+            std::string method = line.substr(0, methodEnd);
+            std::string target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+            size_t query = target.find('?');
+            if (query != std::string::npos)
+                target.resize(query);
+
+            if (target != "/metrics")
+                respond_(connection, "404 Not Found", "text/plain", "not found\n");
+            else if (method != "GET")
+                respond_(connection, "405 Method Not Allowed", "text/plain", "method not allowed\n");
+            else
+            {
+                boost::shared_ptr<MetricsHttpServer> server = boost::static_pointer_cast<MetricsHttpServer>(connection->server());
+                if (!server)
+                    connection->close();
+                else
+                    respond_(connection, "200 OK", MetricsRegistry::contentType(), server->registry().render());
+            }
+        }
+
+        virtual void onConnectionClosed(boost::shared_ptr<TcpConnection> connection)
+        {}
+
+    private:
+        void respond_(boost::shared_ptr<TcpConnection> connection, const char* status, const char* contentType, const std::string& body)
+        {
+            char header[256];
+            int headerSize = snprintf(header, sizeof(header), "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %llu\r\nConnection: close\r\n\r\n"
+                , status, contentType, static_cast<unsigned long long>(body.size()));
+
+            std::vector<unsigned char> response;
+            response.reserve(headerSize + body.size());
+            response.insert(response.end(), header, header + headerSize);
+            response.insert(response.end(), body.begin(), body.end());
+
+            responded_ = true;
+            request_.clear();
+            connection->send(response);
+        }
+
+    private:
+        bool responded_;
+        std::string request_;
+    };
+
+} } }
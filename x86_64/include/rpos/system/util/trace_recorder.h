@@ -0,0 +1,652 @@
+/*
+* trace_recorder.h
+* Low overhead scope tracing into per thread lock-free buffers, exported as Chrome Trace Event JSON
+* (loadable by chrome://tracing and the Perfetto UI)
+*
+* Copyright 2026 (c) Shanghai Slamtec Co., Ltd.
+*/
+
+#pragma once
+
+#include "time_util.h"
+#include "lock_free_loop_buffer.h"
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#   include <process.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace rpos { namespace system { namespace util {
+
+    /**
+    * A recorded trace event, names point to string literals or interned strings
+    */
+    struct TraceEvent {
+        // 'X' complete scope, 'i' instant (check point)
+        char phase;
+        const char* category;
+        const char* name;
+        const char* argument;
+        std::uint64_t timestamp;
+        std::uint64_t duration;
+    };
+
+    /**
+    * Events of one thread, written by that thread only and drained by the exporter
+    *
+    * When the thread exits the buffer is retired, and recycled for another thread once it is drained.
+    */
+    class TraceThreadBuffer : private boost::noncopyable {
+    public:
+        TraceThreadBuffer(std::uint32_t threadId, size_t capacity)
+            : threadId_(threadId)
+            , capacity_(detail::roundUpToPowerOf2(capacity < 2 ? 2 : capacity))
+            , mask_(capacity_ - 1)
+            , events_(capacity_)
+            , head_(0)
+            , tail_(0)
+            , dropped_(0)
+        {}
+
+    public:
+        /**
+        * Owner thread only
+        */
+        void push(const TraceEvent& event)
+        {
+            std::uint64_t tail = tail_.load(boost::memory_order_relaxed);
+            if (tail - head_.load(boost::memory_order_acquire) >= capacity_)
+            {
+                dropped_.fetch_add(1, boost::memory_order_relaxed);
+                return;
+            }
+            events_[tail & mask_] = event;
+            tail_.store(tail + 1, boost::memory_order_release);
+        }
+
+        /**
+        * Exporter only, moves the recorded events to out
+        */
+        void drain(std::vector<TraceEvent>& out)
+        {
+            std::uint64_t head = head_.load(boost::memory_order_relaxed);
+            std::uint64_t tail = tail_.load(boost::memory_order_acquire);
+            for (; head != tail; head++)
+                out.push_back(events_[head & mask_]);
+            head_.store(head, boost::memory_order_release);
+        }
+
+        /**
+        * Exporter only, drops the recorded events
+        *
+        * @return events dropped
+        */
+        std::uint64_t discard()
+        {
+            std::uint64_t head = head_.load(boost::memory_order_relaxed);
+            std::uint64_t tail = tail_.load(boost::memory_order_acquire);
+            head_.store(tail, boost::memory_order_release);
+            return tail - head;
+        }
+
+        bool empty() const
+        {
+            return head_.load(boost::memory_order_acquire) == tail_.load(boost::memory_order_acquire);
+        }
+
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        /**
+        * Hand a drained buffer of an exited thread to a new thread
+        */
+        void recycle(std::uint32_t threadId)
+        {
+            threadId_ = threadId;
+            dropped_.store(0, boost::memory_order_relaxed);
+            setThreadName(std::string());
+        }
+
+        std::uint32_t threadId() const
+        {
+            return threadId_;
+        }
+
+        std::string threadName() const
+        {
+            boost::lock_guard<boost::mutex> guard(nameLock_);
+            return threadName_;
+        }
+
+        void setThreadName(const std::string& name)
+        {
+            boost::lock_guard<boost::mutex> guard(nameLock_);
+            threadName_ = name;
+        }
+
+        std::uint64_t dropped() const
+        {
+            return dropped_.load(boost::memory_order_relaxed);
+        }
+
+    private:
+        // only changes while the buffer is not in use (see recycle)
+        std::uint32_t threadId_;
+        const size_t capacity_;
+        const size_t mask_;
+        std::vector<TraceEvent> events_;
+
+        mutable boost::mutex nameLock_;
+        std::string threadName_;
+
+        char padding0_[kCacheLineSize];
+        boost::atomic<std::uint64_t> head_;
+        char padding1_[kCacheLineSize];
+        boost::atomic<std::uint64_t> tail_;
+        boost::atomic<std::uint64_t> dropped_;
+    };
+
+    /**
+    * Process wide trace recorder
+    *
+    * Recording is off by default; while off, a TraceScope costs one relaxed atomic load. Each thread
+    * records into its own ring buffer (allocated on its first event), so recording never takes a lock.
+    * When a ring is full, new events of that thread are dropped until the next export.
+    *
+    * Memory stays bounded with short lived threads: the buffer of an exited thread is kept until its
+    * events are exported, then reused by the next new thread. At most maxRetiredBuffers buffers of
+    * exited threads wait for an export, beyond that the oldest one's events are dropped. Interned
+    * names are limited to maxInternedStrings.
+    */
+    class TraceRecorder : private boost::noncopyable {
+    private:
+        // the per thread buffer pointer is process wide, so there is exactly one recorder
+        TraceRecorder()
+            : enabled_(false)
+            , bufferCapacity_(64 * 1024)
+            , nextThreadId_(1)
+            , maxRetiredBuffers_(16)
+            , maxFreeBuffers_(4)
+            , maxInternedStrings_(4096)
+            , recycledDropped_(0)
+            , internOverflows_(0)
+        {}
+
+    public:
+        static TraceRecorder& instance()
+        {
+            static TraceRecorder recorder;
+            return recorder;
+        }
+
+    public:
+        bool isEnabled() const
+        {
+            return enabled_.load(boost::memory_order_relaxed);
+        }
+
+        void setEnabled(bool enabled)
+        {
+            enabled_.store(enabled, boost::memory_order_relaxed);
+        }
+
+        /**
+        * Events per thread for buffers created after this call
+        */
+        void setBufferCapacity(size_t capacity)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            bufferCapacity_ = capacity;
+        }
+
+        /**
+        * Buffers of exited threads kept for the next export, and drained ones kept for reuse
+        */
+        void setMaxRetiredBuffers(size_t retired, size_t free)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            maxRetiredBuffers_ = retired;
+            maxFreeBuffers_ = free;
+        }
+
+        /**
+        * Interned strings are never freed (events refer to them), once this many exist intern returns a placeholder
+        */
+        void setMaxInternedStrings(size_t count)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            maxInternedStrings_ = count;
+        }
+
+        /**
+        * Return a stable pointer for a dynamic name, for use as category, name or argument
+        */
+        const char* intern(const std::string& text)
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            auto iter = strings_.find(text);
+            if (iter != strings_.end())
+                return iter->c_str();
+            if (strings_.size() >= maxInternedStrings_)
+            {
+                internOverflows_++;
+                return "(too many trace names)";
+            }
+            return strings_.insert(text).first->c_str();
+        }
+
+        /**
+        * Number of intern calls answered with the placeholder
+        */
+        std::uint64_t internOverflows() const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            return internOverflows_;
+        }
+
+        /**
+        * Number of per thread buffers currently allocated
+        */
+        size_t allocatedBuffers() const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            return buffers_.size() + free_.size();
+        }
+
+        void record(const TraceEvent& event)
+        {
+            currentThreadBuffer_().push(event);
+        }
+
+        /**
+        * Name the calling thread in exported traces
+        */
+        void setCurrentThreadName(const std::string& name)
+        {
+            currentThreadBuffer_().setThreadName(name);
+        }
+
+        static std::uint64_t now()
+        {
+            return static_cast<std::uint64_t>(high_resolution_clock::get_time_in_ns());
+        }
+
+    public:
+        /**
+        * Drain all recorded events and write them as a Chrome Trace Event JSON document
+        *
+        * @return number of events written
+        */
+        size_t exportChromeTrace(std::ostream& out)
+        {
+            boost::lock_guard<boost::mutex> exportGuard(exportLock_);
+            std::vector<boost::shared_ptr<TraceThreadBuffer>> buffers;
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                buffers = buffers_;
+            }
+
+#ifdef _WIN32
+            int pid = _getpid();
+#else
+            int pid = static_cast<int>(getpid());
+#endif
+
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            size_t count = 0;
+            std::vector<TraceEvent> events;
+            std::string line;
+            for (auto iter = buffers.begin(); iter != buffers.end(); ++iter)
+            {
+                TraceThreadBuffer& buffer = **iter;
+                std::string threadName = buffer.threadName();
+                if (!threadName.empty())
+                {
+                    line = "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + std::to_string(pid)
+                        + ",\"tid\":" + std::to_string(buffer.threadId()) + ",\"args\":{\"name\":";
+                    appendJsonString_(line, threadName.c_str());
+                    line += "}}";
+                    writeEvent_(out, line, first);
+                }
+
+                events.clear();
+                buffer.drain(events);
+                for (auto event = events.begin(); event != events.end(); ++event)
+                {
+                    formatEvent_(*event, pid, buffer.threadId(), line);
+                    writeEvent_(out, line, first);
+                    count++;
+                }
+            }
+            out << "]}\n";
+
+            // exited threads whose events are all written no longer need their buffers
+            boost::lock_guard<boost::mutex> guard(lock_);
+            for (auto iter = retired_.begin(); iter != retired_.end();)
+            {
+                if ((*iter)->empty())
+                {
+                    recycle_(*iter);
+                    iter = retired_.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+            return count;
+        }
+
+        size_t exportChromeTraceToFile(const std::string& filename)
+        {
+            std::ofstream out(filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            if (!out)
+                return 0;
+            return exportChromeTrace(out);
+        }
+
+        /**
+        * Events dropped because a thread buffer was full
+        */
+        std::uint64_t droppedEvents() const
+        {
+            boost::lock_guard<boost::mutex> guard(lock_);
+            std::uint64_t dropped = recycledDropped_;
+            for (auto iter = buffers_.begin(); iter != buffers_.end(); ++iter)
+                dropped += (*iter)->dropped();
+            return dropped;
+        }
+
+    private:
+        /**
+        * Retires the buffer of a thread when the thread exits
+        */
+        struct ThreadBufferHolder_ {
+            ThreadBufferHolder_()
+                : buffer(nullptr)
+            {}
+
+            ~ThreadBufferHolder_()
+            {
+                if (buffer)
+                    TraceRecorder::instance().retire_(buffer);
+            }
+
+            TraceThreadBuffer* buffer;
+        };
+
+        TraceThreadBuffer& currentThreadBuffer_()
+        {
+            // buffers are owned by the recorder so events of finished threads can still be exported
+            static thread_local ThreadBufferHolder_ holder;
+            if (!holder.buffer)
+            {
+                boost::lock_guard<boost::mutex> guard(lock_);
+                boost::shared_ptr<TraceThreadBuffer> buffer;
+                while (!free_.empty() && !buffer)
+                {
+                    // capacity may have changed since the buffer was created
+                    if (free_.back()->capacity() >= bufferCapacity_)
+                    {
+                        buffer = free_.back();
+                        buffer->recycle(nextThreadId_++);
+                    }
+                    free_.pop_back();
+                }
+                if (!buffer)
+                    buffer.reset(new TraceThreadBuffer(nextThreadId_++, bufferCapacity_));
+                buffers_.push_back(buffer);
+                holder.buffer = buffer.get();
+            }
+            return *holder.buffer;
+        }
+
+        void retire_(TraceThreadBuffer* buffer)
+        {
+            // draining is the exporter's job, only do it here when no export is running
+            boost::unique_lock<boost::mutex> exportGuard(exportLock_, boost::try_to_lock);
+            boost::lock_guard<boost::mutex> guard(lock_);
+            for (auto iter = buffers_.begin(); iter != buffers_.end(); ++iter)
+            {
+                if (iter->get() != buffer)
+                    continue;
+                if (buffer->empty() && exportGuard.owns_lock())
+                    recycle_(*iter);
+                else
+                    retired_.push_back(*iter);
+                break;
+            }
+
+            while (exportGuard.owns_lock() && retired_.size() > maxRetiredBuffers_)
+            {
+                recycledDropped_ += retired_.front()->discard();
+                recycle_(retired_.front());
+                retired_.pop_front();
+            }
+        }
+
+        /**
+        * Move a drained buffer from buffers_ to the free list, requires lock_ and no concurrent drain
+        */
+        void recycle_(const boost::shared_ptr<TraceThreadBuffer>& buffer)
+        {
+            recycledDropped_ += buffer->dropped();
+            for (auto iter = buffers_.begin(); iter != buffers_.end(); ++iter)
+            {
+                if (*iter == buffer)
+                {
+                    buffers_.erase(iter);
+                    break;
+                }
+            }
+            if (free_.size() < maxFreeBuffers_)
+                free_.push_back(buffer);
+        }
+
+        static void appendJsonString_(std::string& dest, const char* text)
+        {
+            dest.push_back('"');
+            for (const char* p = text ? text : ""; *p; p++)
+            {
+                unsigned char c = static_cast<unsigned char>(*p);
+                switch (c)
+                {
+                case '"':
+                    dest += "\\\"";
+                    break;
+                case '\\':
+                    dest += "\\\\";
+                    break;
+                case '\n':
+                    dest += "\\n";
+                    break;
+                case '\r':
+                    dest += "\\r";
+                    break;
+                case '\t':
+                    dest += "\\t";
+                    break;
+                default:
+                    if (c < 0x20)
+                    {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        dest += escaped;
+                    }
+                    else
+                    {
+                        dest.push_back(static_cast<char>(c));
+                    }
+                    break;
+                }
+            }
+            dest.push_back('"');
+        }
+
+        static void appendMicroseconds_(std::string& dest, std::uint64_t ns)
+        {
+            // the trace event format uses microseconds, keep the nanosecond precision as decimals
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%llu.%03u", static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000));
+            dest += buffer;
+        }
+
+        static void formatEvent_(const TraceEvent& event, int pid, std::uint32_t tid, std::string& line)
+        {
+            line = "{\"ph\":\"";
+            line.push_back(event.phase);
+            line += "\",\"cat\":";
+            appendJsonString_(line, event.category);
+            line += ",\"name\":";
+            appendJsonString_(line, event.name);
+            line += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) + ",\"ts\":";
+            appendMicroseconds_(line, event.timestamp);
+            if (event.phase == 'X')
+            {
+                line += ",\"dur\":";
+                appendMicroseconds_(line, event.duration);
+            }
+            else if (event.phase == 'i')
+            {
+                line += ",\"s\":\"t\"";
+            }
+            if (event.argument)
+            {
+                line += ",\"args\":{\"arg\":";
+                appendJsonString_(line, event.argument);
+                line += "}";
+            }
+            line += "}";
+        }
+
+        static void writeEvent_(std::ostream& out, const std::string& line, bool& first)
+        {
+            if (!first)
+                out << ",\n";
+            out << line;
+            first = false;
+        }
+
+    private:
+        boost::atomic<bool> enabled_;
+
+        mutable boost::mutex lock_;
+        size_t bufferCapacity_;
+        std::uint32_t nextThreadId_;
+        // buffers of running threads and of exited threads not yet drained
+        std::vector<boost::shared_ptr<TraceThreadBuffer>> buffers_;
+        // exited threads, oldest first
+        std::deque<boost::shared_ptr<TraceThreadBuffer>> retired_;
+        // drained buffers ready for new threads
+        std::vector<boost::shared_ptr<TraceThreadBuffer>> free_;
+        size_t maxRetiredBuffers_;
+        size_t maxFreeBuffers_;
+        size_t maxInternedStrings_;
+        std::unordered_set<std::string> strings_;
+        std::uint64_t recycledDropped_;
+        std::uint64_t internOverflows_;
+
+        // taken before lock_ when both are needed
+        boost::mutex exportLock_;
+    };
+
+    /**
+    * Traced counterpart of ProfilingScope
+    *
+    * Records a complete event from construction to destruction and an instant event per check point.
+    * The const char* overloads expect string literals (or strings outliving the export), the
+    * std::string overloads intern their text, which is bounded (see TraceRecorder), so prefer
+    * literals for names built at run time from unbounded values.
+    */
+    class TraceScope : private boost::noncopyable {
+    public:
+        TraceScope(const char* module, const char* operation)
+            : recorder_(TraceRecorder::instance())
+            , enabled_(recorder_.isEnabled())
+            , module_(module)
+            , operation_(operation)
+            , argument_(nullptr)
+            , start_(enabled_ ? TraceRecorder::now() : 0)
+        {}
+
+        TraceScope(const std::string& module, const std::string& operation)
+            : recorder_(TraceRecorder::instance())
+            , enabled_(recorder_.isEnabled())
+            , module_(enabled_ ? recorder_.intern(module) : nullptr)
+            , operation_(enabled_ ? recorder_.intern(operation) : nullptr)
+            , argument_(nullptr)
+            , start_(enabled_ ? TraceRecorder::now() : 0)
+        {}
+
+        ~TraceScope()
+        {
+            if (!enabled_)
+                return;
+
+            TraceEvent event;
+            event.phase = 'X';
+            event.category = module_;
+            event.name = operation_;
+            event.argument = argument_;
+            event.timestamp = start_;
+            event.duration = TraceRecorder::now() - start_;
+            recorder_.record(event);
+        }
+
+    public:
+        void addArgument(const std::string& arg)
+        {
+            if (enabled_)
+                argument_ = recorder_.intern(arg);
+        }
+
+        void addCheckPoint(const char* checkpoint)
+        {
+            if (!enabled_)
+                return;
+
+            TraceEvent event;
+            event.phase = 'i';
+            event.category = module_;
+            event.name = checkpoint;
+            event.argument = operation_;
+            event.timestamp = TraceRecorder::now();
+            event.duration = 0;
+            recorder_.record(event);
+        }
+
+        void addCheckPoint(const std::string& checkpoint)
+        {
+            if (enabled_)
+                addCheckPoint(recorder_.intern(checkpoint));
+        }
+
+    private:
+        TraceRecorder& recorder_;
+        const bool enabled_;
+        const char* module_;
+        const char* operation_;
+        const char* argument_;
+        const std::uint64_t start_;
+    };
+
+} } }